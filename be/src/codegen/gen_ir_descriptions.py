@@ -40,6 +40,7 @@ ir_functions = [
 #    ["HASH_CRC", "IrCrcHash"],
 #    ["HASH_FVN", "IrFvnHash"],
     ["HASH_JOIN_PROCESS_BUILD_BATCH", "12HashJoinNode19process_build_batch"],
+    ["HASH_JOIN_APPEND_BUILD_BATCH", "12HashJoinNode18append_build_batch"],
     ["HASH_JOIN_PROCESS_PROBE_BATCH", "12HashJoinNode19process_probe_batch"],
     ["EXPR_GET_BOOLEAN_VAL", "4Expr15get_boolean_val"],
     ["EXPR_GET_TINYINT_VAL", "4Expr16get_tiny_int_val"],
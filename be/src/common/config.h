@@ -185,6 +185,24 @@ namespace config {
     CONF_Int32(doris_max_scan_key_num, "1024");
     // return_row / total_row
     CONF_Int32(doris_max_pushdown_conjuncts_return_rate, "90");
+    // hash joins whose build side is too large to push down as an in predicate
+    // push down a runtime filter, the range and a bloom filter of the keys
+    CONF_Bool(enable_hash_join_runtime_filter, "true");
+    // build sides with more rows only push down the range of their keys
+    CONF_Int64(runtime_filter_max_bloom_filter_rows, "16777216");
+    // false positive probability of the bloom filter of a runtime filter
+    CONF_Double(runtime_filter_bloom_filter_fpp, "0.05");
+    // olap scans wait at most this long for the runtime filters published by
+    // hash joins in other fragments, and scan without the missing ones
+    CONF_Int32(runtime_filter_wait_time_ms, "1000");
+    // timeout of the rpcs merging and publishing runtime filters
+    CONF_Int32(runtime_filter_rpc_timeout_ms, "5000");
+    // runtime filters merged or published are dropped after this long
+    CONF_Int32(runtime_filter_expire_time_sec, "600");
+    // number of threads linking the build rows of a hash join into its hash table,
+    // each in its own range of buckets. 1 builds the hash table on the build side
+    // thread, row by row
+    CONF_Int32(hash_join_build_threads, "1");
     // (Advanced) Maximum size of per-query receive-side buffer
     CONF_Int32(exchg_node_buffer_size_bytes, "10485760");
     // insert sort threadhold for sorter
@@ -196,6 +214,14 @@ namespace config {
 
     CONF_Int64(column_dictionary_key_ration_threshold, "0");
     CONF_Int64(column_dictionary_key_size_threshold, "0");
+    // level of LZ4-HC for tables created with compress_kind LZ4HC, from 1 to 12
+    CONF_Int32(lz4hc_compression_level, "9");
+    // decode the columns of pushed down predicates first when scanning a
+    // segment, and the other columns only up to the last row that passes
+    CONF_Bool(enable_segment_late_materialization, "true");
+    // scan tables whose rows need no merge a batch at a time, converting
+    // column vectors to tuples without going through RowCursor
+    CONF_Bool(enable_vectorized_olap_scan, "true");
     // if true, output IR after optimization passes
     CONF_Bool(dump_ir, "false");
     // if set, saves the generated IR to the output file.
@@ -229,7 +255,38 @@ namespace config {
     //file descriptors cache, by default, cache 30720 descriptors
     CONF_Int32(file_descriptor_cache_capacity, "30720");
     CONF_Int64(index_stream_cache_capacity, "10737418240");
+    // eviction policy of the file descriptor, index stream and stream page
+    // caches: lru, or slru (segmented LRU) to keep entries looked up more than
+    // once from being evicted by scans
+    CONF_String(cache_eviction_policy, "lru");
+    // part of the capacity of an slru cache for entries looked up more than once
+    CONF_Int32(cache_slru_protected_percent, "80");
+    // when a cache is full, admit a new entry only if its key was looked up
+    // more often than the key of the entry it evicts (TinyLFU)
+    CONF_Bool(cache_tinylfu_admission, "false");
+    // decompressed blocks of column data streams shared by queries, 0 to disable
+    CONF_Int64(stream_page_cache_capacity, "1073741824");
+    // threads reading data streams of segments ahead of queries, 0 (the
+    // default) to read synchronously. Each stream of a scan holds up to two
+    // windows of segment_read_ahead_window_bytes, charged to the query.
+    // Reads are not queued beyond segment_read_ahead_queue_size, the scanner
+    // does them itself then.
+    CONF_Int32(segment_read_ahead_num_threads, "0");
+    CONF_Int32(segment_read_ahead_queue_size, "2048");
+    CONF_Int64(segment_read_ahead_window_bytes, "131072");
     CONF_Int64(max_packed_row_block_size, "20971520");
+    // bloom filter columns of type CHAR and VARCHAR also get an ngram bloom
+    // filter of each row block, which prunes blocks for LIKE '%foo%'. Grams
+    // are this many bytes, at most 8, 0 to disable. BEs that do not know the
+    // ngram bloom filter stream can not read segments written with it.
+    CONF_Int32(ngram_bloom_filter_gram_size, "0");
+    // the short key index of a segment keeps the key prefix of one entry out
+    // of this many in a first level searched before the entries, 0 to disable
+    CONF_Int32(short_key_index_sample_interval, "16");
+    // read the entries of the short key index of a segment on its first seek
+    // and keep them in the index stream cache, which may evict them, instead
+    // of holding them in memory from when the segment group is opened
+    CONF_Bool(short_key_index_lazy_load, "true");
 
     // be policy
     CONF_Int64(base_compaction_start_hour, "20");
@@ -248,6 +305,23 @@ namespace config {
     CONF_Int64(cumulative_compaction_budgeted_bytes, "104857600");
     CONF_Int32(cumulative_compaction_write_mbytes_per_sec, "100");
 
+    // compaction threads per data dir, if > 0 they replace
+    // *_compaction_num_threads and at most this many compactions of a kind
+    // run on a dir at a time
+    CONF_Int32(base_compaction_num_threads_per_disk, "0");
+    CONF_Int32(cumulative_compaction_num_threads_per_disk, "0");
+    // bytes per second written by all compactions and schema changes of a
+    // data dir together, 0 for no limit
+    CONF_Int64(compaction_disk_write_mbytes_per_sec, "0");
+    // compaction priority: tablets queried often go first, large ones later.
+    // Query counts are halved every half life.
+    CONF_Double(compaction_query_hotness_weight, "0.5");
+    CONF_Double(compaction_data_size_weight, "0.1");
+    CONF_Int64(compaction_query_hotness_half_life_sec, "600");
+    // merge compactions and schema changes a batch of rows at a time,
+    // column by column, when no delete condition applies
+    CONF_Bool(enable_columnar_compaction, "false");
+
     // Port to start debug webserver on
     CONF_Int32(webserver_port, "8040");
     // Interface to start debug webserver on. If blank, webserver binds to 0.0.0.0
@@ -372,6 +446,23 @@ namespace config {
     // write buffer size before flush
     CONF_Int32(write_buffer_size, "104857600");
 
+    // number of shards of a memtable. with more than one shard, batches of the
+    // same tablet from different senders are inserted in parallel
+    CONF_Int32(memtable_shard_num, "1");
+    // append rows of DUP_KEYS tables to the memtable and sort them once on
+    // flush, instead of keeping them sorted in a skiplist
+    CONF_Bool(memtable_sort_dup_keys_on_flush, "true");
+    // aggregate rows of AGG_KEYS and UNIQUE_KEYS tables in a hash index on the
+    // key and sort the distinct rows once on flush, instead of keeping them
+    // sorted in a skiplist
+    CONF_Bool(memtable_hash_aggregate, "true");
+
+    // number of threads flushing memtables, per data dir
+    CONF_Int32(flush_thread_num_per_store, "2");
+    // max memtables of one tablet being flushed at the same time. a writer
+    // with more in flight blocks until one of them is done
+    CONF_Int32(max_flushing_memtable_per_writer, "2");
+
     // update interval of tablet stat cache
     CONF_Int32(tablet_stat_cache_update_interval_second, "300");
 
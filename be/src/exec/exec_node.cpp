@@ -33,6 +33,7 @@
 #include "exec/es_scan_node.h"
 #include "exec/pre_aggregation_node.h"
 #include "exec/hash_join_node.h"
+#include "exec/partitioned_hash_join_node.h"
 #include "exec/broker_scan_node.h"
 #include "exec/cross_join_node.h"
 #include "exec/empty_set_node.h"
@@ -386,7 +387,15 @@ Status ExecNode::create_node(RuntimeState* state, ObjectPool* pool, const TPlanN
           *node = pool->add(new PreAggregationNode(pool, tnode, descs));
           return Status::OK;*/
     case TPlanNodeType::HASH_JOIN_NODE:
-        *node = pool->add(new HashJoinNode(pool, tnode, descs));
+        // PartitionedHashJoinNode neither pushes predicates down to the probe side nor
+        // publishes runtime filters, the plans expecting them keep HashJoinNode.
+        if (config::enable_partitioned_hash_join
+                && !tnode.hash_join_node.is_push_down
+                && tnode.hash_join_node.runtime_filters.empty()) {
+            *node = pool->add(new PartitionedHashJoinNode(pool, tnode, descs));
+        } else {
+            *node = pool->add(new HashJoinNode(pool, tnode, descs));
+        }
         return Status::OK;
 
     case TPlanNodeType::CROSS_JOIN_NODE:
@@ -20,14 +20,23 @@
 #include <sstream>
 
 #include "codegen/llvm_codegen.h"
+#include "common/config.h"
 #include "exec/hash_table.hpp"
 #include "exprs/expr.h"
 #include "exprs/in_predicate.h"
+#include "exprs/runtime_filter_predicate.h"
+#include "exprs/runtime_filter.h"
 #include "exprs/slot_ref.h"
+#include "runtime/exec_env.h"
 #include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
+#include "service/brpc.h"
+#include "util/brpc_stub_cache.h"
 #include "util/runtime_profile.h"
+#include "util/uid_util.h"
 #include "gen_cpp/PlanNodes_types.h"
+#include "gen_cpp/internal_service.pb.h"
+#include "gen_cpp/palo_internal_service.pb.h"
 
 using llvm::Function;
 using llvm::PointerType;
@@ -38,11 +47,18 @@ using llvm::LLVMContext;
 namespace doris {
 const char* HashJoinNode::_s_llvm_class_name = "class.doris::HashJoinNode";
 
+// Build sides of up to this many rows are pushed down as in predicates,
+// larger ones as runtime filters
+static const int64_t MAX_IN_PREDICATE_ROWS = 1024;
+
 HashJoinNode::HashJoinNode(
         ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs) :
             ExecNode(pool, tnode, descs),
             _join_op(tnode.hash_join_node.join_op),
+            _probe_group_start(0),
+            _probe_group_end(0),
             _probe_eos(false),
+            _use_runtime_filters(false),
             _codegen_process_build_batch_fn(NULL),
             _process_build_batch_fn(NULL),
             _process_probe_batch_fn(NULL),
@@ -53,6 +69,9 @@ HashJoinNode::HashJoinNode(
     _match_all_build =
         (_join_op == TJoinOp::RIGHT_OUTER_JOIN || _join_op == TJoinOp::FULL_OUTER_JOIN);
     _is_push_down = tnode.hash_join_node.is_push_down;
+    if (tnode.hash_join_node.__isset.runtime_filters) {
+        _global_runtime_filter_descs = tnode.hash_join_node.runtime_filters;
+    }
 }
 
 HashJoinNode::~HashJoinNode() {
@@ -77,6 +96,15 @@ Status HashJoinNode::init(const TPlanNode& tnode, RuntimeState* state) {
         Expr::create_expr_trees(_pool, tnode.hash_join_node.other_join_conjuncts,
                               &_other_join_conjunct_ctxs));
 
+    for (const TRuntimeFilterDesc& desc : _global_runtime_filter_descs) {
+        if (desc.expr_order < 0 || desc.expr_order >= eq_join_conjuncts.size()) {
+            std::stringstream ss;
+            ss << "invalid expr order of runtime filter " << desc.filter_id
+               << ", expr_order=" << desc.expr_order;
+            return Status(ss.str());
+        }
+    }
+
     return Status::OK;
 }
 
@@ -100,6 +128,8 @@ Status HashJoinNode::prepare(RuntimeState* state) {
         ADD_COUNTER(runtime_profile(), "ProbeRows", TUnit::UNIT);
     _hash_tbl_load_factor_counter =
         ADD_COUNTER(runtime_profile(), "LoadFactor", TUnit::DOUBLE_VALUE);
+    _range_only_runtime_filters_counter =
+        ADD_COUNTER(runtime_profile(), "RangeOnlyRuntimeFilters", TUnit::UNIT);
 
     // build and probe exprs are evaluated in the context of the rows produced by our
     // right and left children, respectively
@@ -154,8 +184,9 @@ Status HashJoinNode::prepare(RuntimeState* state) {
             return Status::OK;
         }
 
-        // Codegen for build path
-        _codegen_process_build_batch_fn = codegen_process_build_batch(state, hash_fn);
+        // Codegen for build path, appending the rows if they are linked by several threads
+        _codegen_process_build_batch_fn = codegen_process_build_batch(
+            state, hash_fn, config::hash_join_build_threads > 1);
         if (_codegen_process_build_batch_fn != NULL) {
             codegen->add_function_to_jit(
                 _codegen_process_build_batch_fn,
@@ -200,6 +231,10 @@ Status HashJoinNode::close(RuntimeState* state) {
     Expr::close(_build_expr_ctxs, state);
     Expr::close(_probe_expr_ctxs, state);
     Expr::close(_other_join_conjunct_ctxs, state);
+    // the filters not finished release their hashes from mem_tracker() before
+    // it is closed, the finished ones pushed down hold none
+    _runtime_filters.clear();
+    _global_runtime_filters.clear();
 #if 0
     for (auto iter : _push_down_expr_ctxs) {
         iter->close(state);
@@ -224,6 +259,7 @@ Status HashJoinNode::construct_hash_table(RuntimeState* state) {
     // don't need to be stored in the _build_pool.
     RowBatch build_batch(child(1)->row_desc(), state->batch_size(), mem_tracker());
     RETURN_IF_ERROR(child(1)->open(state));
+    const int build_threads = config::hash_join_build_threads;
 
     while (true) {
         RETURN_IF_CANCELLED(state);
@@ -235,10 +271,20 @@ Status HashJoinNode::construct_hash_table(RuntimeState* state) {
         RETURN_IF_LIMIT_EXCEEDED(state);
 
         // Call codegen version if possible
-        if (_process_build_batch_fn == NULL) {
-            process_build_batch(&build_batch);
-        } else {
+        if (!_runtime_filters.empty() || !_global_runtime_filters.empty()) {
+            process_build_batch_with_filters(&build_batch, build_threads > 1);
+        } else if (_process_build_batch_fn != NULL) {
             _process_build_batch_fn(this, &build_batch);
+        } else if (build_threads > 1) {
+            append_build_batch(&build_batch);
+        } else {
+            process_build_batch(&build_batch);
+        }
+
+        if (_use_runtime_filters && _runtime_filters.empty()
+                && _hash_tbl->size() > MAX_IN_PREDICATE_ROWS) {
+            SCOPED_TIMER(_push_compute_timer);
+            create_runtime_filters();
         }
 
         VLOG_ROW << _hash_tbl->debug_string(true, &child(1)->row_desc());
@@ -253,6 +299,178 @@ Status HashJoinNode::construct_hash_table(RuntimeState* state) {
         }
     }
 
+    if (build_threads > 1) {
+        SCOPED_TIMER(_build_timer);
+        bool resized = _hash_tbl->link_nodes(build_threads, state->resource_pool());
+        COUNTER_SET(_build_buckets_counter, _hash_tbl->num_buckets());
+        COUNTER_SET(_hash_tbl_load_factor_counter, _hash_tbl->load_factor());
+        if (!resized) {
+            return state->set_mem_limit_exceeded("Hash join build exceeded mem limit"
+                    " growing the hash table buckets.");
+        }
+    }
+
+    if (!_global_runtime_filters.empty()) {
+        send_global_runtime_filters(state);
+    }
+    return Status::OK;
+}
+
+void HashJoinNode::create_runtime_filters() {
+    for (int i = 0; i < _build_expr_ctxs.size(); ++i) {
+        const TypeDescriptor& type = _build_expr_ctxs[i]->root()->type();
+        if (!RuntimeFilter::is_supported(type.type)
+                || type.type != _probe_expr_ctxs[i]->root()->type().type) {
+            _runtime_filters.push_back(nullptr);
+            continue;
+        }
+        _runtime_filters.emplace_back(new RuntimeFilter(
+                type, config::runtime_filter_max_bloom_filter_rows,
+                config::runtime_filter_bloom_filter_fpp, mem_tracker()));
+    }
+    // only the rows before the table grew past MAX_IN_PREDICATE_ROWS are
+    // evaluated again, the later ones are added as they are inserted
+    for (int64_t i = 0; i < _hash_tbl->size(); ++i) {
+        TupleRow* row = _hash_tbl->get_row(i);
+        for (int j = 0; j < _runtime_filters.size(); ++j) {
+            if (_runtime_filters[j] != nullptr) {
+                _runtime_filters[j]->insert(_build_expr_ctxs[j]->get_value(row));
+            }
+        }
+    }
+}
+
+void HashJoinNode::process_build_batch_with_filters(RowBatch* build_batch, bool append) {
+    for (int i = 0; i < build_batch->num_rows(); ++i) {
+        int64_t num_rows = _hash_tbl->size();
+        if (append) {
+            _hash_tbl->append(build_batch->get_row(i));
+        } else {
+            _hash_tbl->insert(build_batch->get_row(i));
+        }
+        // a row the table skips for its NULL key matches nothing
+        if (_hash_tbl->size() == num_rows) {
+            continue;
+        }
+        for (int j = 0; j < _runtime_filters.size(); ++j) {
+            if (_runtime_filters[j] != nullptr && !_hash_tbl->last_expr_value_null(j)) {
+                _runtime_filters[j]->insert(_hash_tbl->last_expr_value(j));
+            }
+        }
+        for (int j = 0; j < _global_runtime_filters.size(); ++j) {
+            int expr_idx = _global_runtime_filter_descs[j].expr_order;
+            if (_global_runtime_filters[j] != nullptr
+                    && !_hash_tbl->last_expr_value_null(expr_idx)) {
+                _global_runtime_filters[j]->insert(_hash_tbl->last_expr_value(expr_idx));
+            }
+        }
+    }
+}
+
+// Logs the outcome of an asynchronous merge_runtime_filter rpc, then
+// deletes itself
+class MergeRuntimeFilterClosure : public google::protobuf::Closure {
+public:
+    MergeRuntimeFilterClosure(int32_t filter_id, const TNetworkAddress& merge_addr)
+            : _filter_id(filter_id), _merge_addr(merge_addr) { }
+
+    void Run() override {
+        if (cntl.Failed()) {
+            LOG(WARNING) << "fail to merge runtime filter " << _filter_id
+                         << ", merge_addr=" << _merge_addr << ", error=" << cntl.ErrorText();
+        } else {
+            Status status(result.status());
+            if (!status.ok()) {
+                LOG(WARNING) << "fail to merge runtime filter " << _filter_id
+                             << ", merge_addr=" << _merge_addr
+                             << ", error=" << status.get_error_msg();
+            }
+        }
+        delete this;
+    }
+
+    brpc::Controller cntl;
+    PMergeRuntimeFilterResult result;
+
+private:
+    int32_t _filter_id;
+    TNetworkAddress _merge_addr;
+};
+
+void HashJoinNode::send_global_runtime_filters(RuntimeState* state) {
+    SCOPED_TIMER(_push_down_timer);
+    for (int i = 0; i < _global_runtime_filters.size(); ++i) {
+        if (_global_runtime_filters[i] == nullptr) {
+            continue;
+        }
+        const TRuntimeFilterDesc& desc = _global_runtime_filter_descs[i];
+        PMergeRuntimeFilterRequest request;
+        *request.mutable_query_id() = UniqueId(state->query_id()).to_proto();
+        request.set_filter_id(desc.filter_id);
+        request.set_num_producers(desc.num_producers);
+        for (const TNetworkAddress& addr : desc.target_addrs) {
+            PNetworkAddress* target = request.add_targets();
+            target->set_hostname(addr.hostname);
+            target->set_port(addr.port);
+        }
+        _global_runtime_filters[i]->finish();
+        _global_runtime_filters[i]->to_protobuf(request.mutable_filter());
+        VLOG(1) << "send runtime filter " << desc.filter_id << ", "
+                << _global_runtime_filters[i]->debug_string();
+
+        palo::PInternalService_Stub* stub =
+            state->exec_env()->brpc_stub_cache()->get_stub(desc.merge_addr);
+        if (stub == nullptr) {
+            LOG(WARNING) << "fail to get stub to merge runtime filter " << desc.filter_id
+                         << ", merge_addr=" << desc.merge_addr;
+            continue;
+        }
+        // the request is serialized by the call, the closure outlives the join
+        MergeRuntimeFilterClosure* closure =
+            new MergeRuntimeFilterClosure(desc.filter_id, desc.merge_addr);
+        closure->cntl.set_timeout_ms(config::runtime_filter_rpc_timeout_ms);
+        stub->merge_runtime_filter(&closure->cntl, &request, &closure->result, closure);
+    }
+    // the filters are no longer needed once sent
+    _global_runtime_filters.clear();
+}
+
+// Type descriptor of a predicate pushed down to the probe side
+static TTypeDesc boolean_type_desc() {
+    TScalarType tscalar_type;
+    tscalar_type.__set_type(TPrimitiveType::BOOLEAN);
+    TTypeNode ttype_node;
+    ttype_node.__set_type(TTypeNodeType::SCALAR);
+    ttype_node.__set_scalar_type(tscalar_type);
+    TTypeDesc t_type_desc;
+    t_type_desc.types.push_back(ttype_node);
+    return t_type_desc;
+}
+
+Status HashJoinNode::push_down_runtime_filters(RuntimeState* state, bool* pushed) {
+    *pushed = false;
+    for (int i = 0; i < _runtime_filters.size(); ++i) {
+        if (_runtime_filters[i] == nullptr) {
+            continue;
+        }
+        {
+            SCOPED_TIMER(_push_compute_timer);
+            _runtime_filters[i]->finish();
+        }
+        TExprNode node;
+        node.__set_node_type(TExprNodeType::RUNTIME_FILTER_PRED);
+        node.__set_type(boolean_type_desc());
+        RuntimeFilterPredicate* pred =
+            _pool->add(new RuntimeFilterPredicate(node, _runtime_filters[i]));
+        pred->add_child(Expr::copy(_pool, _probe_expr_ctxs[i]->root()));
+        _push_down_expr_ctxs.push_back(_pool->add(new ExprContext(pred)));
+        VLOG(1) << "push down " << pred->debug_string();
+        *pushed = true;
+    }
+    if (*pushed) {
+        SCOPED_TIMER(_push_down_timer);
+        push_down_predicate(state, &_push_down_expr_ctxs);
+    }
     return Status::OK;
 }
 
@@ -274,6 +492,45 @@ Status HashJoinNode::open(RuntimeState* state) {
     // main thread
     boost::promise<Status> thread_status;
 
+    if (_children[0]->type() == TPlanNodeType::EXCHANGE_NODE
+            && _children[1]->type() == TPlanNodeType::EXCHANGE_NODE) {
+        _is_push_down = false;
+    }
+
+    // The runtime filters are created by construct_hash_table once the hash
+    // table is too large for in predicates.
+    _use_runtime_filters = _is_push_down && config::enable_hash_join_runtime_filter;
+
+    // The global runtime filters are sent whether the join is pushed down or
+    // not, their targets are the scans of other fragments.
+    for (const TRuntimeFilterDesc& desc : _global_runtime_filter_descs) {
+        const TypeDescriptor& type = _build_expr_ctxs[desc.expr_order]->root()->type();
+        if (!RuntimeFilter::is_supported(type.type)) {
+            LOG(WARNING) << "runtime filter " << desc.filter_id << " of unsupported type " << type;
+            _global_runtime_filters.push_back(nullptr);
+            continue;
+        }
+        // The bloom filters of all the instances need the same size to merge,
+        // which only the plan can fix. A single instance sizes its bloom
+        // filter by its keys, as it is merged with no other.
+        bool sized_by_plan = desc.__isset.expected_build_rows && desc.expected_build_rows > 0;
+        int64_t max_bloom_filter_rows = config::runtime_filter_max_bloom_filter_rows;
+        if (!sized_by_plan && desc.num_producers > 1) {
+            LOG(INFO) << "runtime filter " << desc.filter_id << " has no expected build rows, "
+                      << "only the range of its keys is sent";
+            COUNTER_UPDATE(_range_only_runtime_filters_counter, 1);
+            max_bloom_filter_rows = 0;
+        }
+        std::shared_ptr<RuntimeFilter> filter(new RuntimeFilter(
+                type, max_bloom_filter_rows, config::runtime_filter_bloom_filter_fpp,
+                mem_tracker()));
+        if (sized_by_plan) {
+            filter->init_bloom_filter(std::min<int64_t>(
+                    desc.expected_build_rows, config::runtime_filter_max_bloom_filter_rows));
+        }
+        _global_runtime_filters.push_back(filter);
+    }
+
     if (state->resource_pool()->try_acquire_thread_token()) {
         add_runtime_exec_option("Hash Table Built Asynchronously");
         boost::thread(bind(&HashJoinNode::build_side_thread, this, state, &thread_status));
@@ -281,11 +538,6 @@ Status HashJoinNode::open(RuntimeState* state) {
         thread_status.set_value(construct_hash_table(state));
     }
 
-    if (_children[0]->type() == TPlanNodeType::EXCHANGE_NODE
-            && _children[1]->type() == TPlanNodeType::EXCHANGE_NODE) {
-        _is_push_down = false;
-    }
-
     if (_is_push_down) {
         // Blocks until ConstructHashTable has returned, after which
         // the hash table is fully constructed and we can start the probe
@@ -302,23 +554,22 @@ Status HashJoinNode::open(RuntimeState* state) {
             return Status::OK;
         }
 
-        if (_hash_tbl->size() > 1024) {
+        // Too many keys for in predicates, push down the runtime filters
+        bool runtime_filter_pushed = false;
+        if (_hash_tbl->size() > MAX_IN_PREDICATE_ROWS) {
             _is_push_down = false;
+            RETURN_IF_ERROR(push_down_runtime_filters(state, &runtime_filter_pushed));
         }
+        // the predicates hold the filters they need
+        _runtime_filters.clear();
 
         // TODO: this is used for Code Check, Remove this later
-        if (_is_push_down || 0 != child(1)->conjunct_ctxs().size()) {
+        if (!runtime_filter_pushed
+                && (_is_push_down || 0 != child(1)->conjunct_ctxs().size())) {
             for (int i = 0; i < _probe_expr_ctxs.size(); ++i) {
                 TExprNode node;
                 node.__set_node_type(TExprNodeType::IN_PRED);
-                TScalarType tscalar_type;
-                tscalar_type.__set_type(TPrimitiveType::BOOLEAN);
-                TTypeNode ttype_node;
-                ttype_node.__set_type(TTypeNodeType::SCALAR);
-                ttype_node.__set_scalar_type(tscalar_type);
-                TTypeDesc t_type_desc;
-                t_type_desc.types.push_back(ttype_node);
-                node.__set_type(t_type_desc);
+                node.__set_type(boolean_type_desc());
                 node.in_predicate.__set_is_not_in(false);
                 node.__set_opcode(TExprOpcode::FILTER_IN);
                 node.__isset.vector_opcode = true;
@@ -382,6 +633,7 @@ Status HashJoinNode::open(RuntimeState* state) {
         RETURN_IF_ERROR(child(0)->get_next(state, _probe_batch.get(), &_probe_eos));
         COUNTER_UPDATE(_probe_rows_counter, _probe_batch->num_rows());
         _probe_batch_pos = 0;
+        _probe_group_start = _probe_group_end = 0;
 
         if (_probe_batch->num_rows() == 0) {
             if (_probe_eos) {
@@ -543,6 +795,7 @@ Status HashJoinNode::get_next(RuntimeState* state, RowBatch* out_batch, bool* eo
             // pass on resources, out_batch might still need them
             _probe_batch->transfer_resource_ownership(out_batch);
             _probe_batch_pos = 0;
+            _probe_group_start = _probe_group_end = 0;
 
             if (out_batch->is_full() || out_batch->at_resource_limit()) {
                 return Status::OK;
@@ -590,10 +843,15 @@ Status HashJoinNode::get_next(RuntimeState* state, RowBatch* out_batch, bool* eo
         }
 
         // join remaining rows in probe _batch
-        _current_probe_row = _probe_batch->get_row(_probe_batch_pos++);
+        if (_probe_batch_pos >= _probe_group_end) {
+            _probe_group_start = _probe_batch_pos;
+            _probe_group_end = _probe_batch_pos
+                + _hash_tbl->eval_and_hash_probe_group(_probe_batch.get(), _probe_batch_pos);
+        }
+        _current_probe_row = _probe_batch->get_row(_probe_batch_pos);
         VLOG_ROW << "probe row: " << get_probe_row_output_string(_current_probe_row);
         _matched_probe = false;
-        _hash_tbl_iterator = _hash_tbl->find(_current_probe_row);
+        _hash_tbl_iterator = _hash_tbl->find_cached(_probe_batch_pos++ - _probe_group_start);
     }
 
     *eos = true;
@@ -683,6 +941,7 @@ Status HashJoinNode::left_join_get_next(RuntimeState* state,
         if (!_hash_tbl_iterator.has_next() && _probe_batch_pos == _probe_batch->num_rows()) {
             _probe_batch->transfer_resource_ownership(out_batch);
             _probe_batch_pos = 0;
+            _probe_group_start = _probe_group_end = 0;
 
             if (out_batch->is_full() || out_batch->at_resource_limit()) {
                 break;
@@ -856,15 +1115,16 @@ Function* HashJoinNode::codegen_create_output_row(LlvmCodeGen* codegen) {
     return codegen->finalize_function(fn);
 }
 
-Function* HashJoinNode::codegen_process_build_batch(RuntimeState* state, Function* hash_fn) {
+Function* HashJoinNode::codegen_process_build_batch(
+        RuntimeState* state, Function* hash_fn, bool append) {
     LlvmCodeGen* codegen = NULL;
     if (!state->get_codegen(&codegen).ok()) {
         return NULL;
     }
 
     // Get cross compiled function
-    Function* process_build_batch_fn = codegen->get_function(
-        IRFunction::HASH_JOIN_PROCESS_BUILD_BATCH);
+    Function* process_build_batch_fn = codegen->get_function(append ?
+        IRFunction::HASH_JOIN_APPEND_BUILD_BATCH : IRFunction::HASH_JOIN_PROCESS_BUILD_BATCH);
     DCHECK(process_build_batch_fn != NULL);
 
     // Codegen for evaluating build rows
@@ -21,6 +21,7 @@
 #include <boost/scoped_ptr.hpp>
 #include <boost/unordered_set.hpp>
 #include <boost/thread.hpp>
+#include <memory>
 #include <string>
 
 #include "exec/exec_node.h"
@@ -31,6 +32,7 @@ namespace doris {
 
 class MemPool;
 class RowBatch;
+class RuntimeFilter;
 class TupleRow;
 
 // Node for in-memory hash joins:
@@ -80,6 +82,20 @@ private:
     std::vector<ExprContext*> _build_expr_ctxs;
     std::list<ExprContext*> _push_down_expr_ctxs;
 
+    // true if the join is pushed down and may push down runtime filters
+    bool _use_runtime_filters;
+    // runtime filter of the keys of each equi-join conjunct, NULL for types
+    // without runtime filter. They are only pushed down for build sides too
+    // large for in predicates, so they are created once the hash table grows
+    // past that, see create_runtime_filters().
+    std::vector<std::shared_ptr<RuntimeFilter>> _runtime_filters;
+
+    // runtime filters sent to the backend merging them for the scans of other
+    // fragments, filled while the hash table is built, NULL for types without
+    // runtime filter
+    std::vector<TRuntimeFilterDesc> _global_runtime_filter_descs;
+    std::vector<std::shared_ptr<RuntimeFilter>> _global_runtime_filters;
+
     // non-equi-join conjuncts from the JOIN clause
     std::vector<ExprContext*> _other_join_conjunct_ctxs;
 
@@ -103,6 +119,11 @@ private:
     // is responsible for.
     boost::scoped_ptr<RowBatch> _probe_batch;
     int _probe_batch_pos;  // current scan pos in _probe_batch
+    // Rows [_probe_group_start, _probe_group_end) of _probe_batch are hashed and cached
+    // in _hash_tbl, see HashTable::eval_and_hash_probe_group(). Reset when
+    // _probe_batch is refilled.
+    int _probe_group_start;
+    int _probe_group_end;
     bool _probe_eos;  // if true, probe child has no more rows to process
     TupleRow* _current_probe_row;
 
@@ -118,7 +139,7 @@ private:
     llvm::Function* _codegen_process_build_batch_fn;
 
     // Function declaration for codegen'd function.  Signature must match
-    // HashJoinNode::ProcessBuildBatch
+    // HashJoinNode::ProcessBuildBatch and HashJoinNode::append_build_batch
     typedef void (*ProcessBuildBatchFn)(HashJoinNode*, RowBatch*);
     ProcessBuildBatchFn _process_build_batch_fn;
 
@@ -138,6 +159,8 @@ private:
     RuntimeProfile::Counter* _probe_rows_counter;   // num probe rows
     RuntimeProfile::Counter* _build_buckets_counter;   // num buckets in hash table
     RuntimeProfile::Counter* _hash_tbl_load_factor_counter;
+    // global runtime filters sent without bloom filter, see open()
+    RuntimeProfile::Counter* _range_only_runtime_filters_counter;
 
     // Supervises ConstructHashTable in a separate thread, and
     // returns its status in the promise parameter.
@@ -149,6 +172,10 @@ private:
     // same time.
     Status construct_hash_table(RuntimeState* state);
 
+    // Appends the rows of build_batch to _hash_tbl, they are linked into its buckets by
+    // several threads once the build side is consumed.
+    void append_build_batch(RowBatch* build_batch);
+
     // GetNext helper function for the common join cases: Inner join, left semi and left
     // outer
     Status left_join_get_next(RuntimeState* state, RowBatch* row_batch, bool* eos);
@@ -164,6 +191,23 @@ private:
     // Construct the build hash table, adding all the rows in 'build_batch'
     void process_build_batch(RowBatch* build_batch);
 
+    // Create _runtime_filters and add the keys of the rows already in _hash_tbl
+    void create_runtime_filters();
+
+    // Insert, or append if 'append' is true, the rows of 'build_batch' into _hash_tbl,
+    // and add their keys to _runtime_filters and _global_runtime_filters. The keys are
+    // the build expr values the hash table evaluated, so the exprs are evaluated once.
+    void process_build_batch_with_filters(RowBatch* build_batch, bool append);
+
+    // Send _global_runtime_filters to the backends merging them, without
+    // waiting for the rpcs. A filter that fails to be sent is only logged,
+    // its targets scan without it.
+    void send_global_runtime_filters(RuntimeState* state);
+
+    // Push down _runtime_filters to the probe side, *pushed is false if the
+    // join has none
+    Status push_down_runtime_filters(RuntimeState* state, bool* pushed);
+
     // Write combined row, consisting of probe_row and build_row, to out_row.
     // This is replaced by codegen.
     void create_output_row(TupleRow* out_row, TupleRow* probe_row, TupleRow* build_row);
@@ -181,9 +225,10 @@ private:
 
     /// Codegen processing build batches.  Identical signature to ProcessBuildBatch.
     /// hash_fn is the codegen'd function for computing hashes over tuple rows in the
-    /// hash table.
+    /// hash table. If append is true, codegens append_build_batch() instead.
     /// Returns NULL if codegen was not possible.
-    llvm::Function* codegen_process_build_batch(RuntimeState* state, llvm::Function* hash_fn);
+    llvm::Function* codegen_process_build_batch(
+        RuntimeState* state, llvm::Function* hash_fn, bool append);
 
     /// Codegen processing probe batches.  Identical signature to ProcessProbeBatch.
     /// hash_fn is the codegen'd function for computing hashes over tuple rows in the
@@ -121,8 +121,14 @@ int HashJoinNode::process_probe_batch(RowBatch* out_batch, RowBatch* probe_batch
                 goto end;
             }
 
-            _current_probe_row = probe_batch->get_row(_probe_batch_pos++);
-            _hash_tbl_iterator = _hash_tbl->find(_current_probe_row);
+            // Hash a group of probe rows ahead, their buckets are prefetched
+            if (_probe_batch_pos >= _probe_group_end) {
+                _probe_group_start = _probe_batch_pos;
+                _probe_group_end = _probe_batch_pos
+                    + _hash_tbl->eval_and_hash_probe_group(probe_batch, _probe_batch_pos);
+            }
+            _current_probe_row = probe_batch->get_row(_probe_batch_pos);
+            _hash_tbl_iterator = _hash_tbl->find_cached(_probe_batch_pos++ - _probe_group_start);
             _matched_probe = false;
         }
     }
@@ -143,5 +149,11 @@ void HashJoinNode::process_build_batch(RowBatch* build_batch) {
         _hash_tbl->insert(build_batch->get_row(i));
     }
 }
+
+void HashJoinNode::append_build_batch(RowBatch* build_batch) {
+    for (int i = 0; i < build_batch->num_rows(); ++i) {
+        _hash_tbl->append(build_batch->get_row(i));
+    }
+}
 }
 
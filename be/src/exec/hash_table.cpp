@@ -17,6 +17,9 @@
 
 #include "exec/hash_table.hpp"
 
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
 #include "codegen/codegen_anyval.h"
 #include "codegen/llvm_codegen.h"
 
@@ -38,6 +41,9 @@ using llvm::PHINode;
 namespace doris {
 
 const float HashTable::MAX_BUCKET_OCCUPANCY_FRACTION = 0.75f;
+const int HashTable::MAX_PROBE_GROUP_ROWS;
+const int HashTable::MAX_PROBE_GROUP_BYTES;
+const int64_t HashTable::MIN_ROWS_PER_LINK_THREAD;
 const char* HashTable::_s_llvm_class_name = "class.doris::HashTable";
 
 HashTable::HashTable(const vector<ExprContext*>& build_expr_ctxs,
@@ -53,6 +59,7 @@ HashTable::HashTable(const vector<ExprContext*>& build_expr_ctxs,
         _num_filled_buckets(0),
         _nodes(NULL),
         _num_nodes(0),
+        _num_linked_nodes(0),
         _exceeded_limit(false),
         _mem_tracker(mem_tracker),
         _mem_limit_exceeded(false) {
@@ -72,6 +79,16 @@ HashTable::HashTable(const vector<ExprContext*>& build_expr_ctxs,
     memset(_expr_values_buffer, 0, sizeof(uint8_t) * _results_buffer_size);
     _expr_value_null_bits = new uint8_t[_build_expr_ctxs.size()];
 
+    // Cache as many probe rows as fit in MAX_PROBE_GROUP_BYTES, at least one.
+    int probe_row_bytes = _results_buffer_size + _build_expr_ctxs.size()
+        + sizeof(uint32_t) + sizeof(uint8_t);
+    _probe_group_capacity = std::max(1, std::min(MAX_PROBE_GROUP_ROWS,
+                MAX_PROBE_GROUP_BYTES / probe_row_bytes));
+    _probe_group_values = new uint8_t[_probe_group_capacity * _results_buffer_size];
+    _probe_group_null_bits = new uint8_t[_probe_group_capacity * _build_expr_ctxs.size()];
+    _probe_group_hashes = new uint32_t[_probe_group_capacity];
+    _probe_group_no_match = new uint8_t[_probe_group_capacity];
+
     _nodes_capacity = 1024;
     _nodes = reinterpret_cast<uint8_t*>(malloc(_nodes_capacity * _node_byte_size));
     memset(_nodes, 0, _nodes_capacity * _node_byte_size);
@@ -95,6 +112,10 @@ void HashTable::close() {
     // TODO: use tr1::array?
     delete[] _expr_values_buffer;
     delete[] _expr_value_null_bits;
+    delete[] _probe_group_values;
+    delete[] _probe_group_null_bits;
+    delete[] _probe_group_hashes;
+    delete[] _probe_group_no_match;
     free(_nodes);
 #if 0
     if (DorisMetrics::hash_table_total_bytes() != NULL) {
@@ -202,14 +223,14 @@ bool HashTable::equals(TupleRow* build_row) {
     return true;
 }
 
-void HashTable::resize_buckets(int64_t num_buckets) {
+bool HashTable::resize_buckets(int64_t num_buckets) {
     DCHECK_EQ((num_buckets & (num_buckets - 1)), 0) << "num_buckets must be a power of 2";
 
     int64_t old_num_buckets = _num_buckets;
     int64_t delta_bytes = (num_buckets - old_num_buckets) * sizeof(Bucket);
     if (!_mem_tracker->try_consume(delta_bytes)) {
         mem_limit_exceeded(delta_bytes);
-        return;
+        return false;
     }
 
     _buckets.resize(num_buckets);
@@ -255,6 +276,110 @@ void HashTable::resize_buckets(int64_t num_buckets) {
 
     _num_buckets = num_buckets;
     _num_buckets_till_resize = MAX_BUCKET_OCCUPANCY_FRACTION * _num_buckets;
+    return true;
+}
+
+bool HashTable::link_nodes(int max_threads, ThreadResourceMgr::ResourcePool* resource_pool) {
+    int64_t num_nodes = _num_nodes - _num_linked_nodes;
+    if (num_nodes == 0) {
+        return true;
+    }
+
+    // Grow the buckets once, as if each row filled a bucket.
+    int64_t num_buckets = _num_buckets;
+    while (_num_filled_buckets + num_nodes > num_buckets * MAX_BUCKET_OCCUPANCY_FRACTION) {
+        num_buckets *= 2;
+    }
+    // If the buckets cannot grow, the rows are still linked into the current ones.
+    bool resized = (num_buckets == _num_buckets) || resize_buckets(num_buckets);
+
+    // The calling thread links one share, each other thread holds a thread token of the
+    // query so that the threads are accounted like the other threads of the query.
+    int num_threads = std::min<int64_t>(max_threads, num_nodes / MIN_ROWS_PER_LINK_THREAD);
+    int num_tokens = 0;
+    while (resource_pool != NULL && num_tokens < num_threads - 1
+            && resource_pool->try_acquire_thread_token()) {
+        ++num_tokens;
+    }
+    num_threads = num_tokens + 1;
+    // The ranges of buckets are picked by the high bits of the bucket index, there are
+    // at least as many as threads so that each thread links whole ranges.
+    int num_ranges = 1;
+    int range_shift = 0;
+    while (num_ranges < num_threads) {
+        num_ranges *= 2;
+    }
+    while ((_num_buckets >> range_shift) > num_ranges) {
+        ++range_shift;
+    }
+    int64_t idxs_bytes = num_nodes * sizeof(int64_t);
+    if (num_threads <= 1 || (_num_buckets >> range_shift) < num_ranges
+            || !_mem_tracker->try_consume(idxs_bytes)) {
+        for (int64_t idx = _num_linked_nodes; idx < _num_nodes; ++idx) {
+            Node* node = get_node(idx);
+            add_to_bucket(&_buckets[node->_hash & (_num_buckets - 1)], idx, node);
+        }
+        _num_linked_nodes = _num_nodes;
+        for (int i = 0; i < num_tokens; ++i) {
+            resource_pool->release_thread_token(false);
+        }
+        return resized;
+    }
+
+    // Partition the nodes by the range of their bucket: count the nodes of each range,
+    // then scatter their indexes.
+    int64_t mask = _num_buckets - 1;
+    std::vector<int64_t> range_offsets(num_ranges + 1, 0);
+    for (int64_t idx = _num_linked_nodes; idx < _num_nodes; ++idx) {
+        ++range_offsets[((get_node(idx)->_hash & mask) >> range_shift) + 1];
+    }
+    for (int i = 0; i < num_ranges; ++i) {
+        range_offsets[i + 1] += range_offsets[i];
+    }
+    std::vector<int64_t> node_idxs(num_nodes);
+    std::vector<int64_t> range_ends(range_offsets.begin(), range_offsets.end() - 1);
+    for (int64_t idx = _num_linked_nodes; idx < _num_nodes; ++idx) {
+        node_idxs[range_ends[(get_node(idx)->_hash & mask) >> range_shift]++] = idx;
+    }
+
+    // Each thread links a contiguous run of ranges.
+    std::vector<int64_t> num_filled_buckets(num_threads, 0);
+    boost::thread_group threads;
+    for (int i = 1; i < num_threads; ++i) {
+        int64_t begin = range_offsets[i * num_ranges / num_threads];
+        int64_t end = range_offsets[(i + 1) * num_ranges / num_threads];
+        threads.create_thread(boost::bind(&HashTable::link_range, this,
+                    node_idxs.data() + begin, end - begin, &num_filled_buckets[i]));
+    }
+    link_range(node_idxs.data(), range_offsets[num_ranges / num_threads],
+            &num_filled_buckets[0]);
+    threads.join_all();
+    for (int i = 0; i < num_tokens; ++i) {
+        resource_pool->release_thread_token(false);
+    }
+
+    for (int i = 0; i < num_threads; ++i) {
+        _num_filled_buckets += num_filled_buckets[i];
+    }
+    _num_linked_nodes = _num_nodes;
+    _mem_tracker->release(idxs_bytes);
+    return resized;
+}
+
+void HashTable::link_range(
+        const int64_t* node_idxs, int64_t num_nodes, int64_t* num_filled_buckets) {
+    int64_t mask = _num_buckets - 1;
+    int64_t filled = 0;
+    for (int64_t i = 0; i < num_nodes; ++i) {
+        Node* node = get_node(node_idxs[i]);
+        Bucket* bucket = &_buckets[node->_hash & mask];
+        if (bucket->_node_idx == -1) {
+            ++filled;
+        }
+        node->_next_idx = bucket->_node_idx;
+        bucket->_node_idx = node_idxs[i];
+    }
+    *num_filled_buckets = filled;
 }
 
 void HashTable::grow_node_array() {
@@ -23,6 +23,7 @@
 
 #include "codegen/doris_ir.h"
 #include "common/logging.h"
+#include "runtime/thread_resource_mgr.h"
 #include "util/hash_util.hpp"
 
 namespace llvm {
@@ -36,6 +37,7 @@ namespace doris {
 class Expr;
 class ExprContext;
 class LlvmCodeGen;
+class RowBatch;
 class RowDescriptor;
 class Tuple;
 class TupleRow;
@@ -118,6 +120,21 @@ public:
         insert_impl(row);
     }
 
+    // Evaluates row over _build_expr_ctxs and appends it to the table, without linking
+    // it into its bucket. The rows appended cannot be found until link_nodes() is
+    // called, and insert() cannot be called in between.
+    void IR_ALWAYS_INLINE append(TupleRow* row);
+
+    // Grows the buckets for all the rows, then links the rows appended since the last
+    // call into their buckets. The buckets are split into ranges by the high bits of
+    // their index, the rows are partitioned by the range of their bucket, and up to
+    // max_threads threads link the rows of disjoint ranges. The calling thread links one
+    // share, the others run only on thread tokens acquired from resource_pool, which may
+    // be NULL to link serially.
+    // Returns false if the buckets could not grow within the mem limit, the rows are
+    // still linked into the current buckets then.
+    bool link_nodes(int max_threads, ThreadResourceMgr::ResourcePool* resource_pool);
+
     // Returns the start iterator for all rows that match 'probe_row'.  'probe_row' is
     // evaluated with _probe_expr_ctxs.  The iterator can be iterated until HashTable::end()
     // to find all the matching rows.
@@ -129,11 +146,35 @@ public:
     // Returns HashTable::end() if there is no match.
     Iterator IR_ALWAYS_INLINE find(TupleRow* probe_row);
 
+    // Evaluates and hashes the probe exprs of the rows of 'batch' from 'start_row', at
+    // most probe_group_capacity() of them, and caches the results. The buckets of the
+    // hashes are prefetched, then the first node of each bucket, so that the cache
+    // misses of the whole group overlap instead of stalling each find().
+    // The cached values of string keys point into the string data of 'batch': they are
+    // only valid until 'batch' is reset or its resources are transferred, and the group
+    // must be probed before that.
+    // Returns the number of rows cached.
+    int IR_ALWAYS_INLINE eval_and_hash_probe_group(RowBatch* batch, int start_row);
+
+    // Same as find() for the 'group_idx'-th row cached by the last
+    // eval_and_hash_probe_group(), without evaluating the probe exprs again.
+    Iterator IR_ALWAYS_INLINE find_cached(int group_idx);
+
+    // Max number of probe rows eval_and_hash_probe_group() caches
+    int probe_group_capacity() const {
+        return _probe_group_capacity;
+    }
+
     // Returns number of elements in the hash table
     int64_t size() {
         return _num_nodes;
     }
 
+    // Returns the 'node_idx'-th row of the table, in the order of insert() and append()
+    TupleRow* get_row(int64_t node_idx) {
+        return get_node(node_idx)->data();
+    }
+
     // Returns the number of buckets
     int64_t num_buckets() {
         return _buckets.size();
@@ -299,6 +340,15 @@ private:
         }
     };
 
+    // Returns the first node of the bucket of 'hash' matching the values cached in
+    // '_expr_values_buffer', or end().
+    Iterator IR_ALWAYS_INLINE find_in_bucket(uint32_t hash);
+
+    // Links the 'num_nodes' nodes of 'node_idxs' into their buckets, no other thread
+    // links into these buckets. Sets *num_filled_buckets to the number of buckets
+    // that were empty.
+    void link_range(const int64_t* node_idxs, int64_t num_nodes, int64_t* num_filled_buckets);
+
     // Returns the next non-empty bucket and updates idx to be the index of that bucket.
     // If there are no more buckets, returns NULL and sets idx to -1
     Bucket* next_bucket(int64_t* bucket_idx);
@@ -310,8 +360,9 @@ private:
         return reinterpret_cast<Node*>(_nodes + _node_byte_size * idx);
     }
 
-    // Resize the hash table to 'num_buckets'
-    void resize_buckets(int64_t num_buckets);
+    // Resize the hash table to 'num_buckets'. Returns false if the mem limit was
+    // exceeded, the table is unchanged then.
+    bool resize_buckets(int64_t num_buckets);
 
     // Insert row into the hash table
     void IR_ALWAYS_INLINE insert_impl(TupleRow* row);
@@ -375,6 +426,15 @@ private:
     // brought us over the mem limit.
     void mem_limit_exceeded(int64_t allocation_size);
 
+    // Bounds of the number of probe rows cached by eval_and_hash_probe_group(). The
+    // group must be large enough to hide the latency of the prefetches, and small
+    // enough for the prefetched buckets and nodes to still be in cache when probed.
+    static const int MAX_PROBE_GROUP_ROWS = 256;
+    static const int MAX_PROBE_GROUP_BYTES = 256 << 10;
+
+    // link_nodes() uses no more threads than one per this many rows.
+    static const int64_t MIN_ROWS_PER_LINK_THREAD = 64 * 1024;
+
     // Load factor that will trigger growing the hash table on insert.  This is
     // defined as the number of non-empty buckets / total_buckets
     static const float MAX_BUCKET_OCCUPANCY_FRACTION;
@@ -399,6 +459,8 @@ private:
     uint8_t* _nodes;
     // number of nodes stored (i.e. size of hash table)
     int64_t _num_nodes;
+    // number of nodes linked into their buckets, the others are appended
+    int64_t _num_linked_nodes;
     // max number of nodes that can be stored in '_nodes' before realloc
     int64_t _nodes_capacity;
 
@@ -434,6 +496,16 @@ private:
     // Use bytes instead of bools to be compatible with llvm.  This address must
     // not change once allocated.
     uint8_t* _expr_value_null_bits;
+
+    // Probe rows cached by eval_and_hash_probe_group(): for each row, its expr values
+    // (laid out as '_expr_values_buffer'), null bits and hash, and whether it has a
+    // NULL key that matches nothing. The StringValues of the expr values are not deep
+    // copied, they reference the probe batch.
+    int _probe_group_capacity;
+    uint8_t* _probe_group_values;
+    uint8_t* _probe_group_null_bits;
+    uint32_t* _probe_group_hashes;
+    uint8_t* _probe_group_no_match;
 };
 
 }
@@ -18,8 +18,15 @@
 #ifndef DORIS_BE_SRC_QUERY_EXEC_HASH_TABLE_HPP
 #define DORIS_BE_SRC_QUERY_EXEC_HASH_TABLE_HPP
 
+#include <algorithm>
+#include <cstring>
+
 #include "exec/hash_table.h"
 
+#include "common/compiler_util.h"
+#include "common/config.h"
+#include "runtime/row_batch.h"
+
 namespace doris {
 
 inline HashTable::Iterator HashTable::find(TupleRow* probe_row) {
@@ -30,6 +37,60 @@ inline HashTable::Iterator HashTable::find(TupleRow* probe_row) {
     }
 
     uint32_t hash = hash_current_row();
+    return find_in_bucket(hash);
+}
+
+inline int HashTable::eval_and_hash_probe_group(RowBatch* batch, int start_row) {
+    int num_rows = std::min(batch->num_rows() - start_row, _probe_group_capacity);
+    int num_exprs = _probe_expr_ctxs.size();
+    int64_t mask = _num_buckets - 1;
+
+    for (int i = 0; i < num_rows; ++i) {
+        bool has_nulls = eval_probe_row(batch->get_row(start_row + i));
+        if (!_stores_nulls && has_nulls) {
+            _probe_group_no_match[i] = 1;
+            continue;
+        }
+        _probe_group_no_match[i] = 0;
+        uint32_t hash = hash_current_row();
+        _probe_group_hashes[i] = hash;
+        memcpy(_probe_group_values + i * _results_buffer_size, _expr_values_buffer,
+               _results_buffer_size);
+        memcpy(_probe_group_null_bits + i * num_exprs, _expr_value_null_bits, num_exprs);
+        if (config::enable_prefetch) {
+            PREFETCH(&_buckets[hash & mask]);
+        }
+    }
+
+    if (config::enable_prefetch) {
+        // The buckets are in cache by now, prefetch the nodes they point to.
+        for (int i = 0; i < num_rows; ++i) {
+            if (_probe_group_no_match[i]) {
+                continue;
+            }
+            int64_t node_idx = _buckets[_probe_group_hashes[i] & mask]._node_idx;
+            if (node_idx != -1) {
+                PREFETCH(get_node(node_idx));
+            }
+        }
+    }
+    return num_rows;
+}
+
+inline HashTable::Iterator HashTable::find_cached(int group_idx) {
+    DCHECK_LT(group_idx, _probe_group_capacity);
+    if (_probe_group_no_match[group_idx]) {
+        return end();
+    }
+
+    int num_exprs = _probe_expr_ctxs.size();
+    memcpy(_expr_values_buffer, _probe_group_values + group_idx * _results_buffer_size,
+           _results_buffer_size);
+    memcpy(_expr_value_null_bits, _probe_group_null_bits + group_idx * num_exprs, num_exprs);
+    return find_in_bucket(_probe_group_hashes[group_idx]);
+}
+
+inline HashTable::Iterator HashTable::find_in_bucket(uint32_t hash) {
     int64_t bucket_idx = hash & (_num_buckets - 1);
 
     Bucket* bucket = &_buckets[bucket_idx];
@@ -73,6 +134,7 @@ inline HashTable::Bucket* HashTable::next_bucket(int64_t* bucket_idx) {
 }
 
 inline void HashTable::insert_impl(TupleRow* row) {
+    DCHECK_EQ(_num_linked_nodes, _num_nodes) << "insert() after append()";
     bool has_null = eval_build_row(row);
 
     if (!_stores_nulls && has_null) {
@@ -92,6 +154,24 @@ inline void HashTable::insert_impl(TupleRow* row) {
     memcpy(data, row, sizeof(Tuple*) * _num_build_tuples);
     add_to_bucket(&_buckets[bucket_idx], _num_nodes, node);
     ++_num_nodes;
+    ++_num_linked_nodes;
+}
+
+inline void HashTable::append(TupleRow* row) {
+    bool has_null = eval_build_row(row);
+
+    if (!_stores_nulls && has_null) {
+        return;
+    }
+
+    if (_num_nodes == _nodes_capacity) {
+        grow_node_array();
+    }
+
+    Node* node = get_node(_num_nodes);
+    node->_hash = hash_current_row();
+    memcpy(node->data(), row, sizeof(Tuple*) * _num_build_tuples);
+    ++_num_nodes;
 }
 
 inline void HashTable::add_to_bucket(Bucket* bucket, int64_t node_idx, Node* node) {
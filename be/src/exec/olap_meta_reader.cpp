@@ -113,4 +113,42 @@ Status EngineMetaReader::get_hints(
     return Status::OK;
 }
 
+Status EngineMetaReader::get_block_splits(
+        boost::shared_ptr<DorisScanRange> scan_range,
+        int block_row_count,
+        int max_splits,
+        std::vector<OlapScanRange>* sub_scan_range) {
+    auto tablet_id = scan_range->scan_range().tablet_id;
+    int32_t schema_hash = strtoul(scan_range->scan_range().schema_hash.c_str(), NULL, 10);
+    OLAPTablePtr table = OLAPEngine::get_instance()->get_table(
+        tablet_id, schema_hash);
+    if (table.get() == NULL) {
+        LOG(WARNING) << "tablet does not exist. tablet_id=" << tablet_id << ", schema_hash="
+            << schema_hash;
+        std::stringstream ss;
+        ss << "tablet does not exist: " << tablet_id;
+        return Status(ss.str());
+    }
+    if (table->keys_type() != KeysType::DUP_KEYS) {
+        return Status::OK;
+    }
+
+    int64_t num_rows = 0;
+    {
+        ReadLock rdlock(table->get_header_lock_ptr());
+        num_rows = table->get_num_rows();
+    }
+    int64_t num_splits = std::min<int64_t>(num_rows / block_row_count, max_splits);
+    if (num_splits <= 1) {
+        return Status::OK;
+    }
+    for (int32_t i = 0; i < num_splits; ++i) {
+        OlapScanRange range;
+        range.block_split = i;
+        range.num_block_splits = num_splits;
+        sub_scan_range->push_back(range);
+    }
+    return Status::OK;
+}
+
 } // namespace doris
@@ -48,6 +48,16 @@ public:
         std::vector<OlapScanRange>& scan_key_range,
         std::vector<OlapScanRange>* sub_scan_range, 
         RuntimeProfile* profile);
+
+    // Split a DUP_KEYS tablet by row blocks into parts of about
+    // block_row_count rows, at most max_splits of them. Rows of such a
+    // tablet need no merge, so the parts are read by scanners of their own.
+    // sub_scan_range is left empty for other tablets.
+    static Status get_block_splits(
+        boost::shared_ptr<DorisScanRange> scan_range,
+        int block_row_count,
+        int max_splits,
+        std::vector<OlapScanRange>* sub_scan_range);
 };
 
 } // namespace doris
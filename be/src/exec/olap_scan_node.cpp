@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <boost/foreach.hpp>
+#include <chrono>
 #include <sstream>
 #include <iostream>
 #include <utility>
@@ -29,8 +30,11 @@
 #include "exprs/expr.h"
 #include "exprs/binary_predicate.h"
 #include "exprs/in_predicate.h"
+#include "exprs/runtime_filter.h"
+#include "exprs/runtime_filter_predicate.h"
 #include "gen_cpp/PlanNodes_types.h"
 #include "runtime/exec_env.h"
+#include "runtime/runtime_filter_mgr.h"
 #include "runtime/runtime_state.h"
 #include "runtime/row_batch.h"
 #include "runtime/string_value.h"
@@ -128,14 +132,24 @@ void OlapScanNode::_init_counter(RuntimeState* state) {
         ADD_COUNTER(_runtime_profile, "RowsVectorPredFiltered", TUnit::UNIT);
     _vec_cond_timer =
         ADD_TIMER(_runtime_profile, "VectorPredEvalTime");
+    _rows_lazy_skipped_counter =
+        ADD_COUNTER(_runtime_profile, "RowsLazySkipped", TUnit::UNIT);
 
     _stats_filtered_counter =
         ADD_COUNTER(_runtime_profile, "RowsStatsFiltered", TUnit::UNIT);
+    _blocks_stats_filtered_counter =
+        ADD_COUNTER(_runtime_profile, "BlocksStatsFiltered", TUnit::UNIT);
+    _segments_stats_filtered_counter =
+        ADD_COUNTER(_runtime_profile, "SegmentsStatsFiltered", TUnit::UNIT);
+    _blocks_ngram_filtered_counter =
+        ADD_COUNTER(_runtime_profile, "BlocksNgramFiltered", TUnit::UNIT);
     _del_filtered_counter =
         ADD_COUNTER(_runtime_profile, "RowsDelFiltered", TUnit::UNIT);
 
     _io_timer = ADD_TIMER(_runtime_profile, "IOTimer");
     _decompressor_timer = ADD_TIMER(_runtime_profile, "DecompressorTimer");
+    _page_cache_hit_counter = ADD_COUNTER(_runtime_profile, "PageCacheHit", TUnit::UNIT);
+    _page_cache_miss_counter = ADD_COUNTER(_runtime_profile, "PageCacheMiss", TUnit::UNIT);
     _index_load_timer = ADD_TIMER(_runtime_profile, "IndexLoadTime");
 
     _scan_timer = ADD_TIMER(_runtime_profile, "ScanTime");
@@ -149,6 +163,9 @@ Status OlapScanNode::prepare(RuntimeState* state) {
         ADD_COUNTER(runtime_profile(), "TabletCount ", TUnit::UNIT);
     _rows_pushed_cond_filtered_counter =
         ADD_COUNTER(_runtime_profile, "RowsPushedCondFiltered", TUnit::UNIT);
+    _runtime_filter_wait_timer = ADD_TIMER(_runtime_profile, "RuntimeFilterWaitTime");
+    _runtime_filters_arrived_counter =
+        ADD_COUNTER(_runtime_profile, "RuntimeFiltersArrived", TUnit::UNIT);
     _init_counter(state);
 
     _tuple_desc = state->desc_tbl().get_tuple_descriptor(_tuple_id);
@@ -374,6 +391,10 @@ Status OlapScanNode::set_scan_ranges(const std::vector<TScanRangeParams>& scan_r
 Status OlapScanNode::start_scan(RuntimeState* state) {
     RETURN_IF_CANCELLED(state);
 
+    VLOG(1) << "WaitRuntimeFilters";
+    // 0. Add the runtime filters published by other fragments to the conjuncts
+    RETURN_IF_ERROR(wait_runtime_filters(state));
+
     VLOG(1) << "NormalizeConjuncts";
     // 1. Convert conjuncts to ColumnValueRange in each column
     RETURN_IF_ERROR(normalize_conjuncts());
@@ -401,6 +422,45 @@ Status OlapScanNode::start_scan(RuntimeState* state) {
     return Status::OK;
 }
 
+Status OlapScanNode::wait_runtime_filters(RuntimeState* state) {
+    if (!_olap_scan_node.__isset.runtime_filters || _olap_scan_node.runtime_filters.empty()) {
+        return Status::OK;
+    }
+    SCOPED_TIMER(_runtime_filter_wait_timer);
+    // all the filters are waited for at the same time
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+        + std::chrono::milliseconds(config::runtime_filter_wait_time_ms);
+    for (const TRuntimeFilterTarget& target : _olap_scan_node.runtime_filters) {
+        std::shared_ptr<RuntimeFilter> filter = state->exec_env()->runtime_filter_mgr()->wait(
+                state->query_id(), target.filter_id, deadline);
+        if (filter == nullptr) {
+            VLOG(1) << "runtime filter " << target.filter_id << " is not published in time";
+            continue;
+        }
+        ExprContext* target_ctx = NULL;
+        RETURN_IF_ERROR(Expr::create_expr_tree(_pool, target.target_expr, &target_ctx));
+        if (target_ctx->root()->type().type != filter->type().type) {
+            LOG(WARNING) << "runtime filter " << target.filter_id << " of type "
+                         << filter->type() << " on expr of type " << target_ctx->root()->type();
+            continue;
+        }
+
+        TExprNode node;
+        node.__set_node_type(TExprNodeType::RUNTIME_FILTER_PRED);
+        node.__set_type(TypeDescriptor(TYPE_BOOLEAN).to_thrift());
+        RuntimeFilterPredicate* pred = _pool->add(new RuntimeFilterPredicate(node, filter));
+        pred->add_child(target_ctx->root());
+        ExprContext* ctx = _pool->add(new ExprContext(pred));
+        RETURN_IF_ERROR(ctx->prepare(state, row_desc(), expr_mem_tracker()));
+        RETURN_IF_ERROR(ctx->open(state));
+        // after _direct_conjunct_size, like the predicates pushed down by joins
+        _conjunct_ctxs.push_back(ctx);
+        COUNTER_UPDATE(_runtime_filters_arrived_counter, 1);
+        VLOG(1) << "runtime filter " << target.filter_id << " arrived, " << pred->debug_string();
+    }
+    return Status::OK;
+}
+
 Status OlapScanNode::normalize_conjuncts() {
     std::vector<SlotDescriptor*> slots = _tuple_desc->slots();
 
@@ -465,6 +525,9 @@ Status OlapScanNode::normalize_conjuncts() {
                                                 StringValue(&min_char, 0),
                                                 StringValue(&max_char, 1));
             normalize_predicate(range, slots[slot_idx]);
+            if (slots[slot_idx]->type().type != TYPE_HLL) {
+                normalize_like_predicate(slots[slot_idx]);
+            }
             break;
         }
 
@@ -520,6 +583,10 @@ Status OlapScanNode::build_olap_filters() {
         }
     }
 
+    for (auto& filter : _like_filters) {
+        _olap_filter.push_back(filter);
+    }
+
     return Status::OK;
 }
 
@@ -623,7 +690,8 @@ Status OlapScanNode::start_scan_thread(RuntimeState* state) {
              j < key_range_num_per_scanner
              && i < key_range_size
              && _query_scan_ranges[i] == _query_scan_ranges[i - 1]
-             && _query_key_ranges[i].end_include == _query_key_ranges[i - 1].end_include;
+             && _query_key_ranges[i].end_include == _query_key_ranges[i - 1].end_include
+             && _query_key_ranges[i].num_block_splits == 1;
              j++, i++) {
             key_ranges.push_back(_query_key_ranges[i]);
         }
@@ -658,7 +726,10 @@ Status OlapScanNode::normalize_predicate(ColumnValueRange<T>& range, SlotDescrip
     // 2. Normalize BinaryPredicate , add to ColumnValueRange
     RETURN_IF_ERROR(normalize_binary_predicate(slot, &range));
 
-    // 3. Add range to Column->ColumnValueRange map
+    // 3. Normalize runtime filters of hash joins, add to ColumnValueRange
+    RETURN_IF_ERROR(normalize_runtime_filter(slot, &range));
+
+    // 4. Add range to Column->ColumnValueRange map
     _column_value_ranges[slot->col_name()] = range;
 
     return Status::OK;
@@ -853,6 +924,43 @@ void OlapScanNode::construct_is_null_pred_in_where_pred(Expr* expr, SlotDescript
     return;
 }
 
+void OlapScanNode::normalize_like_predicate(SlotDescriptor* slot) {
+    for (int conj_idx = 0; conj_idx < _conjunct_ctxs.size(); ++conj_idx) {
+        Expr* root_expr = _conjunct_ctxs[conj_idx]->root();
+        if (TExprNodeType::FUNCTION_CALL != root_expr->node_type()
+                || root_expr->fn().name.function_name != "like"
+                || root_expr->get_num_children() != 2) {
+            continue;
+        }
+
+        // the column itself, a cast may not keep its substrings
+        Expr* slot_expr = root_expr->get_child(0);
+        if (slot_expr->node_type() != TExprNodeType::SLOT_REF) {
+            continue;
+        }
+        std::vector<SlotId> slot_ids;
+        if (1 != slot_expr->get_slot_ids(&slot_ids) || slot_ids[0] != slot->id()) {
+            continue;
+        }
+
+        Expr* pattern_expr = root_expr->get_child(1);
+        if (!pattern_expr->is_constant()) {
+            continue;
+        }
+        void* value = _conjunct_ctxs[conj_idx]->get_value(pattern_expr, NULL);
+        if (value == NULL) {
+            continue;
+        }
+        StringValue* pattern = reinterpret_cast<StringValue*>(value);
+
+        TCondition like;
+        like.column_name = slot->col_name();
+        like.condition_op = "like";
+        like.condition_values.push_back(std::string(pattern->ptr, pattern->len));
+        _like_filters.push_back(like);
+    }
+}
+
 template<class T>
 Status OlapScanNode::normalize_binary_predicate(SlotDescriptor* slot, ColumnValueRange<T>* range) {
     for (int conj_idx = 0; conj_idx < _conjunct_ctxs.size(); ++conj_idx) {
@@ -949,6 +1057,89 @@ Status OlapScanNode::normalize_binary_predicate(SlotDescriptor* slot, ColumnValu
     return Status::OK;
 }
 
+template<class T>
+Status OlapScanNode::normalize_runtime_filter(SlotDescriptor* slot, ColumnValueRange<T>* range) {
+    for (int conj_idx = _direct_conjunct_size; conj_idx < _conjunct_ctxs.size(); ++conj_idx) {
+        Expr* root_expr = _conjunct_ctxs[conj_idx]->root();
+        if (TExprNodeType::RUNTIME_FILTER_PRED != root_expr->node_type()) {
+            continue;
+        }
+
+        // the filter holds values of the type of the column
+        Expr* slot_expr = root_expr->get_child(0);
+        if (slot_expr->node_type() != TExprNodeType::SLOT_REF
+                || slot_expr->type().type != slot->type().type) {
+            continue;
+        }
+        std::vector<SlotId> slot_ids;
+        if (1 != slot_expr->get_slot_ids(&slot_ids) || slot_ids[0] != slot->id()) {
+            continue;
+        }
+
+        const RuntimeFilter* filter =
+            static_cast<RuntimeFilterPredicate*>(root_expr)->runtime_filter().get();
+        if (filter->empty()) {
+            continue;
+        }
+
+        // 1. The range of the keys prunes blocks by their zone maps
+        const void* bounds[2] = {filter->min_value(), filter->max_value()};
+        const SQLFilterOp ops[2] = {FILTER_LARGER_OR_EQUAL, FILTER_LESS_OR_EQUAL};
+        for (int i = 0; i < 2; ++i) {
+            switch (slot->type().type) {
+            case TYPE_TINYINT: {
+                int32_t v = *reinterpret_cast<const int8_t*>(bounds[i]);
+                range->add_range(ops[i], *reinterpret_cast<T*>(&v));
+                break;
+            }
+            case TYPE_DATE: {
+                DateTimeValue date_value = *reinterpret_cast<const DateTimeValue*>(bounds[i]);
+                date_value.cast_to_date();
+                range->add_range(ops[i], *reinterpret_cast<T*>(&date_value));
+                break;
+            }
+            case TYPE_DECIMAL:
+            case TYPE_CHAR:
+            case TYPE_VARCHAR:
+            case TYPE_DATETIME:
+            case TYPE_SMALLINT:
+            case TYPE_INT:
+            case TYPE_BIGINT:
+            case TYPE_LARGEINT: {
+                range->add_range(ops[i], *reinterpret_cast<const T*>(bounds[i]));
+                break;
+            }
+            default: {
+                break;
+            }
+            }
+        }
+
+        // 2. The bloom filter is tested by the storage engine, for the types
+        // it stores as they are in memory
+        switch (slot->type().type) {
+        case TYPE_TINYINT:
+        case TYPE_SMALLINT:
+        case TYPE_INT:
+        case TYPE_BIGINT:
+        case TYPE_LARGEINT:
+        case TYPE_VARCHAR: {
+            if (filter->bloom_filter() != nullptr) {
+                _bloom_filters.emplace_back(slot->col_name(), filter->bloom_filter());
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+        }
+
+        VLOG(1) << slot->col_name() << " runtime filter: " << filter->debug_string();
+    }
+
+    return Status::OK;
+}
+
 bool OlapScanNode::select_scan_range(boost::shared_ptr<DorisScanRange> scan_range) {
     std::map<std::string, ColumnValueRangeType>::iterator iter
         = _column_value_ranges.begin();
@@ -972,6 +1163,19 @@ Status OlapScanNode::get_sub_scan_range(
     std::vector<OlapScanRange> scan_key_range;
     RETURN_IF_ERROR(_scan_keys.get_key_range(&scan_key_range));
 
+    if (limit() == -1 && scan_key_range.empty()) {
+        // without keys a DUP_KEYS tablet is split by row blocks, which
+        // still works when its short keys are all the same
+        if (EngineMetaReader::get_block_splits(
+                    scan_range,
+                    config::doris_scan_range_row_count,
+                    config::doris_scanner_thread_pool_thread_num,
+                    sub_range).ok() && !sub_range->empty()) {
+            return Status::OK;
+        }
+        sub_range->clear();
+    }
+
     if (limit() != -1 ||
         scan_key_range.size() > 64) {
         if (scan_key_range.size() != 0) {
@@ -133,6 +133,10 @@ protected:
     }
 
     Status start_scan(RuntimeState* state);
+    // Wait for the runtime filters published by hash joins in other fragments,
+    // at most runtime_filter_wait_time_ms, and add the arrived ones to the
+    // pushed down conjuncts
+    Status wait_runtime_filters(RuntimeState* state);
     Status normalize_conjuncts();
     Status build_olap_filters();
     Status select_scan_ranges();
@@ -149,6 +153,11 @@ protected:
     template<class T>
     Status normalize_binary_predicate(SlotDescriptor* slot, ColumnValueRange<T>* range);
 
+    // Add the [min, max] range of the runtime filters of hash joins on slot to
+    // range, and collect their bloom filters for the storage engine
+    template<class T>
+    Status normalize_runtime_filter(SlotDescriptor* slot, ColumnValueRange<T>* range);
+
     bool select_scan_range(boost::shared_ptr<DorisScanRange> scan_range);
     Status get_sub_scan_range(
         boost::shared_ptr<DorisScanRange> scan_range,
@@ -167,9 +176,16 @@ private:
 
     void construct_is_null_pred_in_where_pred(Expr* expr, SlotDescriptor* slot, std::string is_null_str);
 
+    // Push 'col LIKE pattern' down to the storage engine, which prunes row
+    // blocks by ngram bloom filters, the conjunct stays to filter the rows
+    void normalize_like_predicate(SlotDescriptor* slot);
+
     friend class OlapScanner;
 
     std::vector<TCondition> _is_null_vector;
+    std::vector<TCondition> _like_filters;
+    // bloom filters of runtime filters, by column name
+    std::vector<std::pair<std::string, std::shared_ptr<const BloomFilter>>> _bloom_filters;
     // Tuple id resolved in prepare() to set _tuple_desc;
     TupleId _tuple_id;
     // doris scan node used to scan doris
@@ -246,6 +262,8 @@ private:
     RuntimeProfile::Counter* _scan_timer;
     RuntimeProfile::Counter* _tablet_counter;
     RuntimeProfile::Counter* _rows_pushed_cond_filtered_counter = nullptr;
+    RuntimeProfile::Counter* _runtime_filter_wait_timer = nullptr;
+    RuntimeProfile::Counter* _runtime_filters_arrived_counter = nullptr;
     RuntimeProfile::Counter* _reader_init_timer = nullptr;
 
     TResourceInfo* _resource_info;
@@ -259,12 +277,18 @@ private:
     RuntimeProfile::Counter* _read_compressed_counter = nullptr;
     RuntimeProfile::Counter* _decompressor_timer = nullptr;
     RuntimeProfile::Counter* _read_uncompressed_counter = nullptr;
+    RuntimeProfile::Counter* _page_cache_hit_counter = nullptr;
+    RuntimeProfile::Counter* _page_cache_miss_counter = nullptr;
     RuntimeProfile::Counter* _raw_rows_counter = nullptr;
 
     RuntimeProfile::Counter* _rows_vec_cond_counter = nullptr;
     RuntimeProfile::Counter* _vec_cond_timer = nullptr;
+    RuntimeProfile::Counter* _rows_lazy_skipped_counter = nullptr;
 
     RuntimeProfile::Counter* _stats_filtered_counter = nullptr;
+    RuntimeProfile::Counter* _blocks_stats_filtered_counter = nullptr;
+    RuntimeProfile::Counter* _segments_stats_filtered_counter = nullptr;
+    RuntimeProfile::Counter* _blocks_ngram_filtered_counter = nullptr;
     RuntimeProfile::Counter* _del_filtered_counter = nullptr;
 
     RuntimeProfile::Counter* _block_seek_timer = nullptr;
@@ -156,8 +156,15 @@ Status OlapScanner::_init_params(
     for (auto& is_null_str : is_nulls) {
         _params.conditions.push_back(is_null_str);
     }
+    _params.bloom_filters = _parent->_bloom_filters;
     // Range
     for (auto& key_range : key_ranges) {
+        if (key_range.num_block_splits > 1) {
+            // the only range of its scanner, see start_scan_thread
+            _params.block_split = key_range.block_split;
+            _params.num_block_splits = key_range.num_block_splits;
+            continue;
+        }
         if (key_range.begin_scan_range.size() == 1 &&
                 key_range.begin_scan_range.get_value(0) == NEGATIVE_INFINITY) {
             continue;
@@ -233,6 +240,10 @@ Status OlapScanner::_init_return_columns() {
 
 Status OlapScanner::get_batch(
         RuntimeState* state, RowBatch* batch, bool* eof) {
+    if (_reader->vectorized_read()) {
+        return _get_vector_batch(state, batch, eof);
+    }
+
     // 2. Allocate Row's Tuple buf
     uint8_t *tuple_buf = batch->tuple_data_pool()->allocate(
         state->batch_size() * _tuple_desc->byte_size());
@@ -264,80 +275,16 @@ Status OlapScanner::get_batch(
                 VLOG_ROW << "OlapScanner input row: " << Tuple::to_string(tuple, *_tuple_desc);
             }
 
-            // 3.4 Set tuple to RowBatch(not commited)
-            int row_idx = batch->add_row();
-            TupleRow* row = batch->get_row(row_idx);
-            row->set_tuple(_tuple_idx, tuple);
-
-            do {
-                // 3.5.1 Using direct conjuncts to filter data
-                if (_eval_conjuncts_fn != nullptr) {
-                    if (!_eval_conjuncts_fn(&_conjunct_ctxs[0], _direct_conjunct_size, row)) {
-                        // check direct conjuncts fail then clear tuple for reuse
-                        // make sure to reset null indicators since we're overwriting
-                        // the tuple assembled for the previous row
-                        tuple->init(_tuple_desc->byte_size());
-                        break;
-                    }
-                } else {
-                    if (!ExecNode::eval_conjuncts(&_conjunct_ctxs[0], _direct_conjunct_size, row)) {
-                        // check direct conjuncts fail then clear tuple for reuse
-                        // make sure to reset null indicators since we're overwriting
-                        // the tuple assembled for the previous row
-                        tuple->init(_tuple_desc->byte_size());
-                        break;
-                    }
-                }
-
-                // 3.5.2 Using pushdown conjuncts to filter data
-                if (_use_pushdown_conjuncts) {
-                    if (!ExecNode::eval_conjuncts(
-                            &_conjunct_ctxs[_direct_conjunct_size],
-                            _conjunct_ctxs.size() - _direct_conjunct_size, row)) {
-                        // check pushdown conjuncts fail then clear tuple for reuse
-                        // make sure to reset null indicators since we're overwriting
-                        // the tuple assembled for the previous row
-                        tuple->init(_tuple_desc->byte_size());
-                        _num_rows_pushed_cond_filtered++;
-                        break;
-                    }
-                }
-
-                // Copy string slot
-                for (auto desc : _string_slots) {
-                    StringValue* slot = tuple->get_string_slot(desc->tuple_offset());
-                    if (slot->len != 0) {
-                        uint8_t* v = batch->tuple_data_pool()->allocate(slot->len);
-                        memory_copy(v, slot->ptr, slot->len);
-                        slot->ptr = reinterpret_cast<char*>(v);
-                    }
-                }
-                if (VLOG_ROW_IS_ON) {
-                    VLOG_ROW << "OlapScanner output row: " << Tuple::to_string(tuple, *_tuple_desc);
-                }
-
-                // check direct && pushdown conjuncts success then commit tuple
-                batch->commit_last_row();
+            if (_commit_row(batch, tuple)) {
                 char* new_tuple = reinterpret_cast<char*>(tuple);
                 new_tuple += _tuple_desc->byte_size();
                 tuple = reinterpret_cast<Tuple*>(new_tuple);
-
-                // compute pushdown conjuncts filter rate
-                if (_use_pushdown_conjuncts) {
-                    // check this rate after 
-                    if (_num_rows_read > 32768) {
-                        int32_t pushdown_return_rate
-                            = _num_rows_read * 100 / (_num_rows_read + _num_rows_pushed_cond_filtered);
-                        if (pushdown_return_rate > config::doris_max_pushdown_conjuncts_return_rate) {
-                            _use_pushdown_conjuncts = false;
-                            VLOG(2) << "Stop Using PushDown Conjuncts. "
-                                << "PushDownReturnRate: " << pushdown_return_rate << "%"
-                                << " MaxPushDownReturnRate: "
-                                << config::doris_max_pushdown_conjuncts_return_rate << "%";
-                        }
-                    }
-                }
-            } while (false);
+            } else {
+                // check conjuncts fail then clear tuple for reuse
+                // make sure to reset null indicators since we're overwriting
+                // the tuple assembled for the previous row
+                tuple->init(_tuple_desc->byte_size());
+            }
 
             if (raw_rows_read() >= raw_rows_threshold) {
                 break;
@@ -348,6 +295,108 @@ Status OlapScanner::get_batch(
     return Status::OK;
 }
 
+Status OlapScanner::_get_vector_batch(
+        RuntimeState* state, RowBatch* batch, bool* eof) {
+    int64_t raw_rows_threshold = raw_rows_read() + config::doris_scanner_row_num;
+    SCOPED_TIMER(_parent->_scan_timer);
+    while (!batch->is_full()) {
+        if (_vector_batch == nullptr || _vector_row_idx >= _vector_batch->size()) {
+            auto res = _reader->next_vector_batch(&_vector_batch, eof);
+            if (res != OLAP_SUCCESS) {
+                return Status("Internal Error: read storage fail.");
+            }
+            if (UNLIKELY(*eof)) {
+                _vector_batch = nullptr;
+                break;
+            }
+            _vector_row_idx = 0;
+        }
+
+        int num_rows = std::min(_vector_batch->size() - _vector_row_idx,
+                                batch->capacity() - batch->num_rows());
+        size_t tuple_size = _tuple_desc->byte_size();
+        uint8_t* tuple_buf = batch->tuple_data_pool()->allocate(num_rows * tuple_size);
+        bzero(tuple_buf, num_rows * tuple_size);
+        _convert_vector_to_tuples(_vector_batch, _vector_row_idx, num_rows, tuple_buf);
+        _vector_row_idx += num_rows;
+        _num_rows_read += num_rows;
+
+        for (int i = 0; i < num_rows; ++i) {
+            Tuple* tuple = reinterpret_cast<Tuple*>(tuple_buf + i * tuple_size);
+            if (VLOG_ROW_IS_ON) {
+                VLOG_ROW << "OlapScanner input row: " << Tuple::to_string(tuple, *_tuple_desc);
+            }
+            _commit_row(batch, tuple);
+        }
+
+        if (raw_rows_read() >= raw_rows_threshold) {
+            break;
+        }
+    }
+    return Status::OK;
+}
+
+bool OlapScanner::_commit_row(RowBatch* batch, Tuple* tuple) {
+    // Set tuple to RowBatch(not commited)
+    int row_idx = batch->add_row();
+    TupleRow* row = batch->get_row(row_idx);
+    row->set_tuple(_tuple_idx, tuple);
+
+    // Using direct conjuncts to filter data
+    if (_eval_conjuncts_fn != nullptr) {
+        if (!_eval_conjuncts_fn(&_conjunct_ctxs[0], _direct_conjunct_size, row)) {
+            return false;
+        }
+    } else {
+        if (!ExecNode::eval_conjuncts(&_conjunct_ctxs[0], _direct_conjunct_size, row)) {
+            return false;
+        }
+    }
+
+    // Using pushdown conjuncts to filter data
+    if (_use_pushdown_conjuncts) {
+        if (!ExecNode::eval_conjuncts(
+                &_conjunct_ctxs[_direct_conjunct_size],
+                _conjunct_ctxs.size() - _direct_conjunct_size, row)) {
+            _num_rows_pushed_cond_filtered++;
+            return false;
+        }
+    }
+
+    // Copy string slot
+    for (auto desc : _string_slots) {
+        StringValue* slot = tuple->get_string_slot(desc->tuple_offset());
+        if (slot->len != 0) {
+            uint8_t* v = batch->tuple_data_pool()->allocate(slot->len);
+            memory_copy(v, slot->ptr, slot->len);
+            slot->ptr = reinterpret_cast<char*>(v);
+        }
+    }
+    if (VLOG_ROW_IS_ON) {
+        VLOG_ROW << "OlapScanner output row: " << Tuple::to_string(tuple, *_tuple_desc);
+    }
+
+    // check direct && pushdown conjuncts success then commit tuple
+    batch->commit_last_row();
+
+    // compute pushdown conjuncts filter rate
+    if (_use_pushdown_conjuncts) {
+        // check this rate after 
+        if (_num_rows_read > 32768) {
+            int32_t pushdown_return_rate
+                = _num_rows_read * 100 / (_num_rows_read + _num_rows_pushed_cond_filtered);
+            if (pushdown_return_rate > config::doris_max_pushdown_conjuncts_return_rate) {
+                _use_pushdown_conjuncts = false;
+                VLOG(2) << "Stop Using PushDown Conjuncts. "
+                    << "PushDownReturnRate: " << pushdown_return_rate << "%"
+                    << " MaxPushDownReturnRate: "
+                    << config::doris_max_pushdown_conjuncts_return_rate << "%";
+            }
+        }
+    }
+    return true;
+}
+
 void OlapScanner::_convert_row_to_tuple(Tuple* tuple) {
     char* row = _read_row_cursor.get_buf();
     size_t slots_size = _query_slots.size();
@@ -358,60 +407,90 @@ void OlapScanner::_convert_row_to_tuple(Tuple* tuple) {
             tuple->set_null(slot_desc->null_indicator_offset());
             continue;
         }
-        char* ptr = (char*)field->get_ptr(row);
-        size_t len = field->size();
-        switch (slot_desc->type().type) {
-        case TYPE_CHAR: {
-            Slice* slice = reinterpret_cast<Slice*>(ptr);
-            StringValue *slot = tuple->get_string_slot(slot_desc->tuple_offset());
-            slot->ptr = slice->data;
-            slot->len = strnlen(slot->ptr, slice->size);
-            break;
-        }
-        case TYPE_VARCHAR:
-        case TYPE_HLL: {
-            Slice* slice = reinterpret_cast<Slice*>(ptr);
-            StringValue *slot = tuple->get_string_slot(slot_desc->tuple_offset());
-            slot->ptr = slice->data;
-            slot->len = slice->size;
-            break;
-        }
-        case TYPE_DECIMAL: {
-            DecimalValue *slot = tuple->get_decimal_slot(slot_desc->tuple_offset());
+        _convert_field_to_slot(slot_desc, (char*)field->get_ptr(row), field->size(), tuple);
+    }
+}
 
-            // TODO(lingbin): should remove this assign, use set member function
-            int64_t int_value = *(int64_t*)(ptr);
-            int32_t frac_value = *(int32_t*)(ptr + sizeof(int64_t));
-            *slot = DecimalValue(int_value, frac_value);
-            break;
-        }
-        case TYPE_DATETIME: {
-            DateTimeValue *slot = tuple->get_datetime_slot(slot_desc->tuple_offset());
-            uint64_t value = *reinterpret_cast<uint64_t*>(ptr);
-            if (!slot->from_olap_datetime(value)) {
-                tuple->set_null(slot_desc->null_indicator_offset());
-            }
-            break;
-        }
-        case TYPE_DATE: {
-            DateTimeValue *slot = tuple->get_datetime_slot(slot_desc->tuple_offset());
-            uint64_t value = 0;
-            value = *(unsigned char*)(ptr + 2);
-            value <<= 8;
-            value |= *(unsigned char*)(ptr + 1);
-            value <<= 8;
-            value |= *(unsigned char*)(ptr);
-            if (!slot->from_olap_date(value)) {
+void OlapScanner::_convert_vector_to_tuples(
+        VectorizedRowBatch* vec_batch, int start, int num_rows, uint8_t* tuple_buf) {
+    const uint16_t* selected =
+        vec_batch->selected_in_use() ? vec_batch->selected() + start : nullptr;
+    size_t tuple_size = _tuple_desc->byte_size();
+    size_t slots_size = _query_slots.size();
+    // one column at a time, values of a column vector are laid out one after
+    // another with the size of the field in a row
+    for (int i = 0; i < slots_size; ++i) {
+        SlotDescriptor* slot_desc = _query_slots[i];
+        size_t len = _query_fields[i]->size();
+        ColumnVector* column = vec_batch->column(_return_columns[i]);
+        char* col_data = reinterpret_cast<char*>(column->col_data());
+        const bool* is_null = column->no_nulls() ? nullptr : column->is_null();
+        uint8_t* tuple_ptr = tuple_buf;
+        for (int j = 0; j < num_rows; ++j, tuple_ptr += tuple_size) {
+            int row = selected != nullptr ? selected[j] : start + j;
+            Tuple* tuple = reinterpret_cast<Tuple*>(tuple_ptr);
+            if (is_null != nullptr && is_null[row]) {
                 tuple->set_null(slot_desc->null_indicator_offset());
+                continue;
             }
-            break;
+            _convert_field_to_slot(slot_desc, col_data + row * len, len, tuple);
         }
-        default: {
-            void *slot = tuple->get_slot(slot_desc->tuple_offset());
-            memory_copy(slot, ptr, len);
-            break;
+    }
+}
+
+inline void OlapScanner::_convert_field_to_slot(
+        const SlotDescriptor* slot_desc, char* ptr, size_t len, Tuple* tuple) {
+    switch (slot_desc->type().type) {
+    case TYPE_CHAR: {
+        Slice* slice = reinterpret_cast<Slice*>(ptr);
+        StringValue *slot = tuple->get_string_slot(slot_desc->tuple_offset());
+        slot->ptr = slice->data;
+        slot->len = strnlen(slot->ptr, slice->size);
+        break;
+    }
+    case TYPE_VARCHAR:
+    case TYPE_HLL: {
+        Slice* slice = reinterpret_cast<Slice*>(ptr);
+        StringValue *slot = tuple->get_string_slot(slot_desc->tuple_offset());
+        slot->ptr = slice->data;
+        slot->len = slice->size;
+        break;
+    }
+    case TYPE_DECIMAL: {
+        DecimalValue *slot = tuple->get_decimal_slot(slot_desc->tuple_offset());
+
+        // TODO(lingbin): should remove this assign, use set member function
+        int64_t int_value = *(int64_t*)(ptr);
+        int32_t frac_value = *(int32_t*)(ptr + sizeof(int64_t));
+        *slot = DecimalValue(int_value, frac_value);
+        break;
+    }
+    case TYPE_DATETIME: {
+        DateTimeValue *slot = tuple->get_datetime_slot(slot_desc->tuple_offset());
+        uint64_t value = *reinterpret_cast<uint64_t*>(ptr);
+        if (!slot->from_olap_datetime(value)) {
+            tuple->set_null(slot_desc->null_indicator_offset());
         }
+        break;
+    }
+    case TYPE_DATE: {
+        DateTimeValue *slot = tuple->get_datetime_slot(slot_desc->tuple_offset());
+        uint64_t value = 0;
+        value = *(unsigned char*)(ptr + 2);
+        value <<= 8;
+        value |= *(unsigned char*)(ptr + 1);
+        value <<= 8;
+        value |= *(unsigned char*)(ptr);
+        if (!slot->from_olap_date(value)) {
+            tuple->set_null(slot_desc->null_indicator_offset());
         }
+        break;
+    }
+    default: {
+        void *slot = tuple->get_slot(slot_desc->tuple_offset());
+        memory_copy(slot, ptr, len);
+        break;
+    }
     }
 }
 
@@ -426,6 +505,8 @@ void OlapScanner::update_counter() {
     COUNTER_UPDATE(_parent->_read_compressed_counter, _reader->stats().compressed_bytes_read);
     COUNTER_UPDATE(_parent->_decompressor_timer, _reader->stats().decompress_ns);
     COUNTER_UPDATE(_parent->_read_uncompressed_counter, _reader->stats().uncompressed_bytes_read);
+    COUNTER_UPDATE(_parent->_page_cache_hit_counter, _reader->stats().page_cache_hit);
+    COUNTER_UPDATE(_parent->_page_cache_miss_counter, _reader->stats().page_cache_miss);
     COUNTER_UPDATE(_parent->bytes_read_counter(), _reader->stats().bytes_read);
 
     COUNTER_UPDATE(_parent->_block_load_timer, _reader->stats().block_load_ns);
@@ -439,8 +520,15 @@ void OlapScanner::update_counter() {
 
     COUNTER_UPDATE(_parent->_vec_cond_timer, _reader->stats().vec_cond_ns);
     COUNTER_UPDATE(_parent->_rows_vec_cond_counter, _reader->stats().rows_vec_cond_filtered);
+    COUNTER_UPDATE(_parent->_rows_lazy_skipped_counter, _reader->stats().rows_lazy_skipped);
 
     COUNTER_UPDATE(_parent->_stats_filtered_counter, _reader->stats().rows_stats_filtered);
+    COUNTER_UPDATE(_parent->_blocks_stats_filtered_counter,
+                   _reader->stats().blocks_stats_filtered);
+    COUNTER_UPDATE(_parent->_segments_stats_filtered_counter,
+                   _reader->stats().segments_stats_filtered);
+    COUNTER_UPDATE(_parent->_blocks_ngram_filtered_counter,
+                   _reader->stats().blocks_ngram_filtered);
     COUNTER_UPDATE(_parent->_del_filtered_counter, _reader->stats().rows_del_filtered);
 
     COUNTER_UPDATE(_parent->_index_load_timer, _reader->stats().index_load_ns);
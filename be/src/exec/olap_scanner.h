@@ -93,6 +93,19 @@ private:
     Status _init_return_columns();
     void _convert_row_to_tuple(Tuple* tuple);
 
+    // Fill RowBatch from the column vectors of the reader, for readers that
+    // need no merge of rows
+    Status _get_vector_batch(RuntimeState* state, RowBatch* batch, bool* eof);
+    // Convert num_rows selected rows of vec_batch from start to consecutive
+    // tuples, one column at a time
+    void _convert_vector_to_tuples(
+        VectorizedRowBatch* vec_batch, int start, int num_rows, uint8_t* tuple_buf);
+    void _convert_field_to_slot(
+        const SlotDescriptor* slot_desc, char* ptr, size_t len, Tuple* tuple);
+    // Evaluate conjuncts on tuple and add it to batch if it passes. Return
+    // false if tuple is filtered.
+    bool _commit_row(RowBatch* batch, Tuple* tuple);
+
     RuntimeState* _runtime_state;
     OlapScanNode* _parent;
     const TupleDescriptor* _tuple_desc;      /**< tuple descripter */
@@ -122,6 +135,10 @@ private:
 
     RowCursor _read_row_cursor;
 
+    // batch being read by _get_vector_batch and its next row to read
+    VectorizedRowBatch* _vector_batch = nullptr;
+    int _vector_row_idx = 0;
+
     std::vector<uint32_t> _request_columns_size;
 
     std::vector<SlotDescriptor*> _query_slots;
@@ -82,7 +82,8 @@ static const char* POSITIVE_INFINITY = "+oo";
 
 typedef struct OlapScanRange {
 public:
-    OlapScanRange() : begin_include(true), end_include(true) {
+    OlapScanRange() : begin_include(true), end_include(true),
+            block_split(0), num_block_splits(1) {
         begin_scan_range.add_value(NEGATIVE_INFINITY);
         end_scan_range.add_value(POSITIVE_INFINITY);
     }
@@ -92,12 +93,17 @@ public:
         std::vector<std::string>& begin_range,
         std::vector<std::string>& end_range)
         : begin_include(begin), end_include(end),
-          begin_scan_range(begin_range), end_scan_range(end_range) { }
+          begin_scan_range(begin_range), end_scan_range(end_range),
+          block_split(0), num_block_splits(1) { }
 
     bool begin_include;
     bool end_include;
     OlapTuple begin_scan_range;
     OlapTuple end_scan_range;
+    // With num_block_splits > 1 the range is the whole tablet, of which
+    // only part block_split of its row blocks is read
+    int32_t block_split;
+    int32_t num_block_splits;
 } OlapScanRange;
 
 static char encoding_table[] = {
@@ -0,0 +1,909 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/partitioned_hash_join_node.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "exec/partitioned_hash_table.inline.h"
+#include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "runtime/buffered_tuple_stream2.inline.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/tuple_row.h"
+#include "util/runtime_profile.h"
+
+#include "gen_cpp/PlanNodes_types.h"
+
+using std::list;
+using std::stringstream;
+using std::vector;
+
+namespace doris {
+
+PartitionedHashJoinNode::PartitionedHashJoinNode(
+        ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs) :
+        ExecNode(pool, tnode, descs),
+        _join_op(tnode.hash_join_node.join_op),
+        _state(NULL),
+        _block_mgr_client(NULL),
+        _partition_pool(new ObjectPool()),
+        _input_partition(NULL),
+        _phase(PROBING),
+        _probe_tuple_row_size(0),
+        _build_tuple_row_size(0),
+        _probe_batch_pos(0),
+        _probe_eos(false),
+        _current_probe_row(NULL),
+        _matched_probe(false),
+        _num_build_rows(0),
+        _build_has_null_key(false),
+        _build_timer(NULL),
+        _build_hash_tables_timer(NULL),
+        _probe_timer(NULL),
+        _build_rows_counter(NULL),
+        _probe_rows_counter(NULL),
+        _num_hash_buckets(NULL),
+        _partitions_created(NULL),
+        _num_spilled_partitions(NULL),
+        _num_repartitions(NULL),
+        _num_row_repartitioned(NULL) {
+    DCHECK_EQ(PARTITION_FANOUT, 1 << NUM_PARTITIONING_BITS);
+    _match_all_probe =
+        (_join_op == TJoinOp::LEFT_OUTER_JOIN || _join_op == TJoinOp::FULL_OUTER_JOIN);
+    _match_one_build = (_join_op == TJoinOp::LEFT_SEMI_JOIN);
+    _match_all_build =
+        (_join_op == TJoinOp::RIGHT_OUTER_JOIN || _join_op == TJoinOp::FULL_OUTER_JOIN);
+}
+
+Status PartitionedHashJoinNode::init(const TPlanNode& tnode, RuntimeState* state) {
+    RETURN_IF_ERROR(ExecNode::init(tnode, state));
+    DCHECK(tnode.__isset.hash_join_node);
+    const vector<TEqJoinCondition>& eq_join_conjuncts = tnode.hash_join_node.eq_join_conjuncts;
+    if (eq_join_conjuncts.empty()) {
+        return Status("partitioned hash join needs equi-join conjuncts");
+    }
+    for (int i = 0; i < eq_join_conjuncts.size(); ++i) {
+        ExprContext* ctx = NULL;
+        RETURN_IF_ERROR(Expr::create_expr_tree(_pool, eq_join_conjuncts[i].left, &ctx));
+        _probe_expr_ctxs.push_back(ctx);
+        RETURN_IF_ERROR(Expr::create_expr_tree(_pool, eq_join_conjuncts[i].right, &ctx));
+        _build_expr_ctxs.push_back(ctx);
+    }
+    RETURN_IF_ERROR(Expr::create_expr_trees(_pool, tnode.hash_join_node.other_join_conjuncts,
+                                            &_other_join_conjunct_ctxs));
+    if (_join_op == TJoinOp::NULL_AWARE_LEFT_ANTI_JOIN && !_other_join_conjunct_ctxs.empty()) {
+        return Status("partitioned hash join does not support null-aware left anti join "
+                      "with other join conjuncts");
+    }
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::prepare(RuntimeState* state) {
+    SCOPED_TIMER(_runtime_profile->total_time_counter());
+    RETURN_IF_ERROR(ExecNode::prepare(state));
+    _state = state;
+
+    _build_timer = ADD_TIMER(runtime_profile(), "BuildTime");
+    _build_hash_tables_timer = ADD_TIMER(runtime_profile(), "BuildHashTablesTime");
+    _probe_timer = ADD_TIMER(runtime_profile(), "ProbeTime");
+    _build_rows_counter = ADD_COUNTER(runtime_profile(), "BuildRows", TUnit::UNIT);
+    _probe_rows_counter = ADD_COUNTER(runtime_profile(), "ProbeRows", TUnit::UNIT);
+    _num_hash_buckets = ADD_COUNTER(runtime_profile(), "HashBuckets", TUnit::UNIT);
+    _partitions_created = ADD_COUNTER(runtime_profile(), "PartitionsCreated", TUnit::UNIT);
+    _num_spilled_partitions = ADD_COUNTER(
+            runtime_profile(), "SpilledPartitions", TUnit::UNIT);
+    _num_repartitions = ADD_COUNTER(runtime_profile(), "NumRepartitions", TUnit::UNIT);
+    _num_row_repartitioned = ADD_COUNTER(
+            runtime_profile(), "RowsRepartitioned", TUnit::UNIT);
+
+    // build and probe exprs are evaluated in the context of the rows produced by our
+    // right and left children, respectively
+    RETURN_IF_ERROR(Expr::prepare(
+            _build_expr_ctxs, state, child(1)->row_desc(), expr_mem_tracker()));
+    RETURN_IF_ERROR(Expr::prepare(
+            _probe_expr_ctxs, state, child(0)->row_desc(), expr_mem_tracker()));
+    // _other_join_conjuncts are evaluated in the context of the rows produced by this node
+    RETURN_IF_ERROR(Expr::prepare(
+            _other_join_conjunct_ctxs, state, _row_descriptor, expr_mem_tracker()));
+
+    int num_build_tuples = child(1)->row_desc().tuple_descriptors().size();
+    _probe_tuple_row_size = child(0)->row_desc().tuple_descriptors().size() * sizeof(Tuple*);
+    _build_tuple_row_size = num_build_tuples * sizeof(Tuple*);
+
+    // The build rows with NULL keys match nothing, they are only kept by the joins
+    // returning the unmatched build rows
+    const bool stores_nulls = _join_op == TJoinOp::RIGHT_OUTER_JOIN
+        || _join_op == TJoinOp::FULL_OUTER_JOIN
+        || _join_op == TJoinOp::RIGHT_ANTI_JOIN
+        || _join_op == TJoinOp::RIGHT_SEMI_JOIN;
+    _ht_ctx.reset(new PartitionedHashTableCtx(_build_expr_ctxs, _probe_expr_ctxs,
+                stores_nulls, false, state->fragment_hash_seed(), MAX_PARTITION_DEPTH,
+                num_build_tuples));
+    RETURN_IF_ERROR(state->block_mgr2()->register_client(
+                min_required_buffers(), mem_tracker(), state, &_block_mgr_client));
+
+    _probe_batch.reset(new RowBatch(child(0)->row_desc(), state->batch_size(), mem_tracker()));
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::open(RuntimeState* state) {
+    SCOPED_TIMER(_runtime_profile->total_time_counter());
+    RETURN_IF_ERROR(ExecNode::open(state));
+    RETURN_IF_ERROR(exec_debug_action(TExecNodePhase::OPEN));
+    RETURN_IF_CANCELLED(state);
+    RETURN_IF_ERROR(Expr::open(_build_expr_ctxs, state));
+    RETURN_IF_ERROR(Expr::open(_probe_expr_ctxs, state));
+    RETURN_IF_ERROR(Expr::open(_other_join_conjunct_ctxs, state));
+
+    // Partition all the build rows, the build side can be closed once they are copied
+    // into the build streams.
+    RETURN_IF_ERROR(create_hash_partitions(0));
+    RETURN_IF_ERROR(child(1)->open(state));
+    RETURN_IF_ERROR(process_build_input(state));
+    child(1)->close(state);
+    RETURN_IF_ERROR(build_hash_tables());
+
+    RETURN_IF_ERROR(child(0)->open(state));
+    _probe_batch_pos = 0;
+    _probe_eos = false;
+    _current_probe_row = NULL;
+    _phase = PROBING;
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::get_next(RuntimeState* state, RowBatch* out_batch, bool* eos) {
+    SCOPED_TIMER(_runtime_profile->total_time_counter());
+    RETURN_IF_ERROR(exec_debug_action(TExecNodePhase::GETNEXT));
+    RETURN_IF_CANCELLED(state);
+    RETURN_IF_ERROR(state->check_query_state());
+
+    *eos = false;
+    if (reached_limit()) {
+        *eos = true;
+        return Status::OK;
+    }
+    if (_join_op == TJoinOp::NULL_AWARE_LEFT_ANTI_JOIN && _build_has_null_key) {
+        // NOT IN a set with NULL is never true.
+        *eos = true;
+        return Status::OK;
+    }
+
+    while (!out_batch->at_capacity() && !reached_limit()) {
+        if (_phase == PARTITIONS_DONE) {
+            // The rows returned before referencing their build rows have been passed up.
+            close_done_partitions();
+            if (_spilled_partitions.empty()) {
+                *eos = true;
+                break;
+            }
+            RETURN_IF_ERROR(prepare_next_partition());
+            continue;
+        }
+
+        if (_phase == PROBING) {
+            bool probe_done = false;
+            {
+                SCOPED_TIMER(_probe_timer);
+                RETURN_IF_ERROR(process_probe(state, out_batch, &probe_done));
+            }
+            if (probe_done) {
+                RETURN_IF_ERROR(finish_partitions());
+            }
+        } else {
+            DCHECK_EQ(_phase, OUTPUTTING_UNMATCHED);
+            output_unmatched_build_rows(out_batch);
+        }
+
+        if (_phase == PARTITIONS_DONE) {
+            if (_spilled_partitions.empty()) {
+                *eos = true;
+            } else {
+                // The rows of out_batch must be passed up before the partitions are
+                // closed in the next call.
+                out_batch->mark_need_to_return();
+            }
+            break;
+        }
+    }
+
+    if (reached_limit()) {
+        *eos = true;
+    }
+    COUNTER_SET(_rows_returned_counter, _num_rows_returned);
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::close(RuntimeState* state) {
+    if (is_closed()) {
+        return Status::OK;
+    }
+    RETURN_IF_ERROR(exec_debug_action(TExecNodePhase::CLOSE));
+    // Must reset _probe_batch in close() to release resources
+    _probe_batch.reset();
+
+    close_partitions();
+    if (_ht_ctx.get() != NULL) {
+        _ht_ctx->close();
+    }
+    if (_block_mgr_client != NULL) {
+        state->block_mgr2()->clear_reservations(_block_mgr_client);
+    }
+
+    Expr::close(_build_expr_ctxs, state);
+    Expr::close(_probe_expr_ctxs, state);
+    Expr::close(_other_join_conjunct_ctxs, state);
+    return ExecNode::close(state);
+}
+
+Status PartitionedHashJoinNode::Partition::init_build_stream() {
+    build_rows.reset(new BufferedTupleStream2(parent->_state, parent->child(1)->row_desc(),
+                parent->_state->block_mgr2(), parent->_block_mgr_client,
+                true /* use_initial_small_buffers */, false /* read_write */));
+    return build_rows->init(parent->id(), parent->runtime_profile(), true);
+}
+
+Status PartitionedHashJoinNode::Partition::init_probe_stream() {
+    DCHECK(is_spilled);
+    DCHECK(probe_rows.get() == NULL);
+    probe_rows.reset(new BufferedTupleStream2(parent->_state, parent->child(0)->row_desc(),
+                parent->_state->block_mgr2(), parent->_block_mgr_client,
+                false /* use_initial_small_buffers */, false /* read_write */));
+    // This stream is only used to spill, no need to ever have this pinned.
+    RETURN_IF_ERROR(probe_rows->init(parent->id(), parent->runtime_profile(), false));
+    DCHECK(probe_rows->has_write_block());
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::Partition::build_hash_table(bool* built) {
+    DCHECK(build_rows->is_pinned());
+    DCHECK(hash_tbl.get() == NULL);
+    *built = false;
+
+    // We use the upper PARTITION_FANOUT num bits to pick the partition so only the
+    // remaining bits can be used for the hash table.
+    PartitionedHashTableCtx* ctx = parent->_ht_ctx.get();
+    hash_tbl.reset(PartitionedHashTable::create(parent->_state, parent->_block_mgr_client,
+                parent->child(1)->row_desc().tuple_descriptors().size(), build_rows.get(),
+                1 << (32 - NUM_PARTITIONING_BITS),
+                PartitionedHashTable::EstimateNumBuckets(
+                    std::max<int64_t>(build_rows->num_rows(), 1))));
+    if (!hash_tbl->init()) {
+        hash_tbl->close();
+        hash_tbl.reset();
+        return Status::OK;
+    }
+
+    if (build_rows->num_rows() > 0) {
+        // The rows are read without being deleted, the hash table references them.
+        bool got_buffer = false;
+        RETURN_IF_ERROR(build_rows->prepare_for_read(false, &got_buffer));
+        DCHECK(got_buffer) << "Stream is pinned";
+
+        RowBatch batch(parent->child(1)->row_desc(), parent->_state->batch_size(),
+                parent->mem_tracker());
+        vector<BufferedTupleStream2::RowIdx> indices;
+        bool eos = false;
+        while (!eos) {
+            RETURN_IF_CANCELLED(parent->_state);
+            RETURN_IF_ERROR(build_rows->get_next(&batch, &eos, &indices));
+            DCHECK_EQ(batch.num_rows(), indices.size());
+            bool inserted = hash_tbl->check_and_resize(batch.num_rows(), ctx);
+            for (int i = 0; inserted && i < batch.num_rows(); ++i) {
+                TupleRow* row = batch.get_row(i);
+                uint32_t hash = 0;
+                if (!ctx->eval_and_hash_build(row, &hash)) {
+                    continue;
+                }
+                inserted = hash_tbl->insert(ctx, indices[i], row, hash);
+            }
+            batch.reset();
+            if (!inserted) {
+                // Not enough memory for the buckets or the duplicate nodes.
+                hash_tbl->close();
+                hash_tbl.reset();
+                return Status::OK;
+            }
+        }
+    }
+
+    COUNTER_UPDATE(parent->_num_hash_buckets, hash_tbl->num_buckets());
+    *built = true;
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::Partition::spill() {
+    DCHECK(!is_closed);
+    DCHECK(!is_spilled);
+
+    if (hash_tbl.get() != NULL) {
+        DCHECK(!hash_tbl->HasMatches()) << "The matches of the build rows would be lost";
+        hash_tbl->close();
+        hash_tbl.reset();
+    }
+
+    // Try to switch to an IO-sized buffer, if more build rows are to be appended, to avoid
+    // writing small buffers to disk.
+    if (build_rows->has_write_block() && build_rows->using_small_buffers()) {
+        bool got_buffer = false;
+        RETURN_IF_ERROR(build_rows->switch_to_io_buffers(&got_buffer));
+        if (!got_buffer) {
+            // We'll try again to get the buffer when the stream fills up the small buffers.
+            VLOG_QUERY << "Not enough memory to switch to IO-sized buffer for partition "
+                << this << " of join=" << parent->_id;
+        }
+    }
+    RETURN_IF_ERROR(build_rows->unpin_stream(false));
+    is_spilled = true;
+
+    COUNTER_UPDATE(parent->_num_spilled_partitions, 1);
+    if (parent->_num_spilled_partitions->value() == 1) {
+        parent->add_runtime_exec_option("Spilled");
+    }
+    return Status::OK;
+}
+
+void PartitionedHashJoinNode::Partition::close() {
+    if (is_closed) {
+        return;
+    }
+    is_closed = true;
+    if (hash_tbl.get() != NULL) {
+        hash_tbl->close();
+        hash_tbl.reset();
+    }
+    if (build_rows.get() != NULL) {
+        build_rows->close();
+    }
+    if (probe_rows.get() != NULL) {
+        probe_rows->close();
+    }
+}
+
+Status PartitionedHashJoinNode::create_hash_partitions(int level) {
+    DCHECK(_hash_partitions.empty());
+    _ht_ctx->set_level(level);
+    for (int i = 0; i < PARTITION_FANOUT; ++i) {
+        Partition* partition = _partition_pool->add(new Partition(this, level));
+        _hash_partitions.push_back(partition);
+        RETURN_IF_ERROR(partition->init_build_stream());
+    }
+    COUNTER_UPDATE(_partitions_created, PARTITION_FANOUT);
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::process_build_input(RuntimeState* state) {
+    RowBatch build_batch(child(1)->row_desc(), state->batch_size(), mem_tracker());
+    bool eos = false;
+    do {
+        RETURN_IF_CANCELLED(state);
+        RETURN_IF_ERROR(state->check_query_state());
+        RETURN_IF_ERROR(child(1)->get_next(state, &build_batch, &eos));
+        SCOPED_TIMER(_build_timer);
+        RETURN_IF_ERROR(process_build_batch(&build_batch));
+        _num_build_rows += build_batch.num_rows();
+        COUNTER_UPDATE(_build_rows_counter, build_batch.num_rows());
+        build_batch.reset();
+    } while (!eos);
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::process_build_stream(BufferedTupleStream2* input_stream) {
+    if (input_stream->num_rows() > 0) {
+        while (true) {
+            bool got_buffer = false;
+            RETURN_IF_ERROR(input_stream->prepare_for_read(true, &got_buffer));
+            if (got_buffer) {
+                break;
+            }
+            // Did not have a buffer to read the input stream. Spill and try again.
+            RETURN_IF_ERROR(spill_partition());
+        }
+
+        RowBatch batch(child(1)->row_desc(), _state->batch_size(), mem_tracker());
+        bool eos = false;
+        do {
+            RETURN_IF_CANCELLED(_state);
+            RETURN_IF_ERROR(input_stream->get_next(&batch, &eos));
+            SCOPED_TIMER(_build_timer);
+            RETURN_IF_ERROR(process_build_batch(&batch));
+            batch.reset();
+        } while (!eos);
+    }
+    input_stream->close();
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::process_build_batch(RowBatch* build_batch) {
+    for (int i = 0; i < build_batch->num_rows(); ++i) {
+        TupleRow* row = build_batch->get_row(i);
+        uint32_t hash = 0;
+        if (!_ht_ctx->eval_and_hash_build(row, &hash)) {
+            // A NULL key matches nothing, and the unmatched build rows are not returned.
+            if (_join_op == TJoinOp::NULL_AWARE_LEFT_ANTI_JOIN) {
+                _build_has_null_key = true;
+            }
+            continue;
+        }
+        Partition* partition = _hash_partitions[hash >> (32 - NUM_PARTITIONING_BITS)];
+        RETURN_IF_ERROR(append_build_row(partition->build_rows.get(), row));
+    }
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::append_build_row(BufferedTupleStream2* stream, TupleRow* row) {
+    Status status;
+    while (!stream->add_row(row, &status)) {
+        // Adding fails iff either we hit an error or the stream did not get a new block.
+        RETURN_IF_ERROR(status);
+        bool got_buffer = false;
+        if (stream->using_small_buffers()) {
+            RETURN_IF_ERROR(stream->switch_to_io_buffers(&got_buffer));
+        }
+        if (!got_buffer) {
+            // An unpinned stream with an IO-sized buffer always gets a new block, so this
+            // ends once the partition of the stream is spilled.
+            RETURN_IF_ERROR(spill_partition());
+        }
+    }
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::build_hash_tables() {
+    SCOPED_TIMER(_build_hash_tables_timer);
+    for (int i = 0; i < _hash_partitions.size(); ++i) {
+        Partition* partition = _hash_partitions[i];
+        if (partition->is_spilled) {
+            continue;
+        }
+        if (partition->build_rows->num_rows() == 0) {
+            // No probe row of this partition matches.
+            partition->close();
+            continue;
+        }
+        bool built = false;
+        RETURN_IF_ERROR(partition->build_hash_table(&built));
+        if (!built) {
+            RETURN_IF_ERROR(partition->spill());
+        }
+    }
+    return init_probe_streams();
+}
+
+Status PartitionedHashJoinNode::init_probe_streams() {
+    // Spilling a partition to get a buffer makes it need a probe stream too, so look for
+    // the partitions without one until there is none.
+    while (true) {
+        Partition* partition = NULL;
+        for (int i = 0; i < _hash_partitions.size(); ++i) {
+            if (_hash_partitions[i]->is_spilled && _hash_partitions[i]->probe_rows.get() == NULL) {
+                partition = _hash_partitions[i];
+                break;
+            }
+        }
+        if (partition == NULL) {
+            return Status::OK;
+        }
+        // No more build rows are appended, release the buffer of the build stream.
+        RETURN_IF_ERROR(partition->build_rows->unpin_stream(true));
+        while (!_state->block_mgr2()->try_acquire_tmp_reservation(_block_mgr_client, 1)) {
+            RETURN_IF_ERROR(spill_partition());
+        }
+        RETURN_IF_ERROR(partition->init_probe_stream());
+    }
+}
+
+Status PartitionedHashJoinNode::spill_partition() {
+    int64_t max_freed_mem = 0;
+    int partition_idx = -1;
+
+    // Iterate over the partitions and pick the largest partition that is not spilled.
+    for (int i = 0; i < _hash_partitions.size(); ++i) {
+        Partition* partition = _hash_partitions[i];
+        if (partition->is_closed || partition->is_spilled || partition->has_probe_hits) {
+            continue;
+        }
+        int64_t mem = partition->build_rows->bytes_in_mem(false);
+        if (partition->hash_tbl.get() != NULL) {
+            mem += partition->hash_tbl->byte_size();
+        }
+        if (mem > max_freed_mem) {
+            max_freed_mem = mem;
+            partition_idx = i;
+        }
+    }
+    if (partition_idx == -1) {
+        // Could not find a partition to spill. This means the mem limit was just too low.
+        return _state->block_mgr2()->mem_limit_too_low_error(_block_mgr_client, id());
+    }
+    return _hash_partitions[partition_idx]->spill();
+}
+
+Status PartitionedHashJoinNode::append_probe_row(BufferedTupleStream2* stream, TupleRow* row) {
+    Status status;
+    while (!stream->add_row(row, &status)) {
+        RETURN_IF_ERROR(status);
+        // The probe stream is unpinned, it gets a block once enough memory is freed. The
+        // partition spilled needs a probe stream too.
+        RETURN_IF_ERROR(spill_partition());
+        RETURN_IF_ERROR(init_probe_streams());
+    }
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::prepare_next_partition() {
+    DCHECK(_hash_partitions.empty());
+    DCHECK(_input_partition == NULL);
+    DCHECK(!_spilled_partitions.empty());
+
+    // The spilled partitions are pushed at the front. This means a depth first walk
+    // (more finely partitioned partitions are processed first). This allows us
+    // to delete blocks earlier and bottom out the recursion earlier.
+    Partition* partition = _spilled_partitions.front();
+    _spilled_partitions.pop_front();
+    DCHECK(partition->is_spilled);
+    int64_t num_build_rows = partition->build_rows->num_rows();
+    int64_t num_probe_rows = partition->probe_rows->num_rows();
+    if ((num_probe_rows == 0 && !needs_unmatched_build_rows())
+            || (num_build_rows == 0 && !needs_unmatched_probe_rows())) {
+        // Joining this partition returns nothing.
+        partition->close();
+        return Status::OK;
+    }
+    _input_partition = partition;
+
+    // Read the probe rows first, the buffer to read them is then taken before
+    // the build rows are repartitioned.
+    _probe_eos = (num_probe_rows == 0);
+    if (!_probe_eos) {
+        bool got_buffer = false;
+        RETURN_IF_ERROR(partition->probe_rows->prepare_for_read(true, &got_buffer));
+        if (!got_buffer) {
+            // All the other partitions are unpinned, nothing is left to spill.
+            return _state->block_mgr2()->mem_limit_too_low_error(_block_mgr_client, id());
+        }
+    }
+    _probe_batch_pos = 0;
+    _current_probe_row = NULL;
+
+    // The build rows are joined without repartitioning if they fit in memory.
+    _ht_ctx->set_level(partition->level);
+    bool built = false;
+    bool pinned = false;
+    RETURN_IF_ERROR(partition->build_rows->pin_stream(false, &pinned));
+    if (pinned) {
+        RETURN_IF_ERROR(partition->build_hash_table(&built));
+        if (!built) {
+            RETURN_IF_ERROR(partition->build_rows->unpin_stream(true));
+        }
+    }
+    if (built) {
+        // The build rows are back in memory.
+        partition->is_spilled = false;
+        _phase = PROBING;
+        return Status::OK;
+    }
+
+    if (partition->level + 1 >= MAX_PARTITION_DEPTH) {
+        Status status = Status::MEM_LIMIT_EXCEEDED;
+        stringstream error_msg;
+        error_msg << "Cannot perform hash join at node with id " << _id << ". "
+                << "The input partition was repartitioned " << partition->level
+                << " times and still does not fit in memory. Number of build rows "
+                << num_build_rows << ".";
+        status.add_error_msg(error_msg.str());
+        return status;
+    }
+
+    RETURN_IF_ERROR(create_hash_partitions(partition->level + 1));
+    COUNTER_UPDATE(_num_repartitions, 1);
+    RETURN_IF_ERROR(process_build_stream(partition->build_rows.get()));
+    COUNTER_UPDATE(_num_row_repartitioned, num_build_rows);
+    RETURN_IF_ERROR(build_hash_tables());
+
+    // Check if there was any reduction in the size of partitions after repartitioning.
+    int64_t largest_partition = 0;
+    for (int i = 0; i < _hash_partitions.size(); ++i) {
+        if (_hash_partitions[i]->is_spilled) {
+            largest_partition = std::max(
+                    largest_partition, _hash_partitions[i]->build_rows->num_rows());
+        }
+    }
+    DCHECK_GE(num_build_rows, largest_partition) << "Cannot have a partition with "
+        "more rows than the input";
+    if (num_build_rows == largest_partition) {
+        Status status = Status::MEM_LIMIT_EXCEEDED;
+        stringstream error_msg;
+        error_msg << "Cannot perform hash join at node with id " << _id << ". "
+                << "Repartitioning did not reduce the size of a spilled partition. "
+                << "Repartitioning level " << partition->level + 1
+                << ". Number of rows " << num_build_rows << ".";
+        status.add_error_msg(error_msg.str());
+        return status;
+    }
+    _phase = PROBING;
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::next_probe_batch(RuntimeState* state) {
+    DCHECK(!_probe_eos);
+    if (_input_partition == NULL) {
+        RETURN_IF_ERROR(child(0)->get_next(state, _probe_batch.get(), &_probe_eos));
+        COUNTER_UPDATE(_probe_rows_counter, _probe_batch->num_rows());
+    } else {
+        RETURN_IF_ERROR(_input_partition->probe_rows->get_next(_probe_batch.get(), &_probe_eos));
+    }
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::process_probe(
+        RuntimeState* state, RowBatch* out_batch, bool* probe_done) {
+    *probe_done = false;
+    while (!out_batch->at_capacity() && !reached_limit()) {
+        if (_current_probe_row != NULL) {
+            if (!join_probe_row(out_batch)) {
+                return Status::OK;
+            }
+            _current_probe_row = NULL;
+            continue;
+        }
+
+        if (_probe_batch_pos == _probe_batch->num_rows()) {
+            // pass on resources, out_batch might still need them
+            _probe_batch->transfer_resource_ownership(out_batch);
+            _probe_batch_pos = 0;
+            if (_probe_eos) {
+                *probe_done = true;
+                return Status::OK;
+            }
+            if (out_batch->at_capacity()) {
+                return Status::OK;
+            }
+            RETURN_IF_CANCELLED(state);
+            RETURN_IF_ERROR(next_probe_batch(state));
+            continue;
+        }
+
+        TupleRow* row = _probe_batch->get_row(_probe_batch_pos++);
+        _matched_probe = false;
+        _hash_tbl_iterator = PartitionedHashTable::Iterator();
+        uint32_t hash = 0;
+        // A row with a NULL key matches nothing, whatever its partition.
+        if (_ht_ctx->eval_and_hash_probe(row, &hash)) {
+            Partition* partition = _hash_partitions.empty() ?
+                _input_partition : _hash_partitions[hash >> (32 - NUM_PARTITIONING_BITS)];
+            if (partition->is_spilled) {
+                // Joined later, with the spilled build rows of the partition.
+                RETURN_IF_ERROR(append_probe_row(partition->probe_rows.get(), row));
+                continue;
+            }
+            if (partition->hash_tbl.get() != NULL) {
+                _hash_tbl_iterator = partition->hash_tbl->find(_ht_ctx.get(), hash);
+                if (!_hash_tbl_iterator.at_end()) {
+                    partition->has_probe_hits = true;
+                }
+            }
+        } else if (_join_op == TJoinOp::NULL_AWARE_LEFT_ANTI_JOIN && _num_build_rows > 0) {
+            // NULL NOT IN a non-empty set is not true.
+            continue;
+        }
+        _current_probe_row = row;
+    }
+    return Status::OK;
+}
+
+bool PartitionedHashJoinNode::join_probe_row(RowBatch* out_batch) {
+    ExprContext* const* other_conjunct_ctxs = &_other_join_conjunct_ctxs[0];
+    int num_other_conjunct_ctxs = _other_join_conjunct_ctxs.size();
+    ExprContext* const* conjunct_ctxs = &_conjunct_ctxs[0];
+    int num_conjunct_ctxs = _conjunct_ctxs.size();
+
+    // create output rows as long as:
+    // 1) we haven't already created an output row for the probe row and are doing
+    //    a semi-join;
+    // 2) there are more matching build rows
+    while (!_hash_tbl_iterator.at_end()) {
+        if ((_join_op == TJoinOp::RIGHT_ANTI_JOIN || _join_op == TJoinOp::RIGHT_SEMI_JOIN)
+                && _hash_tbl_iterator.is_matched()) {
+            // We have already matched this build row, continue to next match.
+            _hash_tbl_iterator.next_duplicate();
+            continue;
+        }
+
+        int row_idx = out_batch->add_row();
+        TupleRow* out_row = out_batch->get_row(row_idx);
+        create_output_row(out_row, _current_probe_row, _hash_tbl_iterator.get_row());
+        if (!eval_conjuncts(other_conjunct_ctxs, num_other_conjunct_ctxs, out_row)) {
+            _hash_tbl_iterator.next_duplicate();
+            continue;
+        }
+
+        // we have a match for the purpose of the (outer?) join as soon as we
+        // satisfy the JOIN clause conjuncts
+        _matched_probe = true;
+        if (is_left_anti_join()) {
+            // left_anti_join: equal match won't return
+            _hash_tbl_iterator.set_at_end();
+            break;
+        }
+        if (_join_op == TJoinOp::RIGHT_ANTI_JOIN) {
+            // the build row is only returned if no probe row matches it
+            _hash_tbl_iterator.set_matched();
+            _hash_tbl_iterator.next_duplicate();
+            continue;
+        }
+        if (_match_all_build || _join_op == TJoinOp::RIGHT_SEMI_JOIN) {
+            // remember that we matched this build row
+            _hash_tbl_iterator.set_matched();
+        }
+        if (_match_one_build) {
+            _hash_tbl_iterator.set_at_end();
+        } else {
+            _hash_tbl_iterator.next_duplicate();
+        }
+
+        if (eval_conjuncts(conjunct_ctxs, num_conjunct_ctxs, out_row)) {
+            out_batch->commit_last_row();
+            VLOG_ROW << "match row: " << out_row->to_string(row_desc());
+            ++_num_rows_returned;
+            if (out_batch->at_capacity() || reached_limit()) {
+                return false;
+            }
+        }
+    }
+
+    // check whether we need to output the current probe row
+    if (!_matched_probe && needs_unmatched_probe_rows()) {
+        _matched_probe = true;
+        int row_idx = out_batch->add_row();
+        TupleRow* out_row = out_batch->get_row(row_idx);
+        create_output_row(out_row, _current_probe_row, NULL);
+        if (eval_conjuncts(conjunct_ctxs, num_conjunct_ctxs, out_row)) {
+            out_batch->commit_last_row();
+            VLOG_ROW << "match row: " << out_row->to_string(row_desc());
+            ++_num_rows_returned;
+            if (out_batch->at_capacity() || reached_limit()) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+Status PartitionedHashJoinNode::finish_partitions() {
+    DCHECK(_probe_eos);
+    _hash_tbl_iterator = PartitionedHashTable::Iterator();
+    if (_hash_partitions.empty()) {
+        // The build rows of the input partition were joined without repartitioning.
+        DCHECK(_input_partition != NULL && !_input_partition->is_spilled);
+        if (needs_unmatched_build_rows()) {
+            _output_build_partitions.push_back(_input_partition);
+        }
+    }
+    for (int i = 0; i < _hash_partitions.size(); ++i) {
+        Partition* partition = _hash_partitions[i];
+        if (partition->is_closed) {
+            continue;
+        }
+        if (partition->is_spilled) {
+            // We need to unpin all the spilled partitions to make room to allocate new
+            // _hash_partitions when we repartition the spilled partitions.
+            RETURN_IF_ERROR(partition->probe_rows->unpin_stream(true));
+            _spilled_partitions.push_front(partition);
+            continue;
+        }
+        if (needs_unmatched_build_rows()) {
+            _output_build_partitions.push_back(partition);
+        }
+        _done_partitions.push_back(partition);
+    }
+    _hash_partitions.clear();
+    if (_input_partition != NULL) {
+        _done_partitions.push_back(_input_partition);
+        _input_partition = NULL;
+    }
+    _phase = _output_build_partitions.empty() ? PARTITIONS_DONE : OUTPUTTING_UNMATCHED;
+    return Status::OK;
+}
+
+void PartitionedHashJoinNode::output_unmatched_build_rows(RowBatch* out_batch) {
+    ExprContext* const* conjunct_ctxs = &_conjunct_ctxs[0];
+    int num_conjunct_ctxs = _conjunct_ctxs.size();
+
+    while (!out_batch->at_capacity() && !reached_limit()) {
+        if (_hash_tbl_iterator.at_end()) {
+            if (_output_build_partitions.empty()) {
+                _phase = PARTITIONS_DONE;
+                return;
+            }
+            Partition* partition = _output_build_partitions.front();
+            _output_build_partitions.pop_front();
+            _hash_tbl_iterator = partition->hash_tbl->first_unmatched(_ht_ctx.get());
+            continue;
+        }
+
+        int row_idx = out_batch->add_row();
+        TupleRow* out_row = out_batch->get_row(row_idx);
+        create_output_row(out_row, NULL, _hash_tbl_iterator.get_row());
+        _hash_tbl_iterator.next_unmatched();
+        if (eval_conjuncts(conjunct_ctxs, num_conjunct_ctxs, out_row)) {
+            out_batch->commit_last_row();
+            VLOG_ROW << "match row: " << out_row->to_string(row_desc());
+            ++_num_rows_returned;
+        }
+    }
+}
+
+void PartitionedHashJoinNode::close_done_partitions() {
+    DCHECK(_output_build_partitions.empty());
+    for (int i = 0; i < _done_partitions.size(); ++i) {
+        _done_partitions[i]->close();
+    }
+    _done_partitions.clear();
+}
+
+void PartitionedHashJoinNode::close_partitions() {
+    for (int i = 0; i < _hash_partitions.size(); ++i) {
+        _hash_partitions[i]->close();
+    }
+    for (list<Partition*>::iterator it = _spilled_partitions.begin();
+            it != _spilled_partitions.end(); ++it) {
+        (*it)->close();
+    }
+    for (int i = 0; i < _done_partitions.size(); ++i) {
+        _done_partitions[i]->close();
+    }
+    if (_input_partition != NULL) {
+        _input_partition->close();
+    }
+    _hash_partitions.clear();
+    _spilled_partitions.clear();
+    _output_build_partitions.clear();
+    _done_partitions.clear();
+    _input_partition = NULL;
+    _partition_pool->clear();
+}
+
+void PartitionedHashJoinNode::create_output_row(
+        TupleRow* out, TupleRow* probe, TupleRow* build) {
+    uint8_t* out_ptr = reinterpret_cast<uint8_t*>(out);
+    if (probe == NULL) {
+        memset(out_ptr, 0, _probe_tuple_row_size);
+    } else {
+        memcpy(out_ptr, probe, _probe_tuple_row_size);
+    }
+
+    if (build == NULL) {
+        memset(out_ptr + _probe_tuple_row_size, 0, _build_tuple_row_size);
+    } else {
+        memcpy(out_ptr + _probe_tuple_row_size, build, _build_tuple_row_size);
+    }
+}
+
+void PartitionedHashJoinNode::debug_string(int indentation_level, stringstream* out) const {
+    *out << std::string(indentation_level * 2, ' ');
+    *out << "PartitionedHashJoinNode(join_op=" << _join_op
+         << " phase=" << _phase
+         << " hash_partitions=" << _hash_partitions.size()
+         << " spilled_partitions=" << _spilled_partitions.size();
+    ExecNode::debug_string(indentation_level, out);
+    *out << ")";
+}
+
+} // end namespace doris
@@ -0,0 +1,336 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_EXEC_PARTITIONED_HASH_JOIN_NODE_H
+#define DORIS_BE_SRC_EXEC_PARTITIONED_HASH_JOIN_NODE_H
+
+#include <list>
+#include <vector>
+#include <boost/scoped_ptr.hpp>
+
+#include "exec/exec_node.h"
+#include "exec/partitioned_hash_table.h"
+#include "runtime/buffered_block_mgr2.h"
+#include "runtime/buffered_tuple_stream2.h"
+
+#include "gen_cpp/PlanNodes_types.h"
+
+namespace doris {
+
+class RowBatch;
+class RuntimeState;
+class TupleRow;
+
+// Node for hash joins whose build side may not fit in memory.
+//  1. The build rows (child(1)) are hashed into _hash_partitions and appended to the
+//  build stream of their partition. When the streams run out of memory, the largest
+//  partition is spilled: its stream is unpinned and written to disk by the block mgr.
+//  2. When all the build rows are consumed, a hash table is built for each partition
+//  still in memory. A partition whose hash table does not fit is spilled too.
+//  3. The probe rows (child(0)) are hashed the same way. The rows of an in-memory
+//  partition probe its hash table, the rows of a spilled partition are appended to
+//  its probe stream. If a probe stream runs out of memory, an in-memory partition no
+//  probe row has hit yet is spilled too: nothing references its build rows, and its
+//  build rows are all unmatched so far.
+//  4. The spilled partitions are then joined one at a time. The hash table is built
+//  from the spilled build rows if they fit in memory, otherwise they are partitioned
+//  again with the hash of the next level, and the steps repeat with the spilled probe
+//  rows as probe input.
+//
+// A probe row is joined once, against the partition holding the build rows of the same
+// hash, so all the join ops of HashJoinNode are supported. The unmatched build rows of
+// right outer, full outer and right anti joins are returned after all the probe rows of
+// their partition were joined. A null-aware left anti join returns nothing if a build row
+// has a NULL key, and a probe row with a NULL key only if there is no build row; it
+// takes no other join conjuncts.
+//
+// Buffering: each partition needs one buffer to append its build rows, one more buffer
+// reads a spilled partition's probe rows and one its build rows while they are partitioned
+// again. The build streams start with small buffers, so that small joins do not take an
+// IO-sized buffer per partition. The probe streams only exist for spilled partitions and
+// use IO-sized buffers.
+//
+// The streams and hash tables are those of PartitionedAggregationNode: BufferedBlockMgr2,
+// BufferedTupleStream2 and PartitionedHashTable. The buffer pool based ones need the
+// reservation planned by the FE for the node, which only the aggregation plans carry.
+//
+// Predicates are not pushed down to the probe side and no runtime filter is built, the
+// plans expecting them use HashJoinNode, see ExecNode::create_node().
+//
+// TODO: Codegen and batch the probe.
+class PartitionedHashJoinNode : public ExecNode {
+public:
+    PartitionedHashJoinNode(ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs);
+    // a null dtor to pass codestyle check
+    virtual ~PartitionedHashJoinNode() {}
+
+    virtual Status init(const TPlanNode& tnode, RuntimeState* state = nullptr);
+    virtual Status prepare(RuntimeState* state);
+    virtual Status open(RuntimeState* state);
+    virtual Status get_next(RuntimeState* state, RowBatch* row_batch, bool* eos);
+    virtual Status close(RuntimeState* state);
+
+protected:
+    virtual void debug_string(int indentation_level, std::stringstream* out) const;
+
+private:
+    struct Partition;
+
+    // Number of partitions to create at each level. Must be a power of 2.
+    static const int PARTITION_FANOUT = 16;
+
+    // Needs to be the log(PARTITION_FANOUT).
+    // We use the upper bits to pick the partition and lower bits in the HT.
+    static const int NUM_PARTITIONING_BITS = 4;
+
+    // Maximum number of times we will repartition. The maximum build side we can process
+    // (if we have enough scratch disk space) in case there is no skew is:
+    //  MEM_LIMIT * (PARTITION_FANOUT ^ MAX_PARTITION_DEPTH).
+    // In the case where there is skew, repartitioning is unlikely to help (assuming a
+    // reasonable hash function).
+    // Note that we need to have at least as many SEED_PRIMES in PartitionedHashTableCtx.
+    static const int MAX_PARTITION_DEPTH = 16;
+
+    // What get_next() does next
+    enum JoinPhase {
+        // Joining the probe rows of the current partitions
+        PROBING,
+        // Returning the build rows of the current partitions no probe row matched
+        OUTPUTTING_UNMATCHED,
+        // The current partitions are done, the next spilled partition is joined once
+        // the rows returned are passed up
+        PARTITIONS_DONE
+    };
+
+    TJoinOp::type _join_op;
+
+    // derived from _join_op
+    bool _match_all_probe;  // output all rows coming from the probe input
+    bool _match_one_build;  // match at most one build row to each probe row
+    bool _match_all_build;  // output all rows coming from the build input
+
+    // our equi-join predicates "<lhs> = <rhs>" are separated into
+    // _build_exprs (over child(1)) and _probe_exprs (over child(0))
+    std::vector<ExprContext*> _probe_expr_ctxs;
+    std::vector<ExprContext*> _build_expr_ctxs;
+
+    // non-equi-join conjuncts from the JOIN clause
+    std::vector<ExprContext*> _other_join_conjunct_ctxs;
+
+    RuntimeState* _state;
+    BufferedBlockMgr2::Client* _block_mgr_client;
+
+    // Used for hash-related functionality, such as evaluating rows and calculating hashes.
+    boost::scoped_ptr<PartitionedHashTableCtx> _ht_ctx;
+
+    // Object pool that holds the Partition objects.
+    boost::scoped_ptr<ObjectPool> _partition_pool;
+
+    // Current partitions the build and probe rows are partitioned into. Empty when
+    // the build rows of _input_partition are joined without repartitioning.
+    std::vector<Partition*> _hash_partitions;
+
+    // Spilled partition whose rows are the input of the current partitions, NULL
+    // while the rows of the children are joined.
+    Partition* _input_partition;
+
+    // All partitions that have been spilled and need further processing.
+    std::list<Partition*> _spilled_partitions;
+
+    // Partitions whose unmatched build rows are still to be returned.
+    std::list<Partition*> _output_build_partitions;
+
+    // Partitions that are joined. Output rows may reference their build rows, so they
+    // are only closed once the batch returned is passed up.
+    std::vector<Partition*> _done_partitions;
+
+    JoinPhase _phase;
+
+    // Size of the TupleRow (just the Tuple ptrs) from the build (right) and probe (left)
+    // sides.
+    int _probe_tuple_row_size;
+    int _build_tuple_row_size;
+
+    // Probe rows, from child(0) or from the probe stream of _input_partition.
+    boost::scoped_ptr<RowBatch> _probe_batch;
+    int _probe_batch_pos;  // current scan pos in _probe_batch
+    bool _probe_eos;  // if true, the probe input has no more rows to process
+
+    // The probe row being joined, NULL if the next one is to be read
+    TupleRow* _current_probe_row;
+    // if true, we have matched the current probe row
+    bool _matched_probe;
+
+    // Number of build rows read from child(1), including those with NULL keys.
+    int64_t _num_build_rows;
+    // If true, a build row has a NULL key. A null-aware left anti join returns nothing.
+    bool _build_has_null_key;
+    // Next build row matching _current_probe_row, or the next unmatched build row
+    // while OUTPUTTING_UNMATCHED.
+    PartitionedHashTable::Iterator _hash_tbl_iterator;
+
+    RuntimeProfile::Counter* _build_timer;   // time to partition the build rows
+    RuntimeProfile::Counter* _build_hash_tables_timer;   // time to build the hash tables
+    RuntimeProfile::Counter* _probe_timer;   // time to probe
+    RuntimeProfile::Counter* _build_rows_counter;   // num build rows
+    RuntimeProfile::Counter* _probe_rows_counter;   // num probe rows
+    RuntimeProfile::Counter* _num_hash_buckets;   // num buckets of all the hash tables
+    RuntimeProfile::Counter* _partitions_created;
+    RuntimeProfile::Counter* _num_spilled_partitions;
+    RuntimeProfile::Counter* _num_repartitions;
+    RuntimeProfile::Counter* _num_row_repartitioned;
+
+    // The build rows of a partition and, once it is spilled, its probe rows.
+    struct Partition {
+        Partition(PartitionedHashJoinNode* parent, int level) :
+                parent(parent), is_closed(false), is_spilled(false), has_probe_hits(false),
+                level(level) {}
+
+        // Initializes build_rows, pinned and with small buffers.
+        Status init_build_stream();
+
+        // Initializes probe_rows, unpinned and with IO-sized buffers.
+        Status init_probe_stream();
+
+        // Builds the hash table from build_rows, which must be pinned. *built is false
+        // if there was not enough memory, the hash table is then closed.
+        Status build_hash_table(bool* built);
+
+        // Spills this partition: closes the hash table and unpins build_rows.
+        Status spill();
+
+        void close();
+
+        PartitionedHashJoinNode* parent;
+
+        // If true, this partition is closed and there is nothing left to do.
+        bool is_closed;
+
+        // If true, the build rows are on disk and the probe rows are appended to
+        // probe_rows, to be joined later.
+        bool is_spilled;
+
+        // If true, a probe row found build rows in hash_tbl. The output rows may
+        // reference them and they may be matched, so the partition cannot be spilled.
+        bool has_probe_hits;
+
+        // How many times rows in this partition have been repartitioned. Partitions created
+        // from the node's children's input is level 0, 1 after the first repartitionining,
+        // etc.
+        const int level;
+
+        // Hash table of build_rows. NULL until built, and once spilled.
+        boost::scoped_ptr<PartitionedHashTable> hash_tbl;
+
+        boost::scoped_ptr<BufferedTupleStream2> build_rows;
+
+        // Probe rows of a spilled partition. NULL until the partition spills.
+        boost::scoped_ptr<BufferedTupleStream2> probe_rows;
+    };
+
+    // Initializes _hash_partitions. 'level' is the level for the partitions to create.
+    // Also sets _ht_ctx's level to 'level'.
+    Status create_hash_partitions(int level);
+
+    // Reads all the rows from child(1) into _hash_partitions.
+    Status process_build_input(RuntimeState* state);
+
+    // Reads all the rows from input_stream into _hash_partitions, and closes it.
+    Status process_build_stream(BufferedTupleStream2* input_stream);
+
+    // Appends each row of build_batch to the build stream of its partition, spilling
+    // partitions as necessary.
+    Status process_build_batch(RowBatch* build_batch);
+
+    // Appends row to stream, switching to IO-sized buffers or spilling partitions if the
+    // stream is full.
+    Status append_build_row(BufferedTupleStream2* stream, TupleRow* row);
+
+    // Builds the hash tables of the partitions in _hash_partitions that are not spilled,
+    // spilling those that do not fit, and initializes the probe streams of the spilled
+    // ones.
+    Status build_hash_tables();
+
+    // Initializes the probe stream of each spilled partition in _hash_partitions. Other
+    // partitions are spilled if there is no buffer left for them.
+    Status init_probe_streams();
+
+    // Picks the partition of _hash_partitions that frees the most memory and spills it.
+    // The partitions a probe row has hit are not candidates.
+    Status spill_partition();
+
+    // Appends a probe row to the probe stream of a spilled partition, spilling more
+    // partitions if the stream gets no block.
+    Status append_probe_row(BufferedTupleStream2* stream, TupleRow* row);
+
+    // Removes the next partition from _spilled_partitions, and builds the hash table of
+    // its build rows or repartitions them. Its probe rows are the next probe input.
+    // The partition is just closed if joining it returns nothing.
+    Status prepare_next_partition();
+
+    // Reads the next batch of the probe input into _probe_batch.
+    Status next_probe_batch(RuntimeState* state);
+
+    // Joins the probe rows into out_batch until it is full, the limit is reached or
+    // the probe input is exhausted, *probe_done is then true.
+    Status process_probe(RuntimeState* state, RowBatch* out_batch, bool* probe_done);
+
+    // Joins _current_probe_row with the build rows from _hash_tbl_iterator. Returns
+    // false if out_batch is full or the limit is reached before the probe row is done.
+    bool join_probe_row(RowBatch* out_batch);
+
+    // Moves the spilled partitions of the current ones to _spilled_partitions and the
+    // others to _done_partitions, once all their probe rows are joined.
+    Status finish_partitions();
+
+    // Returns the build rows of _output_build_partitions no probe row matched.
+    void output_unmatched_build_rows(RowBatch* out_batch);
+
+    // Closes _done_partitions.
+    void close_done_partitions();
+
+    // Closes all the partitions.
+    void close_partitions();
+
+    // Write combined row, consisting of probe_row and build_row, to out_row.
+    void create_output_row(TupleRow* out_row, TupleRow* probe_row, TupleRow* build_row);
+
+    // True if the build rows no probe row matched are returned
+    bool needs_unmatched_build_rows() const {
+        return _match_all_build || _join_op == TJoinOp::RIGHT_ANTI_JOIN;
+    }
+
+    // True if the probe rows that match no build row are returned
+    bool needs_unmatched_probe_rows() const {
+        return _match_all_probe || is_left_anti_join();
+    }
+
+    bool is_left_anti_join() const {
+        return _join_op == TJoinOp::LEFT_ANTI_JOIN
+            || _join_op == TJoinOp::NULL_AWARE_LEFT_ANTI_JOIN;
+    }
+
+    // We need one buffer per partition for its build stream. We need two additional
+    // buffers to read the probe and build streams of the partition we are repartitioning.
+    int min_required_buffers() const {
+        return PARTITION_FANOUT + 2;
+    }
+};
+
+} // end namespace doris
+
+#endif // DORIS_BE_SRC_EXEC_PARTITIONED_HASH_JOIN_NODE_H
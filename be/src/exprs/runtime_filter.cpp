@@ -0,0 +1,322 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exprs/runtime_filter.h"
+
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+
+#include "common/logging.h"
+#include "gen_cpp/internal_service.pb.h"
+#include "olap/bloom_filter_predicate.h"
+#include "runtime/datetime_value.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/raw_value.h"
+#include "runtime/string_value.hpp"
+
+namespace doris {
+
+// Types whose keys also get a bloom filter
+static bool has_bloom_filter(PrimitiveType type) {
+    switch (type) {
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_LARGEINT:
+    case TYPE_CHAR:
+    case TYPE_VARCHAR:
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+        return true;
+    default:
+        return false;
+    }
+}
+
+RuntimeFilter::RuntimeFilter(
+        const TypeDescriptor& type, int64_t max_bloom_filter_values, double fpp,
+        MemTracker* mem_tracker) :
+            _type(type),
+            _max_bloom_filter_values(max_bloom_filter_values),
+            _fpp(fpp),
+            _num_values(0),
+            _min_slot(value_slot(&_min, type.type)),
+            _max_slot(value_slot(&_max, type.type)),
+            _use_bloom_filter(has_bloom_filter(type.type) && max_bloom_filter_values > 0),
+            _mem_tracker(mem_tracker),
+            _tracked_bytes(0) {
+    DCHECK(is_supported(type.type));
+}
+
+RuntimeFilter::~RuntimeFilter() {
+    if (_mem_tracker != NULL) {
+        _mem_tracker->release(_tracked_bytes);
+    }
+}
+
+void RuntimeFilter::update_tracked_bytes() {
+    int64_t bytes = _hashes.capacity() * sizeof(uint64_t);
+    if (_mem_tracker != NULL && bytes != _tracked_bytes) {
+        _mem_tracker->consume(bytes - _tracked_bytes);
+    }
+    _tracked_bytes = bytes;
+}
+
+bool RuntimeFilter::is_supported(PrimitiveType type) {
+    return has_bloom_filter(type) || type == TYPE_DECIMAL;
+}
+
+void* RuntimeFilter::value_slot(ExprValue* value, PrimitiveType type) {
+    switch (type) {
+    case TYPE_TINYINT:
+        return &value->tinyint_val;
+    case TYPE_SMALLINT:
+        return &value->smallint_val;
+    case TYPE_INT:
+        return &value->int_val;
+    case TYPE_BIGINT:
+        return &value->bigint_val;
+    case TYPE_LARGEINT:
+        return &value->large_int_val;
+    case TYPE_CHAR:
+    case TYPE_VARCHAR:
+        return &value->string_val;
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+        return &value->datetime_val;
+    case TYPE_DECIMAL:
+        return &value->decimal_val;
+    default:
+        return NULL;
+    }
+}
+
+void RuntimeFilter::set_value(const void* value, void* slot, ExprValue* expr_value) {
+    if (_type.is_string_type()) {
+        // the string is copied, the build side rows may go before the filter
+        expr_value->set_string_val(*reinterpret_cast<const StringValue*>(value));
+    } else {
+        RawValue::write(value, slot, _type, NULL);
+    }
+}
+
+void RuntimeFilter::value_to_bytes(const void* slot, std::string* bytes) const {
+    if (_type.is_string_type()) {
+        const StringValue* value = reinterpret_cast<const StringValue*>(slot);
+        bytes->assign(value->ptr, value->len);
+    } else {
+        bytes->assign(reinterpret_cast<const char*>(slot), _type.get_slot_size());
+    }
+}
+
+Status RuntimeFilter::value_from_bytes(
+        const std::string& bytes, void* slot, ExprValue* expr_value) {
+    if (_type.is_string_type()) {
+        StringValue value(const_cast<char*>(bytes.data()), bytes.size());
+        set_value(&value, slot, expr_value);
+    } else if (bytes.size() == _type.get_slot_size()) {
+        set_value(bytes.data(), slot, expr_value);
+    } else {
+        std::stringstream ss;
+        ss << "invalid value of runtime filter, type=" << _type << ", size=" << bytes.size();
+        return Status(ss.str());
+    }
+    return Status::OK;
+}
+
+Status RuntimeFilter::create_from_protobuf(
+        const PRuntimeFilter& pfilter, std::shared_ptr<RuntimeFilter>* filter) {
+    TypeDescriptor type = TypeDescriptor::from_protobuf(pfilter.type());
+    if (!is_supported(type.type)) {
+        std::stringstream ss;
+        ss << "runtime filter of unsupported type " << type;
+        return Status(ss.str());
+    }
+    // no key is inserted into a filter received
+    std::shared_ptr<RuntimeFilter> result(new RuntimeFilter(type, 0, 0));
+    if (pfilter.num_values() > 0) {
+        RETURN_IF_ERROR(result->value_from_bytes(
+                pfilter.min_value(), result->_min_slot, &result->_min));
+        RETURN_IF_ERROR(result->value_from_bytes(
+                pfilter.max_value(), result->_max_slot, &result->_max));
+        result->_num_values = pfilter.num_values();
+    }
+    if (pfilter.has_bloom_filter()) {
+        const std::string& bits = pfilter.bloom_filter();
+        if (bits.empty() || bits.size() % (SPLIT_BLOCK_BITS / 8) != 0) {
+            std::stringstream ss;
+            ss << "invalid bloom filter of runtime filter, size=" << bits.size();
+            return Status(ss.str());
+        }
+        uint32_t len = bits.size() / sizeof(uint64_t);
+        uint64_t* data = new uint64_t[len];
+        memcpy(data, bits.data(), bits.size());
+        result->_bloom_filter.reset(new BloomFilter());
+        // the bloom filter takes the ownership of data
+        result->_bloom_filter->init(data, len, SPLIT_BLOCK_WORDS, true);
+    }
+    *filter = result;
+    return Status::OK;
+}
+
+void RuntimeFilter::to_protobuf(PRuntimeFilter* pfilter) const {
+    _type.to_protobuf(pfilter->mutable_type());
+    pfilter->set_num_values(_num_values);
+    if (!empty()) {
+        value_to_bytes(_min_slot, pfilter->mutable_min_value());
+        value_to_bytes(_max_slot, pfilter->mutable_max_value());
+    }
+    if (_bloom_filter != nullptr) {
+        DCHECK(_bloom_filter->split_block());
+        pfilter->set_bloom_filter(reinterpret_cast<const char*>(_bloom_filter->bit_set_data()),
+                                  _bloom_filter->bit_set_data_len() * sizeof(uint64_t));
+    }
+}
+
+uint64_t RuntimeFilter::hash(const void* value, PrimitiveType type) {
+    switch (type) {
+    case TYPE_TINYINT:
+        return runtime_filter_hash(*reinterpret_cast<const int8_t*>(value));
+    case TYPE_SMALLINT:
+        return runtime_filter_hash(*reinterpret_cast<const int16_t*>(value));
+    case TYPE_INT:
+        return runtime_filter_hash(*reinterpret_cast<const int32_t*>(value));
+    case TYPE_BIGINT:
+        return runtime_filter_hash(*reinterpret_cast<const int64_t*>(value));
+    case TYPE_LARGEINT:
+        return runtime_filter_hash(*reinterpret_cast<const __int128*>(value));
+    case TYPE_CHAR:
+    case TYPE_VARCHAR:
+        return runtime_filter_hash(*reinterpret_cast<const StringValue*>(value));
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+        // DateTimeValue has unused bytes, hash the packed value
+        return runtime_filter_hash(reinterpret_cast<const DateTimeValue*>(value)->to_int64());
+    default:
+        DCHECK(false) << "no bloom filter for type " << type;
+        return 0;
+    }
+}
+
+void RuntimeFilter::insert(const void* value) {
+    if (value == NULL) {
+        return;
+    }
+    if (_num_values == 0) {
+        set_value(value, _min_slot, &_min);
+        set_value(value, _max_slot, &_max);
+    } else if (RawValue::lt(value, _min_slot, _type)) {
+        set_value(value, _min_slot, &_min);
+    } else if (RawValue::lt(_max_slot, value, _type)) {
+        set_value(value, _max_slot, &_max);
+    }
+    ++_num_values;
+
+    if (_bloom_filter != nullptr) {
+        _bloom_filter->add_hash(hash(value, _type.type));
+    } else if (_use_bloom_filter) {
+        if (_hashes.size() < _max_bloom_filter_values) {
+            _hashes.push_back(hash(value, _type.type));
+        } else {
+            _use_bloom_filter = false;
+            std::vector<uint64_t>().swap(_hashes);
+        }
+        update_tracked_bytes();
+    }
+}
+
+bool RuntimeFilter::init_bloom_filter(int64_t expected_values) {
+    DCHECK(empty());
+    if (!has_bloom_filter(_type.type)) {
+        return false;
+    }
+    std::shared_ptr<BloomFilter> bloom_filter(new BloomFilter());
+    if (!bloom_filter->init(std::max<int64_t>(expected_values, 1), _fpp, true)) {
+        LOG(WARNING) << "fail to init bloom filter of runtime filter. [values="
+                     << expected_values << "]";
+        _use_bloom_filter = false;
+        return false;
+    }
+    _bloom_filter = bloom_filter;
+    return true;
+}
+
+void RuntimeFilter::finish() {
+    if (!_use_bloom_filter || _hashes.empty() || _bloom_filter != nullptr) {
+        return;
+    }
+    // duplicated keys make the filter larger than needed, which is only
+    // cheaper to test
+    std::shared_ptr<BloomFilter> bloom_filter(new BloomFilter());
+    if (bloom_filter->init(_hashes.size(), _fpp, true)) {
+        for (uint64_t hash : _hashes) {
+            bloom_filter->add_hash(hash);
+        }
+        _bloom_filter = bloom_filter;
+    } else {
+        LOG(WARNING) << "fail to init bloom filter of runtime filter. [values="
+                     << _hashes.size() << "]";
+    }
+    std::vector<uint64_t>().swap(_hashes);
+    update_tracked_bytes();
+}
+
+void RuntimeFilter::merge(const RuntimeFilter& other) {
+    DCHECK_EQ(_type.type, other._type.type);
+    if (!other.empty()) {
+        if (empty() || RawValue::lt(other._min_slot, _min_slot, _type)) {
+            set_value(other._min_slot, _min_slot, &_min);
+        }
+        if (empty() || RawValue::lt(_max_slot, other._max_slot, _type)) {
+            set_value(other._max_slot, _max_slot, &_max);
+        }
+        _num_values += other._num_values;
+    }
+    if (_bloom_filter != nullptr
+            && (other._bloom_filter == nullptr || !_bloom_filter->merge(*other._bloom_filter))) {
+        LOG(WARNING) << "drop bloom filter of runtime filter, the filters merged differ";
+        _bloom_filter.reset();
+    }
+    _use_bloom_filter = _bloom_filter != nullptr;
+}
+
+bool RuntimeFilter::find(const void* value) const {
+    if (empty()) {
+        return false;
+    }
+    if (RawValue::lt(value, _min_slot, _type) || RawValue::lt(_max_slot, value, _type)) {
+        return false;
+    }
+    return _bloom_filter == nullptr || _bloom_filter->test_hash(hash(value, _type.type));
+}
+
+std::string RuntimeFilter::debug_string() const {
+    std::stringstream out;
+    out << "RuntimeFilter(type=" << _type << " values=" << _num_values;
+    if (!empty()) {
+        out << " min=";
+        RawValue::print_value(_min_slot, _type, -1, &out);
+        out << " max=";
+        RawValue::print_value(_max_slot, _type, -1, &out);
+    }
+    out << " bloom_filter=" << (_bloom_filter == nullptr ? 0 : _bloom_filter->bit_num()) << ")";
+    return out.str();
+}
+
+}
@@ -0,0 +1,155 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_QUERY_EXPRS_RUNTIME_FILTER_H
+#define DORIS_BE_SRC_QUERY_EXPRS_RUNTIME_FILTER_H
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/status.h"
+#include "exprs/expr_value.h"
+#include "gutil/macros.h"
+#include "olap/bloom_filter.hpp"
+#include "runtime/types.h"
+
+namespace doris {
+
+class MemTracker;
+class PRuntimeFilter;
+
+// Runtime filter of the keys of one equi-join conjunct of a hash join: the
+// [min, max] range of the build side keys and a bloom filter of them. A probe
+// row whose key is out of the range or missed by the bloom filter has no
+// match, so the scan of the probe side can skip it, and prune the blocks of
+// the storage whose zone map is out of the range.
+//
+// Keys are inserted while the build side is read, before their number is
+// known, so their hashes are buffered until finish() sizes and fills the
+// bloom filter. Types without bloom filter, and build sides with more than
+// max_bloom_filter_values keys, only get the range.
+//
+// The filters of the instances of a join in several fragments are merged,
+// see RuntimeFilterMgr. Their bloom filters are sized before the build by
+// init_bloom_filter(), as only filters of the same size can be merged.
+//
+// The buffered hashes are charged to mem_tracker, if not NULL, until finish()
+// or the destruction of the filter, which the tracker must outlive.
+class RuntimeFilter {
+public:
+    RuntimeFilter(const TypeDescriptor& type, int64_t max_bloom_filter_values, double fpp,
+                  MemTracker* mem_tracker = NULL);
+
+    ~RuntimeFilter();
+
+    // Types a runtime filter can be built for
+    static bool is_supported(PrimitiveType type);
+
+    // Create a filter sent by another backend
+    static Status create_from_protobuf(
+            const PRuntimeFilter& pfilter, std::shared_ptr<RuntimeFilter>* filter);
+
+    // Allocate the bloom filter for expected_values keys before any insert,
+    // keys are then added to it whatever their number. Return false if the
+    // type has no bloom filter or the allocation fails.
+    bool init_bloom_filter(int64_t expected_values);
+
+    // Add a key of the build side, a NULL key matches nothing and is skipped
+    void insert(const void* value);
+
+    // Build the bloom filter, no key may be inserted after
+    void finish();
+
+    // Add the keys of a finished filter of the same type. The bloom filter is
+    // dropped unless both have one of the same size.
+    void merge(const RuntimeFilter& other);
+
+    void to_protobuf(PRuntimeFilter* pfilter) const;
+
+    // Return false if no key of the build side can be equal to value
+    bool find(const void* value) const;
+
+    const TypeDescriptor& type() const {
+        return _type;
+    }
+
+    // Return true if no key was inserted, no probe row matches then
+    bool empty() const {
+        return _num_values == 0;
+    }
+
+    // Bounds of the inserted keys, NULL if empty
+    const void* min_value() const {
+        return empty() ? NULL : _min_slot;
+    }
+
+    const void* max_value() const {
+        return empty() ? NULL : _max_slot;
+    }
+
+    // NULL if there is no bloom filter, or before finish() unless the bloom
+    // filter was initialized
+    std::shared_ptr<const BloomFilter> bloom_filter() const {
+        return _bloom_filter;
+    }
+
+    // Hash of value in the bloom filter
+    static uint64_t hash(const void* value, PrimitiveType type);
+
+    std::string debug_string() const;
+
+private:
+    static void* value_slot(ExprValue* value, PrimitiveType type);
+
+    void set_value(const void* value, void* slot, ExprValue* expr_value);
+
+    void value_to_bytes(const void* slot, std::string* bytes) const;
+
+    Status value_from_bytes(const std::string& bytes, void* slot, ExprValue* expr_value);
+
+    // Charge the change of the capacity of _hashes to _mem_tracker
+    void update_tracked_bytes();
+
+    const TypeDescriptor _type;
+    const int64_t _max_bloom_filter_values;
+    const double _fpp;
+
+    int64_t _num_values;
+    ExprValue _min;
+    ExprValue _max;
+    void* _min_slot;
+    void* _max_slot;
+
+    // false once the keys are too many, or for types without bloom filter
+    bool _use_bloom_filter;
+    // hashes of the keys inserted until finish(), unless the bloom filter
+    // was initialized
+    std::vector<uint64_t> _hashes;
+    std::shared_ptr<BloomFilter> _bloom_filter;
+
+    MemTracker* _mem_tracker;
+    // bytes consumed from _mem_tracker
+    int64_t _tracked_bytes;
+
+    DISALLOW_COPY_AND_ASSIGN(RuntimeFilter);
+};
+
+}
+
+#endif
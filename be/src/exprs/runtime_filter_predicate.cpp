@@ -0,0 +1,51 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exprs/runtime_filter_predicate.h"
+
+#include <sstream>
+
+#include "codegen/llvm_codegen.h"
+#include "exprs/expr_context.h"
+
+namespace doris {
+
+RuntimeFilterPredicate::RuntimeFilterPredicate(
+        const TExprNode& node, const std::shared_ptr<RuntimeFilter>& filter) :
+            Predicate(node),
+            _runtime_filter(filter) {
+}
+
+RuntimeFilterPredicate::~RuntimeFilterPredicate() {
+}
+
+std::string RuntimeFilterPredicate::debug_string() const {
+    std::stringstream out;
+    out << "RuntimeFilterPredicate(" << get_child(0)->debug_string() << " "
+        << _runtime_filter->debug_string() << ")";
+    return out.str();
+}
+
+BooleanVal RuntimeFilterPredicate::get_boolean_val(ExprContext* ctx, TupleRow* row) {
+    void* lhs_slot = ctx->get_value(_children[0], row);
+    if (lhs_slot == NULL) {
+        return BooleanVal::null();
+    }
+    return BooleanVal(_runtime_filter->find(lhs_slot));
+}
+
+}
@@ -0,0 +1,65 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_QUERY_EXPRS_RUNTIME_FILTER_PREDICATE_H
+#define DORIS_BE_SRC_QUERY_EXPRS_RUNTIME_FILTER_PREDICATE_H
+
+#include <memory>
+#include <string>
+
+#include "exprs/predicate.h"
+#include "exprs/runtime_filter.h"
+
+namespace doris {
+
+// Predicate `child IN runtime_filter`, pushed down by HashJoinNode to the
+// probe side when the build side is too large for an InPredicate. Only
+// created by the BE, its node type is RUNTIME_FILTER_PRED.
+class RuntimeFilterPredicate : public Predicate {
+public:
+    virtual ~RuntimeFilterPredicate();
+    virtual Expr* clone(ObjectPool* pool) const override {
+        return pool->add(new RuntimeFilterPredicate(*this));
+    }
+
+    virtual BooleanVal get_boolean_val(ExprContext* context, TupleRow* row);
+
+    virtual Status get_codegend_compute_fn(RuntimeState* state, llvm::Function** fn) override {
+        return get_codegend_compute_fn_wrapper(state, fn);
+    }
+
+    const std::shared_ptr<RuntimeFilter>& runtime_filter() const {
+        return _runtime_filter;
+    }
+
+protected:
+    friend class Expr;
+    friend class HashJoinNode;
+    friend class OlapScanNode;
+
+    RuntimeFilterPredicate(const TExprNode& node, const std::shared_ptr<RuntimeFilter>& filter);
+
+    virtual std::string debug_string() const;
+
+private:
+    // shared by the clones
+    std::shared_ptr<RuntimeFilter> _runtime_filter;
+};
+
+}
+
+#endif
@@ -0,0 +1,78 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/bloom_filter_predicate.h"
+#include "olap/field.h"
+#include "olap/predicate_kernel.h"
+#include "runtime/string_value.hpp"
+#include "runtime/vectorized_row_batch.h"
+
+namespace doris {
+
+namespace predicate_kernel {
+
+// Matcher for `column IN bloom_filter`. Bloom filter tests do not vectorize,
+// word() only saves the branches of the row-at-a-time path.
+template <class T>
+class BloomFilterMatcher {
+public:
+    static const bool NULL_SAFE = NullSlotReadable<T>::value;
+
+    BloomFilterMatcher(const T* data, const BloomFilter& filter) : _data(data), _filter(filter) {}
+
+    uint64_t word(uint16_t base) const {
+        const T* data = _data + base;
+        uint64_t word = 0;
+        for (int i = 0; i < ROWS_PER_WORD; ++i) {
+            word |= static_cast<uint64_t>(_filter.test_hash(runtime_filter_hash(data[i]))) << i;
+        }
+        return word;
+    }
+
+    bool row(uint16_t i) const {
+        return _filter.test_hash(runtime_filter_hash(_data[i]));
+    }
+
+private:
+    const T* _data;
+    const BloomFilter& _filter;
+};
+
+} // namespace predicate_kernel
+
+template<class type>
+BloomFilterColumnPredicate<type>::BloomFilterColumnPredicate(
+        int32_t column_id, std::shared_ptr<const BloomFilter> filter)
+    : ColumnPredicate(column_id), _filter(std::move(filter)) {}
+
+template<class type>
+void BloomFilterColumnPredicate<type>::evaluate(VectorizedRowBatch* batch) const {
+    ColumnVector* column = batch->column(_column_id);
+    const type* col_vector = reinterpret_cast<const type*>(column->col_data());
+    const bool* is_null = column->no_nulls() ? nullptr : column->is_null();
+    predicate_kernel::BloomFilterMatcher<type> matcher(col_vector, *_filter);
+    predicate_kernel::evaluate_batch(matcher, is_null, batch);
+}
+
+template class BloomFilterColumnPredicate<int8_t>;
+template class BloomFilterColumnPredicate<int16_t>;
+template class BloomFilterColumnPredicate<int32_t>;
+template class BloomFilterColumnPredicate<int64_t>;
+template class BloomFilterColumnPredicate<int128_t>;
+template class BloomFilterColumnPredicate<StringValue>;
+
+} //namespace doris
@@ -0,0 +1,71 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_BLOOM_FILTER_PREDICATE_H
+#define DORIS_BE_SRC_OLAP_BLOOM_FILTER_PREDICATE_H
+
+#include <stdint.h>
+#include <memory>
+
+#include "olap/bloom_filter.hpp"
+#include "olap/column_predicate.h"
+#include "runtime/string_value.h"
+#include "util/hash_util.hpp"
+
+namespace doris {
+
+class VectorizedRowBatch;
+class WrapperField;
+
+// Hash of a value in the bloom filter of a hash join runtime filter. Integers
+// and strings have the same representation in the storage and in the query
+// execution, so the storage can test values the execution added.
+template <class T>
+inline uint64_t runtime_filter_hash(const T& value) {
+    return HashUtil::hash64(&value, sizeof(T), DEFAULT_SEED);
+}
+
+// Only the content, the pointer of an empty string may be anything
+template <>
+inline uint64_t runtime_filter_hash<StringValue>(const StringValue& value) {
+    return HashUtil::hash64(value.ptr, value.len, DEFAULT_SEED);
+}
+
+// Predicate `column IN bloom_filter`, which passes the rows whose value may
+// be in the filter. Used for the runtime filters of hash joins, whose bloom
+// filter is shared with the query execution.
+template <class type>
+class BloomFilterColumnPredicate : public ColumnPredicate {
+public:
+    BloomFilterColumnPredicate(int32_t column_id, std::shared_ptr<const BloomFilter> filter);
+    virtual ~BloomFilterColumnPredicate() {}
+
+    virtual void evaluate(VectorizedRowBatch* batch) const override;
+
+    // a bloom filter tells nothing about a range
+    virtual bool evaluate(
+            const std::pair<WrapperField*, WrapperField*>& statistic) const override {
+        return true;
+    }
+
+private:
+    std::shared_ptr<const BloomFilter> _filter;
+};
+
+} //namespace doris
+
+#endif //DORIS_BE_SRC_OLAP_BLOOM_FILTER_PREDICATE_H
@@ -32,7 +32,8 @@ OLAPStatus BloomFilterIndexReader::init(
         size_t buffer_size,
         bool is_using_cache,
         uint32_t hash_function_num,
-        uint32_t bit_num) {
+        uint32_t bit_num,
+        bool split_block) {
     OLAPStatus res = OLAP_SUCCESS;
 
     _buffer = buffer;
@@ -43,6 +44,7 @@ OLAPStatus BloomFilterIndexReader::init(
     _step_size = bit_num >> 3;
     _entry_count = header->block_count;
     _hash_function_num = hash_function_num;
+    _split_block = split_block;
     _start_offset = sizeof(BloomFilterIndexHeader);
     if (_step_size * _entry_count + _start_offset > _buffer_size) {
         OLAP_LOG_WARNING("invalid param found. "
@@ -56,7 +58,7 @@ OLAPStatus BloomFilterIndexReader::init(
 
 const BloomFilter& BloomFilterIndexReader::entry(uint64_t entry_id) {
     _entry.init((uint64_t*)(_buffer + _start_offset + _step_size * entry_id),
-            _step_size / sizeof(uint64_t), _hash_function_num);
+            _step_size / sizeof(uint64_t), _hash_function_num, _split_block);
     return _entry;
 }
 
@@ -34,13 +34,15 @@ public:
     BloomFilterIndexReader() {}
     ~BloomFilterIndexReader();
 
-    // Init BloomFilterIndexReader with given bloom filter index buffer
+    // Init BloomFilterIndexReader with given bloom filter index buffer,
+    // split_block tells the layout of its entries
     OLAPStatus init(
             char* buffer,
             size_t buffer_size,
             bool is_using_cache,
             uint32_t hash_function_num,
-            uint32_t bit_num);
+            uint32_t bit_num,
+            bool split_block = false);
 
     // Get specified bloom filter entry
     const BloomFilter& entry(uint64_t entry_id);
@@ -61,6 +63,7 @@ private:
     // Bloom filter param
     uint32_t _bit_num;
     uint32_t _hash_function_num;
+    bool _split_block;
 
     // BloomFilterIndexReader will not release bloom filter index buffer in destructor
     // when it is cached in memory
@@ -86,6 +86,29 @@ OLAPStatus ColumnData::get_next_block(RowBlock** row_block) {
     return OLAP_SUCCESS;
 }
 
+OLAPStatus ColumnData::get_next_vector_batch(VectorizedRowBatch** batch) {
+    SCOPED_RAW_TIMER(&_stats->block_fetch_ns);
+    if (_vector_batch_pending) {
+        _vector_batch_pending = false;
+        if (_read_block->has_remaining()) {
+            // rows of _read_block are the selected rows of the batch, in order
+            _current_vector_batch->skip_rows(_read_block->pos());
+            *batch = _current_vector_batch;
+            return OLAP_SUCCESS;
+        }
+    }
+    _is_normal_read = true;
+    auto res = _get_vector_batch(batch, false, 0);
+    if (res != OLAP_SUCCESS) {
+        if (res != OLAP_ERR_DATA_EOF) {
+            LOG(WARNING) << "Get next vector batch failed.";
+        }
+        *batch = nullptr;
+        return res;
+    }
+    return OLAP_SUCCESS;
+}
+
 OLAPStatus ColumnData::_next_row(const RowCursor** row, bool without_filter) {
     _read_block->pos_inc();
     do {
@@ -130,8 +153,12 @@ OLAPStatus ColumnData::_seek_to_block(const RowBlockPosition& block_pos, bool wi
     // TODO(zc): _segment_readers???
     // open segment reader if needed
     if (_segment_reader == nullptr || block_pos.segment != _current_segment) {
+        // an end at the first row of a segment, as a block split ending where
+        // the next one starts, ends the read before that segment is opened
         if (block_pos.segment >= _segment_group->num_segments() ||
-            (_end_key_is_set && block_pos.segment > _end_segment)) {
+            (_end_key_is_set && block_pos.segment > _end_segment) ||
+            (_end_key_is_set && block_pos.segment == _end_segment
+                && _end_block == 0 && _end_row_index == 0)) {
             _eof = true;
             return OLAP_ERR_DATA_EOF;
         }
@@ -167,6 +194,47 @@ OLAPStatus ColumnData::_seek_to_block(const RowBlockPosition& block_pos, bool wi
         block_pos.data_offset, end_block, without_filter, &_next_block, &_segment_eof);
 }
 
+OLAPStatus ColumnData::_find_block_split(RowBlockPosition* position) {
+    uint64_t num_blocks = _segment_group->num_index_entries();
+    uint64_t begin = num_blocks * _block_split / _num_block_splits;
+    uint64_t end = num_blocks * (_block_split + 1) / _num_block_splits;
+    if (begin == end) {
+        return OLAP_ERR_DATA_EOF;
+    }
+
+    RowBlockPosition first_position;
+    auto res = _segment_group->find_first_row_block(&first_position);
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to find first row block, res=" << res;
+        return res;
+    }
+    *position = first_position;
+    if (begin > 0) {
+        res = _segment_group->advance_row_block(begin, position);
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to advance to block " << begin << " of split "
+                << _block_split << "/" << _num_block_splits << ", res=" << res;
+            return res;
+        }
+    }
+    // the split ends before the first block of the next one, which is
+    // stopped at like an end key at its first row
+    if (end < num_blocks) {
+        RowBlockPosition end_position = first_position;
+        res = _segment_group->advance_row_block(end, &end_position);
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to advance to block " << end << " of split "
+                << _block_split << "/" << _num_block_splits << ", res=" << res;
+            return res;
+        }
+        _end_segment = end_position.segment;
+        _end_block = end_position.data_offset;
+        _end_row_index = 0;
+        _end_key_is_set = true;
+    }
+    return OLAP_SUCCESS;
+}
+
 OLAPStatus ColumnData::_find_position_by_short_key(
         const RowCursor& key, bool find_last_key, RowBlockPosition *position) {
     RowBlockPosition tmp_pos;
@@ -361,6 +429,7 @@ OLAPStatus ColumnData::prepare_block_read(
     set_eof(false);
     _end_key_is_set = false;
     _is_normal_read = false;
+    _vector_batch_pending = false;
     // set end position
     if (end_key != nullptr) {
         auto res = _seek_to_row(*end_key, find_end_key, true);
@@ -397,6 +466,16 @@ OLAPStatus ColumnData::prepare_block_read(
         RowBlockPosition pos;
         pos.segment = 0u;
         pos.data_offset = 0u;
+        if (_num_block_splits > 1) {
+            auto res = _find_block_split(&pos);
+            if (res == OLAP_ERR_DATA_EOF) {
+                _eof = true;
+                *first_block = nullptr;
+                return res;
+            } else if (res != OLAP_SUCCESS) {
+                return res;
+            }
+        }
         auto res = _seek_to_block(pos, false);
         if (res != OLAP_SUCCESS) {
             LOG(WARNING) << "failed to seek to block in, res=" << res
@@ -411,6 +490,7 @@ OLAPStatus ColumnData::prepare_block_read(
         }
         *first_block = _read_block.get();
     }
+    _vector_batch_pending = true;
     return OLAP_SUCCESS;
 }
 
@@ -549,7 +629,19 @@ bool ColumnData::delta_pruning_filter() {
         return false;
     }
 
-    return _conditions->delta_pruning_filter(_segment_group->get_column_statistics());
+    const std::vector<std::pair<WrapperField*, WrapperField*>>& column_statistics =
+        _segment_group->get_column_statistics();
+    if (_col_predicates != nullptr) {
+        // segment group statistics are only kept for key columns
+        for (const ColumnPredicate* pred : *_col_predicates) {
+            if (pred->column_id() < column_statistics.size()
+                    && !pred->evaluate(column_statistics[pred->column_id()])) {
+                return true;
+            }
+        }
+    }
+
+    return _conditions->delta_pruning_filter(column_statistics);
 }
 
 int ColumnData::delete_pruning_filter() {
@@ -670,7 +762,10 @@ OLAPStatus ColumnData::_get_block_from_reader(
 
         if (!_segment_eof) {
             _current_block = _next_block;
-            auto res = _segment_reader->get_block(vec_batch, &_next_block, &_segment_eof);
+            // predicates are evaluated by the segment reader, which then
+            // decodes the other columns only for the rows that pass
+            auto res = _segment_reader->get_block(vec_batch, &_next_block, &_segment_eof,
+                                                  !without_filter && _need_eval_predicates);
             if (res != OLAP_SUCCESS) {
                 return res;
             }
@@ -692,33 +787,36 @@ OLAPStatus ColumnData::_get_block_from_reader(
     return OLAP_SUCCESS;
 }
 
-OLAPStatus ColumnData::_get_block(bool without_filter, int rows_read) {
+OLAPStatus ColumnData::_get_vector_batch(
+        VectorizedRowBatch** got_batch, bool without_filter, int rows_read) {
     do {
         VectorizedRowBatch* vec_batch = nullptr;
         auto res = _get_block_from_reader(&vec_batch, without_filter, rows_read);
         if (res != OLAP_SUCCESS) {
             return res;
         }
-        // evaluate predicates
-        if (!without_filter && _need_eval_predicates) {
-            SCOPED_RAW_TIMER(&_stats->vec_cond_ns);
-            size_t old_size = vec_batch->size();
-            for (auto pred : *_col_predicates) {
-                pred->evaluate(vec_batch);
-            }
-            _stats->rows_vec_cond_filtered += old_size - vec_batch->size();
-        }
         // if vector is empty after predicate evaluate, get next block
         if (vec_batch->size() == 0) {
             continue;
         }
-        SCOPED_RAW_TIMER(&_stats->block_convert_ns);
-        // when reach here, we have already read a block successfully
-        _read_block->clear();
-        vec_batch->dump_to_row_block(_read_block.get());
+        *got_batch = vec_batch;
         return OLAP_SUCCESS;
     } while (true);
     return OLAP_SUCCESS;
 }
 
+OLAPStatus ColumnData::_get_block(bool without_filter, int rows_read) {
+    VectorizedRowBatch* vec_batch = nullptr;
+    auto res = _get_vector_batch(&vec_batch, without_filter, rows_read);
+    if (res != OLAP_SUCCESS) {
+        return res;
+    }
+    SCOPED_RAW_TIMER(&_stats->block_convert_ns);
+    // when reach here, we have already read a block successfully
+    _read_block->clear();
+    vec_batch->dump_to_row_block(_read_block.get());
+    _current_vector_batch = vec_batch;
+    return OLAP_SUCCESS;
+}
+
 }  // namespace doris
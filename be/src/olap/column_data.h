@@ -73,6 +73,13 @@ public:
 
     OLAPStatus get_next_block(RowBlock** row_block);
 
+    // Vectorized counterpart of get_next_block, for reads that go on after
+    // prepare_block_read without a RowBlock. The first call returns the rest
+    // of the block prepare_block_read stopped at, later calls load the next
+    // blocks. Rows of the batch are its selected rows, the batch is valid
+    // until the next call.
+    OLAPStatus get_next_vector_batch(VectorizedRowBatch** batch);
+
     void set_read_params(
             const std::vector<uint32_t>& return_columns,
             const std::set<uint32_t>& load_bf_columns,
@@ -83,6 +90,14 @@ public:
             bool is_using_cache,
             RuntimeState* runtime_state);
 
+    // Read only part split of num_splits parts of equal row block counts
+    // when prepare_block_read is given no keys. The parts of all splits
+    // cover every row once, in no particular order across splits.
+    void set_block_split(int32_t split, int32_t num_splits) {
+        _block_split = split;
+        _num_block_splits = num_splits;
+    }
+
     OLAPStatus get_first_row_block(RowBlock** row_block);
     OLAPStatus get_next_row_block(RowBlock** row_block);
 
@@ -102,6 +117,10 @@ public:
         _delete_status = delete_status;
     }
 
+    DelCondSatisfied delete_status() const {
+        return _delete_status;
+    }
+
     // 开放接口查询_eof，让外界知道数据读取是否正常终止
     // 因为这个函数被频繁访问, 从性能考虑, 放在基类而不是虚函数
     bool eof() { return _eof; }
@@ -137,6 +156,10 @@ private:
     // other block. Because the seeked block may be filtered by condition or delete.
     OLAPStatus _seek_to_block(const RowBlockPosition &block_pos, bool without_filter);
 
+    // Find the first block of the block split and set its end as the end
+    // key position. OLAP_ERR_DATA_EOF if the split has no blocks.
+    OLAPStatus _find_block_split(RowBlockPosition* position);
+
     OLAPStatus _find_position_by_short_key(
             const RowCursor& key, bool find_last_key, RowBlockPosition *position);
     OLAPStatus _find_position_by_full_key(
@@ -154,6 +177,10 @@ private:
     // get block from segment reader. If this function returns OLAP_SUCCESS
     OLAPStatus _get_block(bool without_filter, int rows_read = 0);
 
+    // Load the next block with at least one row left by the predicates
+    OLAPStatus _get_vector_batch(
+        VectorizedRowBatch** got_batch, bool without_filter, int rows_read);
+
     const RowCursor* _current_row() {
         _read_block->get_row(_read_block->pos(), &_cursor);
         return &_cursor;
@@ -175,6 +202,8 @@ private:
     // whether in normal read, use return columns to load block
     bool _is_normal_read = false;
     bool _end_key_is_set = false;
+    int32_t _block_split = 0;
+    int32_t _num_block_splits = 1;
     bool _is_using_cache;
     bool _segment_eof = false;
     bool _need_eval_predicates = false;
@@ -187,6 +216,11 @@ private:
 
     std::unique_ptr<VectorizedRowBatch> _seek_vector_batch;
     std::unique_ptr<VectorizedRowBatch> _read_vector_batch;
+    // batch _read_block was last dumped from
+    VectorizedRowBatch* _current_vector_batch = nullptr;
+    // set by prepare_block_read, the next get_next_vector_batch returns the
+    // rest of _current_vector_batch
+    bool _vector_batch_pending = false;
 
     std::unique_ptr<RowBlock> _read_block = nullptr;
     RowCursor _cursor;
@@ -0,0 +1,77 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/column_predicate.h"
+
+#include <string.h>
+
+#include "olap/field.h"
+#include "olap/wrapper_field.h"
+#include "runtime/string_value.hpp"
+#include "util/slice.h"
+
+namespace doris {
+
+// Statistic buffers are not aligned for wide types, so copy the value out.
+template <class T>
+static inline void read_statistic(const WrapperField* field, T* value) {
+    memcpy(value, field->ptr(), sizeof(T));
+}
+
+template <>
+inline void read_statistic<StringValue>(const WrapperField* field, StringValue* value) {
+    const Slice* slice = reinterpret_cast<const Slice*>(field->ptr());
+    value->ptr = slice->data;
+    value->len = slice->size;
+}
+
+// ColumnStatistics starts max as null and min as the type maximum, and null
+// sorts before any value, so a null min means the range has nulls and a null
+// max means it holds nothing but nulls.
+template <class T>
+StatisticRange<T>::StatisticRange(const std::pair<WrapperField*, WrapperField*>& statistic)
+        : valid(statistic.first != nullptr && statistic.second != nullptr),
+          has_null(false),
+          all_null(false),
+          min(),
+          max() {
+    if (!valid) {
+        return;
+    }
+    has_null = statistic.first->is_null();
+    all_null = statistic.second->is_null();
+    if (!has_null) {
+        read_statistic(statistic.first, &min);
+    }
+    if (!all_null) {
+        read_statistic(statistic.second, &max);
+    }
+}
+
+template struct StatisticRange<int8_t>;
+template struct StatisticRange<int16_t>;
+template struct StatisticRange<int32_t>;
+template struct StatisticRange<int64_t>;
+template struct StatisticRange<int128_t>;
+template struct StatisticRange<float>;
+template struct StatisticRange<double>;
+template struct StatisticRange<decimal12_t>;
+template struct StatisticRange<StringValue>;
+template struct StatisticRange<uint24_t>;
+template struct StatisticRange<uint64_t>;
+
+} //namespace doris
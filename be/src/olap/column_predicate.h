@@ -18,16 +18,46 @@
 #ifndef DORIS_BE_SRC_OLAP_COLUMN_PREDICATE_H
 #define DORIS_BE_SRC_OLAP_COLUMN_PREDICATE_H
 
+#include <stdint.h>
+#include <utility>
+
 namespace doris {
 
 class VectorizedRowBatch;
+class WrapperField;
 
 class ColumnPredicate {
 public:
+    explicit ColumnPredicate(int32_t column_id) : _column_id(column_id) {}
     virtual ~ColumnPredicate() {}
 
     //evaluate predicate on VectorizedRowBatch
     virtual void evaluate(VectorizedRowBatch* batch) const = 0;
+
+    // evaluate predicate on the [min, max] statistic of a block or a segment group,
+    // return false only if no row in that range can satisfy the predicate
+    virtual bool evaluate(const std::pair<WrapperField*, WrapperField*>& statistic) const = 0;
+
+    int32_t column_id() const { return _column_id; }
+
+protected:
+    int32_t _column_id;
+};
+
+// Typed view of a column statistic, as recorded by ColumnStatistics for a block
+// or by SegmentGroup for a whole segment group.
+template <class T>
+struct StatisticRange {
+    explicit StatisticRange(const std::pair<WrapperField*, WrapperField*>& statistic);
+
+    // false if no statistic is recorded, e.g. CHAR and VARCHAR blocks
+    bool valid;
+    // some rows are null, min is not meaningful then
+    bool has_null;
+    // every row is null, neither min nor max is meaningful
+    bool all_null;
+    T min;
+    T max;
 };
 
 } //namespace doris
@@ -890,11 +890,12 @@ uint64_t ColumnReader::_count_none_nulls(uint64_t rows) {
         for (uint64_t counter = 0; counter < rows; ++counter) {
             res = _present_reader->next(reinterpret_cast<char*>(&_value_present));
 
-            if (OLAP_SUCCESS == res && (false == _value_present)) {
-                result += 1;
-            } else {
+            if (OLAP_SUCCESS != res) {
                 break;
             }
+            if (false == _value_present) {
+                result += 1;
+            }
         }
 
         return result;
@@ -1111,6 +1112,8 @@ OLAPStatus DecimalColumnReader::seek(PositionProvider* positions) {
 }
 
 OLAPStatus DecimalColumnReader::skip(uint64_t row_count) {
+    // null rows have no int and frac parts
+    row_count = _count_none_nulls(row_count);
     OLAPStatus res = _int_reader->skip(row_count);
 
     if (OLAP_SUCCESS != res) {
@@ -1283,6 +1286,7 @@ OLAPStatus LargeIntColumnReader::seek(PositionProvider* positions) {
 }
 
 OLAPStatus LargeIntColumnReader::skip(uint64_t row_count) {
+    row_count = _count_none_nulls(row_count);
     OLAPStatus res = _high_reader->skip(row_count);
     if (OLAP_SUCCESS != res) {
         OLAP_LOG_WARNING("fail to skip large int high part. [res=%d]", res);
@@ -17,8 +17,12 @@
 
 #include "olap/column_writer.h"
 
+#include <algorithm>
+
+#include "common/config.h"
 #include "olap/bit_field_writer.h"
 #include "olap/file_helper.h"
+#include "olap/ngram_bloom_filter.h"
 
 namespace doris {
 
@@ -164,7 +168,11 @@ ColumnWriter::ColumnWriter(
         _is_found_nulls(false),
         _bf(NULL),
         _num_rows_per_row_block(num_rows_per_row_block),
-        _bf_fpp(bf_fpp) {}
+        _bf_fpp(bf_fpp),
+        _bf_split_block(false),
+        _ngram_gram_size(0),
+        _max_block_ngrams(0),
+        _ngram_bf_index_stream(NULL) {}
 
 ColumnWriter::~ColumnWriter() {
     SAFE_DELETE(_is_present);
@@ -236,13 +244,72 @@ OLAPStatus ColumnWriter::init() {
             return OLAP_ERR_MALLOC_ERROR;
         }
 
-        if (!_bf->init(_num_rows_per_row_block, _bf_fpp)) {
+        _bf_split_block = _field_info.is_split_block_bf_column;
+        if (!_bf->init(_num_rows_per_row_block, _bf_fpp, _bf_split_block)) {
             OLAP_LOG_WARNING("fail to init bloom filter. num rows: %u, fpp: %g", 
                              _num_rows_per_row_block, _bf_fpp);
             return OLAP_ERR_INIT_FAILED;
         }
+
+        if ((_field_info.type == OLAP_FIELD_TYPE_CHAR
+                || _field_info.type == OLAP_FIELD_TYPE_VARCHAR)
+                && config::ngram_bloom_filter_gram_size > 0
+                && config::ngram_bloom_filter_gram_size <= MAX_NGRAM_SIZE) {
+            _ngram_bf_index_stream = _stream_factory->create_stream(
+                    unique_column_id(), StreamInfoMessage::NGRAM_BLOOM_FILTER);
+            if (NULL == _ngram_bf_index_stream) {
+                OLAP_LOG_WARNING("fail to allocate ngram bloom filter index stream");
+                return OLAP_ERR_MALLOC_ERROR;
+            }
+
+            _ngram_gram_size = config::ngram_bloom_filter_gram_size;
+        }
+    }
+
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus ColumnWriter::_write_ngram_bf(ColumnDataHeaderMessage* header) {
+    // the filters of a column have one size, which the reader steps by
+    int64_t expected_ngrams = std::max<int64_t>(_max_block_ngrams, 1);
+    uint32_t bit_num = 0;
+    size_t block_begin = 0;
+    for (size_t block_end : _ngram_block_ends) {
+        BloomFilter* bf = new(std::nothrow) BloomFilter();
+        if (NULL == bf) {
+            OLAP_LOG_WARNING("fail to allocate ngram bloom filter");
+            return OLAP_ERR_MALLOC_ERROR;
+        }
+        if (!bf->init(expected_ngrams, _bf_fpp, true)) {
+            OLAP_LOG_WARNING("fail to init ngram bloom filter. ngrams: %ld, fpp: %g",
+                             expected_ngrams, _bf_fpp);
+            delete bf;
+            return OLAP_ERR_INIT_FAILED;
+        }
+        for (size_t i = block_begin; i < block_end; ++i) {
+            bf->add_hash(_ngram_hashes[i]);
+        }
+        bit_num = bf->bit_num();
+        _ngram_bf_index.add_bloom_filter(bf);
+        block_begin = block_end;
+    }
+    std::vector<uint64_t>().swap(_ngram_hashes);
+
+    OLAPStatus res = _ngram_bf_index.write_to_buffer(_ngram_bf_index_stream);
+    if (OLAP_SUCCESS != res) {
+        OLAP_LOG_WARNING("fail to write ngram bloom filter stream");
+        return res;
     }
 
+    res = _ngram_bf_index_stream->flush();
+    if (OLAP_SUCCESS != res) {
+        OLAP_LOG_WARNING("fail to flush ngram bloom filter stream");
+        return res;
+    }
+
+    header->set_ngram_bf_gram_size(_ngram_gram_size);
+    header->add_ngram_bf_column(unique_column_id());
+    header->add_ngram_bf_bit_num(bit_num);
     return OLAP_SUCCESS;
 }
 
@@ -268,6 +335,10 @@ OLAPStatus ColumnWriter::write(RowCursor* row_cursor) {
             {
                 Slice* slice = reinterpret_cast<Slice*>(buf);
                 _bf->add_bytes(slice->data, slice->size);
+                if (has_ngram_bf()) {
+                    add_ngram_hashes(slice->data, slice->size, _ngram_gram_size,
+                                     &_ngram_hashes);
+                }
             } else {
                 _bf->add_bytes(buf, field->size());
             }
@@ -301,13 +372,23 @@ OLAPStatus ColumnWriter::create_row_index_entry() {
             return OLAP_ERR_MALLOC_ERROR;
         }
 
-        if (!_bf->init(_num_rows_per_row_block, _bf_fpp)) {
+        if (!_bf->init(_num_rows_per_row_block, _bf_fpp, _bf_split_block)) {
             OLAP_LOG_WARNING("fail to init bloom filter. num rows: %u, fpp: %g", 
                              _num_rows_per_row_block, _bf_fpp);
             return OLAP_ERR_INIT_FAILED;
         }
     }
 
+    if (has_ngram_bf()) {
+        size_t block_begin = _ngram_block_ends.empty() ? 0 : _ngram_block_ends.back();
+        std::sort(_ngram_hashes.begin() + block_begin, _ngram_hashes.end());
+        _ngram_hashes.erase(std::unique(_ngram_hashes.begin() + block_begin,
+                                        _ngram_hashes.end()),
+                            _ngram_hashes.end());
+        _ngram_block_ends.push_back(_ngram_hashes.size());
+        _max_block_ngrams = std::max(_max_block_ngrams, _ngram_hashes.size() - block_begin);
+    }
+
     for (std::vector<ColumnWriter*>::iterator it = _sub_writers.begin();
             it != _sub_writers.end(); ++it) {
         if (OLAP_SUCCESS != (res = (*it)->create_row_index_entry())) {
@@ -326,6 +407,9 @@ uint64_t ColumnWriter::estimate_buffered_memory() {
     if (is_bf_column()) {
         result += _bf_index.estimate_buffered_memory();
     }
+    if (has_ngram_bf()) {
+        result += _ngram_hashes.size() * sizeof(uint64_t);
+    }
 
     for (std::vector<ColumnWriter*>::iterator it = _sub_writers.begin();
             it != _sub_writers.end(); ++it) {
@@ -401,6 +485,19 @@ OLAPStatus ColumnWriter::finalize(ColumnDataHeaderMessage* header) {
             OLAP_LOG_WARNING("fail to flush bloom filter stream");
             OLAP_GOTO(FINALIZE_EXIT);
         }
+
+        if (_bf_split_block) {
+            header->add_split_block_bf_column(unique_column_id());
+            header->set_split_block_bf_bit_num(_bf->bit_num());
+        }
+    }
+
+    // write ngram bloom filter index
+    if (has_ngram_bf()) {
+        res = _write_ngram_bf(header);
+        if (OLAP_SUCCESS != res) {
+            OLAP_GOTO(FINALIZE_EXIT);
+        }
     }
 
     // 在Segment头中记录一份Schema信息
@@ -439,7 +536,8 @@ void ColumnWriter::save_encoding(ColumnEncodingMessage* encoding) {
 
 void ColumnWriter::get_bloom_filter_info(bool* has_bf_column,
         uint32_t* bf_hash_function_num, uint32_t* bf_bit_num) {
-    if (is_bf_column()) {
+    // split block bloom filters are recorded by finalize()
+    if (is_bf_column() && !_bf_split_block) {
         *has_bf_column = true;
         *bf_hash_function_num = _bf->hash_function_num();
         *bf_bit_num = _bf->bit_num();
@@ -120,11 +120,16 @@ protected:
 
 private:
     void _remove_is_present_positions();
+    OLAPStatus _write_ngram_bf(ColumnDataHeaderMessage* header);
 
     bool is_bf_column() {
         return _field_info.is_bf_column;
     }
 
+    bool has_ngram_bf() {
+        return _ngram_gram_size != 0;
+    }
+
     uint32_t _column_id;
     const FieldInfo& _field_info;
     OutStreamFactory* _stream_factory; // 该对象由外部调用者所有
@@ -140,6 +145,19 @@ private:
     OutStream* _bf_index_stream;
     size_t _num_rows_per_row_block;
     double _bf_fpp;
+    bool _bf_split_block;
+    // ngram bloom filter of strings, valid when _ngram_gram_size is not 0.
+    // The filters are built at finalize, all sized for the block with the
+    // most distinct ngrams.
+    size_t _ngram_gram_size;
+    // distinct ngram hashes of each finished block, then those of the
+    // current block
+    std::vector<uint64_t> _ngram_hashes;
+    // end of the hashes of each finished block in _ngram_hashes
+    std::vector<size_t> _ngram_block_ends;
+    size_t _max_block_ngrams;
+    BloomFilterIndexWriter _ngram_bf_index;
+    OutStream* _ngram_bf_index_stream;
 
     DISALLOW_COPY_AND_ASSIGN(ColumnWriter);
 };
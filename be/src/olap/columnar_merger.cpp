@@ -0,0 +1,337 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/columnar_merger.h"
+
+#include <string.h>
+#include <algorithm>
+
+#include "common/config.h"
+#include "olap/column_data.h"
+#include "olap/data_writer.h"
+#include "olap/delete_handler.h"
+#include "olap/field.h"
+#include "olap/row_block.h"
+#include "olap/types.h"
+#include "runtime/vectorized_row_batch.h"
+
+namespace doris {
+
+bool ColumnarMerger::SourceLess::operator()(const Source& a, const Source& b) const {
+    int cmp_res = _merger->_key_cmp(a, a.row(), b, b.row());
+    if (cmp_res != 0) {
+        return cmp_res < 0;
+    }
+    // rows of equal keys in the order of their versions, as Reader does
+    return a.version < b.version;
+}
+
+ColumnarMerger::ColumnarMerger(OLAPTablePtr table, ReaderType reader_type,
+                               const Version& version)
+        : _table(table),
+        _reader_type(reader_type),
+        _version(version),
+        _num_columns(table->tablet_schema().size()),
+        _num_key_columns(table->num_key_fields()),
+        _aggregate(table->keys_type() != KeysType::DUP_KEYS),
+        _merge_tree(SourceLess(this)) {
+    const std::vector<FieldInfo>& schema = _table->tablet_schema();
+    size_t max_cell_size = 0;
+    for (uint32_t cid = 0; cid < _num_columns; ++cid) {
+        const FieldInfo& field_info = schema[cid];
+        _return_columns.push_back(cid);
+        _type_infos.push_back(get_type_info(field_info.type));
+        if (field_info.type == OLAP_FIELD_TYPE_CHAR
+                || field_info.type == OLAP_FIELD_TYPE_VARCHAR
+                || field_info.type == OLAP_FIELD_TYPE_HLL) {
+            _cell_sizes.push_back(sizeof(Slice));
+        } else {
+            _cell_sizes.push_back(field_info.length);
+        }
+        max_cell_size = std::max(max_cell_size, _cell_sizes.back());
+
+        ColumnOp op = COPY_FIRST;
+        if (_aggregate && cid >= _num_key_columns) {
+            if (field_info.aggregation == OLAP_FIELD_AGGREGATION_REPLACE) {
+                op = COPY_LAST;
+            } else if (field_info.aggregation != OLAP_FIELD_AGGREGATION_NONE) {
+                op = AGGREGATE;
+            }
+        }
+        _column_ops.push_back(op);
+        _fields.emplace_back(op == AGGREGATE ? Field::create(field_info) : nullptr);
+    }
+    _agg_cell.resize(1 + max_cell_size);
+    _conditions.set_table(_table);
+}
+
+ColumnarMerger::~ColumnarMerger() {
+}
+
+bool ColumnarMerger::can_merge(const std::vector<ColumnData*>& olap_data_arr) {
+    if (!config::enable_columnar_compaction) {
+        return false;
+    }
+    // rows of delete deltas remove rows of other deltas one key at a time
+    for (auto data : olap_data_arr) {
+        if (data->delete_flag()) {
+            return false;
+        }
+    }
+    const std::vector<FieldInfo>& schema = _table->tablet_schema();
+    for (uint32_t cid = 0; cid < _num_columns; ++cid) {
+        if (_column_ops[cid] != AGGREGATE) {
+            continue;
+        }
+        // aggregations of strings need their memory and HLL a finalize
+        // step, Reader does them row by row
+        if (schema[cid].aggregation != OLAP_FIELD_AGGREGATION_SUM
+                && schema[cid].aggregation != OLAP_FIELD_AGGREGATION_MIN
+                && schema[cid].aggregation != OLAP_FIELD_AGGREGATION_MAX) {
+            return false;
+        }
+        if (schema[cid].type == OLAP_FIELD_TYPE_CHAR
+                || schema[cid].type == OLAP_FIELD_TYPE_VARCHAR
+                || schema[cid].type == OLAP_FIELD_TYPE_HLL) {
+            return false;
+        }
+    }
+    if (_reader_type != READER_CUMULATIVE_COMPACTION) {
+        // same delete conditions as Reader applies, rows they hit are
+        // filtered one RowCursor at a time
+        DeleteHandler delete_handler;
+        _table->obtain_header_rdlock();
+        OLAPStatus res = delete_handler.init(_table, _version.second);
+        _table->release_header_lock();
+        bool has_delete_conditions = res != OLAP_SUCCESS || delete_handler.conditions_num() != 0;
+        delete_handler.finalize();
+        if (has_delete_conditions) {
+            return false;
+        }
+    }
+    return true;
+}
+
+OLAPStatus ColumnarMerger::merge(const std::vector<ColumnData*>& olap_data_arr,
+                                 ColumnDataWriter* writer,
+                                 uint64_t* merged_rows, uint64_t* row_count) {
+    *merged_rows = 0;
+    *row_count = 0;
+    for (auto data : olap_data_arr) {
+        if (data->empty() || data->zero_num_rows()) {
+            continue;
+        }
+        data->set_delete_status(DEL_NOT_SATISFIED);
+        // compaction reads do not fill the index stream cache
+        data->set_read_params(_return_columns, _load_bf_columns, _conditions,
+                              _col_predicates, _keys, _keys, false, nullptr);
+        data->set_stats(&_stats);
+        RowBlock* block = nullptr;
+        OLAPStatus res = data->prepare_block_read(nullptr, false, nullptr, false, &block);
+        if (res == OLAP_ERR_DATA_EOF) {
+            continue;
+        } else if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "failed to prepare block read, res=" << res
+                         << ", version=" << data->version().first
+                         << "-" << data->version().second;
+            return res;
+        }
+        Source source;
+        source.data = data;
+        source.version = data->version().second;
+        source.cells.resize(_num_columns);
+        source.nulls.resize(_num_columns);
+        _sources.push_back(source);
+    }
+
+    std::vector<Source*> items;
+    for (Source& source : _sources) {
+        RETURN_NOT_OK(_next_batch(&source));
+        items.push_back(source.batch != nullptr ? &source : nullptr);
+    }
+    _merge_tree.init(items);
+
+    // True if the row at the writer's next row holds a key that may go on
+    // in the next batch of a source. It is committed once it is complete.
+    bool open_row = false;
+    while (_merge_tree.top() != nullptr) {
+        uint32_t first_row = 0;
+        uint32_t num_rows = 0;
+        RETURN_NOT_OK(writer->reserve_rows(&first_row, &num_rows));
+        RowBlock* row_block = writer->row_block();
+
+        // Merge keys until the reserved rows are used up or the batch of a
+        // source ends, the cells of the entries are valid until then.
+        _entries.clear();
+        uint32_t used_rows = open_row ? 1 : 0;
+        Source* exhausted = nullptr;
+        Source* source = nullptr;
+        while ((source = _merge_tree.top()) != nullptr) {
+            uint16_t row = source->row();
+            bool first = true;
+            if (_aggregate) {
+                if (!_entries.empty()) {
+                    const Entry& last = _entries.back();
+                    first = _key_cmp(*source, row, _sources[last.source], last.row) != 0;
+                } else if (open_row) {
+                    first = !_key_equal_to_row(*source, row, row_block, first_row);
+                }
+            }
+            if (first) {
+                if (used_rows == num_rows) {
+                    break;
+                }
+                ++used_rows;
+            } else {
+                ++*merged_rows;
+            }
+            Entry entry;
+            entry.source = source - _sources.data();
+            entry.row = row;
+            entry.out_row = first_row + used_rows - 1;
+            entry.first = first;
+            _entries.push_back(entry);
+
+            if (++source->pos == source->size) {
+                exhausted = source;
+                break;
+            }
+            _merge_tree.next(source);
+        }
+
+        _gather(row_block, writer->mem_pool());
+
+        if (exhausted != nullptr) {
+            RETURN_NOT_OK(_next_batch(exhausted));
+            _merge_tree.next(exhausted->batch != nullptr ? exhausted : nullptr);
+        }
+        open_row = _aggregate && exhausted != nullptr && used_rows > 0
+            && _merge_tree.top() != nullptr;
+        uint32_t complete_rows = open_row ? used_rows - 1 : used_rows;
+        writer->commit_rows(complete_rows);
+        *row_count += complete_rows;
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus ColumnarMerger::_next_batch(Source* source) {
+    VectorizedRowBatch* batch = nullptr;
+    OLAPStatus res = source->data->get_next_vector_batch(&batch);
+    if (res == OLAP_ERR_DATA_EOF) {
+        source->batch = nullptr;
+        return OLAP_SUCCESS;
+    } else if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "failed to get vector batch, res=" << res
+                     << ", version=" << source->data->version().first
+                     << "-" << source->data->version().second;
+        return res;
+    }
+    source->batch = batch;
+    source->pos = 0;
+    source->size = batch->size();
+    source->selected = batch->selected_in_use() ? batch->selected() : nullptr;
+    for (uint32_t cid = 0; cid < _num_columns; ++cid) {
+        ColumnVector* column = batch->column(cid);
+        source->cells[cid] = reinterpret_cast<const char*>(column->col_data());
+        source->nulls[cid] = column->no_nulls() ? nullptr : column->is_null();
+    }
+    return OLAP_SUCCESS;
+}
+
+int ColumnarMerger::_key_cmp(const Source& a, uint16_t a_row,
+                             const Source& b, uint16_t b_row) const {
+    for (uint32_t cid = 0; cid < _num_key_columns; ++cid) {
+        bool a_null = _is_null(a, cid, a_row);
+        bool b_null = _is_null(b, cid, b_row);
+        if (a_null != b_null) {
+            return a_null ? -1 : 1;
+        } else if (a_null) {
+            continue;
+        }
+        int res = _type_infos[cid]->cmp(_cell(a, cid, a_row), _cell(b, cid, b_row));
+        if (res != 0) {
+            return res;
+        }
+    }
+    return 0;
+}
+
+bool ColumnarMerger::_key_equal_to_row(const Source& source, uint16_t row,
+                                       const RowBlock* row_block, uint32_t out_row) const {
+    for (uint32_t cid = 0; cid < _num_key_columns; ++cid) {
+        const char* out_cell = row_block->field_ptr(out_row, cid);
+        bool is_null = _is_null(source, cid, row);
+        if (static_cast<bool>(*out_cell) != is_null) {
+            return false;
+        } else if (is_null) {
+            continue;
+        }
+        if (!_type_infos[cid]->equal(out_cell + 1, _cell(source, cid, row))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ColumnarMerger::_gather(RowBlock* row_block, MemPool* mem_pool) {
+    for (uint32_t cid = 0; cid < _num_columns; ++cid) {
+        switch (_column_ops[cid]) {
+        case COPY_FIRST:
+            for (const Entry& entry : _entries) {
+                if (entry.first) {
+                    _copy_cell(cid, entry, row_block->field_ptr(entry.out_row, cid), mem_pool);
+                }
+            }
+            break;
+        case COPY_LAST:
+            for (size_t i = 0; i < _entries.size(); ++i) {
+                const Entry& entry = _entries[i];
+                if (i + 1 == _entries.size() || _entries[i + 1].out_row != entry.out_row) {
+                    _copy_cell(cid, entry, row_block->field_ptr(entry.out_row, cid), mem_pool);
+                }
+            }
+            break;
+        case AGGREGATE: {
+            Field* field = _fields[cid].get();
+            for (const Entry& entry : _entries) {
+                char* dest = row_block->field_ptr(entry.out_row, cid);
+                if (entry.first) {
+                    _copy_cell(cid, entry, dest, mem_pool);
+                    continue;
+                }
+                const Source& source = _sources[entry.source];
+                _agg_cell[0] = _is_null(source, cid, entry.row);
+                memcpy(&_agg_cell[1], _cell(source, cid, entry.row), _cell_sizes[cid]);
+                field->aggregate(dest, _agg_cell.data());
+            }
+            break;
+        }
+        }
+    }
+}
+
+void ColumnarMerger::_copy_cell(uint32_t cid, const Entry& entry, char* dest, MemPool* mem_pool) {
+    const Source& source = _sources[entry.source];
+    if (_is_null(source, cid, entry.row)) {
+        *dest = 1;
+        return;
+    }
+    *dest = 0;
+    _type_infos[cid]->copy_with_pool(dest + 1, _cell(source, cid, entry.row), mem_pool);
+}
+
+}  // namespace doris
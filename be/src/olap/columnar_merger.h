@@ -0,0 +1,166 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_COLUMNAR_MERGER_H
+#define DORIS_BE_SRC_OLAP_COLUMNAR_MERGER_H
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "olap/loser_tree.h"
+#include "olap/olap_common.h"
+#include "olap/olap_cond.h"
+#include "olap/olap_define.h"
+#include "olap/olap_table.h"
+
+namespace doris {
+
+class ColumnData;
+class ColumnDataWriter;
+class ColumnPredicate;
+class Field;
+class MemPool;
+class RowBlock;
+class RowCursor;
+class TypeInfo;
+class VectorizedRowBatch;
+
+// Merges data a batch of rows at a time instead of a RowCursor at a time.
+//
+// Rows are read from each ColumnData as VectorizedRowBatch. The merge
+// compares key columns only and yields the order of the output rows as a
+// list of (source, row) entries. Then the cells of the entries are gathered
+// one column at a time into the rows of the writer's row block, and for
+// AGG_KEYS and UNIQUE_KEYS tables aggregated with the cells of equal keys.
+//
+// Only used when can_merge() holds: there are no delete conditions or
+// delete deltas to apply, and values are aggregated by REPLACE or by SUM,
+// MIN and MAX of fixed length types. Merger reads other data by rows.
+class ColumnarMerger {
+public:
+    // version is the one the merged data gets, delete conditions up to it
+    // apply to base compactions and schema changes
+    ColumnarMerger(OLAPTablePtr table, ReaderType reader_type, const Version& version);
+    ~ColumnarMerger();
+
+    bool can_merge(const std::vector<ColumnData*>& olap_data_arr);
+
+    // Write the merged rows of olap_data_arr with writer, the caller
+    // finalizes it. merged_rows is the number of rows aggregated into
+    // others, row_count the number of rows written.
+    OLAPStatus merge(const std::vector<ColumnData*>& olap_data_arr,
+                     ColumnDataWriter* writer,
+                     uint64_t* merged_rows, uint64_t* row_count);
+
+private:
+    // how the cells of a column are written to the output row
+    enum ColumnOp {
+        // the first cell of the row's key
+        COPY_FIRST,
+        // the last cell of the row's key
+        COPY_LAST,
+        // all cells of the row's key, by Field::aggregate
+        AGGREGATE
+    };
+
+    // Current batch of a ColumnData and the next row to merge from it
+    struct Source {
+        ColumnData* data = nullptr;
+        int32_t version = 0;
+        VectorizedRowBatch* batch = nullptr;
+        uint16_t pos = 0;
+        uint16_t size = 0;
+        const uint16_t* selected = nullptr;
+        // cells and null flags of the batch by column id, null flags are
+        // nullptr if the column has no null
+        std::vector<const char*> cells;
+        std::vector<const bool*> nulls;
+
+        uint16_t row() const {
+            return selected != nullptr ? selected[pos] : pos;
+        }
+    };
+
+    struct Entry {
+        uint16_t source;
+        uint16_t row;
+        uint32_t out_row;
+        // the first entry of out_row
+        bool first;
+    };
+
+    class SourceLess {
+    public:
+        explicit SourceLess(const ColumnarMerger* merger) : _merger(merger) { }
+        bool operator()(const Source& a, const Source& b) const;
+    private:
+        const ColumnarMerger* _merger;
+    };
+
+    OLAPStatus _next_batch(Source* source);
+
+    bool _is_null(const Source& source, uint32_t cid, uint16_t row) const {
+        return source.nulls[cid] != nullptr && source.nulls[cid][row];
+    }
+
+    const char* _cell(const Source& source, uint32_t cid, uint16_t row) const {
+        return source.cells[cid] + row * _cell_sizes[cid];
+    }
+
+    int _key_cmp(const Source& a, uint16_t a_row, const Source& b, uint16_t b_row) const;
+    // true if the key of row of source equals the key of out_row of
+    // row_block
+    bool _key_equal_to_row(const Source& source, uint16_t row,
+                           const RowBlock* row_block, uint32_t out_row) const;
+
+    // write the cells of _entries to the rows of row_block
+    void _gather(RowBlock* row_block, MemPool* mem_pool);
+    void _copy_cell(uint32_t cid, const Entry& entry, char* dest, MemPool* mem_pool);
+
+    OLAPTablePtr _table;
+    ReaderType _reader_type;
+    Version _version;
+    size_t _num_columns;
+    size_t _num_key_columns;
+    bool _aggregate;
+
+    std::vector<ColumnOp> _column_ops;
+    std::vector<TypeInfo*> _type_infos;
+    std::vector<size_t> _cell_sizes;
+    std::vector<std::unique_ptr<Field>> _fields;
+    // a cell with its null byte, for Field::aggregate
+    std::vector<char> _agg_cell;
+
+    // read params of the sources: all columns and no conditions
+    std::vector<uint32_t> _return_columns;
+    std::set<uint32_t> _load_bf_columns;
+    Conditions _conditions;
+    std::vector<ColumnPredicate*> _col_predicates;
+    std::vector<RowCursor*> _keys;
+
+    std::vector<Source> _sources;
+    std::vector<Entry> _entries;
+    LoserTree<Source, SourceLess> _merge_tree;
+    OlapReaderStatistics _stats;
+
+    DISALLOW_COPY_AND_ASSIGN(ColumnarMerger);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_COLUMNAR_MERGER_H
@@ -0,0 +1,119 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/compaction_scheduler.h"
+
+#include <math.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "common/config.h"
+#include "util/time.h"
+
+namespace doris {
+
+double compaction_priority(uint32_t score, int64_t data_size, double query_hotness) {
+    if (score == 0) {
+        return 0;
+    }
+    double priority = score;
+    priority *= 1.0 + config::compaction_query_hotness_weight * log2(1.0 + query_hotness);
+    double data_size_gb = static_cast<double>(data_size) / (1024 * 1024 * 1024);
+    priority /= 1.0 + config::compaction_data_size_weight * log2(1.0 + data_size_gb);
+    return priority;
+}
+
+void QueryHotness::add(int64_t now_sec) {
+    std::lock_guard<std::mutex> l(_lock);
+    _decay(now_sec);
+    _value += 1;
+}
+
+double QueryHotness::value(int64_t now_sec) const {
+    std::lock_guard<std::mutex> l(_lock);
+    _decay(now_sec);
+    return _value;
+}
+
+void QueryHotness::_decay(int64_t now_sec) const {
+    int64_t half_life = std::max<int64_t>(config::compaction_query_hotness_half_life_sec, 1);
+    if (_time == 0 || now_sec < _time) {
+        _time = now_sec;
+        return;
+    }
+    int64_t half_lives = (now_sec - _time) / half_life;
+    if (half_lives >= 64) {
+        _value = 0;
+        _time = now_sec;
+    } else if (half_lives > 0) {
+        _value = ldexp(_value, -static_cast<int>(half_lives));
+        _time += half_lives * half_life;
+    }
+}
+
+void CompactionSlots::set_max_tasks_per_disk(uint32_t max_tasks_per_disk) {
+    std::lock_guard<std::mutex> l(_lock);
+    _max_tasks_per_disk = max_tasks_per_disk;
+}
+
+bool CompactionSlots::is_full(const std::string& store_path) const {
+    std::lock_guard<std::mutex> l(_lock);
+    auto it = _running.find(store_path);
+    return it != _running.end() && it->second >= _max_tasks_per_disk;
+}
+
+bool CompactionSlots::try_acquire(const std::string& store_path, int64_t tablet_id) {
+    std::lock_guard<std::mutex> l(_lock);
+    uint32_t& running = _running[store_path];
+    if (running >= _max_tasks_per_disk || _tablets.count(tablet_id) > 0) {
+        return false;
+    }
+    ++running;
+    _tablets.insert(tablet_id);
+    return true;
+}
+
+void CompactionSlots::release(const std::string& store_path, int64_t tablet_id) {
+    std::lock_guard<std::mutex> l(_lock);
+    --_running[store_path];
+    _tablets.erase(tablet_id);
+}
+
+uint32_t CompactionSlots::running(const std::string& store_path) const {
+    std::lock_guard<std::mutex> l(_lock);
+    auto it = _running.find(store_path);
+    return it == _running.end() ? 0 : it->second;
+}
+
+void IoThrottle::acquire(int64_t bytes) {
+    int64_t wait_us = reserve(bytes, MonotonicMicros());
+    if (wait_us > 0) {
+        usleep(wait_us);
+    }
+}
+
+int64_t IoThrottle::reserve(int64_t bytes, int64_t now_us) {
+    if (_bytes_per_sec <= 0 || bytes <= 0) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> l(_lock);
+    int64_t start = std::max(_next_free_us, now_us);
+    _next_free_us = start + bytes * 1000000 / _bytes_per_sec;
+    return start - now_us;
+}
+
+}  // namespace doris
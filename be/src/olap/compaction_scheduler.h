@@ -0,0 +1,105 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_COMPACTION_SCHEDULER_H
+#define DORIS_BE_SRC_OLAP_COMPACTION_SCHEDULER_H
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace doris {
+
+// Priority of compacting a tablet, 0 if it needs no compaction.
+//
+// score is the compaction score of the tablet, the number of deltas to
+// merge. Tablets queried often are compacted first, their queries pay for
+// every delta. Among tablets of the same score smaller ones go first, they
+// take less IO to bring their version count down.
+double compaction_priority(uint32_t score, int64_t data_size, double query_hotness);
+
+// Number of queries on a tablet, halved every
+// compaction_query_hotness_half_life_sec seconds. Thread-safe.
+class QueryHotness {
+public:
+    void add(int64_t now_sec);
+    double value(int64_t now_sec) const;
+
+private:
+    void _decay(int64_t now_sec) const;
+
+    mutable std::mutex _lock;
+    mutable double _value = 0;
+    mutable int64_t _time = 0;
+};
+
+// Compactions of one kind running on each store. At most max_tasks_per_disk
+// run on a store, no limit by default, and a tablet is compacted by one
+// thread at a time. Thread-safe.
+class CompactionSlots {
+public:
+    explicit CompactionSlots(uint32_t max_tasks_per_disk = UINT32_MAX)
+            : _max_tasks_per_disk(max_tasks_per_disk) { }
+
+    void set_max_tasks_per_disk(uint32_t max_tasks_per_disk);
+
+    // true if no more compactions may start on the store
+    bool is_full(const std::string& store_path) const;
+
+    // Take a slot on the store for the tablet, false if the store is full
+    // or the tablet is being compacted already.
+    bool try_acquire(const std::string& store_path, int64_t tablet_id);
+
+    void release(const std::string& store_path, int64_t tablet_id);
+
+    uint32_t running(const std::string& store_path) const;
+
+private:
+    mutable std::mutex _lock;
+    uint32_t _max_tasks_per_disk;
+    std::map<std::string, uint32_t> _running;
+    std::set<int64_t> _tablets;
+};
+
+// Limits the bytes per second written to one disk, shared by all
+// compactions writing there. Each writer waits until the bytes written
+// before it are due at the rate. Thread-safe.
+class IoThrottle {
+public:
+    // 0 for no limit
+    explicit IoThrottle(int64_t bytes_per_sec) : _bytes_per_sec(bytes_per_sec) { }
+
+    // Wait until bytes may be written.
+    void acquire(int64_t bytes);
+
+    // Account bytes written at now_us, a monotonic time, and return how
+    // many microseconds the writer has to wait before writing them.
+    int64_t reserve(int64_t bytes, int64_t now_us);
+
+private:
+    std::mutex _lock;
+    const int64_t _bytes_per_sec;
+    // monotonic time when everything acquired so far is written at the rate
+    int64_t _next_free_us = 0;
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_COMPACTION_SCHEDULER_H
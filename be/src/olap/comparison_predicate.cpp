@@ -17,6 +17,7 @@
 
 #include "olap/comparison_predicate.h"
 #include "olap/field.h"
+#include "olap/predicate_kernel.h"
 #include "runtime/string_value.hpp"
 #include "runtime/vectorized_row_batch.h"
 
@@ -25,7 +26,7 @@ namespace doris {
 #define COMPARISON_PRED_CONSTRUCTOR(CLASS) \
     template<class type> \
     CLASS<type>::CLASS(int column_id, const type& value) \
-        : _column_id(column_id), \
+        : ColumnPredicate(column_id), \
           _value(value) \
         {} \
 
@@ -39,7 +40,7 @@ COMPARISON_PRED_CONSTRUCTOR(GreaterEqualPredicate)
 #define COMPARISON_PRED_CONSTRUCTOR_STRING(CLASS) \
     template<> \
     CLASS<StringValue>::CLASS(int column_id, const StringValue& value) \
-        : _column_id(column_id) \
+        : ColumnPredicate(column_id) \
         { \
             _value.len = value.len; \
             _value.ptr = value.ptr; \
@@ -55,60 +56,50 @@ COMPARISON_PRED_CONSTRUCTOR_STRING(GreaterEqualPredicate)
 #define COMPARISON_PRED_EVALUATE(CLASS, OP) \
     template<class type> \
     void CLASS<type>::evaluate(VectorizedRowBatch* batch) const { \
-        uint16_t n = batch->size(); \
-        if (n == 0) { \
-            return; \
+        ColumnVector* column = batch->column(_column_id); \
+        const type* col_vector = reinterpret_cast<const type*>(column->col_data()); \
+        const bool* is_null = column->no_nulls() ? nullptr : column->is_null(); \
+        predicate_kernel::CompareMatcher<predicate_kernel::OP, type> matcher(col_vector, _value); \
+        predicate_kernel::evaluate_batch(matcher, is_null, batch); \
+    } \
+
+COMPARISON_PRED_EVALUATE(EqualPredicate, PRED_OP_EQ)
+COMPARISON_PRED_EVALUATE(NotEqualPredicate, PRED_OP_NE)
+COMPARISON_PRED_EVALUATE(LessPredicate, PRED_OP_LT)
+COMPARISON_PRED_EVALUATE(LessEqualPredicate, PRED_OP_LE)
+COMPARISON_PRED_EVALUATE(GreaterPredicate, PRED_OP_GT)
+COMPARISON_PRED_EVALUATE(GreaterEqualPredicate, PRED_OP_GE)
+
+// A range holding only nulls never matches a comparison. When it holds some
+// nulls its min is unknown, so only bounds checked against max can prune it.
+// The checks only use operator< so they work for every value type.
+#define COMPARISON_PRED_STATISTIC_EVALUATE(CLASS, MAY_MATCH) \
+    template<class type> \
+    bool CLASS<type>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const { \
+        StatisticRange<type> range(statistic); \
+        if (!range.valid) { \
+            return true; \
         } \
-        uint16_t* sel = batch->selected(); \
-        const type* col_vector = reinterpret_cast<const type*>(batch->column(_column_id)->col_data()); \
-        uint16_t new_size = 0; \
-        if (batch->column(_column_id)->no_nulls()) { \
-            if (batch->selected_in_use()) { \
-                for (uint16_t j = 0; j !=n; ++j) { \
-                    uint16_t i = sel[j]; \
-                    sel[new_size] = i; \
-                    new_size += (col_vector[i] OP _value); \
-                } \
-                batch->set_size(new_size); \
-            } else { \
-                for (uint16_t i = 0; i !=n; ++i) { \
-                    sel[new_size] = i; \
-                    new_size += (col_vector[i] OP _value); \
-                } \
-                if (new_size < n) { \
-                    batch->set_size(new_size); \
-                    batch->set_selected_in_use(true); \
-                } \
-            } \
-        } else { \
-            bool* is_null = batch->column(_column_id)->is_null(); \
-            if (batch->selected_in_use()) { \
-                for (uint16_t j = 0; j !=n; ++j) { \
-                    uint16_t i = sel[j]; \
-                    sel[new_size] = i; \
-                    new_size += (!is_null[i] && (col_vector[i] OP _value)); \
-                } \
-                batch->set_size(new_size); \
-            } else { \
-                for (uint16_t i = 0; i !=n; ++i) { \
-                    sel[new_size] = i; \
-                    new_size += (!is_null[i] && (col_vector[i] OP _value)); \
-                } \
-                if (new_size < n) { \
-                    batch->set_size(new_size); \
-                    batch->set_selected_in_use(true); \
-                } \
-            } \
+        if (range.all_null) { \
+            return false; \
         } \
+        return MAY_MATCH; \
     } \
 
-
-COMPARISON_PRED_EVALUATE(EqualPredicate, ==)
-COMPARISON_PRED_EVALUATE(NotEqualPredicate, !=)
-COMPARISON_PRED_EVALUATE(LessPredicate, <)
-COMPARISON_PRED_EVALUATE(LessEqualPredicate, <=)
-COMPARISON_PRED_EVALUATE(GreaterPredicate, >)
-COMPARISON_PRED_EVALUATE(GreaterEqualPredicate, >=)
+COMPARISON_PRED_STATISTIC_EVALUATE(EqualPredicate,
+        (range.has_null || !(_value < range.min)) && !(range.max < _value))
+COMPARISON_PRED_STATISTIC_EVALUATE(NotEqualPredicate,
+        range.has_null || range.min < range.max
+            || range.min < _value || _value < range.min)
+COMPARISON_PRED_STATISTIC_EVALUATE(LessPredicate,
+        range.has_null || range.min < _value)
+COMPARISON_PRED_STATISTIC_EVALUATE(LessEqualPredicate,
+        range.has_null || !(_value < range.min))
+COMPARISON_PRED_STATISTIC_EVALUATE(GreaterPredicate,
+        _value < range.max)
+COMPARISON_PRED_STATISTIC_EVALUATE(GreaterEqualPredicate,
+        !(range.max < _value))
 
 #define COMPARISON_PRED_CONSTRUCTOR_DECLARATION(CLASS) \
     template CLASS<int8_t>::CLASS(int column_id, const int8_t& value); \
@@ -150,4 +141,35 @@ COMPARISON_PRED_EVALUATE_DECLARATION(LessEqualPredicate)
 COMPARISON_PRED_EVALUATE_DECLARATION(GreaterPredicate)
 COMPARISON_PRED_EVALUATE_DECLARATION(GreaterEqualPredicate)
 
+#define COMPARISON_PRED_STATISTIC_EVALUATE_DECLARATION(CLASS) \
+    template bool CLASS<int8_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<int16_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<int32_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<int64_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<int128_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<float>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<double>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<decimal12_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<StringValue>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<uint24_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<uint64_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+
+COMPARISON_PRED_STATISTIC_EVALUATE_DECLARATION(EqualPredicate)
+COMPARISON_PRED_STATISTIC_EVALUATE_DECLARATION(NotEqualPredicate)
+COMPARISON_PRED_STATISTIC_EVALUATE_DECLARATION(LessPredicate)
+COMPARISON_PRED_STATISTIC_EVALUATE_DECLARATION(LessEqualPredicate)
+COMPARISON_PRED_STATISTIC_EVALUATE_DECLARATION(GreaterPredicate)
+COMPARISON_PRED_STATISTIC_EVALUATE_DECLARATION(GreaterEqualPredicate)
+
 } //namespace doris
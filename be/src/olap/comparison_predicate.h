@@ -24,6 +24,7 @@
 namespace doris {
 
 class VectorizedRowBatch;
+class WrapperField;
 
 #define COMPARISON_PRED_CLASS_DEFINE(CLASS) \
     template <class type> \
@@ -32,8 +33,9 @@ class VectorizedRowBatch;
         CLASS(int column_id, const type& value); \
         virtual ~CLASS() { }  \
         virtual void evaluate(VectorizedRowBatch* batch) const override; \
+        virtual bool evaluate( \
+                const std::pair<WrapperField*, WrapperField*>& statistic) const override; \
     private: \
-        int32_t _column_id; \
         type _value; \
     }; \
 
@@ -60,7 +60,9 @@ OLAPStatus lzo_decompress(StorageByteBuffer* in, StorageByteBuffer* out) {
     return res;
 }
 
-OLAPStatus lz4_compress(StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller) {
+// compress with compression_type, out is only advanced if the data shrinks
+static OLAPStatus compress_buffer(StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller,
+                                  OLAPCompressionType compression_type) {
     size_t out_length = 0;
     OLAPStatus res = OLAP_SUCCESS;
     *smaller = false;
@@ -69,7 +71,7 @@ OLAPStatus lz4_compress(StorageByteBuffer* in, StorageByteBuffer* out, bool* sma
             &(out->array()[out->position()]),
             out->remaining(),
             &out_length,
-            OLAP_COMP_LZ4);
+            compression_type);
 
     if (OLAP_SUCCESS == res) {
         if (out_length < in->remaining()) {
@@ -81,6 +83,14 @@ OLAPStatus lz4_compress(StorageByteBuffer* in, StorageByteBuffer* out, bool* sma
     return res;
 }
 
+OLAPStatus lz4_compress(StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller) {
+    return compress_buffer(in, out, smaller, OLAP_COMP_LZ4);
+}
+
+OLAPStatus lz4hc_compress(StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller) {
+    return compress_buffer(in, out, smaller, OLAP_COMP_LZ4HC);
+}
+
 OLAPStatus lz4_decompress(StorageByteBuffer* in, StorageByteBuffer* out) {
     size_t out_length = 0;
     OLAPStatus res = OLAP_SUCCESS;
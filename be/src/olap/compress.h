@@ -49,5 +49,9 @@ OLAPStatus lzo_decompress(StorageByteBuffer* in, StorageByteBuffer* out);
 OLAPStatus lz4_compress(StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller);
 OLAPStatus lz4_decompress(StorageByteBuffer* in, StorageByteBuffer* out);
 
+// slower to compress than lz4_compress for a better ratio, at the level of
+// config::lz4hc_compression_level. decompress with lz4_decompress
+OLAPStatus lz4hc_compress(StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller);
+
 }  // namespace doris
 #endif // DORIS_BE_SRC_OLAP_COLUMN_FILE_COMPRESS_H
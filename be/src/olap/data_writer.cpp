@@ -22,6 +22,7 @@
 #include "olap/segment_writer.h"
 #include "olap/segment_group.h"
 #include "olap/row_block.h"
+#include "olap/store.h"
 
 
 namespace doris {
@@ -155,6 +156,26 @@ OLAPStatus ColumnDataWriter::write(const char* row) {
 }
 
 
+OLAPStatus ColumnDataWriter::reserve_rows(uint32_t* first_row, uint32_t* num_rows) {
+    if (_row_index >= _table->num_rows_per_row_block()) {
+        if (OLAP_SUCCESS != _flush_row_block(false)) {
+            OLAP_LOG_WARNING("failed to flush data while reserving rows.");
+            return OLAP_ERR_OTHER_ERROR;
+        }
+        RETURN_NOT_OK(_flush_segment_with_verfication());
+    }
+    *first_row = _row_index;
+    *num_rows = _table->num_rows_per_row_block() - _row_index;
+    return OLAP_SUCCESS;
+}
+
+void ColumnDataWriter::commit_rows(uint32_t num_rows) {
+    for (uint32_t i = 0; i < num_rows; ++i) {
+        _row_block->get_row(_row_index, &_cursor);
+        next(_cursor);
+    }
+}
+
 void ColumnDataWriter::next(const RowCursor& row_cursor) {
     for (size_t i = 0; i < _table->num_key_fields(); ++i) {
         char* right = row_cursor.get_field_by_index(i)->get_field_ptr(row_cursor.get_buf());
@@ -269,8 +290,14 @@ OLAPStatus ColumnDataWriter::_add_segment() {
     if (_is_push_write) {
         res = _segment_writer->init(config::push_write_mbytes_per_sec);
     } else {
+        // compactions and schema changes writing to the same disk share
+        // its throttle
+        IoThrottle* io_throttle = NULL;
+        if (_table->store() != NULL) {
+            io_throttle = _table->store()->compaction_io_throttle();
+        }
         res = _segment_writer->init(
-                config::base_compaction_write_mbytes_per_sec);
+                config::base_compaction_write_mbytes_per_sec, io_throttle);
     }
 
     if (OLAP_SUCCESS != res) {
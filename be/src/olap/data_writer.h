@@ -39,6 +39,13 @@ public:
     OLAPStatus write(const char* row);
     void next(const RowCursor& row_cursor);
     void next(const char* row, const Schema* schema);
+    // Rows [*first_row, *first_row + *num_rows) of row_block() are free to
+    // be written in place, flushing a full block first. Uncommitted rows
+    // keep what was written to them until the next flush.
+    OLAPStatus reserve_rows(uint32_t* first_row, uint32_t* num_rows);
+    // The next num_rows reserved rows were written.
+    void commit_rows(uint32_t num_rows);
+    RowBlock* row_block() { return _row_block; }
     OLAPStatus finalize();
     uint64_t written_bytes();
     MemPool* mem_pool();
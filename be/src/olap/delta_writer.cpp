@@ -35,6 +35,10 @@ DeltaWriter::DeltaWriter(WriteRequest* req)
       _segment_group_id(-1), _delta_written_success(false) {}
 
 DeltaWriter::~DeltaWriter() {
+    // the memtables being flushed still refer to the schema and segment groups
+    if (_flush_handler != nullptr) {
+        _flush_handler->wait();
+    }
     if (!_delta_written_success) {
         _garbage_collection();
     }
@@ -137,52 +141,106 @@ OLAPStatus DeltaWriter::_init() {
     _field_infos = &(_table->tablet_schema());
     _schema = new Schema(*_field_infos),
     _mem_table = new MemTable(_schema, _field_infos, &_col_ids,
-                              _req.tuple_desc, _table->keys_type());
+                              _req.tuple_desc, _table->keys_type(),
+                              config::memtable_shard_num);
+    _flush_handler = OLAPEngine::get_instance()->memtable_flush_executor()->create_flush_handler(
+            _table->store(), config::max_flushing_memtable_per_writer);
     _is_init = true;
     return OLAP_SUCCESS;
 }
 
+OLAPStatus DeltaWriter::_init_once() {
+    if (_is_init) {
+        return OLAP_SUCCESS;
+    }
+    MutexLock l(&_init_lock);
+    if (_is_init) {
+        return OLAP_SUCCESS;
+    }
+    return init();
+}
+
 OLAPStatus DeltaWriter::write(Tuple* tuple) {
-    if (!_is_init) {
-        auto st = init();
-        if (st != OLAP_SUCCESS) {
-            return st;
+    RETURN_NOT_OK(_init_once());
+    {
+        ReadLock rdlock(&_mem_table_lock);
+        _mem_table->insert(tuple);
+        if (_mem_table->memory_usage() < config::write_buffer_size) {
+            return OLAP_SUCCESS;
         }
     }
+    return _flush_if_full();
+}
 
-    _mem_table->insert(tuple);
-    if (_mem_table->memory_usage() >= config::write_buffer_size) {
-        RETURN_NOT_OK(_mem_table->flush(_writer));
+OLAPStatus DeltaWriter::write_batch(const std::vector<Tuple*>& tuples) {
+    RETURN_NOT_OK(_init_once());
+    {
+        ReadLock rdlock(&_mem_table_lock);
+        for (Tuple* tuple : tuples) {
+            _mem_table->insert(tuple);
+        }
+        if (_mem_table->memory_usage() < config::write_buffer_size) {
+            return OLAP_SUCCESS;
+        }
+    }
+    return _flush_if_full();
+}
 
-        ++_segment_group_id;
-        _cur_segment_group = new SegmentGroup(_table.get(), false, _segment_group_id, 0, true,
-                                   _req.partition_id, _req.transaction_id);
-        DCHECK(_cur_segment_group != nullptr) << "failed to malloc SegmentGroup";
-        _cur_segment_group->acquire();
-        _cur_segment_group->set_load_id(_req.load_id);
-        _segment_group_vec.push_back(_cur_segment_group);
+OLAPStatus DeltaWriter::_flush_if_full() {
+    WriteLock wrlock(&_mem_table_lock);
+    // another writer may have flushed it while we waited for the lock
+    if (_mem_table->memory_usage() < config::write_buffer_size) {
+        return OLAP_SUCCESS;
+    }
+    // the handler owns the memtable and the writer from now on, the new ones
+    // are created even on error so that the writer stays usable for close
+    OLAPStatus res = _flush_handler->submit(_mem_table, _writer);
 
-        SAFE_DELETE(_writer);
-        _writer = ColumnDataWriter::create(_table, _cur_segment_group, true);
-        DCHECK(_writer != nullptr) << "memory error occur when creating writer";
+    ++_segment_group_id;
+    _cur_segment_group = new SegmentGroup(_table.get(), false, _segment_group_id, 0, true,
+                               _req.partition_id, _req.transaction_id);
+    DCHECK(_cur_segment_group != nullptr) << "failed to malloc SegmentGroup";
+    _cur_segment_group->acquire();
+    _cur_segment_group->set_load_id(_req.load_id);
+    _segment_group_vec.push_back(_cur_segment_group);
+
+    _writer = ColumnDataWriter::create(_table, _cur_segment_group, true);
+    DCHECK(_writer != nullptr) << "memory error occur when creating writer";
 
-        SAFE_DELETE(_mem_table);
-        _mem_table = new MemTable(_schema, _field_infos, &_col_ids,
-                                  _req.tuple_desc, _table->keys_type());
+    _mem_table = new MemTable(_schema, _field_infos, &_col_ids,
+                              _req.tuple_desc, _table->keys_type(),
+                              config::memtable_shard_num);
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to flush memtable. tablet=" << _table->full_name()
+                     << ", res=" << res;
     }
-    return OLAP_SUCCESS;
+    return res;
 }
 
 OLAPStatus DeltaWriter::close(google::protobuf::RepeatedPtrField<PTabletInfo>* tablet_vec) {
-    if (!_is_init) {
-        auto st = init();
-        if (st != OLAP_SUCCESS) {
-            return st;
-        }
+    RETURN_NOT_OK(_init_once());
+    OLAPStatus res = OLAP_SUCCESS;
+    {
+        // no insert may still be running on the last memtable
+        WriteLock wrlock(&_mem_table_lock);
+        res = _flush_handler->submit(_mem_table, _writer);
+        _mem_table = nullptr;
+        _writer = nullptr;
+    }
+    if (res != OLAP_SUCCESS) {
+        // the flushes still running are waited for by the destructor
+        LOG(WARNING) << "fail to flush memtable. tablet=" << _table->full_name()
+                     << ", res=" << res;
+        return res;
+    }
+    // wait returns the first error of any flush, including the last one
+    res = _flush_handler->wait();
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to flush memtable. tablet=" << _table->full_name()
+                     << ", res=" << res;
+        return res;
     }
-    RETURN_NOT_OK(_mem_table->close(_writer));
 
-    OLAPStatus res = OLAP_SUCCESS;
     //add pending data to tablet
     RETURN_NOT_OK(_table->add_pending_version(_req.partition_id, _req.transaction_id, nullptr));
     for (SegmentGroup* segment_group : _segment_group_vec) {
@@ -18,7 +18,10 @@
 #ifndef DORIS_BE_SRC_DELTA_WRITER_H
 #define DORIS_BE_SRC_DELTA_WRITER_H
 
+#include <atomic>
+
 #include "olap/memtable.h"
+#include "olap/memtable_flush_executor.h"
 #include "olap/olap_engine.h"
 #include "olap/olap_table.h"
 #include "olap/schema_change.h"
@@ -54,7 +57,10 @@ public:
     OLAPStatus init();
     DeltaWriter(WriteRequest* req);
     ~DeltaWriter();
+    // write and write_batch are thread safe, rows of concurrent calls are
+    // inserted into the memtable in parallel
     OLAPStatus write(Tuple* tuple);
+    OLAPStatus write_batch(const std::vector<Tuple*>& tuples);
     OLAPStatus close(google::protobuf::RepeatedPtrField<PTabletInfo>* tablet_vec);
 
     OLAPStatus cancel();
@@ -63,8 +69,15 @@ public:
 private:
     void _garbage_collection();
     OLAPStatus _init();
-    
-    bool _is_init = false;
+    OLAPStatus _init_once();
+    // hand the memtable over for flushing and switch to a new one if it is
+    // still full
+    OLAPStatus _flush_if_full();
+
+    std::atomic<bool> _is_init{false};
+    Mutex _init_lock;
+    // held shared by inserts and exclusively while the memtable is flushed
+    RWMutex _mem_table_lock;
     WriteRequest _req;
     OLAPTablePtr _table;
     SegmentGroup* _cur_segment_group;
@@ -76,6 +89,8 @@ private:
     Schema* _schema;
     std::vector<FieldInfo>* _field_infos;
     std::vector<uint32_t> _col_ids;
+    // flushes the full memtables in the background
+    std::shared_ptr<FlushHandler> _flush_handler;
 
     int32_t _segment_group_id;
     bool _delta_written_success;
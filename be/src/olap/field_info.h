@@ -308,6 +308,8 @@ public:
 
     // is bloom filter column
     bool is_bf_column;
+    // bloom filter with the split block layout
+    bool is_split_block_bf_column;
 public:
     static std::string get_string_by_field_type(FieldType type);
     static std::string get_string_by_aggregation_type(FieldAggregationMethod aggregation_type);
@@ -66,6 +66,10 @@ OLAPStatus ReadOnlyFileStream::_assure_data() {
         return OLAP_ERR_COLUMN_STREAM_EOF;
     }
 
+    if (_page_cache != NULL && _load_cached_block()) {
+        return OLAP_SUCCESS;
+    }
+
     StreamHead header;
     size_t file_cursor_used = _file_cursor.position();
     OLAPStatus res = OLAP_SUCCESS;
@@ -104,9 +108,39 @@ OLAPStatus ReadOnlyFileStream::_assure_data() {
 
     _uncompressed = _compressed_helper;
     _current_compress_position = file_cursor_used;
+    if (_page_cache != NULL) {
+        _page_cache->insert(_file_cursor.file_name(), _file_cursor.offset() + file_cursor_used,
+                            sizeof(header) + header.length, *_uncompressed);
+    }
     return res;
 }
 
+bool ReadOnlyFileStream::_load_cached_block() {
+    size_t file_cursor_used = _file_cursor.position();
+    uint64_t block_length = 0;
+    StorageByteBuffer* block = _page_cache->lookup(
+            _file_cursor.file_name(), _file_cursor.offset() + file_cursor_used, &block_length);
+    if (_uncompressed == _cached_block) {
+        _uncompressed = NULL;
+    }
+    SAFE_DELETE(_cached_block);
+    if (block == NULL) {
+        ++_stats->page_cache_miss;
+        return false;
+    }
+    if (_file_cursor.seek(file_cursor_used + block_length) != OLAP_SUCCESS) {
+        // not a block of this stream
+        SAFE_DELETE(block);
+        ++_stats->page_cache_miss;
+        return false;
+    }
+    ++_stats->page_cache_hit;
+    _cached_block = block;
+    _uncompressed = _cached_block;
+    _current_compress_position = file_cursor_used;
+    return true;
+}
+
 // 设置读取的位置
 OLAPStatus ReadOnlyFileStream::seek(PositionProvider* position) {
     OLAPStatus res = OLAP_SUCCESS;
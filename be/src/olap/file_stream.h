@@ -30,6 +30,8 @@
 #include "olap/stream_index_reader.h"
 #include "olap/file_helper.h"
 #include "olap/olap_common.h"
+#include "olap/stream_page_cache.h"
+#include "olap/stream_read_ahead.h"
 #include "util/runtime_profile.h"
 
 namespace doris {
@@ -68,6 +70,7 @@ public:
 
     ~ReadOnlyFileStream() {
         SAFE_DELETE(_compressed_helper);
+        SAFE_DELETE(_cached_block);
     }
 
     inline OLAPStatus init() {
@@ -85,6 +88,32 @@ public:
         _file_cursor.reset(offset, length);
     }
 
+    // Read decompressed blocks through page_cache, NULL to read the file
+    void set_page_cache(StreamPageCache* page_cache) {
+        _page_cache = page_cache;
+    }
+
+    // Read the stream ahead in windows of window_size bytes on pool, the
+    // windows are consumed from mem_tracker
+    void set_read_ahead(ThreadPool* pool, uint64_t window_size, MemTracker* mem_tracker) {
+        _read_ahead.reset(new StreamReadAhead(
+                _file_cursor.file_handler(), pool, window_size, mem_tracker));
+        _file_cursor.set_read_ahead(_read_ahead.get());
+    }
+
+    // Start reading the beginning of the stream if it is read ahead, unless
+    // its first block is in the page cache
+    void prefetch() {
+        if (_read_ahead == nullptr) {
+            return;
+        }
+        uint64_t offset = _file_cursor.offset() + _file_cursor.position();
+        if (_page_cache != NULL && _page_cache->contains(_file_cursor.file_name(), offset)) {
+            return;
+        }
+        _read_ahead->prefetch(offset, _file_cursor.offset() + _file_cursor.length());
+    }
+
     // 从数据流中读取一个字节,内部指针后移
     // 如果数据流结束, 返回OLAP_ERR_COLUMN_STREAM_EOF
     inline OLAPStatus read(char* byte);
@@ -158,7 +187,8 @@ private:
                 _file_handler(file_handler),
                 _offset(offset),
                 _length(length),
-                _used(0) {
+                _used(0),
+                _read_ahead(NULL) {
         }
 
         ~FileCursor() {}
@@ -169,11 +199,15 @@ private:
             _used = 0;
         }
 
+        void set_read_ahead(StreamReadAhead* read_ahead) {
+            _read_ahead = read_ahead;
+        }
+
         OLAPStatus read(char* out_buffer, size_t length) {
             if (_used + length <= _length) {
-                OLAPStatus res = _file_handler->pread(out_buffer,
-                             length,
-                             _used + _offset);
+                OLAPStatus res = _read_ahead != NULL
+                        ? _read_ahead->read(out_buffer, length, _used + _offset, _offset + _length)
+                        : _file_handler->pread(out_buffer, length, _used + _offset);
                 if (OLAP_SUCCESS != res) {
                     OLAP_LOG_WARNING("fail to read from file. [res=%d]", res);
                     return res;
@@ -216,20 +250,28 @@ private:
 
         size_t offset() const { return _offset; }
 
+        FileHandler* file_handler() const { return _file_handler; }
+
     private:
         FileHandler* _file_handler;
         size_t _offset; // start from where
         size_t _length; // length limit
         size_t _used;
+        StreamReadAhead* _read_ahead;
     };
 
     OLAPStatus _assure_data();
     OLAPStatus _fill_compressed(size_t length);
+    bool _load_cached_block();
 
     FileCursor _file_cursor;
     StorageByteBuffer* _compressed_helper;
     StorageByteBuffer* _uncompressed;
     StorageByteBuffer** _shared_buffer;
+    StreamPageCache* _page_cache = NULL;
+    // block got from _page_cache, _uncompressed points to it after a hit
+    StorageByteBuffer* _cached_block = NULL;
+    std::unique_ptr<StreamReadAhead> _read_ahead;
 
     Decompressor _decompressor;
     size_t _compress_buffer_size;
@@ -17,6 +17,7 @@
 
 #include "olap/in_list_predicate.h"
 #include "olap/field.h"
+#include "olap/predicate_kernel.h"
 #include "runtime/string_value.hpp"
 #include "runtime/vectorized_row_batch.h"
 
@@ -25,64 +26,63 @@ namespace doris {
 #define IN_LIST_PRED_CONSTRUCTOR(CLASS) \
 template<class type> \
 CLASS<type>::CLASS(int column_id, std::set<type>&& values) \
-    : _column_id(column_id), \
-      _values(std::move(values)) {} \
+    : ColumnPredicate(column_id), \
+      _values(std::move(values)) { \
+    if (predicate_kernel::SimdTraits<type>::vectorized \
+            && _values.size() <= predicate_kernel::MAX_VECTORIZED_IN_LIST_SIZE) { \
+        _value_list.assign(_values.begin(), _values.end()); \
+    } \
+} \
 
 IN_LIST_PRED_CONSTRUCTOR(InListPredicate)
 IN_LIST_PRED_CONSTRUCTOR(NotInListPredicate)
 
-#define IN_LIST_PRED_EVALUATE(CLASS, OP) \
+#define IN_LIST_PRED_EVALUATE(CLASS, NEGATE) \
 template<class type> \
 void CLASS<type>::evaluate(VectorizedRowBatch* batch) const { \
-    uint16_t n = batch->size(); \
-    if (n == 0) { \
-        return; \
-    } \
-    uint16_t* sel = batch->selected(); \
-    const type* col_vector = reinterpret_cast<const type*>(batch->column(_column_id)->col_data()); \
-    uint16_t new_size = 0; \
-    if (batch->column(_column_id)->no_nulls()) { \
-        if (batch->selected_in_use()) { \
-            for (uint16_t j = 0; j != n; ++j) { \
-                uint16_t i = sel[j]; \
-                sel[new_size] = i; \
-                new_size += (_values.find(col_vector[i]) OP _values.end()); \
-            } \
-            batch->set_size(new_size); \
-        } else { \
-            for (uint16_t i = 0; i != n; ++i) { \
-                sel[new_size] = i; \
-                new_size += (_values.find(col_vector[i]) OP _values.end()); \
-            } \
-            if (new_size < n) { \
-                batch->set_size(new_size); \
-                batch->set_selected_in_use(true); \
-            } \
-        } \
-    } else { \
-        bool* is_null = batch->column(_column_id)->is_null(); \
-        if (batch->selected_in_use()) { \
-            for (uint16_t j = 0; j != n; ++j) { \
-                uint16_t i = sel[j]; \
-                sel[new_size] = i; \
-                new_size += (!is_null[i] && _values.find(col_vector[i]) OP _values.end()); \
-            } \
-            batch->set_size(new_size); \
-        } else { \
-            for (int i = 0; i != n; ++i) { \
-                sel[new_size] = i; \
-                new_size += (!is_null[i] && _values.find(col_vector[i]) OP _values.end()); \
-            } \
-            if (new_size < n) { \
-                batch->set_size(new_size); \
-                batch->set_selected_in_use(true); \
-            } \
-        } \
-    } \
+    ColumnVector* column = batch->column(_column_id); \
+    const type* col_vector = reinterpret_cast<const type*>(column->col_data()); \
+    const bool* is_null = column->no_nulls() ? nullptr : column->is_null(); \
+    predicate_kernel::InListMatcher<type, std::set<type>> matcher( \
+            col_vector, _values, _value_list, NEGATE); \
+    predicate_kernel::evaluate_batch(matcher, is_null, batch); \
 } \
 
-IN_LIST_PRED_EVALUATE(InListPredicate, !=)
-IN_LIST_PRED_EVALUATE(NotInListPredicate, ==)
+IN_LIST_PRED_EVALUATE(InListPredicate, false)
+IN_LIST_PRED_EVALUATE(NotInListPredicate, true)
+
+// _values is ordered, so the first value not less than min decides whether
+// any value of the list falls into [min, max].
+template<class type>
+bool InListPredicate<type>::evaluate(
+        const std::pair<WrapperField*, WrapperField*>& statistic) const {
+    StatisticRange<type> range(statistic);
+    if (!range.valid) {
+        return true;
+    }
+    if (range.all_null) {
+        return false;
+    }
+    auto it = range.has_null ? _values.begin() : _values.lower_bound(range.min);
+    return it != _values.end() && !(range.max < *it);
+}
+
+// Only a range holding a single value, which is in the list, can be pruned.
+template<class type>
+bool NotInListPredicate<type>::evaluate(
+        const std::pair<WrapperField*, WrapperField*>& statistic) const {
+    StatisticRange<type> range(statistic);
+    if (!range.valid) {
+        return true;
+    }
+    if (range.all_null) {
+        return false;
+    }
+    if (range.has_null || range.min < range.max) {
+        return true;
+    }
+    return _values.find(range.min) == _values.end();
+}
 
 #define IN_LIST_PRED_CONSTRUCTOR_DECLARATION(CLASS) \
     template CLASS<int8_t>::CLASS(int column_id, std::set<int8_t>&& values); \
@@ -115,4 +115,31 @@ IN_LIST_PRED_CONSTRUCTOR_DECLARATION(NotInListPredicate)
 
 IN_LIST_PRED_EVALUATE_DECLARATION(InListPredicate)
 IN_LIST_PRED_EVALUATE_DECLARATION(NotInListPredicate)
+
+#define IN_LIST_PRED_STATISTIC_EVALUATE_DECLARATION(CLASS) \
+    template bool CLASS<int8_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<int16_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<int32_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<int64_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<int128_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<float>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<double>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<decimal12_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<StringValue>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<uint24_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+    template bool CLASS<uint64_t>::evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const; \
+
+IN_LIST_PRED_STATISTIC_EVALUATE_DECLARATION(InListPredicate)
+IN_LIST_PRED_STATISTIC_EVALUATE_DECLARATION(NotInListPredicate)
 } //namespace doris
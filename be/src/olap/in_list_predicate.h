@@ -20,11 +20,13 @@
 
 #include <stdint.h>
 #include <set>
+#include <vector>
 #include "olap/column_predicate.h"
 
 namespace doris {
 
 class VectorizedRowBatch;
+class WrapperField;
 
 #define IN_LIST_PRED_CLASS_DEFINE(CLASS) \
 template <class type>  \
@@ -33,9 +35,12 @@ public: \
     CLASS(int column_id, std::set<type>&& values); \
     virtual ~CLASS() {} \
     virtual void evaluate(VectorizedRowBatch* batch) const override; \
+    virtual bool evaluate( \
+            const std::pair<WrapperField*, WrapperField*>& statistic) const override; \
 private: \
-    int32_t _column_id; \
     std::set<type> _values; \
+    /* copy of _values used by the SIMD kernel, empty for long lists */ \
+    std::vector<type> _value_list; \
 }; \
 
 IN_LIST_PRED_CLASS_DEFINE(InListPredicate)
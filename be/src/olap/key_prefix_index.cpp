@@ -0,0 +1,192 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/key_prefix_index.h"
+
+#include <algorithm>
+
+#include "olap/field_info.h"
+#include "olap/olap_define.h"
+#include "util/slice.h"
+
+namespace doris {
+
+// non-null prefixes have the top byte set, so nulls go first, the value
+// keeps the top 7 bytes of its order preserving encoding
+static const uint64_t NOT_NULL_PREFIX = 1UL << 56;
+static const size_t PREFIX_VALUE_BYTES = 7;
+
+template<typename T>
+static inline T unaligned_load(const char* ptr) {
+    T value;
+    memcpy(&value, ptr, sizeof(T));
+    return value;
+}
+
+// order preserving unsigned encoding of signed value, in the top bits
+template<typename T>
+static inline uint64_t signed_to_ordered(T value) {
+    static const int shift = 64 - sizeof(T) * 8;
+    uint64_t bits = static_cast<uint64_t>(static_cast<int64_t>(value)) << shift;
+    return bits ^ (1UL << 63);
+}
+
+bool key_prefix_supported(FieldType type) {
+    switch (type) {
+    case OLAP_FIELD_TYPE_TINYINT:
+    case OLAP_FIELD_TYPE_SMALLINT:
+    case OLAP_FIELD_TYPE_INT:
+    case OLAP_FIELD_TYPE_BIGINT:
+    case OLAP_FIELD_TYPE_LARGEINT:
+    case OLAP_FIELD_TYPE_DATE:
+    case OLAP_FIELD_TYPE_DATETIME:
+    case OLAP_FIELD_TYPE_DECIMAL:
+    case OLAP_FIELD_TYPE_CHAR:
+    case OLAP_FIELD_TYPE_VARCHAR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint64_t key_prefix(FieldType type, size_t index_size, const char* cell) {
+    if (*reinterpret_cast<const bool*>(cell)) {
+        return 0;
+    }
+    const char* content = cell + 1;
+    uint64_t value = 0;
+    switch (type) {
+    case OLAP_FIELD_TYPE_TINYINT:
+        value = signed_to_ordered(unaligned_load<int8_t>(content));
+        break;
+    case OLAP_FIELD_TYPE_SMALLINT:
+        value = signed_to_ordered(unaligned_load<int16_t>(content));
+        break;
+    case OLAP_FIELD_TYPE_INT:
+        value = signed_to_ordered(unaligned_load<int32_t>(content));
+        break;
+    case OLAP_FIELD_TYPE_BIGINT:
+    case OLAP_FIELD_TYPE_DATETIME:
+        value = signed_to_ordered(unaligned_load<int64_t>(content));
+        break;
+    case OLAP_FIELD_TYPE_LARGEINT:
+        value = signed_to_ordered(
+                static_cast<int64_t>(unaligned_load<int128_t>(content) >> 64));
+        break;
+    case OLAP_FIELD_TYPE_DATE:
+        value = static_cast<uint64_t>(static_cast<int>(unaligned_load<uint24_t>(content))) << 40;
+        break;
+    case OLAP_FIELD_TYPE_DECIMAL:
+        // decimals compare by integer part first
+        value = signed_to_ordered(unaligned_load<decimal12_t>(content).integer);
+        break;
+    case OLAP_FIELD_TYPE_CHAR:
+    case OLAP_FIELD_TYPE_VARCHAR: {
+        // big endian first bytes, zero padded as shorter strings go first.
+        // Field::index_cmp() compares varchar keys longer than the index
+        // on the bytes the index keeps only
+        Slice slice = unaligned_load<Slice>(content);
+        size_t num_bytes = std::min(slice.size, PREFIX_VALUE_BYTES);
+        if (type == OLAP_FIELD_TYPE_VARCHAR && index_size > OLAP_STRING_MAX_BYTES) {
+            num_bytes = std::min(num_bytes, index_size - OLAP_STRING_MAX_BYTES);
+        }
+        for (size_t i = 0; i < num_bytes; ++i) {
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(slice.data[i])) << (56 - 8 * i);
+        }
+        break;
+    }
+    default:
+        return 0;
+    }
+    return NOT_NULL_PREFIX | (value >> 8);
+}
+
+void KeyPrefixIndex::init(const std::vector<uint64_t>& prefixes, uint32_t interval) {
+    _prefixes.clear();
+    _entries.clear();
+    _interval = interval;
+    if (interval == 0 || prefixes.empty()) {
+        return;
+    }
+
+    std::vector<uint64_t> samples;
+    for (size_t i = 0; i < prefixes.size(); i += interval) {
+        samples.push_back(prefixes[i]);
+    }
+    _prefixes.resize(samples.size() + 1);
+    _entries.resize(samples.size() + 1);
+    size_t sample = 0;
+    _build(samples, &sample, 1);
+}
+
+void KeyPrefixIndex::_build(const std::vector<uint64_t>& samples, size_t* sample, size_t pos) {
+    if (pos >= _prefixes.size()) {
+        return;
+    }
+    // in-order walk of the implicit tree fills it with the sorted samples
+    _build(samples, sample, 2 * pos);
+    _prefixes[pos] = samples[*sample];
+    _entries[pos] = *sample * _interval;
+    ++*sample;
+    _build(samples, sample, 2 * pos + 1);
+}
+
+size_t KeyPrefixIndex::_search(uint64_t key_prefix, bool strict) const {
+    const uint64_t* prefixes = _prefixes.data();
+    size_t size = _prefixes.size();
+    size_t pos = 1;
+    while (pos < size) {
+        // the descendants four levels down share a cache line
+        __builtin_prefetch(prefixes + std::min(16 * pos, size - 1));
+        bool right = strict ? prefixes[pos] <= key_prefix : prefixes[pos] < key_prefix;
+        pos = 2 * pos + right;
+    }
+    // drop the trailing right turns and the last left turn
+    pos >>= __builtin_ffsll(~pos);
+    return pos;
+}
+
+void KeyPrefixIndex::narrow(uint64_t key_prefix, uint32_t* first, uint32_t* last) const {
+    if (empty()) {
+        return;
+    }
+
+    // samples of smaller prefixes have smaller keys, the bound is after them
+    size_t pos = _search(key_prefix, false);
+    uint32_t last_less = 0;
+    bool has_less = true;
+    if (pos == 0) {
+        last_less = (_prefixes.size() - 2) * _interval;
+    } else if (_entries[pos] > 0) {
+        last_less = _entries[pos] - _interval;
+    } else {
+        has_less = false;
+    }
+    if (has_less) {
+        *first = std::max(*first, last_less + 1);
+    }
+
+    // samples of greater prefixes have greater keys, the bound is not after
+    // them
+    pos = _search(key_prefix, true);
+    if (pos != 0) {
+        *last = std::min(*last, _entries[pos]);
+    }
+    *first = std::min(*first, *last);
+}
+
+}  // namespace doris
@@ -0,0 +1,85 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_KEY_PREFIX_INDEX_H
+#define DORIS_BE_SRC_OLAP_KEY_PREFIX_INDEX_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "olap/olap_common.h"
+
+namespace doris {
+
+// Return true if key_prefix() supports cells of type
+bool key_prefix_supported(FieldType type);
+
+// Return the normalized prefix of cell, a null byte followed by the content
+// of a key column of type. Prefixes compare as unsigned integers in the order
+// of Field::index_cmp() of the cells: if the prefix of a is less than the
+// prefix of b, a is less than b. Equal prefixes tell nothing.
+//
+// index_size is the index size of the column, strings are compared on at
+// most the bytes the short key index keeps of them.
+uint64_t key_prefix(FieldType type, size_t index_size, const char* cell);
+
+// First level of the short key index of a segment.
+//
+// Keeps the key prefixes of every interval-th entry in Eytzinger order, so
+// that a search walks down an implicit binary tree whose top levels share
+// cache lines, instead of touching entries all over the segment. A search
+// narrows the range of entries holding the lower or upper bound of a key,
+// which is then found by comparing the full short keys of the few entries
+// in it.
+class KeyPrefixIndex {
+public:
+    KeyPrefixIndex() : _interval(0) { }
+
+    // prefixes are the key prefixes of all entries of the segment, sorted
+    void init(const std::vector<uint64_t>& prefixes, uint32_t interval);
+
+    bool empty() const {
+        return _prefixes.size() <= 1;
+    }
+
+    // Narrow [*first, *last] to the entries which may be the first one not
+    // less than or greater than a key of key_prefix, *last being the number
+    // of entries if no entry is.
+    void narrow(uint64_t key_prefix, uint32_t* first, uint32_t* last) const;
+
+    size_t memory_usage() const {
+        return _prefixes.size() * sizeof(uint64_t) + _entries.size() * sizeof(uint32_t);
+    }
+
+private:
+    // Return the Eytzinger position of the first sample whose prefix is
+    // not less than (strict is false) or greater than (strict is true)
+    // key_prefix, 0 if there is none
+    size_t _search(uint64_t key_prefix, bool strict) const;
+
+    void _build(const std::vector<uint64_t>& samples, size_t* sample, size_t pos);
+
+    uint32_t _interval;
+    // prefixes of the samples in Eytzinger order, starting at 1
+    std::vector<uint64_t> _prefixes;
+    // entry of each sample
+    std::vector<uint32_t> _entries;
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_KEY_PREFIX_INDEX_H
@@ -0,0 +1,143 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_LOSER_TREE_H
+#define DORIS_BE_SRC_OLAP_LOSER_TREE_H
+
+#include <vector>
+
+namespace doris {
+
+// Tournament tree to merge sorted sources. Every inner node keeps the loser
+// of the match played there and the root keeps the winner, so after the
+// winner moves to its next item only the matches on its path are replayed,
+// one comparison per level instead of the two of a binary heap.
+//
+// When one source wins twice in a row, the best of the other sources is
+// looked up once. As long as the winner's next item still beats it, the
+// winner is kept without playing any match, so a long run of one source
+// costs one comparison per item.
+//
+// Less is a strict weak ordering on T. A nullptr item marks an exhausted
+// source, which loses to every item.
+template <class T, class Less>
+class LoserTree {
+public:
+    explicit LoserTree(const Less& less = Less()) : _less(less) { }
+
+    // Build the tree over the current item of each source.
+    void init(const std::vector<T*>& items) {
+        _items = items;
+        _num_sources = _items.size();
+        _second_valid = false;
+        _nodes.assign(_num_sources > 0 ? _num_sources : 1, -1);
+        if (_num_sources == 0) {
+            return;
+        }
+        // Leaves are at [_num_sources, 2 * _num_sources), node n plays the
+        // winners of nodes 2n and 2n + 1.
+        std::vector<int> winners(2 * _num_sources);
+        for (int i = 0; i < _num_sources; ++i) {
+            winners[_num_sources + i] = i;
+        }
+        for (int n = _num_sources - 1; n > 0; --n) {
+            int left = winners[2 * n];
+            int right = winners[2 * n + 1];
+            if (_beats(right, left)) {
+                winners[n] = right;
+                _nodes[n] = left;
+            } else {
+                winners[n] = left;
+                _nodes[n] = right;
+            }
+        }
+        _nodes[0] = _num_sources == 1 ? 0 : winners[1];
+    }
+
+    // Current item of the winning source, nullptr if all are exhausted.
+    T* top() const {
+        return _num_sources > 0 ? _items[_nodes[0]] : nullptr;
+    }
+
+    // Index of the winning source, as in the vector passed to init.
+    int top_source() const {
+        return _nodes[0];
+    }
+
+    // Replace the item of the winning source with its next one, nullptr if
+    // it is exhausted, and find the new winner.
+    void next(T* item) {
+        int last_winner = _nodes[0];
+        _items[last_winner] = item;
+        if (_second_valid && (_second < 0 || _beats(last_winner, _second))) {
+            // winner still beats every other source
+            return;
+        }
+        int winner = last_winner;
+        for (int n = (last_winner + _num_sources) / 2; n > 0; n /= 2) {
+            if (_beats(_nodes[n], winner)) {
+                int loser = winner;
+                winner = _nodes[n];
+                _nodes[n] = loser;
+            }
+        }
+        _nodes[0] = winner;
+        _second_valid = false;
+        if (winner == last_winner) {
+            _second = _best_loser(winner);
+            _second_valid = true;
+        }
+    }
+
+private:
+    // true if source a wins the match against source b, ties go to b
+    bool _beats(int a, int b) const {
+        if (_items[a] == nullptr) {
+            return false;
+        }
+        if (_items[b] == nullptr) {
+            return true;
+        }
+        return _less(*_items[a], *_items[b]);
+    }
+
+    // The best source other than winner lost to winner in one of the
+    // matches on winner's path.
+    int _best_loser(int winner) const {
+        int best = -1;
+        for (int n = (winner + _num_sources) / 2; n > 0; n /= 2) {
+            if (best < 0 || _beats(_nodes[n], best)) {
+                best = _nodes[n];
+            }
+        }
+        return best;
+    }
+
+    Less _less;
+    std::vector<T*> _items;
+    int _num_sources = 0;
+    // _nodes[0] is the winner, _nodes[n] the loser of the match at node n
+    std::vector<int> _nodes;
+    // best source other than the winner, -1 if there is none. Only valid
+    // while the winner has not changed since it was found.
+    int _second = -1;
+    bool _second_valid = false;
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_LOSER_TREE_H
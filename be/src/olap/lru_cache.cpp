@@ -7,11 +7,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 
 #include <rapidjson/document.h>
 
+#include "common/config.h"
 #include "olap/olap_common.h"
 #include "olap/olap_define.h"
 #include "olap/olap_index.h"
@@ -65,6 +67,85 @@ uint32_t CacheKey::hash(const char* data, size_t n, uint32_t seed) const {
 Cache::~Cache() {
 }
 
+bool parse_cache_eviction_policy(const std::string& name, CacheEvictionPolicy* eviction) {
+    if (name == "lru") {
+        *eviction = CACHE_EVICTION_LRU;
+    } else if (name == "slru") {
+        *eviction = CACHE_EVICTION_SLRU;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+CachePolicy cache_policy_from_config() {
+    CachePolicy policy;
+    if (!parse_cache_eviction_policy(config::cache_eviction_policy, &policy.eviction)) {
+        LOG(WARNING) << "unknown cache_eviction_policy " << config::cache_eviction_policy
+                     << ", use lru";
+    }
+    policy.protected_ratio = config::cache_slru_protected_percent / 100.0;
+    policy.tinylfu_admission = config::cache_tinylfu_admission;
+    return policy;
+}
+
+void FrequencySketch::ensure_capacity(size_t num_entries) {
+    if (num_entries * 4 <= _width) {
+        return;
+    }
+    size_t width = 64;
+    while (width < num_entries * 4) {
+        width *= 2;
+    }
+    _width = width;
+    _counters.assign(kNumRows * _width, 0);
+    _num_increments = 0;
+}
+
+size_t FrequencySketch::_index(uint32_t hash, int row) const {
+    static const uint64_t seeds[kNumRows] = {
+        0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL,
+        0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL
+    };
+    uint64_t h = (static_cast<uint64_t>(hash) + 1) * seeds[row];
+    return row * _width + ((h >> 32) & (_width - 1));
+}
+
+uint32_t FrequencySketch::frequency(uint32_t hash) const {
+    if (_width == 0) {
+        return 0;
+    }
+    uint32_t count = kMaxCount;
+    for (int row = 0; row < kNumRows; ++row) {
+        count = std::min<uint32_t>(count, _counters[_index(hash, row)]);
+    }
+    return count;
+}
+
+void FrequencySketch::increment(uint32_t hash) {
+    uint32_t count = frequency(hash);
+    if (_width == 0 || count == kMaxCount) {
+        return;
+    }
+    // only the smallest counters, which overestimate the least
+    for (int row = 0; row < kNumRows; ++row) {
+        uint8_t& counter = _counters[_index(hash, row)];
+        if (counter == count) {
+            ++counter;
+        }
+    }
+    if (++_num_increments >= 10 * _width) {
+        _halve();
+    }
+}
+
+void FrequencySketch::_halve() {
+    for (uint8_t& counter : _counters) {
+        counter >>= 1;
+    }
+    _num_increments /= 2;
+}
+
 // LRU cache implementation
 LRUHandle* HandleTable::lookup(const CacheKey& key, uint32_t hash) {
     return *_find_pointer(key, hash);
@@ -161,24 +242,28 @@ bool HandleTable::_resize() {
     return true;
 }
 
-LRUCache::LRUCache() : _usage(0), _last_id(0), _lookup_count(0),
-    _hit_count(0) {
+LRUCache::LRUCache() : _capacity(0), _protected_capacity(0), _usage(0), _last_id(0),
+    _protected_usage(0), _lookup_count(0), _hit_count(0), _rejected_count(0) {
         // Make empty circular linked list
         _lru.next = &_lru;
         _lru.prev = &_lru;
+        _protected.next = &_protected;
+        _protected.prev = &_protected;
         _in_use.next = &_in_use;
         _in_use.prev = &_in_use;
     }
 
 LRUCache::~LRUCache() {
     assert(_in_use.next == &_in_use);  // Error if caller has an unreleased handle
-    for (LRUHandle* e = _lru.next; e != &_lru;) {
-        LRUHandle* next = e->next;
-        assert(e->in_cache);
-        e->in_cache = false;
-        assert(e->refs == 1);  // Invariant of _lru list.
-        _unref(e);
-        e = next;
+    for (LRUHandle* list : {&_lru, &_protected}) {
+        for (LRUHandle* e = list->next; e != list;) {
+            LRUHandle* next = e->next;
+            assert(e->in_cache);
+            e->in_cache = false;
+            assert(e->refs == 1);  // Invariant of _lru list.
+            _unref(e);
+            e = next;
+        }
     }
 }
 
@@ -204,7 +289,7 @@ void LRUCache::_unref(LRUHandle* e) {
         free(e);
     } else if (e->in_cache && e->refs == 1) {  // No longer in use; move to lru_ list.
         _lru_remove(e);
-        _lru_append(&_lru, e);
+        _lru_append(e->in_protected ? &_protected : &_lru, e);
     }
 }
 
@@ -224,11 +309,20 @@ void LRUCache::_lru_append(LRUHandle* list, LRUHandle* e) {
 Cache::Handle* LRUCache::lookup(const CacheKey& key, uint32_t hash) {
     MutexLock l(&_mutex);
     ++_lookup_count;
+    if (_policy.tinylfu_admission) {
+        _sketch.ensure_capacity(_table.size() + 1);
+        _sketch.increment(hash);
+    }
     LRUHandle* e = _table.lookup(key, hash);
 
     if (e != NULL) {
         ++_hit_count;
         _ref(e);
+        if (_policy.eviction == CACHE_EVICTION_SLRU && !e->in_protected) {
+            e->in_protected = true;
+            _protected_usage += e->charge;
+            _demote_protected();
+        }
     }
 
     return reinterpret_cast<Cache::Handle*>(e);
@@ -252,10 +346,24 @@ Cache::Handle* LRUCache::insert(
     e->key_length = key.size();
     e->hash = hash;
     e->in_cache = false;
+    e->in_protected = false;
     e->refs = 1;  // for the returned handle.
     memcpy(e->key_data, key.data(), key.size());
 
-    if (_capacity > 0) {
+    bool admit = _capacity > 0;
+    if (admit && _policy.tinylfu_admission && _usage + charge > _capacity
+            && _table.lookup(key, hash) == NULL) {
+        // A new key has to be looked up more often than the key it evicts.
+        // A rejected entry is still returned, it is deleted when released.
+        _sketch.ensure_capacity(_table.size() + 1);
+        LRUHandle* victim = _victim();
+        if (victim != NULL && _sketch.frequency(hash) <= _sketch.frequency(victim->hash)) {
+            admit = false;
+            ++_rejected_count;
+        }
+    }
+
+    if (admit) {
         e->refs++;  // for the cache's reference.
         e->in_cache = true;
         _lru_append(&_in_use, e);
@@ -263,8 +371,11 @@ Cache::Handle* LRUCache::insert(
         _finish_erase(_table.insert(e));
     } // else don't cache.  (Tests use capacity_==0 to turn off caching.)
 
-    while (_usage > _capacity && _lru.next != &_lru) {
-        LRUHandle* old = _lru.next;
+    while (_usage > _capacity) {
+        LRUHandle* old = _victim();
+        if (old == NULL) {
+            break;
+        }
         assert(old->refs == 1);
         bool erased = _finish_erase(_table.remove(old->key(), old->hash));
         if (!erased) {  // to avoid unused variable when compiled NDEBUG
@@ -275,6 +386,26 @@ Cache::Handle* LRUCache::insert(
     return reinterpret_cast<Cache::Handle*>(e);
 }
 
+LRUHandle* LRUCache::_victim() {
+    if (_lru.next != &_lru) {
+        return _lru.next;
+    }
+    if (_protected.next != &_protected) {
+        return _protected.next;
+    }
+    return NULL;
+}
+
+void LRUCache::_demote_protected() {
+    while (_protected_usage > _protected_capacity && _protected.next != &_protected) {
+        LRUHandle* e = _protected.next;
+        _lru_remove(e);
+        e->in_protected = false;
+        _protected_usage -= e->charge;
+        _lru_append(&_lru, e);
+    }
+}
+
 // If e != NULL, finish removing *e from the cache; it has already been removed
 // from the hash table.  Return whether e != NULL.  Requires mutex_ held.
 bool LRUCache::_finish_erase(LRUHandle* e) {
@@ -283,6 +414,10 @@ bool LRUCache::_finish_erase(LRUHandle* e) {
         _lru_remove(e);
         e->in_cache = false;
         _usage -= e->charge;
+        if (e->in_protected) {
+            e->in_protected = false;
+            _protected_usage -= e->charge;
+        }
         _unref(e);
     }
     return e != NULL;
@@ -296,8 +431,7 @@ void LRUCache::erase(const CacheKey& key, uint32_t hash) {
 int LRUCache::prune() {
     MutexLock l(&_mutex);
     int num_prune = 0;
-    while (_lru.next != &_lru) {
-        LRUHandle* e = _lru.next;
+    for (LRUHandle* e = _victim(); e != NULL; e = _victim()) {
         assert(e->refs == 1);
         bool erased = _finish_erase(_table.remove(e->key(), e->hash));
         if (!erased) {  // to avoid unused variable when compiled NDEBUG
@@ -316,11 +450,12 @@ uint32_t ShardedLRUCache::_shard(uint32_t hash) {
     return hash >> (32 - kNumShardBits);
 }
 
-ShardedLRUCache::ShardedLRUCache(size_t capacity)
-    : _last_id(0) {
+ShardedLRUCache::ShardedLRUCache(size_t capacity, const CachePolicy& policy)
+    : _policy(policy), _last_id(0) {
         const size_t per_shard = (capacity + (kNumShards - 1)) / kNumShards;
 
         for (int s = 0; s < kNumShards; s++) {
+            _shards[s].set_policy(policy);
             _shards[s].set_capacity(per_shard);
         }
     }
@@ -404,13 +539,28 @@ void ShardedLRUCache::get_cache_status(rapidjson::Document* document) {
         }
 
         shard_info.AddMember("hit_ratio", hit_ratio, document->GetAllocator());
+        shard_info.AddMember("eviction_policy",
+                rapidjson::StringRef(_policy.eviction == CACHE_EVICTION_SLRU ? "slru" : "lru"),
+                document->GetAllocator());
+        shard_info.AddMember("tinylfu_admission", _policy.tinylfu_admission,
+                document->GetAllocator());
+        shard_info.AddMember("protected_usage",
+                static_cast<double>(_shards[i].get_protected_usage()),
+                document->GetAllocator());
+        shard_info.AddMember("rejected_count",
+                static_cast<double>(_shards[i].get_rejected_count()),
+                document->GetAllocator());
         document->PushBack(shard_info, document->GetAllocator());
     }
 
 }
 
 Cache* new_lru_cache(size_t capacity) {
-    return new ShardedLRUCache(capacity);
+    return new ShardedLRUCache(capacity, CachePolicy());
+}
+
+Cache* new_cache(size_t capacity, const CachePolicy& policy) {
+    return new ShardedLRUCache(capacity, policy);
 }
 
 }  // namespace doris
@@ -9,6 +9,7 @@
 #include <string.h>
 
 #include <string>
+#include <vector>
 
 #include <rapidjson/document.h>
 
@@ -44,10 +45,40 @@ namespace doris {
     class Cache;
     class CacheKey;
 
+    enum CacheEvictionPolicy {
+        CACHE_EVICTION_LRU,
+        // Segmented LRU: entries enter a probationary segment and move to a
+        // protected segment when they are looked up again. Entries are
+        // evicted from the probationary segment first, so a scan that reads
+        // every entry once does not evict the entries used repeatedly.
+        CACHE_EVICTION_SLRU,
+    };
+
+    struct CachePolicy {
+        CacheEvictionPolicy eviction = CACHE_EVICTION_LRU;
+        // part of the capacity for the protected segment of SLRU
+        double protected_ratio = 0.8;
+        // TinyLFU: when the cache is full, admit a new entry only if its
+        // key was looked up more often than the key of the entry it would
+        // evict. Lookup frequencies are estimated with a sketch.
+        bool tinylfu_admission = false;
+    };
+
+    // Parse "lru" or "slru". Return false for other names.
+    bool parse_cache_eviction_policy(const std::string& name, CacheEvictionPolicy* eviction);
+
+    // Policy of the storage engine caches, from cache_eviction_policy,
+    // cache_slru_protected_percent and cache_tinylfu_admission of config.
+    CachePolicy cache_policy_from_config();
+
     // Create a new cache with a fixed size capacity.  This implementation
     // of Cache uses a least-recently-used eviction policy.
     extern Cache* new_lru_cache(size_t capacity);
 
+    // Create a new cache with a fixed size capacity and the given eviction
+    // and admission policy.
+    extern Cache* new_cache(size_t capacity, const CachePolicy& policy);
+
     class CacheKey {
         public:
             CacheKey() : _data(NULL), _size(0) {}
@@ -232,6 +263,7 @@ namespace doris {
         size_t charge;
         size_t key_length;
         bool in_cache;      // Whether entry is in the cache.
+        bool in_protected;  // Whether entry is in the protected segment of SLRU.
         uint32_t refs;
         uint32_t hash;      // Hash of key(); used for fast sharding and comparisons
         char key_data[1];   // Beginning of key
@@ -269,6 +301,10 @@ namespace doris {
 
             LRUHandle* remove(const CacheKey& key, uint32_t hash);
 
+            uint32_t size() const {
+                return _elems;
+            }
+
         private:
             // The table consists of an array of buckets where each bucket is
             // a linked list of cache entries that hash into the bucket.
@@ -284,6 +320,33 @@ namespace doris {
     };
 
     // A single shard of sharded cache.
+    // Estimated lookup frequency of keys for TinyLFU admission. A count-min
+    // sketch of 4 rows of counters saturating at 15. All counters are halved
+    // after 10 increments per counter of a row, so that old lookups fade.
+    class FrequencySketch {
+        public:
+            // Keep about four counters per row for each cached entry, so
+            // that few keys share counters. Growing the sketch forgets the
+            // counts.
+            void ensure_capacity(size_t num_entries);
+
+            void increment(uint32_t hash);
+
+            uint32_t frequency(uint32_t hash) const;
+
+        private:
+            static const int kNumRows = 4;
+            static const uint8_t kMaxCount = 15;
+
+            size_t _index(uint32_t hash, int row) const;
+            void _halve();
+
+            // kNumRows rows of _width counters
+            std::vector<uint8_t> _counters;
+            size_t _width = 0;
+            size_t _num_increments = 0;
+    };
+
     class LRUCache {
         public:
             LRUCache();
@@ -292,6 +355,13 @@ namespace doris {
             // Separate from constructor so caller can easily make an array of LRUCache
             void set_capacity(size_t capacity) {
                 _capacity = capacity;
+                _protected_capacity = _policy.eviction == CACHE_EVICTION_SLRU
+                    ? static_cast<size_t>(capacity * _policy.protected_ratio) : 0;
+            }
+
+            // Called before set_capacity
+            void set_policy(const CachePolicy& policy) {
+                _policy = policy;
             }
 
             // Like Cache methods, but with an extra "hash" parameter.
@@ -318,6 +388,12 @@ namespace doris {
             size_t get_capacity() {
                 return _capacity;
             }
+            size_t get_protected_usage() {
+                return _protected_usage;
+            }
+            uint64_t get_rejected_count() {
+                return _rejected_count;
+            }
 
         private:
             void _lru_remove(LRUHandle* e);
@@ -325,9 +401,16 @@ namespace doris {
             void _ref(LRUHandle* e);
             void _unref(LRUHandle* e);
             bool _finish_erase(LRUHandle* e);
+            // Next entry to evict, NULL if every entry is in use
+            LRUHandle* _victim();
+            // Move entries from the protected segment to the probationary one
+            // until the protected segment fits its capacity
+            void _demote_protected();
 
             // Initialized before use.
             size_t _capacity;
+            CachePolicy _policy;
+            size_t _protected_capacity;
 
             // _mutex protects the following state.
             Mutex _mutex;
@@ -337,8 +420,15 @@ namespace doris {
             // Dummy head of LRU list.
             // lru.prev is newest entry, lru.next is oldest entry.
             // Entries have refs==1 and in_cache==true.
+            // With SLRU this is the probationary segment.
             LRUHandle _lru;
 
+            // Dummy head of the protected segment of SLRU, ordered as _lru.
+            // Entries have refs==1, in_cache==true and in_protected==true.
+            LRUHandle _protected;
+            // charge of entries in the protected segment, in use ones included
+            size_t _protected_usage;
+
             // Dummy head of in-use list.
             // Entries are in use by clients, and have refs >= 2 and in_cache==true.
             LRUHandle _in_use;
@@ -347,6 +437,9 @@ namespace doris {
 
             uint64_t _lookup_count;    // cache查找总次数
             uint64_t _hit_count;       // 命中cache的总次数
+
+            FrequencySketch _sketch;
+            uint64_t _rejected_count;  // new entries not admitted by TinyLFU
     };
 
     static const int kNumShardBits = 4;
@@ -354,7 +447,7 @@ namespace doris {
 
     class ShardedLRUCache : public Cache {
         public:
-            explicit ShardedLRUCache(size_t capacity);
+            ShardedLRUCache(size_t capacity, const CachePolicy& policy);
             // TODO(fdy): 析构时清除所有cache元素
             virtual ~ShardedLRUCache() {}
             virtual Handle* insert(
@@ -376,6 +469,7 @@ namespace doris {
             static uint32_t _shard(uint32_t hash);
 
             LRUCache _shards[kNumShards];
+            CachePolicy _policy;
             Mutex _id_mutex;
             uint64_t _last_id;
     };
@@ -17,9 +17,13 @@
 
 #include "olap/memtable.h"
 
+#include <algorithm>
+
+#include "common/config.h"
 #include "olap/hll.h"
 #include "olap/data_writer.h"
 #include "olap/row_cursor.h"
+#include "util/hash_util.hpp"
 #include "util/runtime_profile.h"
 #include "util/debug_util.h"
 
@@ -27,20 +31,32 @@ namespace doris {
 
 MemTable::MemTable(Schema* schema, std::vector<FieldInfo>* field_infos,
                    std::vector<uint32_t>* col_ids, TupleDescriptor* tuple_desc,
-                   KeysType keys_type)
+                   KeysType keys_type, int num_shards)
     : _schema(schema),
       _field_infos(field_infos),
       _tuple_desc(tuple_desc),
       _col_ids(col_ids),
       _keys_type(keys_type),
-      _row_comparator(_schema) {
+      _row_comparator(_schema),
+      _sort_on_flush(keys_type == KeysType::DUP_KEYS
+                     ? config::memtable_sort_dup_keys_on_flush
+                     : config::memtable_hash_aggregate),
+      _aggregate_in_hash(keys_type != KeysType::DUP_KEYS && config::memtable_hash_aggregate) {
     _schema_size = _schema->schema_size();
-    _tuple_buf = _arena.Allocate(_schema_size);
-    _skip_list = new Table(_row_comparator, &_arena);
+    for (int i = 0; i < std::max(num_shards, 1); ++i) {
+        _shards.emplace_back(new Shard(_row_comparator, _schema_size));
+    }
+}
+
+MemTable::~MemTable() {}
+
+MemTable::Shard::Shard(const RowCursorComparator& comparator, size_t schema_size) {
+    tuple_buf = arena.Allocate(schema_size);
+    skip_list = new Table(comparator, &arena);
 }
 
-MemTable::~MemTable() {
-    delete _skip_list;
+MemTable::Shard::~Shard() {
+    delete skip_list;
 }
 
 MemTable::RowCursorComparator::RowCursorComparator(const Schema* schema)
@@ -52,17 +68,133 @@ int MemTable::RowCursorComparator::operator()
 }
 
 size_t MemTable::memory_usage() {
-    return _arena.MemoryUsage();
+    size_t usage = 0;
+    for (auto& shard : _shards) {
+        usage += shard->arena.MemoryUsage() + shard->index_bytes;
+    }
+    return usage;
+}
+
+// The hash must agree with Schema::compare, so values are hashed in the form
+// they are stored in: CHAR without its zero padding, DATE, DATETIME and
+// DECIMAL in their storage encoding.
+uint32_t MemTable::_hash_key(Tuple* tuple) const {
+    static const uint8_t NULL_MARKER = 0;
+    const std::vector<SlotDescriptor*>& slots = _tuple_desc->slots();
+    uint32_t hash = 0;
+    for (size_t i = 0; i < _schema->num_key_columns(); ++i) {
+        const SlotDescriptor* slot = slots[(*_col_ids)[i]];
+        if (tuple->is_null(slot->null_indicator_offset())) {
+            hash = HashUtil::hash(&NULL_MARKER, sizeof(NULL_MARKER), hash);
+            continue;
+        }
+        switch (slot->type().type) {
+            case TYPE_CHAR: {
+                const StringValue* value = tuple->get_string_slot(slot->tuple_offset());
+                int len = value->len;
+                while (len > 0 && value->ptr[len - 1] == '\0') {
+                    --len;
+                }
+                hash = HashUtil::hash(value->ptr, len, hash);
+                break;
+            }
+            case TYPE_VARCHAR: {
+                const StringValue* value = tuple->get_string_slot(slot->tuple_offset());
+                hash = HashUtil::hash(value->ptr, value->len, hash);
+                break;
+            }
+            case TYPE_DECIMAL: {
+                DecimalValue* value = tuple->get_decimal_slot(slot->tuple_offset());
+                decimal12_t storage_value(value->int_value(), value->frac_value());
+                hash = HashUtil::hash(&storage_value, sizeof(storage_value), hash);
+                break;
+            }
+            case TYPE_DATETIME: {
+                DateTimeValue* value = tuple->get_datetime_slot(slot->tuple_offset());
+                uint64_t storage_value = value->to_olap_datetime();
+                hash = HashUtil::hash(&storage_value, sizeof(storage_value), hash);
+                break;
+            }
+            case TYPE_DATE: {
+                DateTimeValue* value = tuple->get_datetime_slot(slot->tuple_offset());
+                uint64_t storage_value = value->to_olap_date();
+                hash = HashUtil::hash(&storage_value, sizeof(storage_value), hash);
+                break;
+            }
+            default: {
+                hash = HashUtil::hash(tuple->get_slot(slot->tuple_offset()),
+                                      _schema->get_col_size(i), hash);
+                break;
+            }
+        }
+    }
+    return hash;
 }
 
 void MemTable::insert(Tuple* tuple) {
+    uint32_t hash = 0;
+    if (_shards.size() > 1 || _aggregate_in_hash) {
+        hash = _hash_key(tuple);
+    }
+    Shard* shard = _shards[hash % _shards.size()].get();
+    std::lock_guard<std::mutex> l(shard->lock);
+    _insert(tuple, hash, shard);
+}
+
+// Slots are picked by the high bits of the hash multiplied by a 64 bit odd
+// constant, the low bits of the hash are the same for all rows of a shard.
+static inline size_t slot_of(uint32_t hash, size_t mask) {
+    return (static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL >> 32) & mask;
+}
+
+size_t MemTable::_find_slot(const Shard* shard, const char* row, uint32_t hash) const {
+    size_t mask = shard->slots.size() - 1;
+    size_t slot = slot_of(hash, mask);
+    while (shard->slots[slot] != nullptr) {
+        if (shard->slot_hashes[slot] == hash && _row_comparator(shard->slots[slot], row) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+bool MemTable::_contains(Shard* shard, const char* row, uint32_t hash) const {
+    if (_aggregate_in_hash) {
+        return !shard->slots.empty() && shard->slots[_find_slot(shard, row, hash)] != nullptr;
+    }
+    return shard->skip_list->Contains(const_cast<char*>(row));
+}
+
+void MemTable::_grow_hash_index(Shard* shard) {
+    static const size_t INITIAL_SLOT_NUM = 1024;
+    size_t num_slots = std::max(shard->slots.size() * 2, INITIAL_SLOT_NUM);
+    std::vector<char*> slots(num_slots, nullptr);
+    std::vector<uint32_t> slot_hashes(num_slots, 0);
+    size_t mask = num_slots - 1;
+    for (size_t i = 0; i < shard->slots.size(); ++i) {
+        if (shard->slots[i] == nullptr) {
+            continue;
+        }
+        size_t slot = slot_of(shard->slot_hashes[i], mask);
+        while (slots[slot] != nullptr) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = shard->slots[i];
+        slot_hashes[slot] = shard->slot_hashes[i];
+    }
+    shard->slots.swap(slots);
+    shard->slot_hashes.swap(slot_hashes);
+}
+
+void MemTable::_insert(Tuple* tuple, uint32_t hash, Shard* shard) {
     const std::vector<SlotDescriptor*>& slots = _tuple_desc->slots();
     size_t offset = 0;
     for (size_t i = 0; i < _col_ids->size(); ++i) {
         const SlotDescriptor* slot = slots[(*_col_ids)[i]];
-        _schema->set_not_null(i, _tuple_buf);
+        _schema->set_not_null(i, shard->tuple_buf);
         if (tuple->is_null(slot->null_indicator_offset())) {
-            _schema->set_null(i, _tuple_buf);
+            _schema->set_null(i, shard->tuple_buf);
             offset += _schema->get_col_size(i) + 1;
             continue;
         }
@@ -71,37 +203,37 @@ void MemTable::insert(Tuple* tuple) {
         switch (type.type) {
             case TYPE_CHAR: {
                 const StringValue* src = tuple->get_string_slot(slot->tuple_offset());
-                Slice* dest = (Slice*)(_tuple_buf + offset);
+                Slice* dest = (Slice*)(shard->tuple_buf + offset);
                 dest->size = (*_field_infos)[i].length;
-                dest->data = _arena.Allocate(dest->size);
+                dest->data = shard->arena.Allocate(dest->size);
                 memcpy(dest->data, src->ptr, src->len);
                 memset(dest->data + src->len, 0, dest->size - src->len);
                 break;
             }
             case TYPE_VARCHAR: {
                 const StringValue* src = tuple->get_string_slot(slot->tuple_offset());
-                Slice* dest = (Slice*)(_tuple_buf + offset);
+                Slice* dest = (Slice*)(shard->tuple_buf + offset);
                 dest->size = src->len;
-                dest->data = _arena.Allocate(dest->size);
+                dest->data = shard->arena.Allocate(dest->size);
                 memcpy(dest->data, src->ptr, dest->size);
                 break;
             }
             case TYPE_HLL: {
                 const StringValue* src = tuple->get_string_slot(slot->tuple_offset());
-                Slice* dest = (Slice*)(_tuple_buf + offset);
+                Slice* dest = (Slice*)(shard->tuple_buf + offset);
                 dest->size = src->len;
-                bool exist = _skip_list->Contains(_tuple_buf);
+                bool exist = _contains(shard, shard->tuple_buf, hash);
                 if (exist) {
-                    dest->data = _arena.Allocate(dest->size);
+                    dest->data = shard->arena.Allocate(dest->size);
                     memcpy(dest->data, src->ptr, dest->size);
                 } else {
                     dest->data = src->ptr;
-                    char* mem = _arena.Allocate(sizeof(HllContext));
+                    char* mem = shard->arena.Allocate(sizeof(HllContext));
                     HllContext* context = new (mem) HllContext;
                     HllSetHelper::init_context(context);
                     HllSetHelper::fill_set(reinterpret_cast<char*>(dest), context);
                     context->has_value = true;
-                    char* variable_ptr = _arena.Allocate(sizeof(HllContext*) + HLL_COLUMN_DEFAULT_LEN);
+                    char* variable_ptr = shard->arena.Allocate(sizeof(HllContext*) + HLL_COLUMN_DEFAULT_LEN);
                     *(size_t*)(variable_ptr) = (size_t)(context);
                     variable_ptr += sizeof(HllContext*);
                     dest->data = variable_ptr;
@@ -111,46 +243,122 @@ void MemTable::insert(Tuple* tuple) {
             }
             case TYPE_DECIMAL: {
                 DecimalValue* decimal_value = tuple->get_decimal_slot(slot->tuple_offset());
-                decimal12_t* storage_decimal_value = reinterpret_cast<decimal12_t*>(_tuple_buf + offset);
+                decimal12_t* storage_decimal_value = reinterpret_cast<decimal12_t*>(shard->tuple_buf + offset);
                 storage_decimal_value->integer = decimal_value->int_value();
                 storage_decimal_value->fraction = decimal_value->frac_value();
                 break;
             }
             case TYPE_DATETIME: {
                 DateTimeValue* datetime_value = tuple->get_datetime_slot(slot->tuple_offset());
-                uint64_t* storage_datetime_value = reinterpret_cast<uint64_t*>(_tuple_buf + offset);
+                uint64_t* storage_datetime_value = reinterpret_cast<uint64_t*>(shard->tuple_buf + offset);
                 *storage_datetime_value = datetime_value->to_olap_datetime();
                 break;
             }
             case TYPE_DATE: {
                 DateTimeValue* date_value = tuple->get_datetime_slot(slot->tuple_offset());
-                uint24_t* storage_date_value = reinterpret_cast<uint24_t*>(_tuple_buf + offset);
+                uint24_t* storage_date_value = reinterpret_cast<uint24_t*>(shard->tuple_buf + offset);
                 *storage_date_value = static_cast<int64_t>(date_value->to_olap_date());
                 break;
             }
             default: {
-                memcpy(_tuple_buf + offset, tuple->get_slot(slot->tuple_offset()), _schema->get_col_size(i));
+                memcpy(shard->tuple_buf + offset, tuple->get_slot(slot->tuple_offset()), _schema->get_col_size(i));
                 break;
             }
         }
         offset = offset + _schema->get_col_size(i);
     }
 
+    if (_aggregate_in_hash) {
+        if (shard->slots.empty()) {
+            _grow_hash_index(shard);
+        }
+        size_t slot = _find_slot(shard, shard->tuple_buf, hash);
+        if (shard->slots[slot] != nullptr) {
+            // the buffer is reused for the next row
+            _schema->aggregate(shard->slots[slot], shard->tuple_buf, &shard->arena);
+            return;
+        }
+        shard->slots[slot] = shard->tuple_buf;
+        shard->slot_hashes[slot] = hash;
+        shard->rows.push_back(shard->tuple_buf);
+        // keep the load factor at most 1/2
+        if (shard->rows.size() * 2 > shard->slots.size()) {
+            _grow_hash_index(shard);
+        }
+        shard->index_bytes = shard->rows.capacity() * sizeof(char*)
+                + shard->slots.size() * (sizeof(char*) + sizeof(uint32_t));
+        shard->tuple_buf = shard->arena.Allocate(_schema_size);
+        return;
+    }
+    if (_sort_on_flush) {
+        shard->rows.push_back(shard->tuple_buf);
+        shard->index_bytes = shard->rows.capacity() * sizeof(char*);
+        shard->tuple_buf = shard->arena.Allocate(_schema_size);
+        return;
+    }
+
     bool overwritten = false;
-    _skip_list->Insert(_tuple_buf, &overwritten, _keys_type);
+    shard->skip_list->Insert(shard->tuple_buf, &overwritten, _keys_type);
     if (!overwritten) {
-        _tuple_buf = _arena.Allocate(_schema_size);
+        shard->tuple_buf = shard->arena.Allocate(_schema_size);
+    }
+}
+
+OLAPStatus MemTable::_visit_sorted_rows(
+        const std::function<OLAPStatus(const char*)>& visitor) {
+    if (_sort_on_flush) {
+        std::vector<char*> rows;
+        if (_shards.size() == 1) {
+            rows.swap(_shards[0]->rows);
+        } else {
+            size_t num_rows = 0;
+            for (auto& shard : _shards) {
+                num_rows += shard->rows.size();
+            }
+            rows.reserve(num_rows);
+            for (auto& shard : _shards) {
+                rows.insert(rows.end(), shard->rows.begin(), shard->rows.end());
+            }
+        }
+        std::sort(rows.begin(), rows.end(), [this](const char* left, const char* right) {
+            return _row_comparator(left, right) < 0;
+        });
+        for (const char* row : rows) {
+            RETURN_NOT_OK(visitor(row));
+        }
+        return OLAP_SUCCESS;
+    }
+
+    std::vector<Table::Iterator> iters;
+    iters.reserve(_shards.size());
+    for (auto& shard : _shards) {
+        iters.emplace_back(shard->skip_list);
+        iters.back().SeekToFirst();
     }
+    // the number of shards is small, a linear scan for the least key is enough
+    while (true) {
+        Table::Iterator* next = nullptr;
+        for (auto& it : iters) {
+            if (it.Valid() && (next == nullptr || _row_comparator(it.key(), next->key()) < 0)) {
+                next = &it;
+            }
+        }
+        if (next == nullptr) {
+            break;
+        }
+        RETURN_NOT_OK(visitor(next->key()));
+        next->Next();
+    }
+    return OLAP_SUCCESS;
 }
 
 OLAPStatus MemTable::flush(ColumnDataWriter* writer) {
-    Table::Iterator it(_skip_list);
-    for (it.SeekToFirst(); it.Valid(); it.Next()) {
-        const char* row = it.key();
+    RETURN_NOT_OK(_visit_sorted_rows([this, writer](const char* row) -> OLAPStatus {
         _schema->finalize(row);
         RETURN_NOT_OK(writer->write(row));
         writer->next(row, _schema);
-    }
+        return OLAP_SUCCESS;
+    }));
 
     RETURN_NOT_OK(writer->finalize());
     return OLAP_SUCCESS;
@@ -18,7 +18,11 @@
 #ifndef DORIS_BE_SRC_OLAP_MEMTABLE_H
 #define DORIS_BE_SRC_OLAP_MEMTABLE_H
 
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include "olap/schema.h"
 #include "olap/skiplist.h"
@@ -29,17 +33,33 @@ namespace doris {
 class ColumnDataWriter;
 class RowCursor;
 
+// MemTable is split into shards, each a skiplist with its own arena and lock,
+// so that insert() can be called from several threads at once. Rows are routed
+// to a shard by the hash of their key: equal keys always meet in the same shard
+// and are aggregated there in arrival order, and flush only has to merge the
+// sorted shards, whose key sets are disjoint.
+//
+// DUP_KEYS tables never aggregate, so unless memtable_sort_dup_keys_on_flush
+// is off their rows are only appended to the arena and sorted once on flush,
+// instead of being inserted into the skiplist one comparison chain at a time.
+// Likewise AGG_KEYS and UNIQUE_KEYS rows are aggregated in place through an
+// open addressing hash index on the key unless memtable_hash_aggregate is off,
+// and only the distinct rows are sorted on flush.
 class MemTable {
 public:
     MemTable(Schema* schema, std::vector<FieldInfo>* field_infos,
              std::vector<uint32_t>* col_ids, TupleDescriptor* tuple_desc,
-             KeysType keys_type);
+             KeysType keys_type, int num_shards = 1);
     ~MemTable();
     size_t memory_usage();
+    // thread safe, may be called concurrently with other inserts
     void insert(Tuple* tuple);
+    // must not be called concurrently with insert
     OLAPStatus flush(ColumnDataWriter* writer);
     OLAPStatus close(ColumnDataWriter* writer);
 private:
+    friend class TestMemTable;
+
     Schema* _schema;
     std::vector<FieldInfo>* _field_infos;
     TupleDescriptor* _tuple_desc;
@@ -52,13 +72,43 @@ private:
         int operator()(const char* left, const char* right) const;
     };
 
-    RowCursorComparator _row_comparator;
-    Arena _arena;
-
     typedef SkipList<char*, RowCursorComparator> Table;
-    char* _tuple_buf;
+
+    struct Shard {
+        Shard(const RowCursorComparator& comparator, size_t schema_size);
+        ~Shard();
+
+        std::mutex lock;
+        Arena arena;
+        char* tuple_buf;
+        Table* skip_list;
+        // rows in arrival order, only used when sorting on flush
+        std::vector<char*> rows;
+        // hash index on the key of rows, a null slot is empty. only used when
+        // aggregating in the hash index
+        std::vector<char*> slots;
+        std::vector<uint32_t> slot_hashes;
+        // bytes held by rows and the hash index, readable while other shards
+        // insert
+        std::atomic<size_t> index_bytes{0};
+    };
+
+    // hash of the key columns of tuple, equal keys have equal hashes
+    uint32_t _hash_key(Tuple* tuple) const;
+    void _insert(Tuple* tuple, uint32_t hash, Shard* shard);
+    // whether a row with the key of row is already in the shard
+    bool _contains(Shard* shard, const char* row, uint32_t hash) const;
+    // the slot of the row equal to row, or the empty slot it belongs to
+    size_t _find_slot(const Shard* shard, const char* row, uint32_t hash) const;
+    void _grow_hash_index(Shard* shard);
+    // call visitor on every row in key order, stop at the first error
+    OLAPStatus _visit_sorted_rows(const std::function<OLAPStatus(const char*)>& visitor);
+
+    RowCursorComparator _row_comparator;
     size_t _schema_size;
-    Table* _skip_list;
+    bool _sort_on_flush;
+    bool _aggregate_in_hash;
+    std::vector<std::unique_ptr<Shard>> _shards;
 }; // class MemTable
 
 } // namespace doris
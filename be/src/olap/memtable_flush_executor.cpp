@@ -0,0 +1,112 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/memtable_flush_executor.h"
+
+#include <algorithm>
+
+#include "common/config.h"
+#include "olap/data_writer.h"
+#include "olap/memtable.h"
+#include "olap/store.h"
+#include "util/doris_metrics.h"
+#include "util/stopwatch.hpp"
+#include "util/thread_pool.hpp"
+
+namespace doris {
+
+// pending flush tasks are bounded by the per writer limit, the queue of the
+// pool only has to hold them
+static const uint32_t FLUSH_QUEUE_SIZE = 1024;
+
+FlushHandler::FlushHandler(ThreadPool* pool, int max_in_flight)
+    : _pool(pool),
+      _max_in_flight(std::max(max_in_flight, 1)),
+      _in_flight(0),
+      _status(OLAP_SUCCESS) {}
+
+OLAPStatus FlushHandler::submit(MemTable* mem_table, ColumnDataWriter* writer) {
+    {
+        std::unique_lock<std::mutex> l(_lock);
+        while (_in_flight >= _max_in_flight) {
+            _cv.wait(l);
+        }
+        ++_in_flight;
+    }
+    DorisMetrics::memtable_flush_queue_count.increment(1);
+    // the task holds a reference, so the handler outlives its writer if needed
+    std::shared_ptr<FlushHandler> self = shared_from_this();
+    bool offered = _pool->offer([self, mem_table, writer]() {
+        self->_flush(mem_table, writer);
+    });
+    if (!offered) {
+        LOG(WARNING) << "fail to submit memtable to flush pool, it is shut down";
+        _flush(mem_table, writer);
+    }
+
+    std::lock_guard<std::mutex> l(_lock);
+    return _status;
+}
+
+OLAPStatus FlushHandler::wait() {
+    std::unique_lock<std::mutex> l(_lock);
+    while (_in_flight > 0) {
+        _cv.wait(l);
+    }
+    return _status;
+}
+
+void FlushHandler::_flush(MemTable* mem_table, ColumnDataWriter* writer) {
+    DorisMetrics::memtable_flush_queue_count.increment(-1);
+    MonotonicStopWatch watch;
+    watch.start();
+    OLAPStatus st = mem_table->flush(writer);
+    DorisMetrics::memtable_flush_total.increment(1);
+    DorisMetrics::memtable_flush_duration_us.increment(watch.elapsed_time() / 1000);
+    if (st != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to flush memtable. res=" << st;
+    }
+    delete mem_table;
+    delete writer;
+
+    std::lock_guard<std::mutex> l(_lock);
+    if (st != OLAP_SUCCESS && _status == OLAP_SUCCESS) {
+        _status = st;
+    }
+    --_in_flight;
+    _cv.notify_all();
+}
+
+MemTableFlushExecutor::MemTableFlushExecutor() {}
+
+MemTableFlushExecutor::~MemTableFlushExecutor() {}
+
+std::shared_ptr<FlushHandler> MemTableFlushExecutor::create_flush_handler(
+        OlapStore* store, int max_in_flight) {
+    return std::make_shared<FlushHandler>(_get_pool(store), max_in_flight);
+}
+
+ThreadPool* MemTableFlushExecutor::_get_pool(OlapStore* store) {
+    std::lock_guard<std::mutex> l(_lock);
+    std::unique_ptr<ThreadPool>& pool = _pools[store->path()];
+    if (pool == nullptr) {
+        pool.reset(new ThreadPool(config::flush_thread_num_per_store, FLUSH_QUEUE_SIZE));
+    }
+    return pool.get();
+}
+
+} // namespace doris
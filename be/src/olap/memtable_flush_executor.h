@@ -0,0 +1,82 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_MEMTABLE_FLUSH_EXECUTOR_H
+#define DORIS_BE_SRC_OLAP_MEMTABLE_FLUSH_EXECUTOR_H
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "olap/olap_define.h"
+
+namespace doris {
+
+class ColumnDataWriter;
+class MemTable;
+class OlapStore;
+class ThreadPool;
+
+// Tracks the memtables one DeltaWriter has handed over for flushing. At most
+// max_in_flight of them are flushed at a time, submit() blocks beyond that,
+// which is the backpressure on the writer.
+class FlushHandler : public std::enable_shared_from_this<FlushHandler> {
+public:
+    FlushHandler(ThreadPool* pool, int max_in_flight);
+
+    // take ownership of mem_table and writer, flush the former into the latter
+    // in the background and delete both afterwards.
+    // return the first error of a previous flush, if any
+    OLAPStatus submit(MemTable* mem_table, ColumnDataWriter* writer);
+
+    // wait until every submitted memtable is flushed, return the first error
+    OLAPStatus wait();
+
+private:
+    void _flush(MemTable* mem_table, ColumnDataWriter* writer);
+
+    ThreadPool* _pool;
+    const int _max_in_flight;
+
+    std::mutex _lock;
+    std::condition_variable _cv;
+    int _in_flight;
+    OLAPStatus _status;
+};
+
+// Owns the flush threads, one pool per data dir, so that a slow disk only
+// holds back the loads writing to it.
+class MemTableFlushExecutor {
+public:
+    MemTableFlushExecutor();
+    ~MemTableFlushExecutor();
+
+    std::shared_ptr<FlushHandler> create_flush_handler(OlapStore* store, int max_in_flight);
+
+private:
+    ThreadPool* _get_pool(OlapStore* store);
+
+    std::mutex _lock;
+    // store path -> flush thread pool
+    std::map<std::string, std::unique_ptr<ThreadPool>> _pools;
+};
+
+} // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_MEMTABLE_FLUSH_EXECUTOR_H
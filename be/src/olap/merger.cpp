@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "olap/column_data.h"
+#include "olap/columnar_merger.h"
 #include "olap/olap_define.h"
 #include "olap/segment_group.h"
 #include "olap/olap_table.h"
@@ -55,6 +56,11 @@ OLAPStatus Merger::merge(const vector<ColumnData*>& olap_data_arr,
         reader_params.version = _segment_group->version();
     }
 
+    ColumnarMerger columnar_merger(_table, _reader_type, reader_params.version);
+    if (columnar_merger.can_merge(olap_data_arr)) {
+        return _merge_columnar(&columnar_merger, olap_data_arr, merged_rows, filted_rows);
+    }
+
     if (OLAP_SUCCESS != reader.init(reader_params)) {
         OLAP_LOG_WARNING("fail to initiate reader. [table='%s']",
                 _table->full_name().c_str());
@@ -125,4 +131,35 @@ OLAPStatus Merger::merge(const vector<ColumnData*>& olap_data_arr,
     return has_error ? OLAP_ERR_OTHER_ERROR : OLAP_SUCCESS;
 }
 
+OLAPStatus Merger::_merge_columnar(ColumnarMerger* columnar_merger,
+                                   const vector<ColumnData*>& olap_data_arr,
+                                   uint64_t* merged_rows, uint64_t* filted_rows) {
+    unique_ptr<ColumnDataWriter> writer(ColumnDataWriter::create(_table, _segment_group, false));
+    if (NULL == writer) {
+        OLAP_LOG_WARNING("fail to allocate writer.");
+        return OLAP_ERR_MALLOC_ERROR;
+    }
+
+    uint64_t num_merged_rows = 0;
+    uint64_t num_rows = 0;
+    OLAPStatus res = columnar_merger->merge(olap_data_arr, writer.get(),
+                                            &num_merged_rows, &num_rows);
+    _row_count += num_rows;
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "columnar compaction failed. [table=" << _table->full_name()
+                     << " res=" << res << "]";
+        return OLAP_ERR_OTHER_ERROR;
+    }
+
+    if (OLAP_SUCCESS != writer->finalize()) {
+        OLAP_LOG_WARNING("fail to finalize writer. [table='%s']",
+                _table->full_name().c_str());
+        return OLAP_ERR_OTHER_ERROR;
+    }
+
+    *merged_rows = num_merged_rows;
+    *filted_rows = 0;
+    return OLAP_SUCCESS;
+}
+
 }  // namespace doris
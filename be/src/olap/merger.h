@@ -25,6 +25,7 @@ namespace doris {
 
 class SegmentGroup;
 class ColumnData;
+class ColumnarMerger;
 
 class Merger {
 public:
@@ -44,6 +45,10 @@ public:
         return _row_count;
     }
 private:
+    OLAPStatus _merge_columnar(ColumnarMerger* columnar_merger,
+                               const std::vector<ColumnData*>& olap_data_arr,
+                               uint64_t* merged_rows, uint64_t* filted_rows);
+
     OLAPTablePtr _table;
     SegmentGroup* _segment_group;
     ReaderType _reader_type;
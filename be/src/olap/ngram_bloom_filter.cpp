@@ -0,0 +1,57 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/ngram_bloom_filter.h"
+
+namespace doris {
+
+void like_pattern_fragments(const std::string& pattern, std::vector<std::string>* fragments) {
+    std::string fragment;
+    bool is_escaped = false;
+    for (char c : pattern) {
+        if (!is_escaped && c == '\\') {
+            is_escaped = true;
+            continue;
+        }
+        if (!is_escaped && (c == '%' || c == '_')) {
+            if (!fragment.empty()) {
+                fragments->push_back(fragment);
+                fragment.clear();
+            }
+            continue;
+        }
+        fragment.push_back(c);
+        is_escaped = false;
+    }
+    if (!fragment.empty()) {
+        fragments->push_back(fragment);
+    }
+}
+
+void ngram_hashes(const std::vector<std::string>& fragments, size_t gram_size,
+                  std::vector<uint64_t>* hashes) {
+    if (gram_size == 0 || gram_size > MAX_NGRAM_SIZE) {
+        return;
+    }
+    for (const std::string& fragment : fragments) {
+        for (size_t i = 0; i + gram_size <= fragment.size(); ++i) {
+            hashes->push_back(ngram_hash(fragment.data() + i, gram_size));
+        }
+    }
+}
+
+}  // namespace doris
@@ -0,0 +1,90 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_NGRAM_BLOOM_FILTER_H
+#define DORIS_BE_SRC_OLAP_NGRAM_BLOOM_FILTER_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "olap/bloom_filter.hpp"
+
+namespace doris {
+
+// An ngram bloom filter of a row block holds every gram_size bytes long
+// substring of the strings of the block. A string containing a substring
+// of at least gram_size bytes contains all its ngrams, so a block whose
+// filter misses one of them has no row matching LIKE '%substring%'.
+//
+// Ngram filters always have the split block layout, a gram is at most
+// MAX_NGRAM_SIZE bytes.
+static const size_t MAX_NGRAM_SIZE = 8;
+
+// Hash of the gram_size bytes at data
+inline uint64_t ngram_hash(const char* data, size_t gram_size) {
+    uint64_t value = 0;
+    memcpy(&value, data, gram_size);
+    // fmix64 of murmur3, the length keeps grams of different sizes apart
+    value ^= gram_size;
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+// Add the ngrams of the size bytes at data to bf
+inline void add_ngrams(const char* data, size_t size, size_t gram_size, BloomFilter* bf) {
+    for (size_t i = 0; i + gram_size <= size; ++i) {
+        bf->add_hash(ngram_hash(data + i, gram_size));
+    }
+}
+
+// Append the hashes of the ngrams of the size bytes at data to hashes
+inline void add_ngram_hashes(const char* data, size_t size, size_t gram_size,
+                             std::vector<uint64_t>* hashes) {
+    for (size_t i = 0; i + gram_size <= size; ++i) {
+        hashes->push_back(ngram_hash(data + i, gram_size));
+    }
+}
+
+// Split a LIKE pattern into the literal strings between its wildcards,
+// which every matching string contains. '\' escapes the next character.
+void like_pattern_fragments(const std::string& pattern, std::vector<std::string>* fragments);
+
+// Append the hashes of the ngrams of fragments to hashes, fragments
+// shorter than gram_size have none
+void ngram_hashes(const std::vector<std::string>& fragments, size_t gram_size,
+                  std::vector<uint64_t>* hashes);
+
+// Return false if bf misses one of hashes
+inline bool test_ngrams(const BloomFilter& bf, const std::vector<uint64_t>& hashes) {
+    for (uint64_t hash : hashes) {
+        if (!bf.test_hash(hash)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_NGRAM_BLOOM_FILTER_H
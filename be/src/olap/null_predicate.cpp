@@ -17,13 +17,15 @@
 
 #include "olap/field.h"
 #include "olap/null_predicate.h"
+#include "olap/predicate_kernel.h"
+#include "olap/wrapper_field.h"
 #include "runtime/string_value.hpp"
 #include "runtime/vectorized_row_batch.h"
 
 namespace doris {
 
 NullPredicate::NullPredicate(int32_t column_id, bool is_null)
-    : _column_id(column_id), _is_null(is_null) {}
+    : ColumnPredicate(column_id), _is_null(is_null) {}
 
 NullPredicate::~NullPredicate() {}
 
@@ -32,32 +34,25 @@ void NullPredicate::evaluate(VectorizedRowBatch* batch) const {
     if (n == 0) {
         return;
     }
-    uint16_t* sel = batch->selected();
-    bool* null_array = batch->column(_column_id)->is_null();
-    uint16_t new_size = 0;
-    if (batch->column(_column_id)->no_nulls() && _is_null) {
-        batch->set_size(new_size);
-        batch->set_selected_in_use(true);
+    ColumnVector* column = batch->column(_column_id);
+    if (column->no_nulls()) {
+        if (_is_null) {
+            batch->set_size(0);
+            batch->set_selected_in_use(true);
+        }
         return;
     }
+    predicate_kernel::NullMatcher matcher(column->is_null(), _is_null);
+    predicate_kernel::evaluate_batch(matcher, nullptr, batch);
+}
 
-    if (batch->selected_in_use()) {
-        for (uint16_t j = 0; j != n; ++j) {
-            uint16_t i = sel[j];
-            sel[new_size] = i;
-            new_size += (null_array[i] == _is_null); 
-        }
-        batch->set_size(new_size);
-    } else {
-        for (uint16_t i = 0; i != n; ++i) {
-            sel[new_size] = i;
-            new_size += (null_array[i] == _is_null);
-        }
-        if (new_size < n) {
-            batch->set_size(new_size);
-            batch->set_selected_in_use(true);
-        }
+bool NullPredicate::evaluate(
+        const std::pair<WrapperField*, WrapperField*>& statistic) const {
+    if (statistic.first == nullptr || statistic.second == nullptr) {
+        return true;
     }
+    // a null min means the range has nulls, a null max means it has nothing else
+    return _is_null ? statistic.first->is_null() : !statistic.second->is_null();
 }
 
 } //namespace doris
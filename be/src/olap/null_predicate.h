@@ -24,6 +24,7 @@
 namespace doris {
 
 class VectorizedRowBatch;
+class WrapperField;
 
 class NullPredicate : public ColumnPredicate {
 public:
@@ -31,8 +32,9 @@ public:
     virtual ~NullPredicate();
 
     virtual void evaluate(VectorizedRowBatch* batch) const override;
+    virtual bool evaluate(
+            const std::pair<WrapperField*, WrapperField*>& statistic) const override;
 private:
-    int32_t _column_id;
     bool _is_null; //true for null, false for not null
 };
 
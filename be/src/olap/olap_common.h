@@ -125,6 +125,7 @@ enum OLAPCompressionType {
     OLAP_COMP_TRANSPORT = 1,    // 用于网络传输的压缩算法，压缩率低，cpu开销低
     OLAP_COMP_STORAGE = 2,      // 用于硬盘数据的压缩算法，压缩率高，cpu开销大
     OLAP_COMP_LZ4 = 3,          // 用于储存的压缩算法，压缩率低，cpu开销低
+    OLAP_COMP_LZ4HC = 4,        // LZ4-HC, compresses better and slower than LZ4, same decompression
 };
 
 // hll数据存储格式,优化存储结构减少多余空间的占用
@@ -216,6 +217,9 @@ struct OlapReaderStatistics {
 
     int64_t decompress_ns = 0;
     int64_t uncompressed_bytes_read = 0;
+    // data stream blocks found in and missing from the page cache
+    int64_t page_cache_hit = 0;
+    int64_t page_cache_miss = 0;
 
     int64_t bytes_read = 0;
 
@@ -229,8 +233,15 @@ struct OlapReaderStatistics {
 
     int64_t rows_vec_cond_filtered = 0;
     int64_t vec_cond_ns = 0;
+    // rows whose columns without predicates were skipped instead of decoded
+    int64_t rows_lazy_skipped = 0;
 
     int64_t rows_stats_filtered = 0;
+    // blocks and segment groups skipped by their min/max statistics
+    int64_t blocks_stats_filtered = 0;
+    int64_t segments_stats_filtered = 0;
+    // blocks skipped by the ngram bloom filters of LIKE conditions
+    int64_t blocks_ngram_filtered = 0;
     int64_t rows_del_filtered = 0;
 
     int64_t index_load_ns = 0;
@@ -22,6 +22,7 @@
 #include <utility>
 #include <thrift/protocol/TDebugProtocol.h>
 
+#include "olap/ngram_bloom_filter.h"
 #include "olap/olap_define.h"
 #include "olap/utils.h"
 #include "olap/wrapper_field.h"
@@ -56,6 +57,10 @@ using doris::ColumnStatistics;
 namespace doris {
 
 static CondOp parse_op_type(const string& op) {
+    if (0 == strcasecmp(op.c_str(), "like")) {
+        return OP_LIKE;
+    }
+
     if (op.size() > 2) {
         return OP_NULL;
     }
@@ -113,6 +118,14 @@ static CondOp parse_op_type(const string& op) {
     return op_type;
 }
 
+static uint64_t bloom_filter_hash(const WrapperField* field) {
+    if (field->is_string_type()) {
+        Slice* slice = (Slice*)(field->ptr());
+        return BloomFilter::hash_bytes(slice->data, slice->size);
+    }
+    return BloomFilter::hash_bytes(field->ptr(), field->size());
+}
+
 Cond::Cond() : op(OP_NULL), operand_field(nullptr) {
 }
 
@@ -146,6 +159,9 @@ OLAPStatus Cond::init(const TCondition& tcond, const FieldInfo& fi) {
             f->set_not_null();
         }
         operand_field = f.release();
+    } else if (op == OP_LIKE) {
+        // the pattern is not a value of the column, keep its literal strings
+        like_pattern_fragments(*tcond.condition_values.begin(), &like_fragments);
     } else if (op != OP_IN) {
         auto operand = tcond.condition_values.begin();
         std::unique_ptr<WrapperField> f(WrapperField::create(fi, operand->length()));
@@ -186,6 +202,14 @@ OLAPStatus Cond::init(const TCondition& tcond, const FieldInfo& fi) {
         }
     }
 
+    if (op == OP_EQ) {
+        bf_hashes.push_back(bloom_filter_hash(operand_field));
+    } else if (op == OP_IN) {
+        for (const WrapperField* operand : operand_set) {
+            bf_hashes.push_back(bloom_filter_hash(operand));
+        }
+    }
+
     return OLAP_SUCCESS;
 }
 
@@ -227,6 +251,9 @@ bool Cond::eval(char* right) const {
             return false;
         }
     }
+    case OP_LIKE:
+        // evaluated by the query layer
+        return true;
     default:
         // Unknown operation type, just return false
         return false;
@@ -240,7 +267,7 @@ bool Cond::eval(const std::pair<WrapperField*, WrapperField*>& statistic) const
     if (statistic.first == nullptr || statistic.second == nullptr) {
         return true;
     }
-    if (OP_IS != op && statistic.first->is_null()) {
+    if ((OP_IS != op && statistic.first->is_null()) || OP_LIKE == op) {
         return true;
     }
     switch (op) {
@@ -428,27 +455,12 @@ int Cond::del_eval(const std::pair<WrapperField*, WrapperField*>& stat) const {
 bool Cond::eval(const BloomFilter& bf) const {
     //通过单列上BloomFilter对block进行过滤。
     switch (op) {
-    case OP_EQ: {
-        bool existed = false;
-        if (operand_field->is_string_type()) {
-            Slice* slice = (Slice*)(operand_field->ptr());
-            existed = bf.test_bytes(slice->data, slice->size);
-        } else {
-            existed = bf.test_bytes(operand_field->ptr(), operand_field->size());
-        }
-        return existed;
-    }
+    case OP_EQ:
     case OP_IN: {
-        FieldSet::const_iterator it = operand_set.begin();
-        for (; it != operand_set.end(); ++it) {
-            bool existed = false;
-            if ((*it)->is_string_type()) {
-                Slice* slice = (Slice*)((*it)->ptr());
-                existed = bf.test_bytes(slice->data, slice->size);
-            } else {
-                existed = bf.test_bytes((*it)->ptr(), (*it)->size());
+        for (uint64_t hash : bf_hashes) {
+            if (bf.test_hash(hash)) {
+                return true;
             }
-            if (existed) { return true; }
         }
         return false;
     }
@@ -457,7 +469,11 @@ bool Cond::eval(const BloomFilter& bf) const {
         if (operand_field->is_null()) {
             return bf.test_bytes(nullptr, 0);
         }
+        break;
     }
+    case OP_LIKE:
+        // tested against the ngram bloom filter
+        return true;
     default:
         break;
     }
@@ -554,6 +570,23 @@ bool CondColumn::eval(const BloomFilter& bf) const {
     return true;
 }
 
+void CondColumn::like_ngram_hashes(size_t gram_size, std::vector<uint64_t>* hashes) const {
+    for (auto& each_cond : _conds) {
+        if (each_cond->op == OP_LIKE) {
+            ngram_hashes(each_cond->like_fragments, gram_size, hashes);
+        }
+    }
+}
+
+bool CondColumn::has_like() const {
+    for (auto& each_cond : _conds) {
+        if (each_cond->op == OP_LIKE) {
+            return true;
+        }
+    }
+    return false;
+}
+
 OLAPStatus Conditions::append_condition(const TCondition& tcond) {
     int32_t index = _table->get_field_index(tcond.column_name);
     if (index < 0) {
@@ -44,7 +44,8 @@ enum CondOp {
     OP_GE = 5,      // greater or equal
     OP_IN = 6,      // IN
     OP_IS = 7,      // is null or not null
-    OP_NULL = 8    // invalid OP
+    OP_LIKE = 8,    // LIKE, only prunes blocks by ngram bloom filters
+    OP_NULL = 9    // invalid OP
 };
 
 // Hash functor for IN set
@@ -84,6 +85,11 @@ public:
     // valid when op is OP_IN
     typedef std::unordered_set<const WrapperField*, FieldHash, FieldEqual> FieldSet;
     FieldSet operand_set;
+    // bloom filter hashes of the operands, valid when op is OP_EQ or OP_IN,
+    // so that testing the bloom filter of each block does not hash them again
+    std::vector<uint64_t> bf_hashes;
+    // literal strings of the pattern, valid when op is OP_LIKE
+    std::vector<std::string> like_fragments;
 };
 
 // 所有归属于同一列上的条件二元组，聚合在一个CondColumn上
@@ -108,6 +114,11 @@ public:
 
     bool eval(const BloomFilter& bf) const;
 
+    // Append the ngram hashes of the LIKE conditions to hashes, a block
+    // whose ngram bloom filter misses one of them is filtered
+    void like_ngram_hashes(size_t gram_size, std::vector<uint64_t>* hashes) const;
+    bool has_like() const;
+
     inline bool is_key() const {
         return _is_key;
     }
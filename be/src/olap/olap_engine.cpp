@@ -44,6 +44,7 @@
 #include "olap/store.h"
 #include "olap/utils.h"
 #include "olap/data_writer.h"
+#include "util/defer_op.h"
 #include "util/time.h"
 #include "util/doris_metrics.h"
 #include "util/pretty_printer.h"
@@ -113,6 +114,8 @@ OLAPEngine::OLAPEngine(const EngineOptions& options)
         _is_drop_tables(false),
         _global_table_id(0),
         _index_stream_lru_cache(NULL),
+        _stream_page_cache(NULL),
+        _read_ahead_thread_pool(NULL),
         _tablet_stat_cache_update_time_ms(0),
         _snapshot_base_id(0),
         _is_report_disk_state_already(false),
@@ -410,7 +413,8 @@ OLAPStatus OLAPEngine::open() {
 
     _update_storage_medium_type_count();
 
-    auto cache = new_lru_cache(config::file_descriptor_cache_capacity);
+    CachePolicy cache_policy = cache_policy_from_config();
+    auto cache = new_cache(config::file_descriptor_cache_capacity, cache_policy);
     if (cache == nullptr) {
         OLAP_LOG_WARNING("failed to init file descriptor LRUCache");
         _tablet_map.clear();
@@ -420,12 +424,16 @@ OLAPStatus OLAPEngine::open() {
 
     // 初始化LRUCache
     // cache大小可通过配置文件配置
-    _index_stream_lru_cache = new_lru_cache(config::index_stream_cache_capacity);
+    _index_stream_lru_cache = new_cache(config::index_stream_cache_capacity, cache_policy);
     if (_index_stream_lru_cache == NULL) {
         OLAP_LOG_WARNING("failed to init index stream LRUCache");
         _tablet_map.clear();
         return OLAP_ERR_INIT_FAILED;
     }
+    if (config::segment_read_ahead_num_threads > 0) {
+        _read_ahead_thread_pool = new ThreadPool(config::segment_read_ahead_num_threads,
+                                                 config::segment_read_ahead_queue_size);
+    }
 
     // 初始化CE调度器
     int32_t cumulative_compaction_num_threads = config::cumulative_compaction_num_threads;
@@ -433,6 +441,16 @@ OLAPStatus OLAPEngine::open() {
     uint32_t file_system_num = get_file_system_count();
     _max_cumulative_compaction_task_per_disk = (cumulative_compaction_num_threads + file_system_num - 1) / file_system_num;
     _max_base_compaction_task_per_disk = (base_compaction_num_threads + file_system_num - 1) / file_system_num;
+    // compactions of a disk are only limited when the per-disk thread count
+    // is set, otherwise any thread may compact on any disk as before
+    if (config::cumulative_compaction_num_threads_per_disk > 0) {
+        _max_cumulative_compaction_task_per_disk = config::cumulative_compaction_num_threads_per_disk;
+        _cumulative_compaction_slots.set_max_tasks_per_disk(_max_cumulative_compaction_task_per_disk);
+    }
+    if (config::base_compaction_num_threads_per_disk > 0) {
+        _max_base_compaction_task_per_disk = config::base_compaction_num_threads_per_disk;
+        _base_compaction_slots.set_max_tasks_per_disk(_max_base_compaction_task_per_disk);
+    }
 
     auto stores = get_stores();
     check_none_row_oriented_table(stores);
@@ -443,6 +461,14 @@ OLAPStatus OLAPEngine::open() {
     return OLAP_SUCCESS;
 }
 
+void OLAPEngine::init_stream_page_cache(MemTracker* process_mem_tracker) {
+    if (config::stream_page_cache_capacity > 0 && _stream_page_cache == NULL) {
+        _stream_page_cache = new StreamPageCache(config::stream_page_cache_capacity,
+                                                 cache_policy_from_config(),
+                                                 process_mem_tracker);
+    }
+}
+
 void OLAPEngine::_update_storage_medium_type_count() {
     set<TStorageMedium::type> available_storage_medium_types;
 
@@ -759,6 +785,8 @@ OLAPStatus OLAPEngine::clear() {
     delete FileHandler::get_fd_cache();
     FileHandler::set_fd_cache(nullptr);
     SAFE_DELETE(_index_stream_lru_cache);
+    SAFE_DELETE(_stream_page_cache);
+    SAFE_DELETE(_read_ahead_thread_pool);
 
     _tablet_map.clear();
     _transaction_tablet_map.clear();
@@ -1824,53 +1852,77 @@ void OLAPEngine::start_clean_fd_cache() {
     VLOG(10) << "end clean file descritpor cache";
 }
 
-void OLAPEngine::perform_cumulative_compaction() {
+bool OLAPEngine::perform_cumulative_compaction() {
     OLAPTablePtr best_table = _find_best_tablet_to_compaction(CompactionType::CUMULATIVE_COMPACTION);
-    if (best_table == nullptr) { return; }
+    if (best_table == nullptr) { return false; }
+    DeferOp release_slot([this, &best_table] {
+        _cumulative_compaction_slots.release(best_table->storage_root_path_name(),
+                                             best_table->tablet_id());
+    });
 
     CumulativeCompaction cumulative_compaction;
     OLAPStatus res = cumulative_compaction.init(best_table);
     if (res != OLAP_SUCCESS) {
         LOG(WARNING) << "failed to init cumulative compaction."
                      << "table=" << best_table->full_name();
-        return;
+        return false;
     }
 
     res = cumulative_compaction.run();
     if (res != OLAP_SUCCESS) {
         LOG(WARNING) << "failed to do cumulative compaction."
                      << "table=" << best_table->full_name();
-        return;
+        return false;
     }
+    return true;
 }
 
-void OLAPEngine::perform_base_compaction() {
+bool OLAPEngine::perform_base_compaction() {
     OLAPTablePtr best_table = _find_best_tablet_to_compaction(CompactionType::BASE_COMPACTION);
-    if (best_table == nullptr) { return; }
+    if (best_table == nullptr) { return false; }
+    DeferOp release_slot([this, &best_table] {
+        _base_compaction_slots.release(best_table->storage_root_path_name(),
+                                       best_table->tablet_id());
+    });
 
     BaseCompaction base_compaction;
     OLAPStatus res = base_compaction.init(best_table);
     if (res != OLAP_SUCCESS) {
         LOG(WARNING) << "failed to init base compaction."
                      << "table=" << best_table->full_name();
-        return;
+        return false;
     }
 
     res = base_compaction.run();
     if (res != OLAP_SUCCESS) {
         LOG(WARNING) << "failed to init base compaction."
                      << "table=" << best_table->full_name();
-        return;
+        return false;
     }
+    return true;
+}
+
+CompactionSlots* OLAPEngine::_compaction_slots(CompactionType compaction_type) {
+    if (compaction_type == CompactionType::BASE_COMPACTION) {
+        return &_base_compaction_slots;
+    }
+    return &_cumulative_compaction_slots;
 }
 
 OLAPTablePtr OLAPEngine::_find_best_tablet_to_compaction(CompactionType compaction_type) {
+    CompactionSlots* slots = _compaction_slots(compaction_type);
+    typedef std::pair<double, OLAPTablePtr> candidate_t;
+    auto lower_priority = [](const candidate_t& a, const candidate_t& b) {
+        return a.first < b.first;
+    };
+    std::priority_queue<candidate_t, std::vector<candidate_t>, decltype(lower_priority)>
+            candidates(lower_priority);
+
     ReadLock tablet_map_rdlock(&_tablet_map_lock);
-    uint32_t highest_score = 0;
-    OLAPTablePtr best_table;
     for (tablet_map_t::value_type& table_ins : _tablet_map){
         for (OLAPTablePtr& table_ptr : table_ins.second.table_arr) {
-            if (!table_ptr->is_loaded() || !_can_do_compaction(table_ptr)) {
+            if (!table_ptr->is_loaded() || !_can_do_compaction(table_ptr)
+                    || slots->is_full(table_ptr->storage_root_path_name())) {
                 continue;
             }
 
@@ -1881,13 +1933,24 @@ OLAPTablePtr OLAPEngine::_find_best_tablet_to_compaction(CompactionType compacti
             } else if (compaction_type == CompactionType::CUMULATIVE_COMPACTION) {
                 table_score = table_ptr->get_cumulative_compaction_score();
             }
-            if (table_score > highest_score) {
-                highest_score = table_score;
-                best_table = table_ptr;
+            if (table_score == 0) {
+                continue;
             }
+            double priority = compaction_priority(table_score, table_ptr->get_data_size(),
+                                                  table_ptr->query_hotness());
+            candidates.emplace(priority, table_ptr);
+        }
+    }
+
+    // other threads may have taken the slots since
+    while (!candidates.empty()) {
+        OLAPTablePtr table = candidates.top().second;
+        candidates.pop();
+        if (slots->try_acquire(table->storage_root_path_name(), table->tablet_id())) {
+            return table;
         }
     }
-    return best_table;
+    return nullptr;
 }
 
 void OLAPEngine::get_cache_status(rapidjson::Document* document) const {
@@ -2038,6 +2101,19 @@ OLAPStatus OLAPEngine::_create_new_table_header(
     // set basic information
     header->set_num_short_key_fields(request.tablet_schema.short_key_column_count);
     header->set_compress_kind(COMPRESS_LZ4);
+    if (request.tablet_schema.__isset.compress_kind) {
+        switch (request.tablet_schema.compress_kind) {
+        case TCompressKind::LZO:
+            header->set_compress_kind(COMPRESS_LZO);
+            break;
+        case TCompressKind::LZ4HC:
+            // recorded as LZ4 so that BEs without LZ4-HC can read the segments
+            header->set_lz4hc_compression(true);
+            break;
+        default:
+            break;
+        }
+    }
     if (request.tablet_schema.keys_type == TKeysType::DUP_KEYS) {
         header->set_keys_type(KeysType::DUP_KEYS);
     } else if (request.tablet_schema.keys_type == TKeysType::UNIQUE_KEYS) {
@@ -2144,6 +2220,10 @@ OLAPStatus OLAPEngine::_create_new_table_header(
             header->mutable_column(i)->set_is_bf_column(column.is_bloom_filter_column);
             has_bf_columns = true;
         }
+        if (column.__isset.is_split_block_bloom_filter_column) {
+            header->mutable_column(i)->set_is_split_block_bf_column(
+                    column.is_split_block_bloom_filter_column);
+        }
         ++i;
     }
     if (true == is_schema_change_table){
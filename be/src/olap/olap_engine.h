@@ -37,12 +37,16 @@
 #include "gen_cpp/BackendService_types.h"
 #include "gen_cpp/MasterService_types.h"
 #include "olap/atomic.h"
+#include "olap/compaction_scheduler.h"
 #include "olap/lru_cache.h"
+#include "olap/memtable_flush_executor.h"
 #include "olap/olap_common.h"
 #include "olap/olap_define.h"
 #include "olap/olap_table.h"
 #include "olap/olap_meta.h"
 #include "olap/options.h"
+#include "olap/stream_page_cache.h"
+#include "util/thread_pool.hpp"
 
 namespace doris {
 
@@ -178,8 +182,10 @@ public:
     OLAPStatus clear();
 
     void start_clean_fd_cache();
-    void perform_cumulative_compaction();
-    void perform_base_compaction();
+    // Compact the tablet of the highest priority on a store with a free
+    // slot, false if there was none or the compaction failed.
+    bool perform_cumulative_compaction();
+    bool perform_base_compaction();
 
     // 获取cache的使用情况信息
     void get_cache_status(rapidjson::Document* document) const;
@@ -204,6 +210,21 @@ public:
         return _index_stream_lru_cache;
     }
 
+    // Create the stream page cache, whose memory is charged to
+    // process_mem_tracker. It is created after the engine is opened, as the
+    // process MemTracker is created by ExecEnv::init().
+    void init_stream_page_cache(MemTracker* process_mem_tracker);
+
+    // NULL if stream_page_cache_capacity is 0
+    StreamPageCache* stream_page_cache() {
+        return _stream_page_cache;
+    }
+
+    // NULL if segment_read_ahead_num_threads is 0
+    ThreadPool* read_ahead_thread_pool() {
+        return _read_ahead_thread_pool;
+    }
+
     // 清理trash和snapshot文件，返回清理后的磁盘使用量
     OLAPStatus start_trash_sweep(double *usage);
 
@@ -234,6 +255,8 @@ public:
     OlapStore* get_store(const std::string& path);
     OlapStore* get_store(int64_t path_hash);
 
+    MemTableFlushExecutor* memtable_flush_executor() { return &_memtable_flush_executor; }
+
     uint32_t available_storage_medium_type_count() {
         return _available_storage_medium_type_count;
     }
@@ -478,36 +501,7 @@ private:
         CUMULATIVE_COMPACTION = 2
     };
 
-    struct CompactionCandidate {
-        CompactionCandidate(uint32_t nicumulative_compaction_, int64_t tablet_id_, uint32_t index_) :
-                nice(nicumulative_compaction_), tablet_id(tablet_id_), disk_index(index_) {}
-        uint32_t nice; // 优先度
-        int64_t tablet_id;
-        uint32_t disk_index = -1;
-    };
-
-    struct CompactionCandidateComparator {
-        bool operator()(const CompactionCandidate& a, const CompactionCandidate& b) {
-            return a.nice > b.nice;
-        }
-    };
-
-    struct CompactionDiskStat {
-        CompactionDiskStat(std::string path, uint32_t index, bool used) :
-                storage_path(path),
-                disk_index(index),
-                task_running(0),
-                task_remaining(0),
-                is_used(used){}
-        const std::string storage_path;
-        const uint32_t disk_index;
-        uint32_t task_running;
-        uint32_t task_remaining;
-        bool is_used;
-    };
-
     typedef std::map<int64_t, TableInstances> tablet_map_t;
-    typedef std::map<std::string, uint32_t> file_system_task_count_t;
 
     OLAPTablePtr _get_table_with_no_lock(TTabletId tablet_id, SchemaHash schema_hash);
 
@@ -527,7 +521,10 @@ private:
 
     OLAPStatus _check_existed_or_else_create_dir(const std::string& path);
 
+    // The returned table holds a slot of compaction_type on its store, the
+    // caller releases it.
     OLAPTablePtr _find_best_tablet_to_compaction(CompactionType compaction_type);
+    CompactionSlots* _compaction_slots(CompactionType compaction_type);
     bool _can_do_compaction(OLAPTablePtr table);
 
     void _cancel_unfinished_schema_change();
@@ -542,6 +539,8 @@ private:
     std::mutex _store_lock;
     std::map<std::string, OlapStore*> _store_map;
     uint32_t _available_storage_medium_type_count;
+    // flush threads of the memtables of all loads, one pool per store
+    MemTableFlushExecutor _memtable_flush_executor;
 
     int32_t _effective_cluster_id;
     bool _is_all_cluster_id_exist;
@@ -558,12 +557,12 @@ private:
     size_t _global_table_id;
     Cache* _file_descriptor_lru_cache;
     Cache* _index_stream_lru_cache;
+    StreamPageCache* _stream_page_cache;
+    ThreadPool* _read_ahead_thread_pool;
     uint32_t _max_base_compaction_task_per_disk;
     uint32_t _max_cumulative_compaction_task_per_disk;
-
-    Mutex _fs_task_mutex;
-    file_system_task_count_t _fs_base_compaction_task_num_map;
-    std::vector<CompactionCandidate> _cumulative_compaction_candidate;
+    CompactionSlots _base_compaction_slots;
+    CompactionSlots _cumulative_compaction_slots;
 
     // cache to save tablets' statistics, such as data size and row
     // TODO(cmy): for now, this is a naive implementation
@@ -22,6 +22,7 @@
 #include <cmath>
 #include <fstream>
 
+#include "common/config.h"
 #include "olap/column_data.h"
 #include "olap/olap_table.h"
 #include "olap/row_block.h"
@@ -47,10 +48,10 @@ MemIndex::MemIndex()
 
 MemIndex::~MemIndex() {
     _num_entries = 0;
-    for (vector<SegmentMetaInfo>::iterator it = _meta.begin(); it != _meta.end(); ++it) {
-        free(it->buffer.data);
-        it->buffer.data = NULL;
-        it->buffer.length = 0;
+    if (_entry_cache != NULL) {
+        for (const SegmentMetaInfo& meta : _meta) {
+            _entry_cache->erase(CacheKey(meta.file_path.data(), meta.file_path.size()));
+        }
     }
 }
 
@@ -59,7 +60,6 @@ OLAPStatus MemIndex::load_segment(const char* file, size_t *current_num_rows_per
 
     SegmentMetaInfo meta;
     OLAPIndexHeaderMessage pb;
-    uint32_t adler_checksum = 0;
     uint32_t num_entries = 0;
 
     if (file == NULL) {
@@ -128,43 +128,77 @@ OLAPStatus MemIndex::load_segment(const char* file, size_t *current_num_rows_per
     (current_num_rows_per_row_block == NULL
      || (*current_num_rows_per_row_block = meta.file_header.message().num_rows_per_block()));
 
+    SegmentMetaInfo& segment = _meta.back();
+    segment.file_path = file;
+    segment.entries_length = num_entries * new_entry_length();
+
     if (OLAP_UNLIKELY(num_entries == 0)) {
+        segment.entries.reset(new SegmentEntries());
+        file_handler.close();
+        return OLAP_SUCCESS;
+    }
+
+    if (_entry_cache == NULL) {
+        res = _load_entries(&file_handler, segment, &segment.entries);
         file_handler.close();
+        if (res != OLAP_SUCCESS) {
+            OLAP_LOG_WARNING("load segment for loading index error. [file=%s; res=%d]", file, res);
+            return res;
+        }
+        segment.first_entry = segment.entries->data;
         return OLAP_SUCCESS;
     }
 
+    // only the first entry is read now, the others on the first lookup
+    char* first_entry = NULL;
+    res = _read_entries(&file_handler, segment, 1, _mem_pool.get(), &first_entry);
+    file_handler.close();
+    if (res != OLAP_SUCCESS) {
+        OLAP_LOG_WARNING("load segment for loading index error. [file=%s; res=%d]", file, res);
+        return res;
+    }
+    segment.first_entry = reinterpret_cast<char*>(_mem_pool->allocate(new_entry_length()));
+    memory_copy(segment.first_entry, first_entry, new_entry_length());
+    free(first_entry);
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus MemIndex::_read_entries(FileHandler* file_handler, const SegmentMetaInfo& meta,
+                                   size_t num_entries, MemPool* mem_pool,
+                                   char** entries) const {
+    bool null_supported = meta.file_header.message().has_null_supported()
+            && meta.file_header.message().null_supported();
+    size_t num_short_key_fields = short_key_num();
+    size_t storage_row_bytes = entry_length();
+    storage_row_bytes -= (null_supported ? 0 : num_short_key_fields);
+    bool read_all = num_entries == meta.count();
+    size_t storage_length = read_all
+            ? meta.file_header.file_length() - meta.file_header.size()
+            : num_entries * storage_row_bytes;
+
     // convert index memory layout for string type
     // previous layout is size|data,
     // target type is ptr|size, ptr pointer to data
     char* storage_data = reinterpret_cast<char*>(calloc(storage_length, 1));
     if (storage_data == nullptr) {
-        res = OLAP_ERR_MALLOC_ERROR;
-        OLAP_LOG_WARNING("load segment for loading index error. [file=%s; res=%d]", file, res);
-        file_handler.close();
-        return res;
+        return OLAP_ERR_MALLOC_ERROR;
     }
 
     // 读取索引内容
     // 为了启动加速，此处可使用mmap方式。
-    if (file_handler.pread(storage_data,
-                           storage_length,
-                           meta.file_header.size()) != OLAP_SUCCESS) {
-        res = OLAP_ERR_IO_ERROR;
-        OLAP_LOG_WARNING("load segment for loading index error. [file=%s; res=%d]", file, res);
-        file_handler.close();
+    if (file_handler->pread(storage_data,
+                            storage_length,
+                            meta.file_header.size()) != OLAP_SUCCESS) {
         free(storage_data);
-        return res;
+        return OLAP_ERR_IO_ERROR;
     }
 
     // checksum validation
-    adler_checksum = olap_adler32(ADLER32_INIT, storage_data, storage_length);
-    if (adler_checksum != meta.file_header.checksum()) {
-        res = OLAP_ERR_INDEX_CHECKSUM_ERROR;
+    uint32_t adler_checksum = olap_adler32(ADLER32_INIT, storage_data, storage_length);
+    if (read_all && adler_checksum != meta.file_header.checksum()) {
         OLAP_LOG_WARNING("checksum validation error.");
-        OLAP_LOG_WARNING("load segment for loading index error. [file=%s; res=%d]", file, res);
-        file_handler.close();
         free(storage_data);
-        return res;
+        return OLAP_ERR_INDEX_CHECKSUM_ERROR;
     }
 
     /*
@@ -174,8 +208,6 @@ OLAPStatus MemIndex::load_segment(const char* file, size_t *current_num_rows_per
      * key, it can not to be handled.
      */
 
-    size_t storage_row_bytes = entry_length();
-    storage_row_bytes -= (null_supported ? 0 : num_short_key_fields);
     char* storage_ptr = storage_data;
     size_t storage_field_offset = 0;
 
@@ -208,7 +240,7 @@ OLAPStatus MemIndex::load_segment(const char* file, size_t *current_num_rows_per
                 size_t storage_field_bytes =
                     *reinterpret_cast<StringLengthType*>(storage_ptr + null_byte);
                 Slice* slice = reinterpret_cast<Slice*>(mem_ptr + 1);
-                char* data = reinterpret_cast<char*>(_mem_pool->allocate(storage_field_bytes));
+                char* data = reinterpret_cast<char*>(mem_pool->allocate(storage_field_bytes));
                 memory_copy(data, storage_ptr + sizeof(StringLengthType) + null_byte, storage_field_bytes);
                 slice->data = data;
                 slice->size = storage_field_bytes;
@@ -233,7 +265,7 @@ OLAPStatus MemIndex::load_segment(const char* file, size_t *current_num_rows_per
 
                 // 2. copy length and content
                 Slice* slice = reinterpret_cast<Slice*>(mem_ptr + 1);
-                char* data = reinterpret_cast<char*>(_mem_pool->allocate(storage_field_bytes));
+                char* data = reinterpret_cast<char*>(mem_pool->allocate(storage_field_bytes));
                 memory_copy(data, storage_ptr + null_byte, storage_field_bytes);
                 slice->data = data;
                 slice->size = storage_field_bytes;
@@ -262,16 +294,97 @@ OLAPStatus MemIndex::load_segment(const char* file, size_t *current_num_rows_per
         storage_ptr += storage_row_bytes;
     }
 
-    _meta.back().buffer.data = mem_buf;
-    _meta.back().buffer.length = num_entries * mem_row_bytes;
+    *entries = mem_buf;
     free(storage_data);
+    return OLAP_SUCCESS;
+}
 
-    file_handler.close();
+OLAPStatus MemIndex::_load_entries(FileHandler* file_handler, const SegmentMetaInfo& meta,
+                                   std::shared_ptr<SegmentEntries>* entries) const {
+    std::shared_ptr<SegmentEntries> loaded(new SegmentEntries());
+    size_t num_entries = meta.count();
+    OLAPStatus res = _read_entries(file_handler, meta, num_entries,
+                                   &loaded->mem_pool, &loaded->data);
+    if (res != OLAP_SUCCESS) {
+        return res;
+    }
+
+    int32_t interval = config::short_key_index_sample_interval;
+    if (interval > 0 && short_key_num() > 0 && key_prefix_supported((*_fields)[0].type)) {
+        const FieldInfo& field = (*_fields)[0];
+        std::vector<uint64_t> prefixes(num_entries);
+        for (size_t i = 0; i < num_entries; ++i) {
+            prefixes[i] = key_prefix(field.type, field.index_length,
+                                     loaded->data + i * new_entry_length());
+        }
+        loaded->key_prefix_index.init(prefixes, interval);
+    }
+    *entries = std::move(loaded);
+    return OLAP_SUCCESS;
+}
+
+void MemIndex::_delete_entries(const CacheKey& key, void* value) {
+    delete reinterpret_cast<std::shared_ptr<SegmentEntries>*>(value);
+}
+
+OLAPStatus MemIndex::_get_entries(iterator_offset_t segment,
+                                  std::shared_ptr<SegmentEntries>* entries) const {
+    const SegmentMetaInfo& meta = _meta[segment];
+    if (meta.entries != nullptr) {
+        *entries = meta.entries;
+        return OLAP_SUCCESS;
+    }
+
+    CacheKey key(meta.file_path.data(), meta.file_path.size());
+    Cache::Handle* handle = _entry_cache->lookup(key);
+    if (handle == NULL) {
+        std::lock_guard<std::mutex> l(_load_lock);
+        // another thread may have read them meanwhile
+        handle = _entry_cache->lookup(key);
+        if (handle == NULL) {
+            FileHandler file_handler;
+            OLAPStatus res = file_handler.open_with_cache(meta.file_path, O_RDONLY);
+            if (res != OLAP_SUCCESS) {
+                OLAP_LOG_WARNING("fail to open index file. [file='%s']", meta.file_path.c_str());
+                return res;
+            }
+            res = _load_entries(&file_handler, meta, entries);
+            file_handler.close();
+            if (res != OLAP_SUCCESS) {
+                OLAP_LOG_WARNING("fail to load index entries. [file='%s' res=%d]",
+                                 meta.file_path.c_str(), res);
+                return res;
+            }
+            size_t charge = meta.entries_length + (*entries)->mem_pool.total_reserved_bytes()
+                    + (*entries)->key_prefix_index.memory_usage();
+            handle = _entry_cache->insert(key, new std::shared_ptr<SegmentEntries>(*entries),
+                                          charge, &_delete_entries);
+            _entry_cache->release(handle);
+            return OLAP_SUCCESS;
+        }
+    }
+    *entries = *reinterpret_cast<std::shared_ptr<SegmentEntries>*>(_entry_cache->value(handle));
+    _entry_cache->release(handle);
     return OLAP_SUCCESS;
 }
 
+void MemIndex::_narrow(const SegmentEntries& entries, const RowCursor& key,
+                       uint32_t* first, uint32_t* last) const {
+    const KeyPrefixIndex& key_prefix_index = entries.key_prefix_index;
+    // keys without a first column compare equal to all entries
+    if (key_prefix_index.empty() || key.key_column_num() == 0
+            || key.get_field_by_index(0) == NULL) {
+        return;
+    }
+    const FieldInfo& field = (*_fields)[0];
+    const Field* key_field = key.get_field_by_index(0);
+    key_prefix_index.narrow(key_prefix(field.type, field.index_length,
+                                       key_field->get_field_ptr(key.get_buf())),
+                            first, last);
+}
+
 OLAPStatus MemIndex::init(size_t short_key_len, size_t new_short_key_len,
-                          size_t short_key_num, RowFields* fields) {
+                          size_t short_key_num, RowFields* fields, Cache* entry_cache) {
     if (fields == NULL) {
         OLAP_LOG_WARNING("fail to init MemIndex, NULL short key fields.");
         return OLAP_ERR_INDEX_LOAD_ERROR;
@@ -281,6 +394,7 @@ OLAPStatus MemIndex::init(size_t short_key_len, size_t new_short_key_len,
     _new_key_length = new_short_key_len;
     _key_num = short_key_num;
     _fields = fields;
+    _entry_cache = entry_cache;
 
     return OLAP_SUCCESS;
 }
@@ -299,6 +413,9 @@ OLAPStatus MemIndex::init(size_t short_key_len, size_t new_short_key_len,
 // because of our sparse index, the first item which short key equals 5(5, xxxx) is indexed
 // by shortkey 4 in the first index item, if we want to find the first key not less than 6, we
 // should return the first index instead the second.
+//
+// Inside the segment, the key prefixes of the first level narrow the range of entries
+// to compare the short keys with.
 const OLAPIndexOffset MemIndex::find(const RowCursor& k,
                                      RowCursor* helper_cursor,
                                      bool find_last) const {
@@ -330,12 +447,20 @@ const OLAPIndexOffset MemIndex::find(const RowCursor& k,
         offset.segment = off;
         IndexComparator index_comparator(this, helper_cursor);
         // second step, binary search index item in given segment
-        BinarySearchIterator index_beg(0);
-        BinarySearchIterator index_fin(_meta[off].count());
-
         if (index_comparator.set_segment_id(off) != OLAP_SUCCESS) {
             throw "index of of range";
         }
+        std::shared_ptr<SegmentEntries> entries;
+        if (_get_entries(off, &entries) != OLAP_SUCCESS) {
+            throw "fail to load index entries";
+        }
+        index_comparator.set_entries(entries->data);
+
+        uint32_t first = 0;
+        uint32_t last = _meta[off].count();
+        _narrow(*entries, k, &first, &last);
+        BinarySearchIterator index_beg(first);
+        BinarySearchIterator index_fin(last);
 
         if (!find_last) {
             it = std::lower_bound(index_beg, index_fin, k, index_comparator);
@@ -403,7 +528,7 @@ const OLAPIndexOffset MemIndex::prev(const OLAPIndexOffset& pos) const {
 const OLAPIndexOffset MemIndex::get_offset(const RowBlockPosition& pos) const {
     uint32_t file_header_size = _meta[pos.segment].file_header.size();
     if (pos.segment >= segment_count()
-            || pos.index_offset > file_header_size + _meta[pos.segment].buffer.length
+            || pos.index_offset > file_header_size + _meta[pos.segment].entries_length
             || (pos.index_offset - file_header_size) % new_entry_length() != 0) {
         return end();
     }
@@ -419,9 +544,15 @@ OLAPStatus MemIndex::get_entry(const OLAPIndexOffset& pos, EntrySlice* slice) co
     if (pos.segment >= segment_count() || pos.offset >= _meta[pos.segment].count()) {
         return OLAP_ERR_INDEX_EOF;
     }
+    std::shared_ptr<SegmentEntries> entries;
+    OLAPStatus res = _get_entries(pos.segment, &entries);
+    if (res != OLAP_SUCCESS) {
+        return res;
+    }
 
     slice->length = new_entry_length();
-    slice->data = _meta[pos.segment].buffer.data + pos.offset * new_entry_length();
+    slice->data = entries->data + pos.offset * new_entry_length();
+    slice->pin = std::move(entries);
 
     return OLAP_SUCCESS;
 }
@@ -441,10 +572,15 @@ OLAPStatus MemIndex::get_row_block_position(
                          pos.segment < segment_count() ? _meta[pos.segment].count() : 0);
         return OLAP_ERR_INDEX_EOF;
     }
+    std::shared_ptr<SegmentEntries> entries;
+    OLAPStatus res = _get_entries(pos.segment, &entries);
+    if (res != OLAP_SUCCESS) {
+        return res;
+    }
 
     rbp->segment = pos.segment;
     rbp->data_offset = *reinterpret_cast<uint32_t*>(
-                            _meta[pos.segment].buffer.data +
+                            entries->data +
                             pos.offset * new_entry_length() + new_short_key_length());
     rbp->index_offset = _meta[pos.segment].file_header.size() + pos.offset * new_entry_length();
 
@@ -452,7 +588,7 @@ OLAPStatus MemIndex::get_row_block_position(
         rbp->block_size = _meta[pos.segment].file_header.extra().data_length - rbp->data_offset;
     } else {
         uint32_t next_offset = *reinterpret_cast<uint32_t*>(
-                                   _meta[pos.segment].buffer.data +
+                                   entries->data +
                                    (pos.offset + 1) * new_entry_length() + new_short_key_length());
         rbp->block_size = next_offset - rbp->data_offset;
     }
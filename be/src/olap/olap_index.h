@@ -21,6 +21,8 @@
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -31,11 +33,15 @@
 #include "olap/atomic.h"
 #include "olap/field.h"
 #include "olap/file_helper.h"
+#include "olap/key_prefix_index.h"
+#include "olap/lru_cache.h"
 #include "olap/olap_common.h"
 #include "olap/olap_define.h"
 #include "olap/olap_table.h"
 #include "olap/row_cursor.h"
 #include "olap/utils.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
 
 namespace doris {
 class IndexComparator;
@@ -59,6 +65,8 @@ struct OLAPIndexFixedHeader {
 struct EntrySlice {
     char* data;
     size_t length;
+    // keeps data valid after the entries are evicted from the cache
+    std::shared_ptr<const void> pin;
     EntrySlice() : data(nullptr), length(0) {}
 };
 
@@ -147,12 +155,26 @@ struct RowBlockPosition {
     uint32_t index_offset;  // offset in index file
 };
 
+// The entries of a segment in memory layout, with the strings they point to
+// and the first level over their key prefixes
+struct SegmentEntries {
+    SegmentEntries() : data(NULL), mem_pool(&tracker) { }
+    ~SegmentEntries() {
+        free(data);
+    }
+
+    char* data;
+    MemTracker tracker;
+    MemPool mem_pool;
+    KeyPrefixIndex key_prefix_index;
+};
+
 // In memory presentation of index meta information
 struct SegmentMetaInfo {
     SegmentMetaInfo() {
         range.first = range.last = 0;
-        buffer.length = 0;
-        buffer.data = NULL;
+        entries_length = 0;
+        first_entry = NULL;
     }
 
     const size_t count() const {
@@ -160,8 +182,14 @@ struct SegmentMetaInfo {
     }
 
     IDRange     range;
-    EntrySlice       buffer;
+    // length of the entries in memory layout
+    size_t entries_length;
     FileHeader<OLAPIndexHeaderMessage, OLAPIndexFixedHeader>  file_header;
+    std::string file_path;
+    // the first entry, always loaded to find the segment of a key
+    char* first_entry;
+    // the entries, NULL if they are read into the entry cache on first use
+    std::shared_ptr<SegmentEntries> entries;
 };
 
 // In memory index structure, all index hold here
@@ -175,8 +203,13 @@ public:
     ~MemIndex();
 
     // 初始化MemIndex, 传入short_key的总长度和对应的Field数组
+    // With entry_cache, load_segment() only reads the first entry of a
+    // segment. The other entries are read on the first lookup in the segment
+    // and kept in entry_cache, which may evict them. Without it they are all
+    // read by load_segment() and kept until the MemIndex is destroyed.
     OLAPStatus init(size_t short_key_len, size_t new_short_key_len,
-                    size_t short_key_num, RowFields* fields);
+                    size_t short_key_num, RowFields* fields,
+                    Cache* entry_cache = NULL);
 
     // 加载一个segment到内存
     OLAPStatus load_segment(const char* file, size_t *current_num_rows_per_row_block);
@@ -323,7 +356,32 @@ public:
     }
 
 private:
+    // Read the first num_entries entries of a segment from file_handler and
+    // convert them into memory layout, with strings allocated from mem_pool.
+    // The checksum is only verified when all entries are read.
+    OLAPStatus _read_entries(FileHandler* file_handler, const SegmentMetaInfo& meta,
+                             size_t num_entries, MemPool* mem_pool, char** entries) const;
+
+    // Read all entries of a segment and build their first level
+    OLAPStatus _load_entries(FileHandler* file_handler, const SegmentMetaInfo& meta,
+                             std::shared_ptr<SegmentEntries>* entries) const;
+
+    // Return the entries of the segment, reading them into the entry cache
+    // if they are not there
+    OLAPStatus _get_entries(iterator_offset_t segment,
+                            std::shared_ptr<SegmentEntries>* entries) const;
+
+    static void _delete_entries(const CacheKey& key, void* value);
+
+    // Narrow [*first, *last] to the entries which may be the bound of key,
+    // by the first level
+    void _narrow(const SegmentEntries& entries, const RowCursor& key,
+                 uint32_t* first, uint32_t* last) const;
+
     std::vector<SegmentMetaInfo> _meta;
+    Cache* _entry_cache = NULL;
+    // one thread reads entries into the cache at a time
+    mutable std::mutex _load_lock;
     size_t _key_length;
     size_t _new_key_length;
     size_t _key_num;
@@ -344,6 +402,7 @@ public:
     IndexComparator(const MemIndex* index, RowCursor* cursor) :
             _index(index),
             _cur_seg(0),
+            _entries(NULL),
             _helper_cursor(cursor) {}
 
     // Destructor do nothing
@@ -366,15 +425,16 @@ public:
         return OLAP_SUCCESS;
     }
 
+    // the entries of the segment, which the caller keeps valid
+    void set_entries(char* entries) {
+        _entries = entries;
+    }
+
 private:
     bool _compare(const iterator_offset_t& index,
                   const RowCursor& key,
                   ComparatorEnum comparator) {
-        EntrySlice slice;
-        OLAPIndexOffset offset(_cur_seg, index);
-        _index->get_entry(offset, &slice);
-
-        _helper_cursor->attach(slice.data);
+        _helper_cursor->attach(_entries + index * _index->new_entry_length());
 
         if (comparator == COMPARATOR_LESS) {
             return _helper_cursor->index_cmp(key) < 0;
@@ -385,6 +445,7 @@ private:
 
     const MemIndex* _index;
     iterator_offset_t _cur_seg;
+    char* _entries;
     RowCursor* _helper_cursor;
 };
 
@@ -411,7 +472,7 @@ private:
                   const RowCursor& key,
                   ComparatorEnum comparator) {
         EntrySlice slice;
-        slice.data = _index->_meta[index].buffer.data;
+        slice.data = _index->_meta[index].first_entry;
         //slice.length = _index->short_key_length();
         slice.length = _index->new_short_key_length();
 
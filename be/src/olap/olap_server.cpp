@@ -60,6 +60,10 @@ OLAPStatus OLAPEngine::_start_bg_worker() {
 
     // start be and ce threads for merge data
     int32_t base_compaction_num_threads = config::base_compaction_num_threads;
+    if (config::base_compaction_num_threads_per_disk > 0) {
+        base_compaction_num_threads =
+            config::base_compaction_num_threads_per_disk * get_file_system_count();
+    }
     _base_compaction_threads.reserve(base_compaction_num_threads);
     for (uint32_t i = 0; i < base_compaction_num_threads; ++i) {
         _base_compaction_threads.emplace_back(
@@ -69,6 +73,10 @@ OLAPStatus OLAPEngine::_start_bg_worker() {
     }
 
     int32_t cumulative_compaction_num_threads = config::cumulative_compaction_num_threads;
+    if (config::cumulative_compaction_num_threads_per_disk > 0) {
+        cumulative_compaction_num_threads =
+            config::cumulative_compaction_num_threads_per_disk * get_file_system_count();
+    }
     _cumulative_compaction_threads.reserve(cumulative_compaction_num_threads);
     for (uint32_t i = 0; i < cumulative_compaction_num_threads; ++i) {
         _cumulative_compaction_threads.emplace_back(
@@ -122,7 +130,11 @@ void* OLAPEngine::_base_compaction_thread_callback(void* arg) {
         // cgroup is not initialized at this time
         // add tid to cgroup
         CgroupsMgr::apply_system_cgroup();
-        perform_base_compaction();
+        // keep going while there are tablets to compact, versions pile up
+        // quickly under heavy load
+        if (perform_base_compaction()) {
+            continue;
+        }
 
         usleep(interval * 1000000);
     }
@@ -235,7 +247,9 @@ void* OLAPEngine::_cumulative_compaction_thread_callback(void* arg) {
         // cgroup is not initialized at this time
         // add tid to cgroup
         CgroupsMgr::apply_system_cgroup();
-        perform_cumulative_compaction();
+        if (perform_cumulative_compaction()) {
+            continue;
+        }
         usleep(interval * 1000000);
     }
 
@@ -209,6 +209,7 @@ OLAPTable::OLAPTable(OLAPHeader* header, OlapStore* store) :
         }
 
         field_info.is_bf_column = header->column(i).is_bf_column();
+        field_info.is_split_block_bf_column = header->column(i).is_split_block_bf_column();
 
         _tablet_schema.push_back(field_info);
         // field name --> field position in full row.
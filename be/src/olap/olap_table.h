@@ -27,6 +27,7 @@
 
 #include "gen_cpp/AgentService_types.h"
 #include "gen_cpp/olap_file.pb.h"
+#include "olap/compaction_scheduler.h"
 #include "olap/field.h"
 #include "olap/olap_define.h"
 #include "olap/olap_header.h"
@@ -483,6 +484,15 @@ public:
         return _header->get_base_compaction_score();
     }
 
+    // Count a query on the table, hot tables are compacted first.
+    void record_query() {
+        _query_hotness.add(time(NULL));
+    }
+
+    double query_hotness() const {
+        return _query_hotness.value(time(NULL));
+    }
+
     const OLAPStatus delete_version(const Version& version) {
         return _header->delete_version(version);
     }
@@ -504,6 +514,11 @@ public:
         return _compress_kind;
     }
 
+    // whether the COMPRESS_LZ4 streams of new segments are compressed with LZ4-HC
+    bool lz4hc_compression() const {
+        return _header->lz4hc_compression();
+    }
+
     int delete_data_conditions_size() const {
         return _header->delete_data_conditions_size();
     }
@@ -751,6 +766,7 @@ private:
     std::atomic<bool> _is_loaded;
     Mutex _load_lock;
     std::string _tablet_path;
+    QueryHotness _query_hotness;
 
     bool _table_for_check;
 
@@ -18,13 +18,15 @@
 #include "olap/out_stream.h"
 
 #include "olap/byte_buffer.h"
+#include "olap/compaction_scheduler.h"
 #include "olap/file_helper.h"
 #include "olap/utils.h"
 #include "util/mem_util.hpp"
 
 namespace doris {
 
-OutStreamFactory::OutStreamFactory(CompressKind compress_kind, uint32_t stream_buffer_size) : 
+OutStreamFactory::OutStreamFactory(CompressKind compress_kind, uint32_t stream_buffer_size,
+                                   bool lz4hc) :
         _compress_kind(compress_kind),
         _stream_buffer_size(stream_buffer_size) {
     switch (compress_kind) {
@@ -37,7 +39,7 @@ OutStreamFactory::OutStreamFactory(CompressKind compress_kind, uint32_t stream_b
         break;
 
     case COMPRESS_LZ4:
-        _compressor = lz4_compress;
+        _compressor = lz4hc ? lz4hc_compress : lz4_compress;
         break;
 
     default:
@@ -56,7 +58,8 @@ OutStream* OutStreamFactory::create_stream(
         uint32_t column_unique_id, StreamInfoMessage::Kind kind) {
     OutStream* stream = NULL;
 
-    if (StreamInfoMessage::ROW_INDEX == kind || StreamInfoMessage::BLOOM_FILTER == kind) {
+    if (StreamInfoMessage::ROW_INDEX == kind || StreamInfoMessage::BLOOM_FILTER == kind
+            || StreamInfoMessage::NGRAM_BLOOM_FILTER == kind) {
         stream = new(std::nothrow) OutStream(_stream_buffer_size, NULL);
     } else {
         stream = new(std::nothrow) OutStream(_stream_buffer_size, _compressor);
@@ -339,7 +342,8 @@ uint64_t OutStream::get_total_buffer_size() const {
 }
 
 OLAPStatus OutStream::write_to_file(FileHandler* file_handle,
-                                uint32_t write_mbytes_per_sec) const {
+                                uint32_t write_mbytes_per_sec,
+                                IoThrottle* io_throttle) const {
     OLAPStatus res = OLAP_SUCCESS;
 
     uint64_t total_stream_len = 0;
@@ -351,6 +355,10 @@ OLAPStatus OutStream::write_to_file(FileHandler* file_handle,
             it != _output_buffers.end(); ++it) {
         VLOG(3) << "write stream begin:" << file_handle->tell();
 
+        if (NULL != io_throttle) {
+            io_throttle->acquire((*it)->limit());
+        }
+
         res = file_handle->write((*it)->array(), (*it)->limit());
         if (OLAP_SUCCESS != res) {
             OLAP_LOG_WARNING("fail to write stream to fail.");
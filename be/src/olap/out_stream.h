@@ -26,6 +26,7 @@
 
 namespace doris {
 class FileHandler;
+class IoThrottle;
 
 // 与OrcFile不同,我们底层没有HDFS无法保证存储数据的可靠性,所以必须写入
 // 校验值,在读取数据的时候检验这一校验值
@@ -87,9 +88,12 @@ public:
     uint64_t get_total_buffer_size() const;
 
     // 将缓存的数据流输出到文件
+    // io_throttle, if not NULL, limits the writes shared with other writers
+    // of the disk on top of write_mbytes_per_sec
     OLAPStatus write_to_file(
         FileHandler* file_handle,
-        uint32_t write_mbytes_per_sec) const;
+        uint32_t write_mbytes_per_sec,
+        IoThrottle* io_throttle = NULL) const;
 
     bool is_suppressed() const {
         return _is_suppressed;
@@ -144,7 +148,9 @@ private:
 // 将所有的输出流托管,同时封装了诸如压缩算法,是否启用Index,block大小等信息
 class OutStreamFactory {
 public:
-    explicit OutStreamFactory(CompressKind compress_kind, uint32_t stream_buffer_size);
+    // lz4hc compresses COMPRESS_LZ4 streams with LZ4-HC, which any LZ4 reader decodes
+    explicit OutStreamFactory(CompressKind compress_kind, uint32_t stream_buffer_size,
+                              bool lz4hc = false);
 
     ~OutStreamFactory();
 
@@ -0,0 +1,623 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_PREDICATE_KERNEL_H
+#define DORIS_BE_SRC_OLAP_PREDICATE_KERNEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#include "runtime/vectorized_row_batch.h"
+
+namespace doris {
+
+struct StringValue;
+
+// Kernels used by ColumnPredicate::evaluate.
+//
+// Rows are processed in words of 64. For every word a matcher produces a
+// 64-bit selection bitmap (bit i set means row base + i passes), null rows
+// are masked out, and the surviving row indexes are appended to `selected`
+// in the same pass. Fixed-width numeric types build the bitmap with
+// SSE4.2, or AVX2 when the BE is compiled with USE_AVX2; other types
+// (LARGEINT, DECIMAL, DATE, CHAR/VARCHAR) use an unrolled branch-free scalar
+// loop that fills the same bitmap.
+namespace predicate_kernel {
+
+enum PredicateOp {
+    PRED_OP_EQ = 0,
+    PRED_OP_NE = 1,
+    PRED_OP_LT = 2,
+    PRED_OP_LE = 3,
+    PRED_OP_GT = 4,
+    PRED_OP_GE = 5
+};
+
+static const uint16_t ROWS_PER_WORD = 64;
+// Rows of a batch are indexed by uint16_t, so a bitmap over a batch never
+// needs more words than this.
+static const uint32_t MAX_BITMAP_WORDS = (1 << 16) / ROWS_PER_WORD;
+
+template <PredicateOp op>
+struct ScalarCompare;
+
+template <> struct ScalarCompare<PRED_OP_EQ> {
+    template <class T> static bool apply(const T& a, const T& b) { return a == b; }
+};
+template <> struct ScalarCompare<PRED_OP_NE> {
+    template <class T> static bool apply(const T& a, const T& b) { return a != b; }
+};
+template <> struct ScalarCompare<PRED_OP_LT> {
+    template <class T> static bool apply(const T& a, const T& b) { return a < b; }
+};
+template <> struct ScalarCompare<PRED_OP_LE> {
+    template <class T> static bool apply(const T& a, const T& b) { return a <= b; }
+};
+template <> struct ScalarCompare<PRED_OP_GT> {
+    template <class T> static bool apply(const T& a, const T& b) { return a > b; }
+};
+template <> struct ScalarCompare<PRED_OP_GE> {
+    template <class T> static bool apply(const T& a, const T& b) { return a >= b; }
+};
+
+// Bitmap of the true entries of 64 consecutive bools.
+inline uint64_t bool_word(const bool* values) {
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + 32));
+    uint64_t lo_false = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, zero)));
+    uint64_t hi_false = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, zero)));
+    return ~(lo_false | (hi_false << 32));
+#elif defined(__SSE4_2__)
+    const __m128i zero = _mm_setzero_si128();
+    uint64_t is_false = 0;
+    for (int i = 0; i < 4; ++i) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i * 16));
+        is_false |= static_cast<uint64_t>(
+                static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)))) << (i * 16);
+    }
+    return ~is_false;
+#else
+    uint64_t word = 0;
+    for (int i = 0; i < ROWS_PER_WORD; ++i) {
+        word |= static_cast<uint64_t>(values[i]) << i;
+    }
+    return word;
+#endif
+}
+
+// Append the row index of every set bit in word to sel, starting at size.
+inline uint16_t emit_word(uint64_t word, uint16_t base, uint16_t* sel, uint16_t size) {
+    if (word == ~0ULL) {
+        for (uint16_t i = 0; i < ROWS_PER_WORD; ++i) {
+            sel[size + i] = base + i;
+        }
+        return size + ROWS_PER_WORD;
+    }
+    while (word != 0) {
+        sel[size++] = base + __builtin_ctzll(word);
+        word &= word - 1;
+    }
+    return size;
+}
+
+// Whether the value slot of a null row may be read. Null CHAR/VARCHAR slots
+// do not hold a valid pointer, so matchers on them fall back to the
+// row-at-a-time path that skips null rows.
+template <class T>
+struct NullSlotReadable {
+    static const bool value = true;
+};
+
+template <>
+struct NullSlotReadable<StringValue> {
+    static const bool value = false;
+};
+
+// Vector traits describing how one register worth of T is loaded and compared.
+// Only specialized for the types (and instruction sets) we have kernels for.
+template <class T>
+struct SimdTraits {
+    static const bool vectorized = false;
+};
+
+#if defined(__AVX2__)
+
+struct Avx2IntBase {
+    typedef __m256i Reg;
+    static Reg not_reg(Reg a) { return _mm256_xor_si256(a, _mm256_set1_epi32(-1)); }
+};
+
+template <> struct SimdTraits<int8_t> : public Avx2IntBase {
+    static const bool vectorized = true;
+    static const int LANES = 32;
+    static Reg set1(int8_t v) { return _mm256_set1_epi8(v); }
+    static Reg load(const int8_t* p) { return _mm256_loadu_si256(reinterpret_cast<const Reg*>(p)); }
+    static Reg eq(Reg a, Reg b) { return _mm256_cmpeq_epi8(a, b); }
+    static Reg gt(Reg a, Reg b) { return _mm256_cmpgt_epi8(a, b); }
+    static uint64_t mask(Reg a) { return static_cast<uint32_t>(_mm256_movemask_epi8(a)); }
+};
+
+template <> struct SimdTraits<int16_t> : public Avx2IntBase {
+    static const bool vectorized = true;
+    static const int LANES = 16;
+    static Reg set1(int16_t v) { return _mm256_set1_epi16(v); }
+    static Reg load(const int16_t* p) { return _mm256_loadu_si256(reinterpret_cast<const Reg*>(p)); }
+    static Reg eq(Reg a, Reg b) { return _mm256_cmpeq_epi16(a, b); }
+    static Reg gt(Reg a, Reg b) { return _mm256_cmpgt_epi16(a, b); }
+    static uint64_t mask(Reg a) {
+        __m128i packed = _mm_packs_epi16(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+        return static_cast<uint16_t>(_mm_movemask_epi8(packed));
+    }
+};
+
+template <> struct SimdTraits<int32_t> : public Avx2IntBase {
+    static const bool vectorized = true;
+    static const int LANES = 8;
+    static Reg set1(int32_t v) { return _mm256_set1_epi32(v); }
+    static Reg load(const int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const Reg*>(p)); }
+    static Reg eq(Reg a, Reg b) { return _mm256_cmpeq_epi32(a, b); }
+    static Reg gt(Reg a, Reg b) { return _mm256_cmpgt_epi32(a, b); }
+    static uint64_t mask(Reg a) { return _mm256_movemask_ps(_mm256_castsi256_ps(a)); }
+};
+
+template <> struct SimdTraits<int64_t> : public Avx2IntBase {
+    static const bool vectorized = true;
+    static const int LANES = 4;
+    static Reg set1(int64_t v) { return _mm256_set1_epi64x(v); }
+    static Reg load(const int64_t* p) { return _mm256_loadu_si256(reinterpret_cast<const Reg*>(p)); }
+    static Reg eq(Reg a, Reg b) { return _mm256_cmpeq_epi64(a, b); }
+    static Reg gt(Reg a, Reg b) { return _mm256_cmpgt_epi64(a, b); }
+    static uint64_t mask(Reg a) { return _mm256_movemask_pd(_mm256_castsi256_pd(a)); }
+};
+
+// DATETIME is stored as uint64_t: flip the sign bit so signed compares order it correctly.
+template <> struct SimdTraits<uint64_t> : public Avx2IntBase {
+    static const bool vectorized = true;
+    static const int LANES = 4;
+    static Reg set1(uint64_t v) { return _mm256_set1_epi64x(v ^ (1ULL << 63)); }
+    static Reg load(const uint64_t* p) {
+        return _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const Reg*>(p)),
+                                _mm256_set1_epi64x(1ULL << 63));
+    }
+    static Reg eq(Reg a, Reg b) { return _mm256_cmpeq_epi64(a, b); }
+    static Reg gt(Reg a, Reg b) { return _mm256_cmpgt_epi64(a, b); }
+    static uint64_t mask(Reg a) { return _mm256_movemask_pd(_mm256_castsi256_pd(a)); }
+};
+
+template <> struct SimdTraits<float> {
+    typedef __m256 Reg;
+    static const bool vectorized = true;
+    static const int LANES = 8;
+    static Reg set1(float v) { return _mm256_set1_ps(v); }
+    static Reg load(const float* p) { return _mm256_loadu_ps(p); }
+    template <int imm> static Reg cmp(Reg a, Reg b) { return _mm256_cmp_ps(a, b, imm); }
+    static uint64_t mask(Reg a) { return _mm256_movemask_ps(a); }
+};
+
+template <> struct SimdTraits<double> {
+    typedef __m256d Reg;
+    static const bool vectorized = true;
+    static const int LANES = 4;
+    static Reg set1(double v) { return _mm256_set1_pd(v); }
+    static Reg load(const double* p) { return _mm256_loadu_pd(p); }
+    template <int imm> static Reg cmp(Reg a, Reg b) { return _mm256_cmp_pd(a, b, imm); }
+    static uint64_t mask(Reg a) { return _mm256_movemask_pd(a); }
+};
+
+#define PRED_KERNEL_FLOAT_EQ _CMP_EQ_OQ
+#define PRED_KERNEL_FLOAT_NE _CMP_NEQ_UQ
+#define PRED_KERNEL_FLOAT_LT _CMP_LT_OQ
+#define PRED_KERNEL_FLOAT_LE _CMP_LE_OQ
+#define PRED_KERNEL_FLOAT_GT _CMP_GT_OQ
+#define PRED_KERNEL_FLOAT_GE _CMP_GE_OQ
+
+#elif defined(__SSE4_2__)
+
+struct SseIntBase {
+    typedef __m128i Reg;
+    static Reg not_reg(Reg a) { return _mm_xor_si128(a, _mm_set1_epi32(-1)); }
+};
+
+template <> struct SimdTraits<int8_t> : public SseIntBase {
+    static const bool vectorized = true;
+    static const int LANES = 16;
+    static Reg set1(int8_t v) { return _mm_set1_epi8(v); }
+    static Reg load(const int8_t* p) { return _mm_loadu_si128(reinterpret_cast<const Reg*>(p)); }
+    static Reg eq(Reg a, Reg b) { return _mm_cmpeq_epi8(a, b); }
+    static Reg gt(Reg a, Reg b) { return _mm_cmpgt_epi8(a, b); }
+    static uint64_t mask(Reg a) { return static_cast<uint16_t>(_mm_movemask_epi8(a)); }
+};
+
+template <> struct SimdTraits<int16_t> : public SseIntBase {
+    static const bool vectorized = true;
+    static const int LANES = 8;
+    static Reg set1(int16_t v) { return _mm_set1_epi16(v); }
+    static Reg load(const int16_t* p) { return _mm_loadu_si128(reinterpret_cast<const Reg*>(p)); }
+    static Reg eq(Reg a, Reg b) { return _mm_cmpeq_epi16(a, b); }
+    static Reg gt(Reg a, Reg b) { return _mm_cmpgt_epi16(a, b); }
+    static uint64_t mask(Reg a) {
+        return static_cast<uint8_t>(_mm_movemask_epi8(_mm_packs_epi16(a, _mm_setzero_si128())));
+    }
+};
+
+template <> struct SimdTraits<int32_t> : public SseIntBase {
+    static const bool vectorized = true;
+    static const int LANES = 4;
+    static Reg set1(int32_t v) { return _mm_set1_epi32(v); }
+    static Reg load(const int32_t* p) { return _mm_loadu_si128(reinterpret_cast<const Reg*>(p)); }
+    static Reg eq(Reg a, Reg b) { return _mm_cmpeq_epi32(a, b); }
+    static Reg gt(Reg a, Reg b) { return _mm_cmpgt_epi32(a, b); }
+    static uint64_t mask(Reg a) { return _mm_movemask_ps(_mm_castsi128_ps(a)); }
+};
+
+template <> struct SimdTraits<int64_t> : public SseIntBase {
+    static const bool vectorized = true;
+    static const int LANES = 2;
+    static Reg set1(int64_t v) { return _mm_set1_epi64x(v); }
+    static Reg load(const int64_t* p) { return _mm_loadu_si128(reinterpret_cast<const Reg*>(p)); }
+    static Reg eq(Reg a, Reg b) { return _mm_cmpeq_epi64(a, b); }
+    static Reg gt(Reg a, Reg b) { return _mm_cmpgt_epi64(a, b); }
+    static uint64_t mask(Reg a) { return _mm_movemask_pd(_mm_castsi128_pd(a)); }
+};
+
+// DATETIME is stored as uint64_t: flip the sign bit so signed compares order it correctly.
+template <> struct SimdTraits<uint64_t> : public SseIntBase {
+    static const bool vectorized = true;
+    static const int LANES = 2;
+    static Reg set1(uint64_t v) { return _mm_set1_epi64x(v ^ (1ULL << 63)); }
+    static Reg load(const uint64_t* p) {
+        return _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const Reg*>(p)),
+                             _mm_set1_epi64x(1ULL << 63));
+    }
+    static Reg eq(Reg a, Reg b) { return _mm_cmpeq_epi64(a, b); }
+    static Reg gt(Reg a, Reg b) { return _mm_cmpgt_epi64(a, b); }
+    static uint64_t mask(Reg a) { return _mm_movemask_pd(_mm_castsi128_pd(a)); }
+};
+
+template <> struct SimdTraits<float> {
+    typedef __m128 Reg;
+    static const bool vectorized = true;
+    static const int LANES = 4;
+    static Reg set1(float v) { return _mm_set1_ps(v); }
+    static Reg load(const float* p) { return _mm_loadu_ps(p); }
+    template <int imm> static Reg cmp(Reg a, Reg b);
+    static uint64_t mask(Reg a) { return _mm_movemask_ps(a); }
+};
+
+template <> struct SimdTraits<double> {
+    typedef __m128d Reg;
+    static const bool vectorized = true;
+    static const int LANES = 2;
+    static Reg set1(double v) { return _mm_set1_pd(v); }
+    static Reg load(const double* p) { return _mm_loadu_pd(p); }
+    template <int imm> static Reg cmp(Reg a, Reg b);
+    static uint64_t mask(Reg a) { return _mm_movemask_pd(a); }
+};
+
+// SSE has no generic compare with an immediate predicate, map each one explicitly.
+#define PRED_KERNEL_FLOAT_EQ 0
+#define PRED_KERNEL_FLOAT_NE 1
+#define PRED_KERNEL_FLOAT_LT 2
+#define PRED_KERNEL_FLOAT_LE 3
+#define PRED_KERNEL_FLOAT_GT 4
+#define PRED_KERNEL_FLOAT_GE 5
+
+#define PRED_KERNEL_SSE_FLOAT_CMP(T, REG, IMM, FUNC) \
+    template <> inline REG SimdTraits<T>::cmp<IMM>(REG a, REG b) { return FUNC(a, b); }
+
+PRED_KERNEL_SSE_FLOAT_CMP(float, __m128, PRED_KERNEL_FLOAT_EQ, _mm_cmpeq_ps)
+PRED_KERNEL_SSE_FLOAT_CMP(float, __m128, PRED_KERNEL_FLOAT_NE, _mm_cmpneq_ps)
+PRED_KERNEL_SSE_FLOAT_CMP(float, __m128, PRED_KERNEL_FLOAT_LT, _mm_cmplt_ps)
+PRED_KERNEL_SSE_FLOAT_CMP(float, __m128, PRED_KERNEL_FLOAT_LE, _mm_cmple_ps)
+PRED_KERNEL_SSE_FLOAT_CMP(float, __m128, PRED_KERNEL_FLOAT_GT, _mm_cmpgt_ps)
+PRED_KERNEL_SSE_FLOAT_CMP(float, __m128, PRED_KERNEL_FLOAT_GE, _mm_cmpge_ps)
+PRED_KERNEL_SSE_FLOAT_CMP(double, __m128d, PRED_KERNEL_FLOAT_EQ, _mm_cmpeq_pd)
+PRED_KERNEL_SSE_FLOAT_CMP(double, __m128d, PRED_KERNEL_FLOAT_NE, _mm_cmpneq_pd)
+PRED_KERNEL_SSE_FLOAT_CMP(double, __m128d, PRED_KERNEL_FLOAT_LT, _mm_cmplt_pd)
+PRED_KERNEL_SSE_FLOAT_CMP(double, __m128d, PRED_KERNEL_FLOAT_LE, _mm_cmple_pd)
+PRED_KERNEL_SSE_FLOAT_CMP(double, __m128d, PRED_KERNEL_FLOAT_GT, _mm_cmpgt_pd)
+PRED_KERNEL_SSE_FLOAT_CMP(double, __m128d, PRED_KERNEL_FLOAT_GE, _mm_cmpge_pd)
+
+#undef PRED_KERNEL_SSE_FLOAT_CMP
+
+#endif
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+
+// Lane compare for integer registers, derived from eq/gt. Integers have no
+// unordered values so NE/LE/GE are plain negations.
+template <PredicateOp op, class V>
+struct IntVecCompare;
+
+template <class V> struct IntVecCompare<PRED_OP_EQ, V> {
+    static typename V::Reg apply(typename V::Reg a, typename V::Reg b) { return V::eq(a, b); }
+};
+template <class V> struct IntVecCompare<PRED_OP_NE, V> {
+    static typename V::Reg apply(typename V::Reg a, typename V::Reg b) {
+        return V::not_reg(V::eq(a, b));
+    }
+};
+template <class V> struct IntVecCompare<PRED_OP_LT, V> {
+    static typename V::Reg apply(typename V::Reg a, typename V::Reg b) { return V::gt(b, a); }
+};
+template <class V> struct IntVecCompare<PRED_OP_LE, V> {
+    static typename V::Reg apply(typename V::Reg a, typename V::Reg b) {
+        return V::not_reg(V::gt(a, b));
+    }
+};
+template <class V> struct IntVecCompare<PRED_OP_GT, V> {
+    static typename V::Reg apply(typename V::Reg a, typename V::Reg b) { return V::gt(a, b); }
+};
+template <class V> struct IntVecCompare<PRED_OP_GE, V> {
+    static typename V::Reg apply(typename V::Reg a, typename V::Reg b) {
+        return V::not_reg(V::gt(b, a));
+    }
+};
+
+// Floating point compares keep NaN semantics of the scalar operators: only
+// NE is true for an unordered pair.
+template <PredicateOp op> struct FloatPredicateImm;
+template <> struct FloatPredicateImm<PRED_OP_EQ> { static const int value = PRED_KERNEL_FLOAT_EQ; };
+template <> struct FloatPredicateImm<PRED_OP_NE> { static const int value = PRED_KERNEL_FLOAT_NE; };
+template <> struct FloatPredicateImm<PRED_OP_LT> { static const int value = PRED_KERNEL_FLOAT_LT; };
+template <> struct FloatPredicateImm<PRED_OP_LE> { static const int value = PRED_KERNEL_FLOAT_LE; };
+template <> struct FloatPredicateImm<PRED_OP_GT> { static const int value = PRED_KERNEL_FLOAT_GT; };
+template <> struct FloatPredicateImm<PRED_OP_GE> { static const int value = PRED_KERNEL_FLOAT_GE; };
+
+template <PredicateOp op, class V>
+struct FloatVecCompare {
+    static typename V::Reg apply(typename V::Reg a, typename V::Reg b) {
+        return V::template cmp<FloatPredicateImm<op>::value>(a, b);
+    }
+};
+
+template <PredicateOp op, class T>
+struct VecCompare : public IntVecCompare<op, SimdTraits<T> > {};
+template <PredicateOp op>
+struct VecCompare<op, float> : public FloatVecCompare<op, SimdTraits<float> > {};
+template <PredicateOp op>
+struct VecCompare<op, double> : public FloatVecCompare<op, SimdTraits<double> > {};
+
+#endif
+
+// Matcher for `column OP value`. word(base) returns the bitmap of 64 rows
+// starting at base, row(i) evaluates a single row.
+template <PredicateOp op, class T, bool vectorized = SimdTraits<T>::vectorized>
+class CompareMatcher {
+public:
+    static const bool NULL_SAFE = NullSlotReadable<T>::value;
+
+    CompareMatcher(const T* data, const T& value) : _data(data), _value(value) {}
+
+    uint64_t word(uint16_t base) const {
+        const T* data = _data + base;
+        uint64_t word = 0;
+        for (int i = 0; i < ROWS_PER_WORD; ++i) {
+            word |= static_cast<uint64_t>(ScalarCompare<op>::apply(data[i], _value)) << i;
+        }
+        return word;
+    }
+
+    bool row(uint16_t i) const {
+        return ScalarCompare<op>::apply(_data[i], _value);
+    }
+
+private:
+    const T* _data;
+    const T& _value;
+};
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+
+template <PredicateOp op, class T>
+class CompareMatcher<op, T, true> {
+public:
+    typedef SimdTraits<T> V;
+    static const bool NULL_SAFE = true;
+
+    CompareMatcher(const T* data, const T& value)
+        : _data(data), _value(value), _value_reg(V::set1(value)) {}
+
+    uint64_t word(uint16_t base) const {
+        const T* data = _data + base;
+        uint64_t word = 0;
+        for (int i = 0; i < ROWS_PER_WORD; i += V::LANES) {
+            typename V::Reg cmp = VecCompare<op, T>::apply(V::load(data + i), _value_reg);
+            word |= V::mask(cmp) << i;
+        }
+        return word;
+    }
+
+    bool row(uint16_t i) const {
+        return ScalarCompare<op>::apply(_data[i], _value);
+    }
+
+private:
+    const T* _data;
+    const T _value;
+    typename V::Reg _value_reg;
+};
+
+#endif
+
+// In-lists up to this size are evaluated with one SIMD equality per value.
+static const size_t MAX_VECTORIZED_IN_LIST_SIZE = 8;
+
+// Matcher for `column IN (values)` (or NOT IN when negate is set). When
+// value_list is non-empty (it is only filled for short lists) the values are
+// OR-ed with SIMD equalities, otherwise every row probes the set.
+template <class T, class Set>
+class InListMatcher {
+public:
+    static const bool NULL_SAFE = NullSlotReadable<T>::value;
+
+    InListMatcher(const T* data, const Set& values, const std::vector<T>& value_list, bool negate)
+        : _data(data), _values(values), _value_list(value_list), _negate(negate) {}
+
+    uint64_t word(uint16_t base) const {
+        uint64_t word = 0;
+        if (SimdTraits<T>::vectorized && !_value_list.empty()) {
+            for (const T& value : _value_list) {
+                word |= CompareMatcher<PRED_OP_EQ, T>(_data, value).word(base);
+            }
+        } else {
+            const T* data = _data + base;
+            for (int i = 0; i < ROWS_PER_WORD; ++i) {
+                word |= static_cast<uint64_t>(_values.find(data[i]) != _values.end()) << i;
+            }
+        }
+        return _negate ? ~word : word;
+    }
+
+    bool row(uint16_t i) const {
+        return (_values.find(_data[i]) != _values.end()) != _negate;
+    }
+
+private:
+    const T* _data;
+    const Set& _values;
+    const std::vector<T>& _value_list;
+    bool _negate;
+};
+
+// Matcher for `column IS [NOT] NULL`.
+class NullMatcher {
+public:
+    static const bool NULL_SAFE = true;
+
+    NullMatcher(const bool* is_null, bool match_null) : _is_null(is_null), _match_null(match_null) {}
+
+    uint64_t word(uint16_t base) const {
+        uint64_t word = bool_word(_is_null + base);
+        return _match_null ? word : ~word;
+    }
+
+    bool row(uint16_t i) const {
+        return _is_null[i] == _match_null;
+    }
+
+private:
+    const bool* _is_null;
+    bool _match_null;
+};
+
+// Fill bitmap with the matcher result for rows [0, n), null rows cleared. n is
+// up to 1 << 16, one past the last row a uint16_t can index.
+template <class Matcher>
+void build_bitmap(const Matcher& matcher, const bool* is_null, uint32_t n, uint64_t* bitmap) {
+    uint32_t i = 0;
+    for (; i + ROWS_PER_WORD <= n; i += ROWS_PER_WORD) {
+        uint64_t word = matcher.word(i);
+        if (is_null != nullptr) {
+            word &= ~bool_word(is_null + i);
+        }
+        bitmap[i / ROWS_PER_WORD] = word;
+    }
+    if (i < n) {
+        uint64_t word = 0;
+        for (uint32_t j = i; j < n; ++j) {
+            bool pass = (is_null == nullptr || !is_null[j]) && matcher.row(j);
+            word |= static_cast<uint64_t>(pass) << (j - i);
+        }
+        bitmap[i / ROWS_PER_WORD] = word;
+    }
+}
+
+// Evaluate matcher over the rows of a batch and compact the survivors into
+// sel. is_null is nullptr when the column has no nulls. Returns the number of
+// selected rows.
+template <class Matcher>
+uint16_t select_rows(const Matcher& matcher, const bool* is_null,
+                uint16_t n, uint16_t* sel, bool selected_in_use) {
+    uint16_t new_size = 0;
+    if (!Matcher::NULL_SAFE && is_null != nullptr) {
+        for (uint16_t j = 0; j != n; ++j) {
+            uint16_t i = selected_in_use ? sel[j] : j;
+            sel[new_size] = i;
+            new_size += (!is_null[i] && matcher.row(i));
+        }
+        return new_size;
+    }
+    if (!selected_in_use) {
+        uint16_t i = 0;
+        for (; i + ROWS_PER_WORD <= n; i += ROWS_PER_WORD) {
+            uint64_t word = matcher.word(i);
+            if (is_null != nullptr) {
+                word &= ~bool_word(is_null + i);
+            }
+            new_size = emit_word(word, i, sel, new_size);
+        }
+        for (; i < n; ++i) {
+            sel[new_size] = i;
+            new_size += ((is_null == nullptr || !is_null[i]) && matcher.row(i));
+        }
+        return new_size;
+    }
+
+    // `sel` is sorted, so the selected rows lie in [0, sel[n - 1]]. When they
+    // are dense enough it is cheaper to evaluate the whole range with the
+    // word kernel and test one bit per selected row. The range is 1 << 16 when
+    // the last selected row is 65535, so it does not fit in uint16_t.
+    uint32_t range = static_cast<uint32_t>(sel[n - 1]) + 1;
+    if (n * 4 >= range) {
+        uint64_t bitmap[MAX_BITMAP_WORDS];
+        build_bitmap(matcher, is_null, range, bitmap);
+        for (uint16_t j = 0; j != n; ++j) {
+            uint16_t i = sel[j];
+            sel[new_size] = i;
+            new_size += (bitmap[i / ROWS_PER_WORD] >> (i % ROWS_PER_WORD)) & 1;
+        }
+    } else {
+        for (uint16_t j = 0; j != n; ++j) {
+            uint16_t i = sel[j];
+            sel[new_size] = i;
+            new_size += ((is_null == nullptr || !is_null[i]) && matcher.row(i));
+        }
+    }
+    return new_size;
+}
+
+// Evaluate matcher over batch and update its size and selection vector.
+template <class Matcher>
+void evaluate_batch(const Matcher& matcher, const bool* is_null, VectorizedRowBatch* batch) {
+    uint16_t n = batch->size();
+    if (n == 0) {
+        return;
+    }
+    uint16_t new_size = select_rows(matcher, is_null, n, batch->selected(), batch->selected_in_use());
+    if (batch->selected_in_use()) {
+        batch->set_size(new_size);
+    } else if (new_size < n) {
+        batch->set_size(new_size);
+        batch->set_selected_in_use(true);
+    }
+}
+
+} // namespace predicate_kernel
+
+} // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_PREDICATE_KERNEL_H
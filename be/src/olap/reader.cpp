@@ -18,6 +18,7 @@
 #include "olap/reader.h"
 
 #include "olap/column_data.h"
+#include "olap/loser_tree.h"
 #include "olap/olap_table.h"
 #include "olap/row_block.h"
 #include "olap/row_cursor.h"
@@ -25,8 +26,10 @@
 #include "util/mem_util.hpp"
 #include "runtime/mem_tracker.h"
 #include "runtime/mem_pool.h"
+#include <algorithm>
 #include <sstream>
 
+#include "olap/bloom_filter_predicate.h"
 #include "olap/comparison_predicate.h"
 #include "olap/in_list_predicate.h"
 #include "olap/null_predicate.h"
@@ -37,6 +40,69 @@ using std::vector;
 
 namespace doris {
 
+bool get_key_prefix(FieldType type, const char* ptr, uint64_t* prefix) {
+    static const uint64_t SIGN_BIT = 1ULL << 63;
+    switch (type) {
+    case OLAP_FIELD_TYPE_TINYINT:
+        *prefix = static_cast<uint64_t>(static_cast<int64_t>(*(const int8_t*)ptr)) ^ SIGN_BIT;
+        return true;
+    case OLAP_FIELD_TYPE_SMALLINT:
+        *prefix = static_cast<uint64_t>(static_cast<int64_t>(*(const int16_t*)ptr)) ^ SIGN_BIT;
+        return true;
+    case OLAP_FIELD_TYPE_INT:
+        *prefix = static_cast<uint64_t>(static_cast<int64_t>(*(const int32_t*)ptr)) ^ SIGN_BIT;
+        return true;
+    case OLAP_FIELD_TYPE_BIGINT:
+    case OLAP_FIELD_TYPE_DATETIME:
+        *prefix = static_cast<uint64_t>(*(const int64_t*)ptr) ^ SIGN_BIT;
+        return true;
+    case OLAP_FIELD_TYPE_LARGEINT:
+        // high 64 bits
+        *prefix = static_cast<uint64_t>(static_cast<int64_t>(
+                reinterpret_cast<const PackedInt128*>(ptr)->value >> 64)) ^ SIGN_BIT;
+        return true;
+    case OLAP_FIELD_TYPE_UNSIGNED_TINYINT:
+        *prefix = *(const uint8_t*)ptr;
+        return true;
+    case OLAP_FIELD_TYPE_UNSIGNED_SMALLINT:
+        *prefix = *(const uint16_t*)ptr;
+        return true;
+    case OLAP_FIELD_TYPE_UNSIGNED_INT:
+        *prefix = *(const uint32_t*)ptr;
+        return true;
+    case OLAP_FIELD_TYPE_UNSIGNED_BIGINT:
+        *prefix = *(const uint64_t*)ptr;
+        return true;
+    case OLAP_FIELD_TYPE_DATE:
+        *prefix = *(const uint24_t*)ptr;
+        return true;
+    case OLAP_FIELD_TYPE_CHAR:
+    case OLAP_FIELD_TYPE_VARCHAR: {
+        // first 8 bytes as a big endian number, shorter values padded with 0
+        const Slice* slice = (const Slice*)ptr;
+        uint64_t value = 0;
+        size_t size = std::min<size_t>(slice->size, sizeof(value));
+        for (size_t i = 0; i < sizeof(value); ++i) {
+            value <<= 8;
+            if (i < size) {
+                value |= static_cast<uint8_t>(slice->data[i]);
+            }
+        }
+        *prefix = value;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void KeyPrefix::update(FieldType key_type, const RowCursor& row) {
+    const Field* field = row.get_field_by_index(0);
+    char* buf = row.get_buf();
+    is_null = field->is_null(buf);
+    valid = is_null || get_key_prefix(key_type, field->get_ptr(buf), &value);
+}
+
 class CollectIterator {
 public:
     ~CollectIterator();
@@ -47,6 +113,9 @@ public:
 
     OLAPStatus add_child(ColumnData* data, RowBlock* block);
 
+    // Called after all children of a key range are added, before reading
+    void start();
+
     // Get top row of the heap, NULL if reach end.
     const RowCursor* current_row(bool* delete_flag) const {
         if (_cur_child != nullptr) {
@@ -65,19 +134,22 @@ public:
 private:
     class ChildCtx {
     public:
-        ChildCtx(ColumnData* data, RowBlock* block, Reader* reader)
+        ChildCtx(ColumnData* data, RowBlock* block, Reader* reader, bool cache_key_prefix)
                 : _data(data),
                 _is_delete(data->delete_flag()),
                 _reader(reader),
+                _cache_key_prefix(cache_key_prefix),
                 _row_block(block) {
         }
 
         OLAPStatus init() {
-            auto res = _row_cursor.init(_data->segment_group()->table()->tablet_schema());
+            const std::vector<FieldInfo>& schema = _data->segment_group()->table()->tablet_schema();
+            auto res = _row_cursor.init(schema);
             if (res != OLAP_SUCCESS) {
                 LOG(WARNING) << "failed to init row cursor, res=" << res;
                 return res;
             }
+            _key_type = schema[0].type;
             res = _refresh_current_row();
             if (res != OLAP_SUCCESS) {
                 return res;
@@ -98,6 +170,10 @@ private:
             return _data->version().second;
         }
 
+        const KeyPrefix& key_prefix() const {
+            return _key_prefix;
+        }
+
         OLAPStatus next(const RowCursor** row, bool* delete_flag) {
             _row_block->pos_inc();
             auto res = _refresh_current_row();
@@ -121,6 +197,9 @@ private:
                         continue;
                     }
                     _current_row = &_row_cursor;
+                    if (_cache_key_prefix) {
+                        _key_prefix.update(_key_type, _row_cursor);
+                    }
                     return OLAP_SUCCESS;
                 } else {
                     auto res = _data->get_next_block(&_row_block);
@@ -138,6 +217,10 @@ private:
         const RowCursor* _current_row = nullptr;
         bool _is_delete = false;
         Reader* _reader;
+        bool _cache_key_prefix;
+        FieldType _key_type = OLAP_FIELD_TYPE_NONE;
+        // First key column of the current row
+        KeyPrefix _key_prefix;
 
         RowCursor _row_cursor;
         RowBlock* _row_block = nullptr;
@@ -145,9 +228,9 @@ private:
 
     // Compare row cursors between multiple merge elements,
     // if row cursors equal, compare data version.
-    class ChildCtxComparator {
+    class ChildCtxLess {
     public:
-        bool operator()(const ChildCtx* a, const ChildCtx* b);
+        bool operator()(const ChildCtx& a, const ChildCtx& b) const;
     };
 
     inline OLAPStatus _merge_next(const RowCursor** row, bool* delete_flag);
@@ -156,8 +239,7 @@ private:
     // If _merge is true, result row must be ordered
     bool _merge = true;
 
-    typedef std::priority_queue<ChildCtx*, std::vector<ChildCtx*>, ChildCtxComparator> MergeHeap;
-    MergeHeap _heap;
+    LoserTree<ChildCtx, ChildCtxLess> _merge_tree;
 
     std::vector<ChildCtx*> _children;
     ChildCtx* _cur_child = nullptr;
@@ -188,7 +270,7 @@ OLAPStatus CollectIterator::init(Reader* reader) {
 }
 
 OLAPStatus CollectIterator::add_child(ColumnData* data, RowBlock* block) {
-    std::unique_ptr<ChildCtx> child(new ChildCtx(data, block, _reader));
+    std::unique_ptr<ChildCtx> child(new ChildCtx(data, block, _reader, _merge));
     RETURN_NOT_OK(child->init());
     if (child->current_row() == nullptr) {
         return OLAP_SUCCESS;
@@ -196,10 +278,7 @@ OLAPStatus CollectIterator::add_child(ColumnData* data, RowBlock* block) {
 
     ChildCtx* child_ptr = child.release();
     _children.push_back(child_ptr);
-    if (_merge) {
-        _heap.push(child_ptr);
-        _cur_child = _heap.top();
-    } else {
+    if (!_merge) {
         if (_cur_child == nullptr) {
             _cur_child = _children[_child_idx];
         }
@@ -207,6 +286,13 @@ OLAPStatus CollectIterator::add_child(ColumnData* data, RowBlock* block) {
     return OLAP_SUCCESS;
 }
 
+void CollectIterator::start() {
+    if (_merge) {
+        _merge_tree.init(_children);
+        _cur_child = _merge_tree.top();
+    }
+}
+
 inline OLAPStatus CollectIterator::next(const RowCursor** row, bool* delete_flag) {
     DCHECK(_cur_child != nullptr);
     if (_merge) {
@@ -217,22 +303,19 @@ inline OLAPStatus CollectIterator::next(const RowCursor** row, bool* delete_flag
 }
 
 inline OLAPStatus CollectIterator::_merge_next(const RowCursor** row, bool* delete_flag) {
-    _heap.pop();
     auto res = _cur_child->next(row, delete_flag);
     if (res == OLAP_SUCCESS) {
-        _heap.push(_cur_child);
-        _cur_child = _heap.top();
+        _merge_tree.next(_cur_child);
     } else if (res == OLAP_ERR_DATA_EOF) {
-        if (_heap.size() > 0) {
-            _cur_child = _heap.top();
-        } else {
-            _cur_child = nullptr;
-            return OLAP_ERR_DATA_EOF;
-        }
+        _merge_tree.next(nullptr);
     } else {
         LOG(WARNING) << "failed to get next from child, res=" << res;
         return res;
     }
+    _cur_child = _merge_tree.top();
+    if (_cur_child == nullptr) {
+        return OLAP_ERR_DATA_EOF;
+    }
     *row = _cur_child->current_row(delete_flag);
     return OLAP_SUCCESS;
 }
@@ -258,22 +341,21 @@ inline OLAPStatus CollectIterator::_normal_next(const RowCursor** row, bool* del
     }
 }
 
-bool CollectIterator::ChildCtxComparator::operator()(const ChildCtx* a, const ChildCtx* b) {
+bool CollectIterator::ChildCtxLess::operator()(const ChildCtx& a, const ChildCtx& b) const {
+    int prefix_cmp = KeyPrefix::compare(a.key_prefix(), b.key_prefix());
+    if (prefix_cmp != 0) {
+        return prefix_cmp < 0;
+    }
     // First compare row cursor.
-    const RowCursor* first = a->current_row();
-    const RowCursor* second = b->current_row();
-    int cmp_res = first->full_key_cmp(*second);
+    int cmp_res = a.current_row()->full_key_cmp(*b.current_row());
     if (cmp_res != 0) {
-        return cmp_res > 0;
+        return cmp_res < 0;
     }
     // if row cursors equal, compare data version.
-    return a->version() > b->version();
+    return a.version() < b.version();
 }
 
 void CollectIterator::clear() {
-    while (_heap.size() > 0) {
-        _heap.pop();
-    }
     for (auto child : _children) {
         delete child;
     }
@@ -307,6 +389,9 @@ OLAPStatus Reader::init(const ReaderParams& read_params) {
         OLAP_LOG_WARNING("fail to init reader when init params.[res=%d]", res);
         return res;
     }
+    if (_reader_type == READER_QUERY) {
+        _olap_table->record_query();
+    }
 
     res = _acquire_data_sources(read_params);
     if (res != OLAP_SUCCESS) {
@@ -318,6 +403,12 @@ OLAPStatus Reader::init(const ReaderParams& read_params) {
         i_data->set_stats(&_stats);
     }
 
+    _vectorized_read = _can_read_vectorized();
+    if (_vectorized_read) {
+        // data is attached by the first next_vector_batch
+        return OLAP_SUCCESS;
+    }
+
     bool eof = false;
     if (OLAP_SUCCESS != (res = _attach_data_to_merge_set(true, &eof))) {
         OLAP_LOG_WARNING("failed to attaching data to merge set. [res=%d]", res);
@@ -503,6 +594,15 @@ OLAPStatus Reader::_acquire_data_sources(const ReaderParams& read_params) {
         is_using_cache = false;
     }
 
+    if (read_params.num_block_splits > 1
+            && (_olap_table->keys_type() != KeysType::DUP_KEYS
+                || !_keys_param.start_keys.empty())) {
+        LOG(WARNING) << "block split is only for DUP_KEYS tablets without keys. table="
+                     << _olap_table->full_name() << ", num_block_splits="
+                     << read_params.num_block_splits;
+        return OLAP_ERR_INPUT_PARAMETER_ERROR;
+    }
+
     for (auto i_data: *data_sources) {
         // skip empty version
         if (i_data->empty() || i_data->zero_num_rows()) {
@@ -517,10 +617,12 @@ OLAPStatus Reader::_acquire_data_sources(const ReaderParams& read_params) {
                                 _keys_param.end_keys,
                                 is_using_cache,
                                 read_params.runtime_state);
+        i_data->set_block_split(read_params.block_split, read_params.num_block_splits);
         if (i_data->delta_pruning_filter()) {
             VLOG(3) << "filter delta in query in condition:"
                     << i_data->version().first << ", " << i_data->version().second;
             _stats.rows_stats_filtered += i_data->num_rows();
+            ++_stats.segments_stats_filtered;
             continue;
         }
         int ret = i_data->delete_pruning_filter();
@@ -639,83 +741,96 @@ OLAPStatus Reader::_init_return_columns(const ReaderParams& read_params) {
     return OLAP_SUCCESS;
 }
 
-OLAPStatus Reader::_attach_data_to_merge_set(bool first, bool *eof) {
+OLAPStatus Reader::_next_key_range(bool first, KeyRange* key_range, bool* eof) {
     OLAPStatus res = OLAP_SUCCESS;
     *eof = false;
+    *key_range = KeyRange();
 
-    do {
-        RowCursor *start_key = NULL;
-        RowCursor *end_key = NULL;
-        bool find_last_row = false;
-        bool end_key_find_last_row = false;
-        _collect_iter->clear();
-
-        if (_keys_param.start_keys.size() > 0) {
-            if (_next_key_index >= _keys_param.start_keys.size()) {
-                *eof = true;
-                VLOG(3) << "can NOT attach while start_key has been used.";
+    if (_keys_param.start_keys.size() > 0) {
+        if (_next_key_index >= _keys_param.start_keys.size()) {
+            *eof = true;
+            VLOG(3) << "can NOT attach while start_key has been used.";
+            return res;
+        }
+        auto cur_key_index = _next_key_index++;
+
+        RowCursor* start_key = _keys_param.start_keys[cur_key_index];
+        RowCursor* end_key = nullptr;
+        key_range->start_key = start_key;
+
+        if (0 != _keys_param.end_keys.size()) {
+            end_key = _keys_param.end_keys[cur_key_index];
+            key_range->end_key = end_key;
+            if (0 == _keys_param.end_range.compare("lt")) {
+                key_range->end_key_find_last_row = false;
+            } else if (0 == _keys_param.end_range.compare("le")) {
+                key_range->end_key_find_last_row = true;
+            } else {
+                OLAP_LOG_WARNING("reader params end_range is error. [range='%s']", 
+                                 _keys_param.to_string().c_str());
+                res = OLAP_ERR_READER_GET_ITERATOR_ERROR;
                 return res;
             }
-            auto cur_key_index = _next_key_index++;
-            
-            start_key = _keys_param.start_keys[cur_key_index];
-
-            if (0 != _keys_param.end_keys.size()) {
-                end_key = _keys_param.end_keys[cur_key_index];
-                if (0 == _keys_param.end_range.compare("lt")) {
-                    end_key_find_last_row = false;
-                } else if (0 == _keys_param.end_range.compare("le")) {
-                    end_key_find_last_row = true;
-                } else {
-                    OLAP_LOG_WARNING("reader params end_range is error. [range='%s']", 
-                                     _keys_param.to_string().c_str());
-                    res = OLAP_ERR_READER_GET_ITERATOR_ERROR;
-                    return res;
-                }
+        }
+        
+        if (0 == _keys_param.range.compare("gt")) {
+            if (NULL != end_key
+                    && start_key->cmp(*end_key) >= 0) {
+                VLOG(10) << "return EOF when range=" << _keys_param.range
+                         << ", start_key=" << start_key->to_string()
+                         << ", end_key=" << end_key->to_string();
+                *eof = true;
+                return res;
             }
             
-            if (0 == _keys_param.range.compare("gt")) {
-                if (NULL != end_key
-                        && start_key->cmp(*end_key) >= 0) {
-                    VLOG(10) << "return EOF when range=" << _keys_param.range
-                             << ", start_key=" << start_key->to_string()
-                             << ", end_key=" << end_key->to_string();
-                    *eof = true;
-                    return res;
-                }
-                
-                find_last_row = true;
-            } else if (0 == _keys_param.range.compare("ge")) {
-                if (NULL != end_key
-                        && start_key->cmp(*end_key) > 0) {
-                    VLOG(10) << "return EOF when range=" << _keys_param.range
-                             << ", start_key=" << start_key->to_string()
-                             << ", end_key=" << end_key->to_string();
-                    *eof = true;
-                    return res;
-                }
-                
-                find_last_row = false;
-            } else if (0 == _keys_param.range.compare("eq")) {
-                find_last_row = false;
-                end_key = start_key;
-                end_key_find_last_row = true;
-            } else {
-                OLAP_LOG_WARNING(
-                        "reader params range is error. [range='%s']", 
-                        _keys_param.to_string().c_str());
-                res = OLAP_ERR_READER_GET_ITERATOR_ERROR;
+            key_range->find_last_row = true;
+        } else if (0 == _keys_param.range.compare("ge")) {
+            if (NULL != end_key
+                    && start_key->cmp(*end_key) > 0) {
+                VLOG(10) << "return EOF when range=" << _keys_param.range
+                         << ", start_key=" << start_key->to_string()
+                         << ", end_key=" << end_key->to_string();
+                *eof = true;
                 return res;
             }
-        } else if (false == first) {
-            *eof = true;
+            
+            key_range->find_last_row = false;
+        } else if (0 == _keys_param.range.compare("eq")) {
+            key_range->find_last_row = false;
+            key_range->end_key = start_key;
+            key_range->end_key_find_last_row = true;
+        } else {
+            OLAP_LOG_WARNING(
+                    "reader params range is error. [range='%s']", 
+                    _keys_param.to_string().c_str());
+            res = OLAP_ERR_READER_GET_ITERATOR_ERROR;
+            return res;
+        }
+    } else if (false == first) {
+        *eof = true;
+        return res;
+    }
+    return res;
+}
+
+OLAPStatus Reader::_attach_data_to_merge_set(bool first, bool *eof) {
+    OLAPStatus res = OLAP_SUCCESS;
+    *eof = false;
+
+    do {
+        KeyRange key_range;
+        _collect_iter->clear();
+
+        res = _next_key_range(first, &key_range, eof);
+        if (res != OLAP_SUCCESS || *eof) {
             return res;
         }
 
         for (auto data : _data_sources) {
             RowBlock* block = nullptr;
             auto res = data->prepare_block_read(
-                start_key, find_last_row, end_key, end_key_find_last_row, &block);
+                key_range.start_key, key_range.find_last_row,
+                key_range.end_key, key_range.end_key_find_last_row, &block);
             if (res == OLAP_SUCCESS) {
                 res = _collect_iter->add_child(data, block);
                 if (res != OLAP_SUCCESS && res != OLAP_ERR_DATA_EOF) {
@@ -729,6 +844,7 @@ OLAPStatus Reader::_attach_data_to_merge_set(bool first, bool *eof) {
                 return res;
             }
         }
+        _collect_iter->start();
 
         _next_key = _collect_iter->current_row(&_next_delete_flag);
         if (_next_key != NULL) {
@@ -741,6 +857,84 @@ OLAPStatus Reader::_attach_data_to_merge_set(bool first, bool *eof) {
     return res;
 }
 
+OLAPStatus Reader::next_vector_batch(VectorizedRowBatch** batch, bool* eof) {
+    DCHECK(_vectorized_read);
+    *eof = false;
+    do {
+        while (_vector_child_idx < _vector_children.size()) {
+            auto res = _vector_children[_vector_child_idx]->get_next_vector_batch(batch);
+            if (res == OLAP_SUCCESS) {
+                return OLAP_SUCCESS;
+            } else if (res != OLAP_ERR_DATA_EOF) {
+                LOG(WARNING) << "failed to get vector batch from data, res=" << res;
+                return res;
+            }
+            // this data has been read in current key range, to read next
+            _vector_child_idx++;
+        }
+        auto res = _attach_data_to_vector_read(eof);
+        if (res != OLAP_SUCCESS) {
+            OLAP_LOG_WARNING("failed to attach data to vector read.");
+            return res;
+        }
+    } while (!*eof);
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus Reader::_attach_data_to_vector_read(bool* eof) {
+    _vector_children.clear();
+    _vector_child_idx = 0;
+
+    KeyRange key_range;
+    auto res = _next_key_range(_vector_first_range, &key_range, eof);
+    _vector_first_range = false;
+    if (res != OLAP_SUCCESS || *eof) {
+        return res;
+    }
+
+    for (auto data : _data_sources) {
+        RowBlock* block = nullptr;
+        res = data->prepare_block_read(
+            key_range.start_key, key_range.find_last_row,
+            key_range.end_key, key_range.end_key_find_last_row, &block);
+        if (res == OLAP_SUCCESS) {
+            _vector_children.push_back(data);
+        } else if (res != OLAP_ERR_DATA_EOF) {
+            LOG(WARNING) << "prepare block failed, res=" << res;
+            return res;
+        }
+    }
+    return OLAP_SUCCESS;
+}
+
+bool Reader::_can_read_vectorized() const {
+    if (!config::enable_vectorized_olap_scan || _reader_type != READER_QUERY) {
+        return false;
+    }
+    // rows hit by a delete condition are filtered one RowCursor at a time
+    for (auto data : _data_sources) {
+        if (data->delete_status() != DEL_NOT_SATISFIED) {
+            return false;
+        }
+    }
+    if (_olap_table->keys_type() == KeysType::DUP_KEYS) {
+        return true;
+    }
+    // rows of one segment are already aggregated by key, as long as nothing
+    // needs to be finalized after aggregation
+    if (_data_sources.size() != 1
+            || _data_sources[0]->delete_flag()
+            || _data_sources[0]->num_segments() != 1) {
+        return false;
+    }
+    for (auto cid : _return_columns) {
+        if (_olap_table->tablet_schema()[cid].type == OLAP_FIELD_TYPE_HLL) {
+            return false;
+        }
+    }
+    return true;
+}
+
 OLAPStatus Reader::_init_keys_param(const ReaderParams& read_params) {
     OLAPStatus res = OLAP_SUCCESS;
 
@@ -814,9 +1008,45 @@ OLAPStatus Reader::_init_conditions_param(const ReaderParams& read_params) {
         }
     }
 
+    for (auto& bloom_filter : read_params.bloom_filters) {
+        ColumnPredicate* predicate = _new_bloom_filter_pred(bloom_filter.first, bloom_filter.second);
+        if (predicate != NULL) {
+            _col_predicates.push_back(predicate);
+        }
+    }
+
     return res;
 }
 
+ColumnPredicate* Reader::_new_bloom_filter_pred(
+        const std::string& column_name, const std::shared_ptr<const BloomFilter>& filter) {
+    int index = _olap_table->get_field_index(column_name);
+    if (index < 0) {
+        return nullptr;
+    }
+    const FieldInfo& fi = _olap_table->tablet_schema()[index];
+    if (fi.aggregation != FieldAggregationMethod::OLAP_FIELD_AGGREGATION_NONE) {
+        return nullptr;
+    }
+    // only types stored as they are in the query execution
+    switch (fi.type) {
+    case OLAP_FIELD_TYPE_TINYINT:
+        return new BloomFilterColumnPredicate<int8_t>(index, filter);
+    case OLAP_FIELD_TYPE_SMALLINT:
+        return new BloomFilterColumnPredicate<int16_t>(index, filter);
+    case OLAP_FIELD_TYPE_INT:
+        return new BloomFilterColumnPredicate<int32_t>(index, filter);
+    case OLAP_FIELD_TYPE_BIGINT:
+        return new BloomFilterColumnPredicate<int64_t>(index, filter);
+    case OLAP_FIELD_TYPE_LARGEINT:
+        return new BloomFilterColumnPredicate<int128_t>(index, filter);
+    case OLAP_FIELD_TYPE_VARCHAR:
+        return new BloomFilterColumnPredicate<StringValue>(index, filter);
+    default:
+        return nullptr;
+    }
+}
+
 #define COMPARISON_PREDICATE_CONDITION_VALUE(NAME, PREDICATE) \
 ColumnPredicate* Reader::_new_##NAME##_pred(FieldInfo& fi, int index, const std::string& cond) { \
     ColumnPredicate* predicate = NULL; \
@@ -1061,7 +1291,8 @@ OLAPStatus Reader::_init_load_bf_columns(const ReaderParams& read_params) {
     for (const auto& cond_column : _conditions.columns()) {
         for (const Cond* cond : cond_column.second->conds()) {
             if (cond->op == OP_EQ
-                    || (cond->op == OP_IN && cond->operand_set.size() < MAX_OP_IN_FIELD_NUM)) {
+                    || (cond->op == OP_IN && cond->operand_set.size() < MAX_OP_IN_FIELD_NUM)
+                    || (cond->op == OP_LIKE && !cond->like_fragments.empty())) {
                 _load_bf_columns.insert(cond_column.first);
             }
         }
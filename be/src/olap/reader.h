@@ -39,11 +39,44 @@
 
 namespace doris {
 
+class BloomFilter;
 class OLAPTable;
 class RowCursor;
 class RowBlock;
 class CollectIterator;
 class RuntimeState;
+class VectorizedRowBatch;
+
+// Order preserving 64-bit prefix of the first key column of a row. Merges
+// order most rows by it without comparing their keys.
+struct KeyPrefix {
+    bool valid = false;
+    bool is_null = false;
+    uint64_t value = 0;
+
+    // Set to the prefix of the first key column of row, of type key_type
+    void update(FieldType key_type, const RowCursor& row);
+
+    // Less or greater than 0 if the prefixes order their rows, 0 if the
+    // full keys need to be compared
+    static int compare(const KeyPrefix& a, const KeyPrefix& b) {
+        if (!a.valid || !b.valid) {
+            return 0;
+        }
+        // null is less than any value
+        if (a.is_null != b.is_null) {
+            return a.is_null ? -1 : 1;
+        }
+        if (a.is_null || a.value == b.value) {
+            return 0;
+        }
+        return a.value < b.value ? -1 : 1;
+    }
+};
+
+// Get an order preserving prefix of a key value: values whose prefixes
+// differ compare as their prefixes do. Returns false for types without one.
+bool get_key_prefix(FieldType type, const char* ptr, uint64_t* prefix);
 
 // Params for Reader,
 // mainly include tablet, data version and fetch range.
@@ -57,17 +90,27 @@ struct ReaderParams {
     std::vector<OlapTuple> start_key;
     std::vector<OlapTuple> end_key;
     std::vector<TCondition> conditions;
+    // Bloom filters of the values columns may have, by column name, from the
+    // runtime filters of hash joins
+    std::vector<std::pair<std::string, std::shared_ptr<const BloomFilter>>> bloom_filters;
     // The ColumnData will be set when using Merger, eg Cumulative, BE.
     std::vector<ColumnData*> olap_data_arr;
     std::vector<uint32_t> return_columns;
     RuntimeProfile* profile;
     RuntimeState* runtime_state;
+    // Read only part block_split of num_block_splits parts of the row
+    // blocks of every version. DUP_KEYS tablets without keys only, whose
+    // rows need no merge across parts.
+    int32_t block_split;
+    int32_t num_block_splits;
 
     ReaderParams() :
             reader_type(READER_QUERY),
             aggregation(true),
             profile(NULL),
-            runtime_state(NULL) {
+            runtime_state(NULL),
+            block_split(0),
+            num_block_splits(1) {
         start_key.clear();
         end_key.clear();
         conditions.clear();
@@ -82,7 +125,8 @@ struct ReaderParams {
            << " aggregation=" << aggregation
            << " version=" << version.first << "-" << version.second
            << " range=" << range
-           << " end_range=" << end_range;
+           << " end_range=" << end_range
+           << " block_split=" << block_split << "/" << num_block_splits;
 
         for (auto& key : start_key) {
             ss << " keys=" << key;
@@ -95,6 +139,10 @@ struct ReaderParams {
         for (int i = 0, size = conditions.size(); i < size; ++i) {
             ss << " conditions=" << apache::thrift::ThriftDebugString(conditions[i]);
         }
+
+        for (auto& bloom_filter : bloom_filters) {
+            ss << " bloom_filter=" << bloom_filter.first;
+        }
         
         return ss.str();
     }
@@ -115,6 +163,18 @@ public:
         return (this->*_next_row_func)(row_cursor, eof);
     }
 
+    // True if rows can be read a batch at a time with next_vector_batch instead
+    // of next_row_with_aggregation. This is the case for queries when no row
+    // needs to be merged with rows of other data and no delete condition
+    // applies to the data.
+    bool vectorized_read() const {
+        return _vectorized_read;
+    }
+
+    // Read next batch of rows, one data source at a time. Rows of the batch
+    // are its selected rows, the batch is valid until the next call.
+    OLAPStatus next_vector_batch(VectorizedRowBatch** batch, bool* eof);
+
     uint64_t merged_rows() const {
         return _merged_rows;
     }
@@ -159,6 +219,14 @@ private:
         std::vector<RowCursor*> end_keys;
     };
 
+    // Rows of all data sources between a start and an end key
+    struct KeyRange {
+        RowCursor* start_key = nullptr;
+        bool find_last_row = false;
+        RowCursor* end_key = nullptr;
+        bool end_key_find_last_row = false;
+    };
+
     friend class CollectIterator;
 
     OLAPStatus _init_params(const ReaderParams& read_params);
@@ -178,13 +246,24 @@ private:
 
     ColumnPredicate* _parse_to_predicate(const TCondition& condition);
 
+    ColumnPredicate* _new_bloom_filter_pred(
+            const std::string& column_name, const std::shared_ptr<const BloomFilter>& filter);
+
     OLAPStatus _init_delete_condition(const ReaderParams& read_params);
 
     OLAPStatus _init_return_columns(const ReaderParams& read_params);
 
     OLAPStatus _init_load_bf_columns(const ReaderParams& read_params);
 
+    // Get the next range of keys to read. Without start keys all rows are one
+    // range, returned when first is true.
+    OLAPStatus _next_key_range(bool first, KeyRange* key_range, bool* eof);
+
     OLAPStatus _attach_data_to_merge_set(bool first, bool *eof);
+
+    OLAPStatus _attach_data_to_vector_read(bool* eof);
+
+    bool _can_read_vectorized() const;
     
     OLAPStatus _dup_key_next_row(RowCursor* row_cursor, bool* eof);
     OLAPStatus _agg_key_next_row(RowCursor* row_cursor, bool* eof);
@@ -221,6 +300,12 @@ private:
     bool _next_delete_flag;
     const RowCursor* _next_key;
     CollectIterator* _collect_iter = nullptr;
+
+    bool _vectorized_read = false;
+    bool _vector_first_range = true;
+    // data sources with rows in current key range, read one after another
+    std::vector<ColumnData*> _vector_children;
+    size_t _vector_child_idx = 0;
     std::vector<uint32_t> _key_cids;
     std::vector<uint32_t> _value_cids;
 
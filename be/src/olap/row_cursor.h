@@ -130,6 +130,10 @@ public:
         return _columns.size();
     }
 
+    size_t key_column_num() const {
+        return _key_column_num;
+    }
+
     // 以string格式输出rowcursor内容，仅供log及debug使用
     std::string to_string() const;
     std::string to_string(std::string sep) const;
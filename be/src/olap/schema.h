@@ -130,6 +130,10 @@ public:
         }
     }
 
+    size_t num_key_columns() const {
+        return _num_key_columns;
+    }
+
     int get_col_offset(int index) const {
         return _cols[index].get_col_offset();
     }
@@ -2338,6 +2338,10 @@ OLAPStatus SchemaChangeHandler::_parse_request(OLAPTablePtr ref_olap_table,
             } else if (new_table_schema[i].is_bf_column != ref_table_schema[i].is_bf_column) {
                 *sc_directly = true;
                 return OLAP_SUCCESS;
+            } else if (new_table_schema[i].is_split_block_bf_column
+                    != ref_table_schema[i].is_split_block_bf_column) {
+                *sc_directly = true;
+                return OLAP_SUCCESS;
             }
         }
     }
@@ -22,7 +22,9 @@
 #include <cmath>
 #include <fstream>
 
+#include "common/config.h"
 #include "olap/column_data.h"
+#include "olap/olap_engine.h"
 #include "olap/olap_table.h"
 #include "olap/row_block.h"
 #include "olap/row_cursor.h"
@@ -289,8 +291,13 @@ OLAPStatus SegmentGroup::load() {
         return res;
     }
 
+    Cache* entry_cache = NULL;
+    if (config::short_key_index_lazy_load && OLAPEngine::get_instance() != NULL) {
+        entry_cache = OLAPEngine::get_instance()->index_stream_lru_cache();
+    }
     if (_index.init(_short_key_length, _new_short_key_length,
-                    _table->num_short_key_fields(), &_short_key_info_list) != OLAP_SUCCESS) {
+                    _table->num_short_key_fields(), &_short_key_info_list,
+                    entry_cache) != OLAP_SUCCESS) {
         OLAP_LOG_WARNING("fail to create MemIndex. [num_segment=%d]", _num_segments);
         return res;
     }
@@ -19,10 +19,13 @@
 
 #include <sys/mman.h>
 
+#include <algorithm>
 #include <istream>
 
+#include "common/config.h"
 #include "olap/file_stream.h"
 #include "olap/in_stream.h"
+#include "olap/ngram_bloom_filter.h"
 #include "olap/out_stream.h"
 #include "olap/olap_cond.h"
 #include "olap/row_block.h"
@@ -50,6 +53,7 @@ SegmentReader::SegmentReader(
         _segment_group(segment_group),
         _segment_id(segment_id),
         _conditions(conditions),
+        _col_predicates(col_predicates),
         _delete_handler(delete_handler),
         _delete_status(delete_status),
         _eof(false),
@@ -70,6 +74,20 @@ SegmentReader::SegmentReader(
         _shared_buffer(NULL),
         _stats(stats) {
     _lru_cache = OLAPEngine::get_instance()->index_stream_lru_cache();
+    // compactions and schema changes read every block once, only queries
+    // go through the page cache
+    if (_runtime_state != NULL && !_runtime_state->disable_page_cache()) {
+        _page_cache = OLAPEngine::get_instance()->stream_page_cache();
+    }
+    // the windows of every stream of every version would take too much
+    // memory in a compaction, only queries read ahead
+    if (_runtime_state != NULL) {
+        _read_ahead_pool = OLAPEngine::get_instance()->read_ahead_thread_pool();
+        if (_read_ahead_pool != NULL) {
+            _read_ahead_tracker.reset(new MemTracker(
+                    -1, "SegmentReadAhead", _runtime_state->instance_mem_tracker()));
+        }
+    }
     _tracker.reset(new MemTracker(-1));
     _mem_pool.reset(new MemPool(_tracker.get()));
 }
@@ -86,6 +104,10 @@ SegmentReader::~SegmentReader() {
         SAFE_DELETE(bf_it.second);
     }
 
+    for (auto& bf_it : _ngram_bloom_filters) {
+        SAFE_DELETE(bf_it.second);
+    }
+
     for (auto handle : _cache_handle) {
         if (handle != nullptr) {
             _lru_cache->release(handle);
@@ -107,6 +129,10 @@ SegmentReader::~SegmentReader() {
         delete reader;
     }
 
+    if (_read_ahead_tracker != nullptr && _read_ahead_tracker->parent() != NULL) {
+        _read_ahead_tracker->unregister_from_parent();
+    }
+
     if (_is_using_mmap) {
         SAFE_DELETE(_mmap_buffer);
     }
@@ -173,6 +199,8 @@ OLAPStatus SegmentReader::_set_decompressor() {
         break;
     }
     case COMPRESS_LZ4: {
+        // also the streams of tables compressed with LZ4-HC, whose output
+        // is plain LZ4
         _decompressor = lz4_decompress;
         break;
     }
@@ -250,7 +278,15 @@ OLAPStatus SegmentReader::seek_to_block(
             OLAP_LOG_WARNING("fail to read data stream");
             return res;
         }
-    
+
+        if (first_block == 0) {
+            // a scan from the first block reads every stream from its
+            // start, read all of them at once
+            for (auto& it : _streams) {
+                it.second->prefetch();
+            }
+        }
+
         OLAPStatus res = _create_reader(&_buffer_size);
         if (res != OLAP_SUCCESS) {
             OLAP_LOG_WARNING("fail to create reader");
@@ -294,7 +330,7 @@ OLAPStatus SegmentReader::seek_to_block(
 }
 
 OLAPStatus SegmentReader::get_block(
-        VectorizedRowBatch* batch, uint32_t* next_block_id, bool* eof) {
+        VectorizedRowBatch* batch, uint32_t* next_block_id, bool* eof, bool eval_predicates) {
     if (_eof) {
         *eof = true;
         return OLAP_SUCCESS;
@@ -310,7 +346,7 @@ OLAPStatus SegmentReader::get_block(
         num_rows_load = std::min(num_rows_load, num_rows_left);
     }
 
-    auto res = _load_to_vectorized_row_batch(batch, num_rows_load);
+    auto res = _load_to_vectorized_row_batch(batch, num_rows_load, eval_predicates);
     if (res != OLAP_SUCCESS) {
         OLAP_LOG_WARNING("fail to load block to vectorized_row_batch. [res=%d]", res);
         return res;
@@ -371,6 +407,10 @@ OLAPStatus SegmentReader::_pick_columns() {
     for (uint32_t i : _load_bf_columns) {
         ColumnId unique_column_id = _table_id_to_unique_id_map[i];
         _include_bf_columns.insert(unique_column_id);
+        if (_conditions != NULL && _conditions->columns().count(i) != 0
+                && _conditions->columns().at(i)->has_like()) {
+            _include_ngram_bf_columns.insert(unique_column_id);
+        }
     }
 
     return OLAP_SUCCESS;
@@ -480,6 +520,7 @@ OLAPStatus SegmentReader::_pick_row_groups(uint32_t first_block, uint32_t last_b
     }
 
     _pick_delete_row_groups(first_block, last_block);
+    _pick_row_groups_by_predicates(first_block, last_block);
 
     if (NULL == _conditions || _conditions->columns().size() == 0) {
         return OLAP_SUCCESS;
@@ -509,15 +550,8 @@ OLAPStatus SegmentReader::_pick_row_groups(uint32_t first_block, uint32_t last_b
             }
 
             if (!i.second->eval(index_reader->entry(j).column_statistic().pair())) {
-                _include_blocks[j] = DEL_SATISFIED;
-                --_remain_block;
-
-                if (j < _block_count - 1) {
-                    _stats->rows_stats_filtered += _num_rows_in_block; 
-                } else {
-                    _stats->rows_stats_filtered +=
-                        _header_message().number_of_rows() - j * _num_rows_in_block;
-                }
+                _filter_block(j);
+                ++_stats->blocks_stats_filtered;
             }
         }
     }
@@ -550,14 +584,37 @@ OLAPStatus SegmentReader::_pick_row_groups(uint32_t first_block, uint32_t last_b
             }
 
             if (!_conditions->columns().at(i)->eval(bf_reader->entry(j))) {
-                _include_blocks[j] = DEL_SATISFIED;
-                --_remain_block;
-                if (j < _block_count - 1) {
-                    _stats->rows_stats_filtered += _num_rows_in_block; 
-                } else {
-                    _stats->rows_stats_filtered +=
-                        _header_message().number_of_rows() - j * _num_rows_in_block;
-                }
+                _filter_block(j);
+            }
+        }
+    }
+
+    // blocks missing an ngram of the literal strings of a LIKE pattern
+    for (auto& it : _ngram_bloom_filters) {
+        ColumnId table_column_id = _unique_id_to_table_id_map[it.first];
+        FieldAggregationMethod aggregation = _table->get_aggregation_by_index(table_column_id);
+        bool is_continue = (aggregation == OLAP_FIELD_AGGREGATION_NONE
+                || (aggregation == OLAP_FIELD_AGGREGATION_REPLACE
+                && _segment_group->version().first == 0));
+        if (!is_continue) {
+            continue;
+        }
+
+        std::vector<uint64_t> hashes;
+        _conditions->columns().at(table_column_id)->like_ngram_hashes(
+                _header_message().ngram_bf_gram_size(), &hashes);
+        if (hashes.empty()) {
+            continue;
+        }
+        BloomFilterIndexReader* bf_reader = it.second;
+        for (int64_t j = first_block; j <= last_block; ++j) {
+            if (_include_blocks[j] == DEL_SATISFIED) {
+                continue;
+            }
+
+            if (!test_ngrams(bf_reader->entry(j), hashes)) {
+                _filter_block(j);
+                ++_stats->blocks_ngram_filtered;
             }
         }
     }
@@ -567,6 +624,44 @@ OLAPStatus SegmentReader::_pick_row_groups(uint32_t first_block, uint32_t last_b
     return OLAP_SUCCESS;
 }
 
+void SegmentReader::_pick_row_groups_by_predicates(uint32_t first_block, uint32_t last_block) {
+    if (_col_predicates == nullptr) {
+        return;
+    }
+
+    // predicates are only built on columns without aggregation, so the
+    // statistics of a block always cover the values read from it
+    for (const ColumnPredicate* pred : *_col_predicates) {
+        ColumnId unique_column_id = _table_id_to_unique_id_map[pred->column_id()];
+        if (0 == _unique_id_to_segment_id_map.count(unique_column_id)
+                || 0 == _indices.count(unique_column_id)) {
+            continue;
+        }
+        StreamIndexReader* index_reader = _indices[unique_column_id];
+        for (int64_t j = first_block; j <= last_block; ++j) {
+            if (_include_blocks[j] == DEL_SATISFIED) {
+                continue;
+            }
+
+            if (!pred->evaluate(index_reader->entry(j).column_statistic().pair())) {
+                _filter_block(j);
+                ++_stats->blocks_stats_filtered;
+            }
+        }
+    }
+}
+
+void SegmentReader::_filter_block(int64_t block_id) {
+    _include_blocks[block_id] = DEL_SATISFIED;
+    --_remain_block;
+    if (block_id < _block_count - 1) {
+        _stats->rows_stats_filtered += _num_rows_in_block;
+    } else {
+        _stats->rows_stats_filtered +=
+            _header_message().number_of_rows() - block_id * _num_rows_in_block;
+    }
+}
+
 CacheKey SegmentReader::_construct_index_stream_key(
         char* buf,
         size_t len,
@@ -604,6 +699,7 @@ OLAPStatus SegmentReader::_load_index(bool is_using_cache) {
 
     _indices.clear();
     _bloom_filters.clear();
+    _ngram_bloom_filters.clear();
     uint64_t stream_length = 0;
     int32_t cache_handle_index = 0;
     uint64_t stream_offset = _header_length;
@@ -625,7 +721,9 @@ OLAPStatus SegmentReader::_load_index(bool is_using_cache) {
         if ((_is_column_included(unique_column_id)
                 && message.kind() == StreamInfoMessage::ROW_INDEX)
                 || (_is_bf_column_included(unique_column_id)
-                && message.kind() == StreamInfoMessage::BLOOM_FILTER)) {
+                && message.kind() == StreamInfoMessage::BLOOM_FILTER)
+                || (_is_ngram_bf_column_included(unique_column_id)
+                && message.kind() == StreamInfoMessage::NGRAM_BLOOM_FILTER)) {
         } else {
             continue;
         }
@@ -694,7 +792,7 @@ OLAPStatus SegmentReader::_load_index(bool is_using_cache) {
 
             // 每个index的entry数量应该一致, 也就是block的数量
             _block_count = index_message->entry_count();
-        } else {
+        } else if (message.kind() == StreamInfoMessage::NGRAM_BLOOM_FILTER) {
             BloomFilterIndexReader* bf_message = new(std::nothrow) BloomFilterIndexReader;
             if (bf_message == NULL) {
                 OLAP_LOG_WARNING("fail to malloc memory. [size=%lu]",
@@ -702,8 +800,44 @@ OLAPStatus SegmentReader::_load_index(bool is_using_cache) {
                 return OLAP_ERR_MALLOC_ERROR;
             }
 
+            const auto& ngram_columns = _header_message().ngram_bf_column();
+            auto column_it = std::find(ngram_columns.begin(), ngram_columns.end(),
+                                       unique_column_id);
+            if (column_it == ngram_columns.end()) {
+                OLAP_LOG_WARNING("ngram bloom filter params not found. [column=%u]",
+                                 unique_column_id);
+                delete bf_message;
+                return OLAP_ERR_INIT_FAILED;
+            }
+            uint32_t bit_num = _header_message().ngram_bf_bit_num(
+                    column_it - ngram_columns.begin());
             res = bf_message->init(stream_buffer, stream_length, is_using_cache,
-                    _header_message().bf_hash_function_num(), _header_message().bf_bit_num());
+                    SPLIT_BLOCK_WORDS, bit_num, true);
+            if (res != OLAP_SUCCESS) {
+                OLAP_LOG_WARNING("fail to init ngram bloom filter reader. [res=%d]", res);
+                return res;
+            }
+
+            _ngram_bloom_filters[unique_column_id] = bf_message;
+            _block_count = bf_message->entry_count();
+        } else {
+            BloomFilterIndexReader* bf_message = new(std::nothrow) BloomFilterIndexReader;
+            if (bf_message == NULL) {
+                OLAP_LOG_WARNING("fail to malloc memory. [size=%lu]",
+                                 sizeof(BloomFilterIndexReader));
+                return OLAP_ERR_MALLOC_ERROR;
+            }
+
+            const auto& split_block_columns = _header_message().split_block_bf_column();
+            if (std::find(split_block_columns.begin(), split_block_columns.end(),
+                          unique_column_id) != split_block_columns.end()) {
+                res = bf_message->init(stream_buffer, stream_length, is_using_cache,
+                        SPLIT_BLOCK_WORDS, _header_message().split_block_bf_bit_num(), true);
+            } else {
+                res = bf_message->init(stream_buffer, stream_length, is_using_cache,
+                        _header_message().bf_hash_function_num(),
+                        _header_message().bf_bit_num());
+            }
             if (res != OLAP_SUCCESS) {
                 OLAP_LOG_WARNING("fail to init bloom filter reader. [res=%d]", res);
                 return res;
@@ -778,7 +912,8 @@ OLAPStatus SegmentReader::_read_all_data_streams(size_t* buffer_size) {
         }
 
         if (message.kind() == StreamInfoMessage::ROW_INDEX ||
-            message.kind() == StreamInfoMessage::BLOOM_FILTER) {
+            message.kind() == StreamInfoMessage::BLOOM_FILTER ||
+            message.kind() == StreamInfoMessage::NGRAM_BLOOM_FILTER) {
             continue;
         }
 
@@ -800,6 +935,11 @@ OLAPStatus SegmentReader::_read_all_data_streams(size_t* buffer_size) {
             OLAP_LOG_WARNING("fail to init stream");
             return res;
         }
+        stream->set_page_cache(_page_cache);
+        if (_read_ahead_pool != NULL) {
+            stream->set_read_ahead(_read_ahead_pool, config::segment_read_ahead_window_bytes,
+                                   _read_ahead_tracker.get());
+        }
 
         *buffer_size += stream->get_buffer_size();
         _streams[name] = stream.release();
@@ -919,20 +1059,16 @@ void SegmentReader::_seek_to_block(int64_t block_id, bool without_filter) {
 }
 
 OLAPStatus SegmentReader::_load_to_vectorized_row_batch(
-        VectorizedRowBatch* batch, size_t size) {
-    SCOPED_RAW_TIMER(&_stats->block_load_ns);
-    MemPool* mem_pool = batch->mem_pool();
-    for (auto cid : batch->columns()) {
-        auto reader = _column_readers[cid];
-        auto res = reader->next_vector(batch->column(cid), size, mem_pool);
-        if (res != OLAP_SUCCESS) {
-            LOG(WARNING) << "fail to read next, res=" << res
-                << ", column=" << reader->column_unique_id()
-                << ", size=" << size;
-            return res;
+        VectorizedRowBatch* batch, size_t size, bool eval_predicates) {
+    if (eval_predicates && config::enable_segment_late_materialization) {
+        RETURN_NOT_OK(_load_late_materialized(batch, size));
+    } else {
+        RETURN_NOT_OK(_read_columns(batch->columns(), batch, size));
+        batch->set_size(size);
+        if (eval_predicates) {
+            _eval_predicates(batch);
         }
     }
-    batch->set_size(size);
     if (_include_blocks != nullptr) {
         batch->set_block_status(_include_blocks[_current_block_id]);
     } else {
@@ -952,4 +1088,82 @@ OLAPStatus SegmentReader::_load_to_vectorized_row_batch(
     return OLAP_SUCCESS;
 }
 
+OLAPStatus SegmentReader::_load_late_materialized(VectorizedRowBatch* batch, size_t size) {
+    _predicate_columns.clear();
+    _lazy_columns.clear();
+    for (auto cid : batch->columns()) {
+        bool has_predicate = false;
+        for (auto pred : *_col_predicates) {
+            if (static_cast<uint32_t>(pred->column_id()) == cid) {
+                has_predicate = true;
+                break;
+            }
+        }
+        if (has_predicate) {
+            _predicate_columns.push_back(cid);
+        } else {
+            _lazy_columns.push_back(cid);
+        }
+    }
+
+    RETURN_NOT_OK(_read_columns(_predicate_columns, batch, size));
+    batch->set_size(size);
+    _eval_predicates(batch);
+
+    // selected rows keep their order, rows after the last one are never used
+    size_t read_size = 0;
+    if (batch->size() > 0) {
+        read_size = batch->selected_in_use() ? batch->selected()[batch->size() - 1] + 1 : size;
+    }
+    if (read_size > 0) {
+        RETURN_NOT_OK(_read_columns(_lazy_columns, batch, read_size));
+    }
+    if (read_size < size && !_lazy_columns.empty()) {
+        RETURN_NOT_OK(_skip_columns(_lazy_columns, size - read_size));
+        _stats->rows_lazy_skipped += size - read_size;
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus SegmentReader::_read_columns(
+        const std::vector<uint32_t>& cids, VectorizedRowBatch* batch, size_t size) {
+    SCOPED_RAW_TIMER(&_stats->block_load_ns);
+    MemPool* mem_pool = batch->mem_pool();
+    for (auto cid : cids) {
+        auto reader = _column_readers[cid];
+        auto res = reader->next_vector(batch->column(cid), size, mem_pool);
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to read next, res=" << res
+                << ", column=" << reader->column_unique_id()
+                << ", size=" << size;
+            return res;
+        }
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus SegmentReader::_skip_columns(const std::vector<uint32_t>& cids, size_t size) {
+    SCOPED_RAW_TIMER(&_stats->block_load_ns);
+    for (auto cid : cids) {
+        auto reader = _column_readers[cid];
+        auto res = reader->skip(size);
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to skip rows, res=" << res
+                << ", column=" << reader->column_unique_id()
+                << ", size=" << size;
+            return res;
+        }
+    }
+    return OLAP_SUCCESS;
+}
+
+void SegmentReader::_eval_predicates(VectorizedRowBatch* batch) {
+    SCOPED_RAW_TIMER(&_stats->vec_cond_ns);
+    size_t old_size = batch->size();
+    for (auto pred : *_col_predicates) {
+        pred->evaluate(batch);
+    }
+    _stats->rows_vec_cond_filtered += old_size - batch->size();
+}
+
 }  //unamespace doris
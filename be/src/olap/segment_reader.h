@@ -101,7 +101,10 @@ public:
     //      block with next_block_id would read if get_block called again.
     //      this field is used to set batch's limit when client found logical end is reach
     // ATTN: If you change batch to contain more columns, you must call seek_to_block again.
-    OLAPStatus get_block(VectorizedRowBatch* batch, uint32_t* next_block_id, bool* eof);
+    // eval_predicates: evaluate col_predicates on the batch, leaving only the passing
+    //      rows selected. The columns they refer to must be in the batch.
+    OLAPStatus get_block(VectorizedRowBatch* batch, uint32_t* next_block_id, bool* eof,
+                         bool eval_predicates = false);
 
     bool eof() const {
         return _eof;
@@ -162,6 +165,10 @@ private:
         return _include_bf_columns.count(column_unique_id) != 0;
     }
 
+    inline bool _is_ngram_bf_column_included(ColumnId column_unique_id) {
+        return _include_ngram_bf_columns.count(column_unique_id) != 0;
+    }
+
     // 加载文件和必要的文件信息
     OLAPStatus _load_segment_file();
 
@@ -189,6 +196,10 @@ private:
     // @return
     OLAPStatus _pick_row_groups(uint32_t first_block, uint32_t last_block);
     OLAPStatus _pick_delete_row_groups(uint32_t first_block, uint32_t last_block);
+    // filter blocks whose min/max statistics can not satisfy _col_predicates
+    void _pick_row_groups_by_predicates(uint32_t first_block, uint32_t last_block);
+    // mark block as filtered by index and account its rows in rows_stats_filtered
+    void _filter_block(int64_t block_id);
 
     // 加载索引，将需要的列的索引读入内存
     OLAPStatus _load_index(bool is_using_cache);
@@ -253,7 +264,9 @@ private:
             if ((_is_column_included(unique_column_id)
                     && message.kind() == StreamInfoMessage::ROW_INDEX)
                     || (_is_bf_column_included(unique_column_id)
-                    && message.kind() == StreamInfoMessage::BLOOM_FILTER)) {
+                    && message.kind() == StreamInfoMessage::BLOOM_FILTER)
+                    || (_is_ngram_bf_column_included(unique_column_id)
+                    && message.kind() == StreamInfoMessage::NGRAM_BLOOM_FILTER)) {
                 ++included_row_index_stream_num;
             }
         }
@@ -261,7 +274,20 @@ private:
     }
 
     OLAPStatus _load_to_vectorized_row_batch(
-        VectorizedRowBatch* batch, size_t size);
+        VectorizedRowBatch* batch, size_t size, bool eval_predicates);
+
+    // Decode the predicate columns, evaluate the predicates, then decode the
+    // other columns only up to the last selected row and skip the rest of the
+    // block in their streams. Nothing but the predicate columns is decoded
+    // for a block without any selected row.
+    OLAPStatus _load_late_materialized(VectorizedRowBatch* batch, size_t size);
+
+    OLAPStatus _read_columns(
+        const std::vector<uint32_t>& cids, VectorizedRowBatch* batch, size_t size);
+
+    OLAPStatus _skip_columns(const std::vector<uint32_t>& cids, size_t size);
+
+    void _eval_predicates(VectorizedRowBatch* batch);
 
 private:
     static const int32_t BYTE_STREAM_POSITIONS = 1;
@@ -282,6 +308,7 @@ private:
     uint32_t _segment_id;
 
     const Conditions* _conditions;         // 列过滤条件
+    const std::vector<ColumnPredicate*>* _col_predicates;
     DeleteHandler _delete_handler;
     DelCondSatisfied _delete_status;
 
@@ -313,10 +340,15 @@ private:
     std::vector<uint32_t> _used_columns;
     std::vector<ColumnReader*> _column_readers;    // 实际的数据读取器
     std::vector<StreamIndexReader*> _column_indices; // 保存column的index
+    // columns of the batch with and without predicates, for late materialization
+    std::vector<uint32_t> _predicate_columns;
+    std::vector<uint32_t> _lazy_columns;
 
     UniqueIdSet _include_columns;           // 用于判断该列是不是被包含
     UniqueIdSet _load_bf_columns;
     UniqueIdSet _include_bf_columns;
+    // bf columns with LIKE conditions
+    UniqueIdSet _include_ngram_bf_columns;
     UniqueIdToColumnIdMap _table_id_to_unique_id_map; // table id到unique id的映射
     UniqueIdToColumnIdMap _unique_id_to_table_id_map; // unique id到table id的映射
     UniqueIdToColumnIdMap _unique_id_to_segment_id_map; // uniqid到segment id的映射
@@ -325,6 +357,7 @@ private:
     std::map<StreamName, ReadOnlyFileStream*> _streams;      //需要读取的流
     UniqueIdEncodingMap _encodings_map;            // 保存encoding
     std::map<ColumnId, BloomFilterIndexReader*> _bloom_filters;
+    std::map<ColumnId, BloomFilterIndexReader*> _ngram_bloom_filters;
     Decompressor _decompressor;                    //根据压缩格式，设置的解压器
     StorageByteBuffer* _mmap_buffer;
 
@@ -346,6 +379,13 @@ private:
 
     Cache* _lru_cache;
     std::vector<Cache::Handle*> _cache_handle;
+    // decompressed data blocks shared by queries, NULL if not used
+    StreamPageCache* _page_cache = NULL;
+    // pool reading data streams ahead, NULL to read them synchronously
+    ThreadPool* _read_ahead_pool = NULL;
+    // windows of the streams read ahead, a child of the query instance's
+    // MemTracker
+    std::unique_ptr<MemTracker> _read_ahead_tracker;
     const FileHeader<ColumnDataHeaderMessage>* _file_header;
 
     std::unique_ptr<MemTracker> _tracker;
@@ -34,7 +34,9 @@ SegmentWriter::SegmentWriter(
         _stream_buffer_size(stream_buffer_size),
         _stream_factory(NULL),
         _row_count(0),
-        _block_count(0) {}
+        _block_count(0),
+        _write_mbytes_per_sec(0),
+        _io_throttle(NULL) {}
 
 SegmentWriter::~SegmentWriter() {
     SAFE_DELETE(_stream_factory);
@@ -45,11 +47,12 @@ SegmentWriter::~SegmentWriter() {
     }
 }
 
-OLAPStatus SegmentWriter::init(uint32_t write_mbytes_per_sec) {
+OLAPStatus SegmentWriter::init(uint32_t write_mbytes_per_sec, IoThrottle* io_throttle) {
     OLAPStatus res = OLAP_SUCCESS;
     // 创建factory
     _stream_factory = 
-        new(std::nothrow) OutStreamFactory(_table->compress_kind(), _stream_buffer_size);
+        new(std::nothrow) OutStreamFactory(_table->compress_kind(), _stream_buffer_size,
+                                           _table->lz4hc_compression());
 
     if (NULL == _stream_factory) {
         OLAP_LOG_WARNING("fail to allocate out stream factory");
@@ -80,6 +83,7 @@ OLAPStatus SegmentWriter::init(uint32_t write_mbytes_per_sec) {
     }
 
     _write_mbytes_per_sec = write_mbytes_per_sec;
+    _io_throttle = io_throttle;
 
     return OLAP_SUCCESS;
 }
@@ -185,7 +189,8 @@ OLAPStatus SegmentWriter::_make_file_header(ColumnDataHeaderMessage* file_header
         stream_info->set_kind(it->first.kind());
 
         if (it->first.kind() == StreamInfoMessage::ROW_INDEX || 
-                it->first.kind() == StreamInfoMessage::BLOOM_FILTER) {
+                it->first.kind() == StreamInfoMessage::BLOOM_FILTER ||
+                it->first.kind() == StreamInfoMessage::NGRAM_BLOOM_FILTER) {
             index_length += stream->get_stream_length();
         } else {
             data_length += stream->get_stream_length();
@@ -244,7 +249,7 @@ OLAPStatus SegmentWriter::finalize(uint32_t* segment_file_size) {
             VLOG(3) << "stream id=" << it->first.unique_column_id()
                     << ", type=" << it->first.kind();
             res = stream->write_to_file(
-                    &file_handle, _write_mbytes_per_sec);
+                    &file_handle, _write_mbytes_per_sec, _io_throttle);
             if (OLAP_SUCCESS != res) {
                 OLAP_LOG_WARNING("fail to write stream to file. [res=%d]", res);
                 return res;
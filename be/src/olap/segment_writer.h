@@ -26,6 +26,7 @@ namespace doris {
 class ColumnWriter;
 class OutStreamFactory;
 class ColumnDataHeaderMessage;
+class IoThrottle;
 
 class SegmentWriter {
 public:
@@ -33,7 +34,8 @@ public:
             OLAPTablePtr table,
             uint32_t stream_buffer_size);
     ~SegmentWriter();
-    OLAPStatus init(uint32_t write_mbytes_per_sec);
+    // io_throttle, if not NULL, is shared by the writers of the disk
+    OLAPStatus init(uint32_t write_mbytes_per_sec, IoThrottle* io_throttle = NULL);
     OLAPStatus write_batch(RowBlock* block, RowCursor* cursor, bool is_finalize);
     // 通过对缓存的使用,预估最终segment的大小
     uint64_t estimate_segment_size();
@@ -54,6 +56,7 @@ private:
 
     // write limit
     uint32_t _write_mbytes_per_sec;
+    IoThrottle* _io_throttle;
 
     DISALLOW_COPY_AND_ASSIGN(SegmentWriter);
 };
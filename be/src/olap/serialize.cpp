@@ -17,6 +17,9 @@
 
 #include "olap/serialize.h"
 
+#include <endian.h>
+#include <string.h>
+
 #include "olap/file_stream.h"
 #include "olap/out_stream.h"
 
@@ -208,6 +211,66 @@ OLAPStatus write_ints(OutStream* output, int64_t* data, uint32_t count, uint32_t
     return OLAP_SUCCESS;
 }
 
+// bits [bit_pos, bit_pos + bit_width) of in, most significant bit first
+static inline int64_t unpack_bits(const uint8_t* in, uint64_t bit_pos, uint32_t bit_width) {
+    uint64_t result = 0;
+    const uint8_t* byte = in + (bit_pos >> 3);
+    uint32_t bits_left = 8 - (bit_pos & 7);
+    uint32_t bits_left_to_read = bit_width;
+    while (bits_left_to_read > bits_left) {
+        result = (result << bits_left) | (*byte++ & ((1U << bits_left) - 1));
+        bits_left_to_read -= bits_left;
+        bits_left = 8;
+    }
+    result = (result << bits_left_to_read)
+            | ((*byte >> (bits_left - bits_left_to_read)) & ((1U << bits_left_to_read) - 1));
+    return result;
+}
+
+template<uint32_t BYTES>
+static inline void unpack_bytes(const uint8_t* in, int64_t* data, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        uint64_t result = 0;
+        for (uint32_t j = 0; j < BYTES; ++j) {
+            result = (result << 8) | in[j];
+        }
+        data[i] = result;
+        in += BYTES;
+    }
+}
+
+void unpack_ints(const uint8_t* in, uint32_t size, int64_t* data, uint32_t count,
+                 uint32_t bit_width) {
+    switch (bit_width) {
+    case 0: memset(data, 0, sizeof(int64_t) * count); return;
+    case 8: return unpack_bytes<1>(in, data, count);
+    case 16: return unpack_bytes<2>(in, data, count);
+    case 24: return unpack_bytes<3>(in, data, count);
+    case 32: return unpack_bytes<4>(in, data, count);
+    case 40: return unpack_bytes<5>(in, data, count);
+    case 48: return unpack_bytes<6>(in, data, count);
+    case 56: return unpack_bytes<7>(in, data, count);
+    case 64: return unpack_bytes<8>(in, data, count);
+    default: break;
+    }
+
+    uint32_t i = 0;
+    // a value and its offset in the first byte fit in one word up to 56 bits
+    if (bit_width <= 56 && size >= sizeof(uint64_t)) {
+        const uint64_t last_word_pos = (size - sizeof(uint64_t)) * 8;
+        for (uint64_t bit_pos = 0; i < count && bit_pos <= last_word_pos;
+                ++i, bit_pos += bit_width) {
+            uint64_t word;
+            memcpy(&word, in + (bit_pos >> 3), sizeof(word));
+            word = be64toh(word) << (bit_pos & 7);
+            data[i] = word >> (64 - bit_width);
+        }
+    }
+    for (; i < count; ++i) {
+        data[i] = unpack_bits(in, static_cast<uint64_t>(i) * bit_width, bit_width);
+    }
+}
+
 OLAPStatus read_ints(ReadOnlyFileStream* input, int64_t* data, uint32_t count, uint32_t bit_width) {
     OLAPStatus res = OLAP_SUCCESS;
     uint32_t bits_left = 0;
@@ -220,28 +283,9 @@ OLAPStatus read_ints(ReadOnlyFileStream* input, int64_t* data, uint32_t count, u
     if (read_bytes <= remaining_bytes) {
         uint32_t pos = 0;
         input->get_position(&pos);
-        for (uint32_t i = 0; i < count; i++) {
-            int64_t result = 0;
-            uint32_t bits_left_to_read = bit_width;
-
-            while (bits_left_to_read > bits_left) {
-                result <<= bits_left;
-                result |= current & ((1 << bits_left) - 1);
-                bits_left_to_read -= bits_left;
-                current = buf[pos++];
-                bits_left = 8;
-            }
-
-            // handle the left over bits
-            if (bits_left_to_read > 0) {
-                result <<= bits_left_to_read;
-                bits_left -= bits_left_to_read;
-                result |= (current >> bits_left) & ((1 << bits_left_to_read) - 1);
-            }
-
-            data[i] = result;
-        }
-        input->set_position(pos);
+        unpack_ints(reinterpret_cast<const uint8_t*>(buf + pos), remaining_bytes,
+                    data, count, bit_width);
+        input->set_position(pos + read_bytes);
     } else {
         for (uint32_t i = 0; i < count; i++) {
             int64_t result = 0;
@@ -146,6 +146,13 @@ OLAPStatus write_ints(OutStream* output, int64_t* data, uint32_t count, uint32_t
 // 读取write_ints输出的数据
 OLAPStatus read_ints(ReadOnlyFileStream* input, int64_t* data, uint32_t count, uint32_t bit_width);
 
+// Unpack count integers of bit_width bits written by write_ints from in, which
+// holds size bytes. Whole 64 bit big endian words are loaded where they fit in
+// the buffer, widths of whole bytes are copied byte by byte.
+// REQUIRES: size >= (count * bit_width + 7) / 8
+void unpack_ints(const uint8_t* in, uint32_t size, int64_t* data, uint32_t count,
+                 uint32_t bit_width);
+
 // Do not want to use Guava LongMath.checkedSubtract() here as it will throw
 // ArithmeticException in case of overflow
 inline bool is_safe_subtract(int64_t left, int64_t right) {
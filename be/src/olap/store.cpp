@@ -36,6 +36,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/interprocess/sync/file_lock.hpp>
 
+#include "common/config.h"
 #include "olap/file_helper.h"
 #include "olap/olap_define.h"
 #include "olap/utils.h" // for check_dir_existed
@@ -60,7 +61,9 @@ OlapStore::OlapStore(const std::string& path, int64_t capacity_bytes)
         _to_be_deleted(false),
         _test_file_read_buf(nullptr),
         _test_file_write_buf(nullptr),
-        _meta((nullptr)) {
+        _meta((nullptr)),
+        _compaction_io_throttle(
+            config::compaction_disk_write_mbytes_per_sec * 1024L * 1024L) {
 }
 
 OlapStore::~OlapStore() {
@@ -24,6 +24,7 @@
 
 #include "common/status.h"
 #include "gen_cpp/Types_types.h"
+#include "olap/compaction_scheduler.h"
 #include "olap/olap_common.h"
 #include "olap/olap_engine.h"
 
@@ -62,6 +63,9 @@ public:
 
     OlapMeta* get_meta();
 
+    // shared by the compactions writing to this store
+    IoThrottle* compaction_io_throttle() { return &_compaction_io_throttle; }
+
     bool is_ssd_disk() const {
         return _storage_medium == TStorageMedium::SSD;
     }
@@ -132,6 +136,7 @@ private:
     char* _test_file_read_buf;
     char* _test_file_write_buf;
     OlapMeta* _meta;
+    IoThrottle _compaction_io_throttle;
 };
 
 }
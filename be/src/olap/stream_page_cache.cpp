@@ -0,0 +1,111 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/stream_page_cache.h"
+
+namespace doris {
+
+StreamPageCache::StreamPageCache(size_t capacity, const CachePolicy& policy,
+                                 MemTracker* parent)
+        : _mem_tracker(new MemTracker(capacity, "StreamPageCache", parent)),
+        _cache(new_cache(capacity, policy)) {
+}
+
+StreamPageCache::~StreamPageCache() {
+    SAFE_DELETE(_cache);
+}
+
+CacheKey StreamPageCache::_construct_key(char* buf, size_t len,
+                                         const std::string& file_name,
+                                         uint64_t offset) {
+    char* current = buf;
+    size_t remain_len = len;
+    OLAP_CACHE_STRING_TO_BUF(current, file_name, remain_len);
+    OLAP_CACHE_NUMERIC_TO_BUF(current, offset, remain_len);
+
+    return CacheKey(buf, len - remain_len);
+}
+
+void StreamPageCache::_delete_page(const CacheKey& key, void* value) {
+    Page* page = reinterpret_cast<Page*>(value);
+    page->mem_tracker->release(page->buffer->capacity());
+    SAFE_DELETE(page->buffer);
+    SAFE_DELETE(page);
+}
+
+StorageByteBuffer* StreamPageCache::lookup(const std::string& file_name, uint64_t offset,
+                                           uint64_t* block_length) {
+    char key_buf[OLAP_LRU_CACHE_MAX_KEY_LENTH];
+    CacheKey key = _construct_key(key_buf, sizeof(key_buf), file_name, offset);
+    if (key.empty()) {
+        return nullptr;
+    }
+    Cache::Handle* handle = _cache->lookup(key);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+    Page* page = reinterpret_cast<Page*>(_cache->value(handle));
+    StorageByteBuffer* buffer = StorageByteBuffer::reference_buffer(
+            page->buffer, 0, page->buffer->capacity());
+    *block_length = page->block_length;
+    _cache->release(handle);
+    return buffer;
+}
+
+bool StreamPageCache::contains(const std::string& file_name, uint64_t offset) {
+    char key_buf[OLAP_LRU_CACHE_MAX_KEY_LENTH];
+    CacheKey key = _construct_key(key_buf, sizeof(key_buf), file_name, offset);
+    if (key.empty()) {
+        return false;
+    }
+    Cache::Handle* handle = _cache->lookup(key);
+    if (handle == nullptr) {
+        return false;
+    }
+    _cache->release(handle);
+    return true;
+}
+
+void StreamPageCache::insert(const std::string& file_name, uint64_t offset,
+                             uint64_t block_length, const StorageByteBuffer& block) {
+    uint64_t size = block.limit();
+    if (size == 0 || _mem_tracker->any_limit_exceeded()) {
+        return;
+    }
+    char key_buf[OLAP_LRU_CACHE_MAX_KEY_LENTH];
+    CacheKey key = _construct_key(key_buf, sizeof(key_buf), file_name, offset);
+    if (key.empty()) {
+        return;
+    }
+    StorageByteBuffer* buffer = StorageByteBuffer::create(size);
+    if (buffer == nullptr) {
+        LOG(WARNING) << "fail to malloc stream page. size=" << size;
+        return;
+    }
+    memcpy(buffer->array(), block.array(), size);
+    Page* page = new Page;
+    page->buffer = buffer;
+    page->block_length = block_length;
+    page->mem_tracker = _mem_tracker.get();
+    _mem_tracker->consume(size);
+    Cache::Handle* handle = _cache->insert(key, page, size, &_delete_page);
+    if (handle != nullptr) {
+        _cache->release(handle);
+    }
+}
+
+}  // namespace doris
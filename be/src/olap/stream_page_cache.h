@@ -0,0 +1,87 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_STREAM_PAGE_CACHE_H
+#define DORIS_BE_SRC_OLAP_STREAM_PAGE_CACHE_H
+
+#include <memory>
+#include <string>
+
+#include "olap/byte_buffer.h"
+#include "olap/lru_cache.h"
+#include "runtime/mem_tracker.h"
+
+namespace doris {
+
+// Cache of decompressed blocks of column data streams, shared by all
+// queries. A block is keyed by its segment file and its offset in the file,
+// as segment files never change once written.
+//
+// The memory of cached blocks is tracked by mem_tracker(), whose limit is
+// the capacity of the cache and whose parent is the process MemTracker.
+// While pinned blocks keep the consumption over the limit, new blocks are
+// not cached.
+class StreamPageCache {
+public:
+    StreamPageCache(size_t capacity, const CachePolicy& policy, MemTracker* parent);
+    ~StreamPageCache();
+
+    // Return a buffer sharing the memory of the cached block at offset of
+    // file_name, nullptr if it is not cached. block_length returns the
+    // length of the block in the file, its head included. The buffer stays
+    // valid after the block is evicted, and is owned by the caller.
+    StorageByteBuffer* lookup(const std::string& file_name, uint64_t offset,
+                              uint64_t* block_length);
+
+    // Whether the block at offset of file_name is cached. It counts as a
+    // lookup for the eviction policy.
+    bool contains(const std::string& file_name, uint64_t offset);
+
+    // Cache a copy of [0, limit) of the decompressed block at offset of
+    // file_name. The block is not cached if the memory of the process is
+    // over its limit.
+    void insert(const std::string& file_name, uint64_t offset, uint64_t block_length,
+                const StorageByteBuffer& block);
+
+    MemTracker* mem_tracker() {
+        return _mem_tracker.get();
+    }
+
+    void get_cache_status(rapidjson::Document* document) {
+        _cache->get_cache_status(document);
+    }
+
+private:
+    struct Page {
+        StorageByteBuffer* buffer;
+        uint64_t block_length;
+        MemTracker* mem_tracker;
+    };
+
+    static CacheKey _construct_key(char* buf, size_t len, const std::string& file_name,
+                                   uint64_t offset);
+    static void _delete_page(const CacheKey& key, void* value);
+
+    std::unique_ptr<MemTracker> _mem_tracker;
+    Cache* _cache;
+
+    DISALLOW_COPY_AND_ASSIGN(StreamPageCache);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_STREAM_PAGE_CACHE_H
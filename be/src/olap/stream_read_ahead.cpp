@@ -0,0 +1,187 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/stream_read_ahead.h"
+
+#include <string.h>
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+#include "common/config.h"
+
+namespace doris {
+
+// Bytes [offset, offset + length) of the file. It is shared with the task
+// offered to the pool, so it stays valid if the stream drops it first.
+class StreamReadAhead::Window {
+public:
+    Window(FileHandler* file_handler, uint64_t offset, uint64_t length)
+            : _file_handler(file_handler),
+            _offset(offset),
+            _length(length),
+            _data(new char[length]) { }
+
+    uint64_t offset() const { return _offset; }
+    uint64_t length() const { return _length; }
+    uint64_t end() const { return _offset + _length; }
+    const char* data() const { return _data.get(); }
+
+    bool contains(uint64_t offset) const {
+        return offset >= _offset && offset < end();
+    }
+
+    // Read the window unless it was started or cancelled already.
+    void run() {
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            if (_state != PENDING) {
+                return;
+            }
+            _state = RUNNING;
+        }
+        OLAPStatus res = _file_handler->pread(_data.get(), _length, _offset);
+        std::lock_guard<std::mutex> l(_lock);
+        _status = res;
+        _state = DONE;
+        _cond.notify_all();
+    }
+
+    // Wait for the data, reading it here if no pool thread has started.
+    OLAPStatus wait() {
+        run();
+        std::unique_lock<std::mutex> l(_lock);
+        while (_state == RUNNING) {
+            _cond.wait(l);
+        }
+        return _status;
+    }
+
+    // Drop a read not started yet and wait for a running one, after that
+    // the file handler is not used any more. The data is freed, though a
+    // task queued on the pool may keep the window itself.
+    void cancel() {
+        std::unique_lock<std::mutex> l(_lock);
+        if (_state == PENDING) {
+            _state = CANCELLED;
+        }
+        while (_state == RUNNING) {
+            _cond.wait(l);
+        }
+        _data.reset();
+    }
+
+private:
+    enum State {
+        PENDING,
+        RUNNING,
+        DONE,
+        CANCELLED
+    };
+
+    FileHandler* _file_handler;
+    const uint64_t _offset;
+    const uint64_t _length;
+    std::unique_ptr<char[]> _data;
+
+    std::mutex _lock;
+    std::condition_variable _cond;
+    State _state = PENDING;
+    OLAPStatus _status = OLAP_SUCCESS;
+};
+
+StreamReadAhead::StreamReadAhead(FileHandler* file_handler, ThreadPool* pool,
+                                 uint64_t window_size, MemTracker* mem_tracker)
+        : _file_handler(file_handler),
+        _pool(pool),
+        _window_size(window_size),
+        _mem_tracker(mem_tracker) {
+}
+
+StreamReadAhead::~StreamReadAhead() {
+    _cancel(&_current);
+    _cancel(&_next);
+}
+
+void StreamReadAhead::prefetch(uint64_t offset, uint64_t end) {
+    if (_current != nullptr || offset >= end) {
+        return;
+    }
+    _current = _submit(offset, std::min(_window_size, end - offset));
+}
+
+OLAPStatus StreamReadAhead::read(char* buf, uint64_t length, uint64_t offset, uint64_t end) {
+    while (length > 0) {
+        if (_current == nullptr || !_current->contains(offset)) {
+            _cancel(&_current);
+            if (_next != nullptr && _next->contains(offset)) {
+                _current = std::move(_next);
+            } else {
+                // not read sequentially, the next window is useless too.
+                // Nobody waits for this one on the pool, wait() reads it
+                _cancel(&_next);
+                uint64_t window_length = std::min(std::max(_window_size, length), end - offset);
+                _current = _new_window(offset, window_length);
+            }
+        }
+
+        OLAPStatus res = _current->wait();
+        if (res != OLAP_SUCCESS) {
+            _cancel(&_current);
+            return res;
+        }
+        if (_next == nullptr && _current->end() < end) {
+            _next = _submit(_current->end(), std::min(_window_size, end - _current->end()));
+        }
+
+        uint64_t copy_length = std::min(length, _current->end() - offset);
+        memcpy(buf, _current->data() + (offset - _current->offset()), copy_length);
+        buf += copy_length;
+        offset += copy_length;
+        length -= copy_length;
+    }
+    return OLAP_SUCCESS;
+}
+
+std::shared_ptr<StreamReadAhead::Window> StreamReadAhead::_new_window(uint64_t offset,
+                                                                      uint64_t length) {
+    _mem_tracker->consume(length);
+    return std::make_shared<Window>(_file_handler, offset, length);
+}
+
+std::shared_ptr<StreamReadAhead::Window> StreamReadAhead::_submit(uint64_t offset,
+                                                                  uint64_t length) {
+    std::shared_ptr<Window> window = _new_window(offset, length);
+    // When the pool is behind, leave the window to wait() rather than block
+    // the scanner on a full queue. Racing scanners may still find it full
+    // and wait for a slot. After the pool is shut down wait() reads it too.
+    if (_pool->get_queue_size() < config::segment_read_ahead_queue_size) {
+        _pool->offer(std::bind(&Window::run, window));
+    }
+    return window;
+}
+
+void StreamReadAhead::_cancel(std::shared_ptr<Window>* window) {
+    if (*window != nullptr) {
+        (*window)->cancel();
+        _mem_tracker->release((*window)->length());
+        window->reset();
+    }
+}
+
+}  // namespace doris
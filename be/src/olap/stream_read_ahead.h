@@ -0,0 +1,78 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_STREAM_READ_AHEAD_H
+#define DORIS_BE_SRC_OLAP_STREAM_READ_AHEAD_H
+
+#include <memory>
+
+#include "olap/file_helper.h"
+#include "olap/olap_define.h"
+#include "runtime/mem_tracker.h"
+#include "util/thread_pool.hpp"
+
+namespace doris {
+
+// Reads one stream of a segment file ahead of its reader. Data is read in
+// windows of window_size bytes: while the reader consumes the current window
+// the next one is read on the thread pool, so the IO of all streams of a
+// segment overlaps with decompressing and decoding them.
+//
+// A read that is not in the current or the next window, as after a seek,
+// drops both and reads a new window at once. A window the pool has not
+// started when the reader needs it is read by the reader itself, so a busy
+// or shut down pool never blocks a scan.
+//
+// The memory of the windows is consumed from mem_tracker while the stream
+// holds them.
+//
+// Not thread-safe, each stream owns one.
+class StreamReadAhead {
+public:
+    StreamReadAhead(FileHandler* file_handler, ThreadPool* pool, uint64_t window_size,
+                    MemTracker* mem_tracker);
+    ~StreamReadAhead();
+
+    // Start reading the window at offset in the background. end is where
+    // the stream ends in the file, no window is read beyond it.
+    void prefetch(uint64_t offset, uint64_t end);
+
+    // Copy length bytes at offset of the file into buf, offset + length
+    // must not be beyond end.
+    OLAPStatus read(char* buf, uint64_t length, uint64_t offset, uint64_t end);
+
+private:
+    class Window;
+
+    std::shared_ptr<Window> _new_window(uint64_t offset, uint64_t length);
+    std::shared_ptr<Window> _submit(uint64_t offset, uint64_t length);
+    void _cancel(std::shared_ptr<Window>* window);
+
+    FileHandler* _file_handler;
+    ThreadPool* _pool;
+    uint64_t _window_size;
+    MemTracker* _mem_tracker;
+    // window holding the last read bytes and the one after it
+    std::shared_ptr<Window> _current;
+    std::shared_ptr<Window> _next;
+
+    DISALLOW_COPY_AND_ASSIGN(StreamReadAhead);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_STREAM_READ_AHEAD_H
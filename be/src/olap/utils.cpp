@@ -29,10 +29,12 @@
 #include <boost/regex.hpp>
 #include <errno.h>
 #include <lz4/lz4.h>
+#include <lz4/lz4hc.h>
 #include <lzo/lzo1c.h>
 #include <lzo/lzo1x.h>
 #include <stdarg.h>
 
+#include "common/config.h"
 #include "common/logging.h"
 #include "gutil/strings/substitute.h"
 #include "olap/new_status.h"
@@ -331,6 +333,19 @@ OLAPStatus olap_compress(const char* src_buf,
         }
         break;
     }
+    case OLAP_COMP_LZ4HC: {
+        int lz4_res = LZ4_compress_HC(src_buf, dest_buf, src_len, dest_len,
+                                      config::lz4hc_compression_level);
+        *written_len = lz4_res;
+        if (0 == lz4_res) {
+            VLOG(3) << "compress failed. src_len=" << src_len
+                    << ", dest_len=" << dest_len
+                    << ", written_len=" << *written_len
+                    << ", lz4_res=" << lz4_res;
+            return OLAP_ERR_BUFFER_OVERFLOW;
+        }
+        break;
+    }
     default:
         OLAP_LOG_WARNING("unknown compression type. [type=%d]", compression_type);
         break;
@@ -403,7 +418,8 @@ OLAPStatus olap_decompress(const char* src_buf,
         }
         break;
     }
-    case OLAP_COMP_LZ4: {
+    case OLAP_COMP_LZ4:
+    case OLAP_COMP_LZ4HC: {
         int lz4_res = LZ4_decompress_safe(src_buf, dest_buf, src_len, dest_len);
         *written_len = lz4_res;
         if (lz4_res < 0) {
@@ -43,6 +43,7 @@ class PriorityThreadPool;
 class PullLoadTaskMgr;
 class ReservationTracker;
 class ResultBufferMgr;
+class RuntimeFilterMgr;
 class TMasterInfo;
 class TabletWriterMgr;
 class TestExecEnv;
@@ -110,6 +111,7 @@ public:
     BufferPool* buffer_pool() { return _buffer_pool; }
     TabletWriterMgr* tablet_writer_mgr() { return _tablet_writer_mgr; }
     LoadStreamMgr* load_stream_mgr() { return _load_stream_mgr; }
+    RuntimeFilterMgr* runtime_filter_mgr() { return _runtime_filter_mgr; }
     const std::vector<StorePath>& store_paths() const { return _store_paths; }
     void set_store_paths(const std::vector<StorePath>& paths) { _store_paths = paths; }
     OLAPEngine* olap_engine() { return _olap_engine; }
@@ -153,6 +155,7 @@ private:
     TabletWriterMgr* _tablet_writer_mgr = nullptr;
     LoadStreamMgr* _load_stream_mgr = nullptr;
     BrpcStubCache* _brpc_stub_cache = nullptr;
+    RuntimeFilterMgr* _runtime_filter_mgr = nullptr;
 
     ReservationTracker* _buffer_reservation = nullptr;
     BufferPool* _buffer_pool = nullptr;
@@ -27,6 +27,7 @@
 #include "runtime/data_stream_mgr.h"
 #include "runtime/disk_io_mgr.h"
 #include "runtime/result_buffer_mgr.h"
+#include "runtime/runtime_filter_mgr.h"
 #include "runtime/mem_tracker.h"
 #include "runtime/thread_resource_mgr.h"
 #include "runtime/fragment_mgr.h"
@@ -95,6 +96,7 @@ Status ExecEnv::_init(const std::vector<StorePath>& store_paths) {
     _tablet_writer_mgr = new TabletWriterMgr(this);
     _load_stream_mgr = new LoadStreamMgr();
     _brpc_stub_cache = new BrpcStubCache();
+    _runtime_filter_mgr = new RuntimeFilterMgr(this);
 
     _client_cache->init_metrics(DorisMetrics::metrics(), "backend");
     _frontend_client_cache->init_metrics(DorisMetrics::metrics(), "frontend");
@@ -182,6 +184,7 @@ void ExecEnv::_init_buffer_pool(int64_t min_page_size,
 }
 
 void ExecEnv::_destory() {
+    delete _runtime_filter_mgr;
     delete _brpc_stub_cache;
     delete _load_stream_mgr;
     delete _tablet_writer_mgr;
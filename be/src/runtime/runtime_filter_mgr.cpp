@@ -0,0 +1,201 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/runtime_filter_mgr.h"
+
+#include <sstream>
+
+#include "common/config.h"
+#include "common/logging.h"
+#include "exprs/runtime_filter.h"
+#include "gen_cpp/palo_internal_service.pb.h"
+#include "runtime/exec_env.h"
+#include "service/backend_options.h"
+#include "service/brpc.h"
+#include "util/brpc_stub_cache.h"
+
+namespace doris {
+
+// Logs the outcome of an asynchronous publish_runtime_filter rpc, then
+// deletes itself
+class PublishRuntimeFilterClosure : public google::protobuf::Closure {
+public:
+    PublishRuntimeFilterClosure(const RuntimeFilterKey& key, const PNetworkAddress& target)
+            : _key(key), _target(target) { }
+
+    void Run() override {
+        if (cntl.Failed()) {
+            LOG(WARNING) << "fail to publish runtime filter, " << _key
+                         << ", target=" << _target.hostname() << ":" << _target.port()
+                         << ", error=" << cntl.ErrorText();
+        } else {
+            Status status(result.status());
+            if (!status.ok()) {
+                LOG(WARNING) << "fail to publish runtime filter, " << _key
+                             << ", target=" << _target.hostname() << ":" << _target.port()
+                             << ", error=" << status.get_error_msg();
+            }
+        }
+        delete this;
+    }
+
+    brpc::Controller cntl;
+    PPublishRuntimeFilterResult result;
+
+private:
+    RuntimeFilterKey _key;
+    PNetworkAddress _target;
+};
+
+RuntimeFilterMgr::RuntimeFilterMgr(ExecEnv* exec_env) :
+        _exec_env(exec_env),
+        _last_gc_time(Clock::now()) {
+}
+
+RuntimeFilterMgr::~RuntimeFilterMgr() {
+}
+
+Status RuntimeFilterMgr::merge(const PMergeRuntimeFilterRequest& request) {
+    RuntimeFilterKey key(request.query_id(), request.filter_id());
+    std::shared_ptr<RuntimeFilter> filter;
+    RETURN_IF_ERROR(RuntimeFilter::create_from_protobuf(request.filter(), &filter));
+
+    std::shared_ptr<RuntimeFilter> merged;
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        _gc_expired_filters();
+        auto it = _merging.find(key);
+        if (it == _merging.end()) {
+            MergeState state;
+            state.filter = filter;
+            state.num_received = 0;
+            state.create_time = Clock::now();
+            it = _merging.emplace(key, state).first;
+        } else {
+            if (it->second.filter->type().type != filter->type().type) {
+                std::stringstream ss;
+                ss << "runtime filters of different types, " << key
+                    << ", type=" << it->second.filter->type() << ", other=" << filter->type();
+                return Status(ss.str());
+            }
+            it->second.filter->merge(*filter);
+        }
+        if (++it->second.num_received < request.num_producers()) {
+            return Status::OK;
+        }
+        merged = it->second.filter;
+        _merging.erase(it);
+    }
+
+    VLOG(1) << "publish runtime filter, " << key << ", " << merged->debug_string();
+    PPublishRuntimeFilterRequest publish_request;
+    *publish_request.mutable_query_id() = request.query_id();
+    publish_request.set_filter_id(request.filter_id());
+    merged->to_protobuf(publish_request.mutable_filter());
+    for (auto& target : request.targets()) {
+        // the scans of this backend get it without a rpc
+        if (target.hostname() == BackendOptions::get_localhost()
+                && target.port() == config::brpc_port) {
+            Status status = publish(publish_request);
+            if (!status.ok()) {
+                LOG(WARNING) << "fail to publish runtime filter locally, " << key
+                    << ", error=" << status.get_error_msg();
+            }
+            continue;
+        }
+        palo::PInternalService_Stub* stub =
+            _exec_env->brpc_stub_cache()->get_stub(target.hostname(), target.port());
+        if (stub == nullptr) {
+            LOG(WARNING) << "fail to get stub to publish runtime filter, " << key
+                << ", target=" << target.hostname() << ":" << target.port();
+            continue;
+        }
+        // not waited for, the brpc handler returns at once. A target that
+        // misses the filter scans without it.
+        PublishRuntimeFilterClosure* closure = new PublishRuntimeFilterClosure(key, target);
+        closure->cntl.set_timeout_ms(config::runtime_filter_rpc_timeout_ms);
+        stub->publish_runtime_filter(
+                &closure->cntl, &publish_request, &closure->result, closure);
+    }
+    return Status::OK;
+}
+
+Status RuntimeFilterMgr::publish(const PPublishRuntimeFilterRequest& request) {
+    RuntimeFilterKey key(request.query_id(), request.filter_id());
+    std::shared_ptr<RuntimeFilter> filter;
+    RETURN_IF_ERROR(RuntimeFilter::create_from_protobuf(request.filter(), &filter));
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        _gc_expired_filters();
+        PublishState state;
+        state.filter = filter;
+        state.create_time = Clock::now();
+        _published[key] = state;
+    }
+    _cond.notify_all();
+    return Status::OK;
+}
+
+std::shared_ptr<RuntimeFilter> RuntimeFilterMgr::wait(
+        const TUniqueId& query_id, int32_t filter_id,
+        const std::chrono::steady_clock::time_point& deadline) {
+    RuntimeFilterKey key(query_id, filter_id);
+    std::unique_lock<std::mutex> l(_lock);
+    while (true) {
+        auto it = _published.find(key);
+        if (it != _published.end()) {
+            return it->second.filter;
+        }
+        if (_cond.wait_until(l, deadline) == std::cv_status::timeout) {
+            it = _published.find(key);
+            return it == _published.end() ? nullptr : it->second.filter;
+        }
+    }
+}
+
+void RuntimeFilterMgr::_gc_expired_filters() {
+    Clock::time_point now = Clock::now();
+    if (now - _last_gc_time < std::chrono::seconds(60)) {
+        return;
+    }
+    _last_gc_time = now;
+    Clock::time_point expire_time =
+        now - std::chrono::seconds(config::runtime_filter_expire_time_sec);
+    for (auto it = _merging.begin(); it != _merging.end();) {
+        if (it->second.create_time < expire_time) {
+            LOG(WARNING) << "drop runtime filter not sent by all the instances, "
+                << it->first << ", received=" << it->second.num_received;
+            it = _merging.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = _published.begin(); it != _published.end();) {
+        if (it->second.create_time < expire_time) {
+            it = _published.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, const RuntimeFilterKey& key) {
+    os << "query_id=" << key.query_id << ", filter_id=" << key.filter_id;
+    return os;
+}
+
+}
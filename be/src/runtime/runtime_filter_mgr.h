@@ -0,0 +1,115 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+#include "common/status.h"
+#include "gen_cpp/Types_types.h"
+#include "gen_cpp/internal_service.pb.h"
+#include "util/hash_util.hpp"
+#include "util/uid_util.h"
+
+namespace doris {
+
+class ExecEnv;
+class RuntimeFilter;
+
+struct RuntimeFilterKey {
+    UniqueId query_id;
+    int32_t filter_id;
+
+    RuntimeFilterKey(const UniqueId& query_id_, int32_t filter_id_)
+        : query_id(query_id_), filter_id(filter_id_) { }
+    ~RuntimeFilterKey() noexcept { }
+
+    bool operator==(const RuntimeFilterKey& rhs) const noexcept {
+        return filter_id == rhs.filter_id && query_id == rhs.query_id;
+    }
+};
+
+struct RuntimeFilterKeyHasher {
+    std::size_t operator()(const RuntimeFilterKey& key) const {
+        size_t seed = key.query_id.hash();
+        return doris::HashUtil::hash(&key.filter_id, sizeof(key.filter_id), seed);
+    }
+};
+
+// Runtime filters of hash joins shipped between fragments. Every instance of
+// a join sends its filter to the backend merging it. Once the filters of all
+// the instances are merged, the result is published to the backends of the
+// target scans, which wait for it before they start scanning.
+//
+// A query does not tell its end here, so the filters are dropped once
+// runtime_filter_expire_time_sec passed.
+class RuntimeFilterMgr {
+public:
+    RuntimeFilterMgr(ExecEnv* exec_env);
+    ~RuntimeFilterMgr();
+
+    // Merge a filter of one instance, and publish the result to the targets
+    // once all the instances sent theirs. The result is stored at once for a
+    // target on this backend, and sent without waiting to the others.
+    Status merge(const PMergeRuntimeFilterRequest& request);
+
+    // Store a merged filter for the scans waiting for it
+    Status publish(const PPublishRuntimeFilterRequest& request);
+
+    // Wait until the filter is published, or until deadline. Return nullptr
+    // if it is not published then.
+    std::shared_ptr<RuntimeFilter> wait(
+            const TUniqueId& query_id, int32_t filter_id,
+            const std::chrono::steady_clock::time_point& deadline);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct MergeState {
+        std::shared_ptr<RuntimeFilter> filter;
+        int num_received;
+        Clock::time_point create_time;
+    };
+
+    struct PublishState {
+        std::shared_ptr<RuntimeFilter> filter;
+        Clock::time_point create_time;
+    };
+
+    // Remove the expired filters, at most once a minute. _lock must be held.
+    void _gc_expired_filters();
+
+    ExecEnv* _exec_env;
+
+    // protects the maps below
+    std::mutex _lock;
+    // notified when a filter is published
+    std::condition_variable _cond;
+
+    std::unordered_map<RuntimeFilterKey, MergeState, RuntimeFilterKeyHasher> _merging;
+    std::unordered_map<RuntimeFilterKey, PublishState, RuntimeFilterKeyHasher> _published;
+    Clock::time_point _last_gc_time;
+};
+
+std::ostream& operator<<(std::ostream& os, const RuntimeFilterKey& key);
+
+}
@@ -460,6 +460,10 @@ public:
         return _query_options.disable_stream_preaggregations;
     }
 
+    bool disable_page_cache() {
+        return _query_options.disable_page_cache;
+    }
+
      // the following getters are only valid after Prepare()
     InitialReservations* initial_reservations() const { 
         return _initial_reservations; 
@@ -21,6 +21,9 @@
 #include <unordered_map>
 #include <utility>
 
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
 #include "common/object_pool.h"
 #include "exec/olap_table_info.h"
 #include "runtime/descriptors.h"
@@ -55,8 +58,10 @@ private:
     // id of this load channel, just for 
     TabletsChannelKey _key;
 
-    // make execute sequece
-    std::mutex _lock;
+    // make execute sequece. add_batch holds it shared, so that the senders write in
+    // parallel, open and close hold it exclusively, so that no batch is written while
+    // the writers are opened or closed
+    boost::shared_mutex _lock;
 
     // initialized in open function
     int64_t _txn_id = -1;
@@ -70,6 +75,8 @@ private:
     // next sequence we expect
     int _num_remaining_senders = 0;
     std::vector<int64_t> _next_seqs;
+    // one lock per sender, guards its entry of _next_seqs
+    std::unique_ptr<std::mutex[]> _sender_locks;
     Bitmap _closed_senders;
     Status _close_status;
 
@@ -91,7 +98,7 @@ TabletsChannel::~TabletsChannel() {
 }
 
 Status TabletsChannel::open(const PTabletWriterOpenRequest& params) {
-    std::lock_guard<std::mutex> l(_lock);
+    boost::unique_lock<boost::shared_mutex> l(_lock);
     if (_opened) {
         // Normal case, already open by other sender
         return Status::OK;
@@ -105,6 +112,7 @@ Status TabletsChannel::open(const PTabletWriterOpenRequest& params) {
 
     _num_remaining_senders = params.num_senders();
     _next_seqs.resize(_num_remaining_senders, 0);
+    _sender_locks.reset(new std::mutex[_num_remaining_senders]);
     _closed_senders.Reset(_num_remaining_senders);
 
     RETURN_IF_ERROR(_open_all_writers(params));
@@ -115,8 +123,11 @@ Status TabletsChannel::open(const PTabletWriterOpenRequest& params) {
 
 Status TabletsChannel::add_batch(const PTabletWriterAddBatchRequest& params) {
     DCHECK(params.tablet_ids_size() == params.row_batch().num_rows());
-    std::lock_guard<std::mutex> l(_lock);
+    boost::shared_lock<boost::shared_mutex> l(_lock);
     DCHECK(_opened);
+    // batches of one sender are applied in order, batches of different
+    // senders are written in parallel
+    std::lock_guard<std::mutex> sender_l(_sender_locks[params.sender_id()]);
     auto next_seq = _next_seqs[params.sender_id()];
     // check packet
     if (params.packet_seq() < next_seq) {
@@ -128,21 +139,30 @@ Status TabletsChannel::add_batch(const PTabletWriterAddBatchRequest& params) {
             << ", recept_seq=" << params.packet_seq();
         return Status("lost data packet");
     }
+    if (_closed_senders.Get(params.sender_id())) {
+        // the writers may already be closed
+        LOG(WARNING) << "data packet after close, sender_id=" << params.sender_id()
+            << ", recept_seq=" << params.packet_seq();
+        return Status("data packet after close");
+    }
 
     RowBatch row_batch(*_row_desc, params.row_batch(), &_mem_tracker);
 
-    // iterator all data
+    // group rows by tablet, so each writer takes its lock once per batch
+    std::unordered_map<int64_t, std::vector<Tuple*>> tablet_to_tuples;
     for (int i = 0; i < params.tablet_ids_size(); ++i) {
         auto tablet_id = params.tablet_ids(i);
-        auto it = _tablet_writers.find(tablet_id);
-        if (it == std::end(_tablet_writers)) {
+        if (_tablet_writers.count(tablet_id) == 0) {
             std::stringstream ss;
             ss << "unknown tablet to append data, tablet=" << tablet_id;
             return Status(ss.str());
         }
-        auto st = it->second->write(row_batch.get_row(i)->get_tuple(0));
+        tablet_to_tuples[tablet_id].push_back(row_batch.get_row(i)->get_tuple(0));
+    }
+    for (auto& it : tablet_to_tuples) {
+        auto st = _tablet_writers.at(it.first)->write_batch(it.second);
         if (st != OLAP_SUCCESS) {
-            LOG(WARNING) << "tablet writer writer failed, tablet_id=" << it->first
+            LOG(WARNING) << "tablet writer writer failed, tablet_id=" << it.first
                 << ", transaction_id=" << _txn_id;
             return Status("tablet writer write failed");
         }
@@ -154,7 +174,7 @@ Status TabletsChannel::add_batch(const PTabletWriterAddBatchRequest& params) {
 Status TabletsChannel::close(int sender_id, bool* finished,
         const google::protobuf::RepeatedField<int64_t>& partition_ids,
         google::protobuf::RepeatedPtrField<PTabletInfo>* tablet_vec) {
-    std::lock_guard<std::mutex> l(_lock);
+    boost::unique_lock<boost::shared_mutex> l(_lock);
     if (_closed_senders.Get(sender_id)) {
         // Dobule close from one sender, just return OK
         *finished = (_num_remaining_senders == 0);
@@ -19,6 +19,7 @@
 #define DORIS_BE_SRC_RUNTIME_VECTORIZED_ROW_BATCH_H
 
 #include <cstddef>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -130,6 +131,23 @@ public:
         _mem_pool->clear();
     }
 
+    // Unselect the first num_rows selected rows
+    void skip_rows(uint16_t num_rows) {
+        DCHECK_LE(num_rows, _size);
+        if (num_rows == 0) {
+            return;
+        }
+        if (_selected_in_use) {
+            memmove(_selected, _selected + num_rows, (_size - num_rows) * sizeof(uint16_t));
+        } else {
+            for (uint16_t i = 0; i < _size - num_rows; ++i) {
+                _selected[i] = i + num_rows;
+            }
+            _selected_in_use = true;
+        }
+        _size -= num_rows;
+    }
+
     uint16_t limit() const { return _limit; }
     void set_limit(uint16_t limit) { _limit = limit; }
     void set_block_status(uint8_t status) { _block_status = status; }
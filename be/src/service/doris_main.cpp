@@ -164,6 +164,7 @@ int main(int argc, char** argv) {
     auto exec_env = doris::ExecEnv::GetInstance();
     doris::ExecEnv::init(exec_env, paths);
     exec_env->set_olap_engine(engine);
+    engine->init_stream_page_cache(exec_env->process_mem_tracker());
 
     doris::FrontendHelper::setup(exec_env);
     doris::ThriftServer* be_server = nullptr;
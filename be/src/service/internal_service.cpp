@@ -23,6 +23,7 @@
 #include "runtime/exec_env.h"
 #include "runtime/data_stream_mgr.h"
 #include "runtime/fragment_mgr.h"
+#include "runtime/runtime_filter_mgr.h"
 #include "service/brpc.h"
 #include "util/uid_util.h"
 #include "util/thrift_util.h"
@@ -183,6 +184,42 @@ void PInternalServiceImpl<T>::trigger_profile_report(
     st.to_protobuf(result->mutable_status());
 }
 
+template<typename T>
+void PInternalServiceImpl<T>::merge_runtime_filter(
+        google::protobuf::RpcController* controller,
+        const PMergeRuntimeFilterRequest* request,
+        PMergeRuntimeFilterResult* result,
+        google::protobuf::Closure* done) {
+    VLOG_RPC << "merge runtime filter, query_id=" << print_id(request->query_id())
+        << ", filter_id=" << request->filter_id();
+    brpc::ClosureGuard closure_guard(done);
+    auto st = _exec_env->runtime_filter_mgr()->merge(*request);
+    if (!st.ok()) {
+        LOG(WARNING) << "merge runtime filter failed, errmsg=" << st.get_error_msg()
+            << ", query_id=" << print_id(request->query_id())
+            << ", filter_id=" << request->filter_id();
+    }
+    st.to_protobuf(result->mutable_status());
+}
+
+template<typename T>
+void PInternalServiceImpl<T>::publish_runtime_filter(
+        google::protobuf::RpcController* controller,
+        const PPublishRuntimeFilterRequest* request,
+        PPublishRuntimeFilterResult* result,
+        google::protobuf::Closure* done) {
+    VLOG_RPC << "publish runtime filter, query_id=" << print_id(request->query_id())
+        << ", filter_id=" << request->filter_id();
+    brpc::ClosureGuard closure_guard(done);
+    auto st = _exec_env->runtime_filter_mgr()->publish(*request);
+    if (!st.ok()) {
+        LOG(WARNING) << "publish runtime filter failed, errmsg=" << st.get_error_msg()
+            << ", query_id=" << print_id(request->query_id())
+            << ", filter_id=" << request->filter_id();
+    }
+    st.to_protobuf(result->mutable_status());
+}
+
 template class PInternalServiceImpl<PBackendService>;
 template class PInternalServiceImpl<palo::PInternalService>;
 
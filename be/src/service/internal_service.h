@@ -80,6 +80,18 @@ public:
         PTriggerProfileReportResult* result,
         google::protobuf::Closure* done) override;
 
+    void merge_runtime_filter(
+        google::protobuf::RpcController* controller,
+        const PMergeRuntimeFilterRequest* request,
+        PMergeRuntimeFilterResult* result,
+        google::protobuf::Closure* done) override;
+
+    void publish_runtime_filter(
+        google::protobuf::RpcController* controller,
+        const PPublishRuntimeFilterRequest* request,
+        PPublishRuntimeFilterResult* result,
+        google::protobuf::Closure* done) override;
+
 private:
     Status _exec_plan_fragment(brpc::Controller* cntl);
 private:
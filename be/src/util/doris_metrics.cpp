@@ -85,12 +85,16 @@ IntCounter DorisMetrics::meta_write_request_duration_us;
 IntCounter DorisMetrics::meta_read_request_total;
 IntCounter DorisMetrics::meta_read_request_duration_us;
 
+IntCounter DorisMetrics::memtable_flush_total;
+IntCounter DorisMetrics::memtable_flush_duration_us;
+
 // gauges
 IntGauge DorisMetrics::memory_pool_bytes_total;
 IntGauge DorisMetrics::process_thread_num;
 IntGauge DorisMetrics::process_fd_num_used;
 IntGauge DorisMetrics::process_fd_num_limit_soft;
 IntGauge DorisMetrics::process_fd_num_limit_hard;
+IntGauge DorisMetrics::memtable_flush_queue_count;
 
 DorisMetrics::DorisMetrics() : _metrics(nullptr), _system_metrics(nullptr) {
 }
@@ -190,12 +194,16 @@ void DorisMetrics::initialize(const std::string& name,
         "meta_request_duration", MetricLabels().add("type", "read"),
         &meta_read_request_duration_us);
 
+    REGISTER_DORIS_METRIC(memtable_flush_total);
+    REGISTER_DORIS_METRIC(memtable_flush_duration_us);
+
     // Gauge
     REGISTER_DORIS_METRIC(memory_pool_bytes_total);
     REGISTER_DORIS_METRIC(process_thread_num);
     REGISTER_DORIS_METRIC(process_fd_num_used);
     REGISTER_DORIS_METRIC(process_fd_num_limit_soft);
     REGISTER_DORIS_METRIC(process_fd_num_limit_hard);
+    REGISTER_DORIS_METRIC(memtable_flush_queue_count);
 
     _metrics->register_hook(_s_hook_name, std::bind(&DorisMetrics::update, this));
 
@@ -89,12 +89,16 @@ public:
     static IntCounter meta_read_request_total;
     static IntCounter meta_read_request_duration_us;
 
+    static IntCounter memtable_flush_total;
+    static IntCounter memtable_flush_duration_us;
+
     // Gauges
     static IntGauge memory_pool_bytes_total;
     static IntGauge process_thread_num;
     static IntGauge process_fd_num_used;
     static IntGauge process_fd_num_limit_soft;
     static IntGauge process_fd_num_limit_hard;
+    static IntGauge memtable_flush_queue_count;
 
     ~DorisMetrics();
     // call before calling metrics
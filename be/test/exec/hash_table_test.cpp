@@ -16,55 +16,111 @@
 // under the License.
 
 #include <map>
+#include <set>
 #include <stdlib.h>
 #include <stdio.h>
 #include <iostream>
+#include <sstream>
 #include <vector>
 
 #include <gtest/gtest.h>
 
 #include "common/compiler_util.h"
+#include "common/object_pool.h"
 #include "exec/hash_table.hpp"
 #include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "exprs/slot_ref.h"
+#include "runtime/descriptors.h"
 #include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/row_batch.h"
 #include "runtime/string_value.h"
-#include "runtime/mem_limit.hpp"
+#include "runtime/thread_resource_mgr.h"
+#include "runtime/tuple_row.h"
+#include "testutil/desc_tbl_builder.h"
 #include "util/cpu_info.h"
+#include "util/logging.h"
 #include "util/runtime_profile.h"
 
 namespace doris {
 
 using std::vector;
 using std::map;
+using std::set;
 
+// Layout of the tuples of the tests with an INT and a VARCHAR key
+static const int INT_SLOT_OFFSET = 0;
+static const int STRING_SLOT_OFFSET = 8;
+static const int STRING_TUPLE_SIZE = STRING_SLOT_OFFSET + sizeof(StringValue);
 
 class HashTableTest : public testing::Test {
 public:
-    HashTableTest() : _mem_pool() {}
+    HashTableTest() : _tracker(-1), _mem_pool(&_tracker) {}
 
 protected:
     ObjectPool _pool;
+    MemTracker _tracker;
     MemPool _mem_pool;
-    vector<Expr*> _build_expr;
-    vector<Expr*> _probe_expr;
+    vector<ExprContext*> _build_expr_ctxs;
+    vector<ExprContext*> _probe_expr_ctxs;
 
     virtual void SetUp() {
-        RowDescriptor desc;
-        Status status;
-
         // Not very easy to test complex tuple layouts so this test will use the
         // simplest.  The purpose of these tests is to exercise the hash map
         // internals so a simple build/probe expr is fine.
-        _build_expr.push_back(_pool.add(new SlotRef(TYPE_INT, 0)));
-        status = Expr::prepare(_build_expr, NULL, desc);
-        EXPECT_TRUE(status.ok());
+        create_expr_ctxs(false, &_build_expr_ctxs);
+        create_expr_ctxs(false, &_probe_expr_ctxs);
+    }
 
-        _probe_expr.push_back(_pool.add(new SlotRef(TYPE_INT, 0)));
-        status = Expr::prepare(_probe_expr, NULL, desc);
+    virtual void TearDown() {
+        Expr::close(_build_expr_ctxs, NULL);
+        Expr::close(_probe_expr_ctxs, NULL);
+        _mem_pool.free_all();
+    }
+
+    // INT key at offset 0 of tuple 0, and VARCHAR key at STRING_SLOT_OFFSET if
+    // 'string_key'. A row whose tuple is NULL has NULL keys.
+    void create_expr_ctxs(bool string_key, vector<ExprContext*>* ctxs) {
+        RowDescriptor desc;
+        Expr* expr = _pool.add(new SlotRef(TYPE_INT, INT_SLOT_OFFSET));
+        ctxs->push_back(_pool.add(new ExprContext(expr)));
+        if (string_key) {
+            expr = _pool.add(new SlotRef(TYPE_VARCHAR, STRING_SLOT_OFFSET));
+            ctxs->push_back(_pool.add(new ExprContext(expr)));
+        }
+        Status status = Expr::prepare(*ctxs, NULL, desc, &_tracker);
+        EXPECT_TRUE(status.ok());
+        status = Expr::open(*ctxs, NULL);
         EXPECT_TRUE(status.ok());
     }
 
-    TupleRow* create_tuple_row(int32_t val);
+    TupleRow* create_tuple_row(int32_t val) {
+        uint8_t* tuple_row_mem = _mem_pool.allocate(sizeof(int32_t*));
+        Tuple* tuple_mem = Tuple::create(sizeof(int32_t), &_mem_pool);
+        *reinterpret_cast<int32_t*>(tuple_mem) = val;
+        TupleRow* row = reinterpret_cast<TupleRow*>(tuple_row_mem);
+        row->set_tuple(0, tuple_mem);
+        return row;
+    }
+
+    // Tuple of the tests with a string key, the string is derived from 'val' and of
+    // varying length. NULL if 'is_null'.
+    Tuple* create_string_tuple(int32_t val, bool is_null) {
+        if (is_null) {
+            return NULL;
+        }
+        Tuple* tuple = Tuple::create(STRING_TUPLE_SIZE, &_mem_pool);
+        *reinterpret_cast<int32_t*>(tuple->get_slot(INT_SLOT_OFFSET)) = val % 10;
+        std::stringstream ss;
+        ss << "key-" << std::string(val % 7, 'x') << val;
+        std::string str = ss.str();
+        char* ptr = reinterpret_cast<char*>(_mem_pool.allocate(str.size()));
+        memcpy(ptr, str.data(), str.size());
+        *reinterpret_cast<StringValue*>(tuple->get_slot(STRING_SLOT_OFFSET)) =
+            StringValue(ptr, str.size());
+        return tuple;
+    }
 
     // Wrapper to call private methods on HashTable
     // TODO: understand google testing, there must be a more natural way to do this
@@ -82,7 +138,7 @@ protected:
 
         while (iter != table->end()) {
             TupleRow* row = iter.get_row();
-            int32_t val = *reinterpret_cast<int32_t*>(_build_expr[0]->get_value(row));
+            int32_t val = *reinterpret_cast<int32_t*>(_build_expr_ctxs[0]->get_value(row));
             EXPECT_GE(val, min);
             EXPECT_LT(val, max);
 
@@ -100,8 +156,10 @@ protected:
     // evaluated over build_exprs
     void validate_match(TupleRow* probe_row, TupleRow* build_row) {
         EXPECT_TRUE(probe_row != build_row);
-        int32_t build_val = *reinterpret_cast<int32_t*>(_build_expr[0]->get_value(probe_row));
-        int32_t probe_val = *reinterpret_cast<int32_t*>(_probe_expr[0]->get_value(build_row));
+        int32_t build_val =
+            *reinterpret_cast<int32_t*>(_build_expr_ctxs[0]->get_value(probe_row));
+        int32_t probe_val =
+            *reinterpret_cast<int32_t*>(_probe_expr_ctxs[0]->get_value(build_row));
         EXPECT_EQ(build_val, probe_val);
     }
 
@@ -131,28 +189,75 @@ protected:
 
                     EXPECT_EQ(matched.size(), data[i].expected_build_rows.size());
 
-                    for (int j = 0; i < data[j].expected_build_rows.size(); ++j) {
+                    for (int j = 0; j < data[i].expected_build_rows.size(); ++j) {
                         EXPECT_TRUE(matched[data[i].expected_build_rows[j]]);
                     }
                 } else {
                     EXPECT_EQ(data[i].expected_build_rows.size(), 1);
-                    EXPECT_EQ(data[i].expected_build_rows[0]->get_tuple(0), 
+                    EXPECT_EQ(data[i].expected_build_rows[0]->get_tuple(0),
                               iter.get_row()->get_tuple(0));
                     validate_match(row, iter.get_row());
                 }
             }
         }
     }
-};
 
-TupleRow* HashTableTest::create_tuple_row(int32_t val) {
-    uint8_t* tuple_row_mem = _mem_pool.allocate(sizeof(int32_t*));
-    uint8_t* tuple_mem = _mem_pool.allocate(sizeof(int32_t));
-    *reinterpret_cast<int32_t*>(tuple_mem) = val;
-    TupleRow* row = reinterpret_cast<TupleRow*>(tuple_row_mem);
-    row->set_tuple(0, reinterpret_cast<Tuple*>(tuple_mem));
-    return row;
-}
+    // Returns the rows from 'iter' to the end of its matches.
+    set<TupleRow*> matches(HashTable* table, HashTable::Iterator iter) {
+        set<TupleRow*> rows;
+        while (iter != table->end()) {
+            EXPECT_TRUE(rows.insert(iter.get_row()).second);
+            iter.next<true>();
+        }
+        return rows;
+    }
+
+    // Builds 'table' with append() and link_nodes() from 'build_rows'.
+    bool append_and_link(HashTable* table, const vector<TupleRow*>& build_rows,
+                         int max_threads, ThreadResourceMgr::ResourcePool* resource_pool) {
+        for (int i = 0; i < build_rows.size(); ++i) {
+            table->append(build_rows[i]);
+        }
+        return table->link_nodes(max_threads, resource_pool);
+    }
+
+    // Checks that each probe row matches the same build rows in 'table' as in 'expected'.
+    void compare_tables(HashTable* expected, HashTable* table,
+                        const vector<TupleRow*>& probe_rows) {
+        EXPECT_EQ(expected->size(), table->size());
+        for (int i = 0; i < probe_rows.size(); ++i) {
+            set<TupleRow*> expected_rows = matches(expected, expected->find(probe_rows[i]));
+            set<TupleRow*> rows = matches(table, table->find(probe_rows[i]));
+            EXPECT_EQ(expected_rows, rows) << "probe row " << i;
+        }
+    }
+
+    // Probes the rows of 'batch' in groups, with eval_and_hash_probe_group() and
+    // find_cached(), and checks that each row matches the same build rows as with
+    // find(). Returns the number of groups.
+    int probe_group_test(HashTable* table, RowBatch* batch, int64_t* num_matches) {
+        int num_groups = 0;
+        *num_matches = 0;
+        for (int start = 0; start < batch->num_rows(); ++num_groups) {
+            int num_cached = table->eval_and_hash_probe_group(batch, start);
+            EXPECT_GT(num_cached, 0);
+            EXPECT_LE(num_cached, table->probe_group_capacity());
+            if (num_cached <= 0) {
+                break;
+            }
+            for (int i = 0; i < num_cached; ++i) {
+                // find() overwrites the values of the current row, the cached ones
+                // are still used by the next find_cached().
+                set<TupleRow*> cached_rows = matches(table, table->find_cached(i));
+                set<TupleRow*> rows = matches(table, table->find(batch->get_row(start + i)));
+                EXPECT_EQ(rows, cached_rows) << "row " << start + i;
+                *num_matches += cached_rows.size();
+            }
+            start += num_cached;
+        }
+        return num_groups;
+    }
+};
 
 TEST_F(HashTableTest, SetupTest) {
     TupleRow* build_row1 = create_tuple_row(1);
@@ -160,10 +265,10 @@ TEST_F(HashTableTest, SetupTest) {
     TupleRow* probe_row3 = create_tuple_row(3);
     TupleRow* probe_row4 = create_tuple_row(4);
 
-    int32_t* val_row1 = reinterpret_cast<int32_t*>(_build_expr[0]->get_value(build_row1));
-    int32_t* val_row2 = reinterpret_cast<int32_t*>(_build_expr[0]->get_value(build_row2));
-    int32_t* val_row3 = reinterpret_cast<int32_t*>(_probe_expr[0]->get_value(probe_row3));
-    int32_t* val_row4 = reinterpret_cast<int32_t*>(_probe_expr[0]->get_value(probe_row4));
+    int32_t* val_row1 = reinterpret_cast<int32_t*>(_build_expr_ctxs[0]->get_value(build_row1));
+    int32_t* val_row2 = reinterpret_cast<int32_t*>(_build_expr_ctxs[0]->get_value(build_row2));
+    int32_t* val_row3 = reinterpret_cast<int32_t*>(_probe_expr_ctxs[0]->get_value(probe_row3));
+    int32_t* val_row4 = reinterpret_cast<int32_t*>(_probe_expr_ctxs[0]->get_value(probe_row4));
 
     EXPECT_EQ(*val_row1, 1);
     EXPECT_EQ(*val_row2, 2);
@@ -193,8 +298,9 @@ TEST_F(HashTableTest, BasicTest) {
         }
     }
 
-    // Create the hash table and insert the build rows
-    HashTable hash_table(_build_expr, _probe_expr, 1, false, 0);
+    // Start with one bucket so that the rows collide, the table grows as they are
+    // inserted.
+    HashTable hash_table(_build_expr_ctxs, _probe_expr_ctxs, 1, false, 0, &_tracker, 1);
 
     for (int i = 0; i < 5; ++i) {
         hash_table.insert(build_rows[i]);
@@ -214,26 +320,19 @@ TEST_F(HashTableTest, BasicTest) {
     full_scan(&hash_table, 0, 5, true, scan_rows, build_rows);
     probe_test(&hash_table, probe_rows, 10, false);
 
-    // Resize to two and cause some collisions
-    resize_table(&hash_table, 2);
-    EXPECT_EQ(hash_table.num_buckets(), 2);
-    EXPECT_EQ(hash_table.size(), 5);
-    memset(scan_rows, 0, sizeof(scan_rows));
-    full_scan(&hash_table, 0, 5, true, scan_rows, build_rows);
-    probe_test(&hash_table, probe_rows, 10, false);
-
-    // Resize to one and turn it into a linked list
-    resize_table(&hash_table, 1);
-    EXPECT_EQ(hash_table.num_buckets(), 1);
+    // Resize by more than doubling
+    resize_table(&hash_table, 1024);
+    EXPECT_EQ(hash_table.num_buckets(), 1024);
     EXPECT_EQ(hash_table.size(), 5);
     memset(scan_rows, 0, sizeof(scan_rows));
     full_scan(&hash_table, 0, 5, true, scan_rows, build_rows);
     probe_test(&hash_table, probe_rows, 10, false);
+    hash_table.close();
 }
 
 // This tests makes sure we can scan ranges of buckets
 TEST_F(HashTableTest, ScanTest) {
-    HashTable hash_table(_build_expr, _probe_expr, 1, false, 0);
+    HashTable hash_table(_build_expr_ctxs, _probe_expr_ctxs, 1, false, 0, &_tracker, 2);
     // Add 1 row with val 1, 2 with val 2, etc
     vector<TupleRow*> build_rows;
     ProbeTestData probe_rows[15];
@@ -263,13 +362,10 @@ TEST_F(HashTableTest, ScanTest) {
     EXPECT_EQ(hash_table.num_buckets(), 128);
     probe_test(&hash_table, probe_rows, 15, true);
 
-    resize_table(&hash_table, 16);
-    EXPECT_EQ(hash_table.num_buckets(), 16);
-    probe_test(&hash_table, probe_rows, 15, true);
-
-    resize_table(&hash_table, 2);
-    EXPECT_EQ(hash_table.num_buckets(), 2);
+    resize_table(&hash_table, 256);
+    EXPECT_EQ(hash_table.num_buckets(), 256);
     probe_test(&hash_table, probe_rows, 15, true);
+    hash_table.close();
 }
 
 // This test continues adding to the hash table to trigger the resize code paths
@@ -278,13 +374,11 @@ TEST_F(HashTableTest, GrowTableTest) {
     int num_to_add = 4;
     int expected_size = 0;
     MemTracker mem_limit(1024 * 1024);
-    vector<MemTracker*> mem_limits;
-    mem_limits.push_back(&mem_limit);
     HashTable hash_table(
-        _build_expr, _probe_expr, 1, false, 0, mem_limits, num_to_add);
+        _build_expr_ctxs, _probe_expr_ctxs, 1, false, 0, &mem_limit, num_to_add);
     EXPECT_TRUE(!mem_limit.limit_exceeded());
 
-    // This inserts about 5M entries
+    // This inserts about 4M entries
     for (int i = 0; i < 20; ++i) {
         for (int j = 0; j < num_to_add; ++build_row_val, ++j) {
             hash_table.insert(create_tuple_row(build_row_val));
@@ -309,47 +403,155 @@ TEST_F(HashTableTest, GrowTableTest) {
             EXPECT_TRUE(iter == hash_table.end());
         }
     }
+    hash_table.close();
 }
 
-// This test continues adding to the hash table to trigger the resize code paths
-TEST_F(HashTableTest, GrowTableTest2) {
-    int build_row_val = 0;
-    int num_to_add = 1024;
-    int expected_size = 0;
-    MemTracker mem_limit(1024 * 1024);
-    vector<MemTracker*> mem_limits;
-    mem_limits.push_back(&mem_limit);
-    HashTable hash_table(
-        _build_expr, _probe_expr, 1, false, 0, mem_limits, num_to_add);
+// Probes in groups spanning several probe_group_capacity(), with duplicate build keys,
+// NULL probe and build keys, and INT and VARCHAR keys.
+TEST_F(HashTableTest, ProbeGroupTest) {
+    vector<ExprContext*> build_expr_ctxs;
+    vector<ExprContext*> probe_expr_ctxs;
+    create_expr_ctxs(true, &build_expr_ctxs);
+    create_expr_ctxs(true, &probe_expr_ctxs);
+
+    DescriptorTblBuilder builder(&_pool);
+    builder.declare_tuple() << TYPE_INT << TYPE_VARCHAR;
+    DescriptorTbl* desc_tbl = builder.build();
+    vector<TTupleId> tuple_ids(1, 0);
+    vector<bool> nullable_tuples(1, true);
+    RowDescriptor row_desc(*desc_tbl, tuple_ids, nullable_tuples);
+
+    const int num_probe_rows = 1000;
+    for (bool stores_nulls : {false, true}) {
+        HashTable hash_table(build_expr_ctxs, probe_expr_ctxs, 1, stores_nulls, 0,
+                             &_tracker, 1024);
+        // The keys are small, the groups are bounded by MAX_PROBE_GROUP_ROWS
+        EXPECT_EQ(HashTable::MAX_PROBE_GROUP_ROWS, hash_table.probe_group_capacity());
+        // Keys [0, 500) twice, and a few NULL keys
+        for (int i = 0; i < 1000; ++i) {
+            TupleRow* row = reinterpret_cast<TupleRow*>(_mem_pool.allocate(sizeof(Tuple*)));
+            row->set_tuple(0, create_string_tuple(i % 500, i % 101 == 0));
+            hash_table.insert(row);
+        }
+
+        // Keys [0, 700), a third of them have no match, and every 7th key is NULL
+        RowBatch batch(row_desc, num_probe_rows, &_tracker);
+        for (int i = 0; i < num_probe_rows; ++i) {
+            TupleRow* row = batch.get_row(batch.add_row());
+            row->set_tuple(0, create_string_tuple(i % 700, i % 7 == 0));
+            batch.commit_last_row();
+        }
 
-    LOG(INFO) << time(NULL);
+        int64_t num_matches = 0;
+        int num_groups = probe_group_test(&hash_table, &batch, &num_matches);
+        EXPECT_EQ((num_probe_rows + HashTable::MAX_PROBE_GROUP_ROWS - 1)
+                  / HashTable::MAX_PROBE_GROUP_ROWS, num_groups);
+        EXPECT_GT(num_matches, 0);
 
-    // This inserts about 5M entries
-    for (int i = 0; i < 5 * 1024 * 1024; ++i) {
-        hash_table.insert(create_tuple_row(build_row_val));
-        expected_size += num_to_add;
+        // The NULL probe keys match the NULL build keys iff the table stores them
+        for (int i = 0; i < num_probe_rows; i += 7) {
+            set<TupleRow*> rows = matches(&hash_table, hash_table.find(batch.get_row(i)));
+            EXPECT_EQ(stores_nulls, !rows.empty());
+        }
+        hash_table.close();
+    }
+
+    Expr::close(build_expr_ctxs, NULL);
+    Expr::close(probe_expr_ctxs, NULL);
+}
+
+// Links enough appended rows for several threads, with duplicate and NULL keys, and
+// checks that the table matches the ones linked by a single thread and built by insert().
+TEST_F(HashTableTest, LinkNodesTest) {
+    const int num_threads = 4;
+    const int num_keys = 100 * 1000;
+    const int num_build_rows = 3 * num_keys;
+    ASSERT_GT(num_build_rows, num_threads * HashTable::MIN_ROWS_PER_LINK_THREAD);
+
+    // Each key three times, and every 97th row NULL
+    vector<TupleRow*> build_rows;
+    int num_null_rows = 0;
+    for (int i = 0; i < num_build_rows; ++i) {
+        TupleRow* row = create_tuple_row(i % num_keys);
+        if (i % 97 == 0) {
+            row->set_tuple(0, NULL);
+            ++num_null_rows;
+        }
+        build_rows.push_back(row);
+    }
+    // Keys with and without a match, and a NULL key
+    vector<TupleRow*> probe_rows;
+    for (int i = 0; i < num_keys + 1000; i += 7) {
+        probe_rows.push_back(create_tuple_row(i));
+    }
+    probe_rows.push_back(create_tuple_row(0));
+    probe_rows.back()->set_tuple(0, NULL);
+
+    ThreadResourceMgr thread_mgr(num_threads * 2);
+    ThreadResourceMgr::ResourcePool* resource_pool = thread_mgr.register_pool();
+    for (bool stores_nulls : {false, true}) {
+        HashTable inserted(_build_expr_ctxs, _probe_expr_ctxs, 1, stores_nulls, 0,
+                           &_tracker, 1024);
+        for (int i = 0; i < num_build_rows; ++i) {
+            inserted.insert(build_rows[i]);
+        }
+        HashTable serial(_build_expr_ctxs, _probe_expr_ctxs, 1, stores_nulls, 0,
+                         &_tracker, 1024);
+        EXPECT_TRUE(append_and_link(&serial, build_rows, 1, NULL));
+        HashTable parallel(_build_expr_ctxs, _probe_expr_ctxs, 1, stores_nulls, 0,
+                           &_tracker, 1024);
+        EXPECT_TRUE(append_and_link(&parallel, build_rows, num_threads, resource_pool));
+        // The thread tokens are released once the rows are linked
+        EXPECT_EQ(0, resource_pool->num_optional_threads());
+
+        EXPECT_EQ(stores_nulls ? num_build_rows : num_build_rows - num_null_rows,
+                  parallel.size());
+        EXPECT_EQ(serial.num_buckets(), parallel.num_buckets());
+        compare_tables(&inserted, &serial, probe_rows);
+        compare_tables(&serial, &parallel, probe_rows);
+        inserted.close();
+        serial.close();
+        parallel.close();
     }
+    thread_mgr.unregister_pool(resource_pool);
+}
 
-    LOG(INFO) << time(NULL);
+// The rows are still linked, into the current buckets, when the buckets cannot grow.
+TEST_F(HashTableTest, LinkNodesMemLimitTest) {
+    const int num_build_rows = 4 * HashTable::MIN_ROWS_PER_LINK_THREAD;
+    vector<TupleRow*> build_rows;
+    for (int i = 0; i < num_build_rows; ++i) {
+        build_rows.push_back(create_tuple_row(i % (num_build_rows / 2)));
+    }
 
-    // Validate that we can find the entries
-    for (int i = 0; i < 5 * 1024 * 1024; ++i) {
+    MemTracker mem_limit(64 * 1024 * 1024);
+    HashTable hash_table(_build_expr_ctxs, _probe_expr_ctxs, 1, false, 0, &mem_limit, 1024);
+    for (int i = 0; i < num_build_rows; ++i) {
+        hash_table.append(build_rows[i]);
+    }
+    // Leave no room for the buckets
+    int64_t reserved = mem_limit.limit() - mem_limit.consumption();
+    mem_limit.consume(reserved);
+    ThreadResourceMgr thread_mgr(4);
+    ThreadResourceMgr::ResourcePool* resource_pool = thread_mgr.register_pool();
+    EXPECT_FALSE(hash_table.link_nodes(4, resource_pool));
+    EXPECT_EQ(0, resource_pool->num_optional_threads());
+    thread_mgr.unregister_pool(resource_pool);
+    mem_limit.release(reserved);
+
+    EXPECT_EQ(1024, hash_table.num_buckets());
+    EXPECT_EQ(num_build_rows, hash_table.size());
+    for (int i = 0; i < num_build_rows / 2; i += 101) {
         TupleRow* probe_row = create_tuple_row(i);
-        hash_table.find(probe_row);
+        EXPECT_EQ(2, matches(&hash_table, hash_table.find(probe_row)).size());
     }
-
-    LOG(INFO) << time(NULL);
+    hash_table.close();
 }
 
 }
 
 int main(int argc, char** argv) {
-    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
-    if (!doris::config::init(conffile.c_str(), false)) {
-        fprintf(stderr, "error read config file. \n");
-        return -1;
-    }
-    init_glog("be-test");
+    doris::init_glog("be-test");
     ::testing::InitGoogleTest(&argc, argv);
     doris::CpuInfo::init();
     return RUN_ALL_TESTS();
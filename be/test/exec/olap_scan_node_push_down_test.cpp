@@ -0,0 +1,340 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "common/object_pool.h"
+#include "exec/hash_join_node.h"
+#include "exec/olap_scan_node.h"
+#include "exprs/expr.h"
+#include "exprs/runtime_filter.h"
+#include "gen_cpp/Exprs_types.h"
+#include "gen_cpp/PaloInternalService_types.h"
+#include "gen_cpp/PlanNodes_types.h"
+#include "runtime/descriptors.h"
+#include "runtime/exec_env.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/runtime_filter_mgr.h"
+#include "runtime/runtime_state.h"
+#include "runtime/thread_resource_mgr.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+#include "runtime/types.h"
+#include "util/descriptor_helper.h"
+#include "util/logging.h"
+
+namespace doris {
+
+// Checks which conjuncts an OlapScanNode pushes down to the storage layer,
+// and the runtime filters a hash join pushes down to it.
+
+static const int VALUE_LEN = 20;
+
+TDescriptorTable create_descriptor_table() {
+    TDescriptorTableBuilder dtb;
+    TTupleDescriptorBuilder tuple_builder;
+
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().type(TYPE_INT).column_name("k1").column_pos(0).build());
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().string_type(VALUE_LEN).column_name("v").column_pos(1).build());
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().string_type(VALUE_LEN).column_name("w").column_pos(2).build());
+    tuple_builder.build(&dtb);
+
+    // the build side of a join, slot 3 in tuple 1
+    TTupleDescriptorBuilder build_tuple_builder;
+    build_tuple_builder.add_slot(
+        TSlotDescriptorBuilder().type(TYPE_INT).column_name("b1").column_pos(0).build());
+    build_tuple_builder.build(&dtb);
+    return dtb.desc_tbl();
+}
+
+TExpr int_slot_ref(int slot_id, int tuple_id) {
+    TExprNode node;
+    node.node_type = TExprNodeType::SLOT_REF;
+    node.type = TypeDescriptor(TYPE_INT).to_thrift();
+    node.num_children = 0;
+    node.__isset.slot_ref = true;
+    node.slot_ref.slot_id = slot_id;
+    node.slot_ref.tuple_id = tuple_id;
+
+    TExpr expr;
+    expr.nodes.push_back(node);
+    return expr;
+}
+
+TExprNode slot_ref_node(int slot_id) {
+    TExprNode node;
+    node.node_type = TExprNodeType::SLOT_REF;
+    node.type = TypeDescriptor::create_varchar_type(VALUE_LEN).to_thrift();
+    node.num_children = 0;
+    node.__isset.slot_ref = true;
+    node.slot_ref.slot_id = slot_id;
+    node.slot_ref.tuple_id = 0;
+    return node;
+}
+
+TExprNode string_literal_node(const std::string& value) {
+    TExprNode node;
+    node.node_type = TExprNodeType::STRING_LITERAL;
+    node.type = TypeDescriptor::create_varchar_type(VALUE_LEN).to_thrift();
+    node.num_children = 0;
+    node.__isset.string_literal = true;
+    node.string_literal.value = value;
+    return node;
+}
+
+// <lhs> LIKE <rhs>, the nodes in pre-order
+TExpr like_expr(const TExprNode& lhs, const TExprNode& rhs) {
+    TExprNode like;
+    like.node_type = TExprNodeType::FUNCTION_CALL;
+    like.type = TypeDescriptor(TYPE_BOOLEAN).to_thrift();
+    like.num_children = 2;
+    TFunction fn;
+    fn.name.function_name = "like";
+    fn.binary_type = TFunctionBinaryType::BUILTIN;
+    like.__set_fn(fn);
+
+    TExpr expr;
+    expr.nodes.push_back(like);
+    expr.nodes.push_back(lhs);
+    expr.nodes.push_back(rhs);
+    return expr;
+}
+
+class OlapScanNodePushDownTest : public testing::Test {
+public:
+    void SetUp() override {
+        DescriptorTbl::create(&_obj_pool, create_descriptor_table(), &_desc_tbl);
+
+        _tnode.node_id = 0;
+        _tnode.node_type = TPlanNodeType::OLAP_SCAN_NODE;
+        _tnode.num_children = 0;
+        _tnode.limit = -1;
+        _tnode.row_tuples.push_back(0);
+        _tnode.nullable_tuples.push_back(false);
+        _tnode.__isset.olap_scan_node = true;
+        _tnode.olap_scan_node.tuple_id = 0;
+        _tnode.olap_scan_node.key_column_name = {"k1"};
+        _tnode.olap_scan_node.key_column_type = {TPrimitiveType::INT};
+        _tnode.olap_scan_node.is_preaggregation = true;
+    }
+
+protected:
+    ObjectPool _obj_pool;
+    DescriptorTbl* _desc_tbl = nullptr;
+    TPlanNode _tnode;
+};
+
+TEST_F(OlapScanNodePushDownTest, normalize_like_predicate) {
+    _tnode.conjuncts.push_back(like_expr(slot_ref_node(1), string_literal_node("%abc%")));
+    // on another column
+    _tnode.conjuncts.push_back(like_expr(slot_ref_node(2), string_literal_node("%xyz%")));
+    // a pattern that is not a constant
+    _tnode.conjuncts.push_back(like_expr(slot_ref_node(1), slot_ref_node(2)));
+
+    ObjectPool pool;
+    OlapScanNode node(&pool, _tnode, *_desc_tbl);
+    ASSERT_TRUE(node.init(_tnode, nullptr).ok());
+    node.normalize_like_predicate(_desc_tbl->get_slot_descriptor(1));
+
+    ASSERT_EQ(1, node._like_filters.size());
+    const TCondition& like = node._like_filters[0];
+    ASSERT_EQ("v", like.column_name);
+    ASSERT_EQ("like", like.condition_op);
+    ASSERT_EQ(std::vector<std::string>({"%abc%"}), like.condition_values);
+}
+
+TEST_F(OlapScanNodePushDownTest, normalize_like_predicate_nothing_to_push) {
+    _tnode.conjuncts.push_back(like_expr(slot_ref_node(2), string_literal_node("%xyz%")));
+
+    ObjectPool pool;
+    OlapScanNode node(&pool, _tnode, *_desc_tbl);
+    ASSERT_TRUE(node.init(_tnode, nullptr).ok());
+    node.normalize_like_predicate(_desc_tbl->get_slot_descriptor(1));
+
+    ASSERT_TRUE(node._like_filters.empty());
+}
+
+// k1 = b1 of an inner join of the scan of tuple 0 with the scan of tuple 1
+TEST_F(OlapScanNodePushDownTest, push_down_runtime_filter) {
+    ExecEnv env;
+    env._thread_mgr = new ThreadResourceMgr();
+    {
+        TQueryOptions query_options;
+        query_options.batch_size = 1024;
+        RuntimeState state(TUniqueId(), query_options, "", &env);
+        state.set_desc_tbl(_desc_tbl);
+
+        ObjectPool pool;
+        OlapScanNode* probe = pool.add(new OlapScanNode(&pool, _tnode, *_desc_tbl));
+        ASSERT_TRUE(probe->init(_tnode, &state).ok());
+
+        TPlanNode build_tnode = _tnode;
+        build_tnode.node_id = 1;
+        build_tnode.row_tuples = {1};
+        build_tnode.olap_scan_node.tuple_id = 1;
+        build_tnode.olap_scan_node.key_column_name = {"b1"};
+        OlapScanNode* build = pool.add(new OlapScanNode(&pool, build_tnode, *_desc_tbl));
+        ASSERT_TRUE(build->init(build_tnode, &state).ok());
+
+        TPlanNode join_tnode;
+        join_tnode.node_id = 2;
+        join_tnode.node_type = TPlanNodeType::HASH_JOIN_NODE;
+        join_tnode.num_children = 2;
+        join_tnode.limit = -1;
+        join_tnode.row_tuples = {0, 1};
+        join_tnode.nullable_tuples = {false, false};
+        join_tnode.__isset.hash_join_node = true;
+        join_tnode.hash_join_node.join_op = TJoinOp::INNER_JOIN;
+        join_tnode.hash_join_node.is_push_down = true;
+        TEqJoinCondition eq_join_conjunct;
+        eq_join_conjunct.left = int_slot_ref(0, 0);
+        eq_join_conjunct.right = int_slot_ref(3, 1);
+        join_tnode.hash_join_node.eq_join_conjuncts.push_back(eq_join_conjunct);
+
+        HashJoinNode join(&pool, join_tnode, *_desc_tbl);
+        join._children.push_back(probe);
+        join._children.push_back(build);
+        ASSERT_TRUE(join.init(join_tnode, &state).ok());
+        ASSERT_TRUE(join.prepare(&state).ok());
+        ASSERT_TRUE(Expr::open(join._build_expr_ctxs, &state).ok());
+        ASSERT_TRUE(Expr::open(join._probe_expr_ctxs, &state).ok());
+
+        // the build rows
+        const std::vector<int32_t> keys = {7, 3, 20, 11};
+        const TupleDescriptor* build_desc = _desc_tbl->get_tuple_descriptor(1);
+        const SlotDescriptor* b1 = _desc_tbl->get_slot_descriptor(3);
+        MemTracker tracker;
+        MemPool mem_pool(&tracker);
+        for (int32_t key : keys) {
+            Tuple* tuple = Tuple::create(build_desc->byte_size(), &mem_pool);
+            *reinterpret_cast<int32_t*>(tuple->get_slot(b1->tuple_offset())) = key;
+            TupleRow* row = reinterpret_cast<TupleRow*>(mem_pool.allocate(sizeof(Tuple*)));
+            row->set_tuple(0, tuple);
+            join._hash_tbl->insert(row);
+        }
+
+        // the hashes buffered until the bloom filter is built are charged to the join
+        int64_t consumption = join.mem_tracker()->consumption();
+        join.create_runtime_filters();
+        ASSERT_EQ(1, join._runtime_filters.size());
+        ASSERT_TRUE(join._runtime_filters[0] != nullptr);
+        ASSERT_GE(join.mem_tracker()->consumption(),
+                  consumption + static_cast<int64_t>(keys.size() * sizeof(uint64_t)));
+
+        bool pushed = false;
+        ASSERT_TRUE(join.push_down_runtime_filters(&state, &pushed).ok());
+        ASSERT_TRUE(pushed);
+        ASSERT_EQ(consumption, join.mem_tracker()->consumption());
+
+        // the predicate is bound to the probe scan only
+        ASSERT_EQ(0, probe->_direct_conjunct_size);
+        ASSERT_EQ(1, probe->_conjunct_ctxs.size());
+        ASSERT_EQ(TExprNodeType::RUNTIME_FILTER_PRED, probe->_conjunct_ctxs[0]->root()->node_type());
+        ASSERT_TRUE(build->_conjunct_ctxs.empty());
+
+        ASSERT_TRUE(probe->normalize_conjuncts().ok());
+        const ColumnValueRange<int32_t>& range =
+            boost::get<ColumnValueRange<int32_t>>(probe->_column_value_ranges["k1"]);
+        ASSERT_EQ(3, range.get_range_min_value());
+        ASSERT_EQ(20, range.get_range_max_value());
+
+        ASSERT_EQ(1, probe->_bloom_filters.size());
+        ASSERT_EQ("k1", probe->_bloom_filters[0].first);
+        for (int32_t key : keys) {
+            ASSERT_TRUE(probe->_bloom_filters[0].second->test_hash(
+                    RuntimeFilter::hash(&key, TYPE_INT)));
+        }
+
+        ASSERT_TRUE(join.close(&state).ok());
+    }
+    delete env._thread_mgr;
+    env._thread_mgr = nullptr;
+}
+
+// a runtime filter of another fragment on k1, published after the wait
+TEST_F(OlapScanNodePushDownTest, wait_runtime_filters) {
+    TRuntimeFilterTarget target;
+    target.filter_id = 1;
+    target.target_expr = int_slot_ref(0, 0);
+    _tnode.olap_scan_node.__isset.runtime_filters = true;
+    _tnode.olap_scan_node.runtime_filters.push_back(target);
+    int32_t origin_wait_time_ms = config::runtime_filter_wait_time_ms;
+    config::runtime_filter_wait_time_ms = 50;
+
+    RuntimeFilterMgr mgr(nullptr);
+    ExecEnv env;
+    env._thread_mgr = new ThreadResourceMgr();
+    env._runtime_filter_mgr = &mgr;
+    {
+        TQueryOptions query_options;
+        query_options.batch_size = 1024;
+        RuntimeState state(TUniqueId(), query_options, "", &env);
+        state.set_desc_tbl(_desc_tbl);
+
+        ObjectPool pool;
+        OlapScanNode node(&pool, _tnode, *_desc_tbl);
+        ASSERT_TRUE(node.init(_tnode, &state).ok());
+        ASSERT_TRUE(node.prepare(&state).ok());
+
+        // the scan starts without the filter once the wait time passed
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        ASSERT_TRUE(node.wait_runtime_filters(&state).ok());
+        ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+        ASSERT_TRUE(node._conjunct_ctxs.empty());
+
+        RuntimeFilter filter(TypeDescriptor(TYPE_INT), 1024, 0.05);
+        int32_t key = 5;
+        filter.insert(&key);
+        filter.finish();
+        PPublishRuntimeFilterRequest request;
+        *request.mutable_query_id() = UniqueId(state.query_id()).to_proto();
+        request.set_filter_id(target.filter_id);
+        filter.to_protobuf(request.mutable_filter());
+        ASSERT_TRUE(mgr.publish(request).ok());
+
+        ASSERT_TRUE(node.wait_runtime_filters(&state).ok());
+        ASSERT_EQ(1, node._conjunct_ctxs.size());
+        ASSERT_EQ(TExprNodeType::RUNTIME_FILTER_PRED, node._conjunct_ctxs[0]->root()->node_type());
+
+        ASSERT_TRUE(node.close(&state).ok());
+    }
+    env._runtime_filter_mgr = nullptr;
+    delete env._thread_mgr;
+    env._thread_mgr = nullptr;
+    config::runtime_filter_wait_time_ms = origin_wait_time_ms;
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,431 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/partitioned_hash_join_node.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+#include <gtest/gtest.h>
+
+#include "common/object_pool.h"
+#include "gen_cpp/PlanNodes_types.h"
+#include "runtime/descriptors.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/test_env.h"
+#include "runtime/tuple_row.h"
+#include "util/cpu_info.h"
+#include "util/disk_info.h"
+#include "util/filesystem_util.h"
+#include "util/logging.h"
+#include "util/runtime_profile.h"
+#include "util/descriptor_helper.h"
+
+using std::string;
+using std::vector;
+
+using boost::scoped_ptr;
+
+namespace doris {
+
+static const string TMP_DIR = "./partitioned_hash_join_node_test_tmp";
+
+// Small blocks and few of them, so that the build side spills and its partitions
+// have to be repartitioned.
+static const int BLOCK_SIZE = 8 * 1024;
+static const int MAX_BUFFERS = 32;
+
+struct TestRow {
+    bool key_is_null;
+    int32_t key;
+    int32_t value;
+};
+
+// Returns the rows it is given, in batches.
+class TestRowsNode : public ExecNode {
+public:
+    TestRowsNode(ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs,
+                 const vector<TestRow>* rows) :
+            ExecNode(pool, tnode, descs), _rows(rows), _pos(0) {}
+    virtual ~TestRowsNode() {}
+
+    virtual Status open(RuntimeState* state) {
+        RETURN_IF_ERROR(ExecNode::open(state));
+        _pos = 0;
+        return Status::OK;
+    }
+
+    virtual Status get_next(RuntimeState* state, RowBatch* batch, bool* eos) {
+        const TupleDescriptor* tuple_desc = row_desc().tuple_descriptors()[0];
+        const SlotDescriptor* key_slot = tuple_desc->slots()[0];
+        const SlotDescriptor* value_slot = tuple_desc->slots()[1];
+        while (!batch->at_capacity() && _pos < _rows->size()) {
+            const TestRow& test_row = (*_rows)[_pos++];
+            Tuple* tuple = reinterpret_cast<Tuple*>(
+                    batch->tuple_data_pool()->allocate(tuple_desc->byte_size()));
+            memset(tuple, 0, tuple_desc->byte_size());
+            if (test_row.key_is_null) {
+                tuple->set_null(key_slot->null_indicator_offset());
+            } else {
+                *reinterpret_cast<int32_t*>(tuple->get_slot(key_slot->tuple_offset())) =
+                    test_row.key;
+            }
+            *reinterpret_cast<int32_t*>(tuple->get_slot(value_slot->tuple_offset())) =
+                test_row.value;
+            TupleRow* row = batch->get_row(batch->add_row());
+            row->set_tuple(0, tuple);
+            batch->commit_last_row();
+        }
+        *eos = _pos == _rows->size();
+        return Status::OK;
+    }
+
+private:
+    const vector<TestRow>* _rows;
+    size_t _pos;
+};
+
+class PartitionedHashJoinNodeTest : public testing::Test {
+public:
+    PartitionedHashJoinNodeTest() : _runtime_state(NULL), _desc_tbl(NULL) {}
+    virtual ~PartitionedHashJoinNodeTest() {}
+
+protected:
+    virtual void SetUp() {
+        ASSERT_TRUE(FileSystemUtil::create_directory(TMP_DIR).ok());
+        _test_env.reset(new TestEnv());
+        _test_env->init_tmp_file_mgr({TMP_DIR}, false);
+        ASSERT_TRUE(_test_env->create_query_state(
+                    0, MAX_BUFFERS, BLOCK_SIZE, &_runtime_state).ok());
+        _runtime_state->init_mem_trackers(TUniqueId());
+
+        // tuple 0 is the probe side, tuple 1 the build side: (nullable INT key, INT value)
+        TDescriptorTableBuilder table_builder;
+        for (int i = 0; i < 2; ++i) {
+            TTupleDescriptorBuilder tuple_builder;
+            tuple_builder.add_slot(
+                    TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build());
+            tuple_builder.add_slot(
+                    TSlotDescriptorBuilder().type(TYPE_INT).nullable(false).build());
+            tuple_builder.build(&table_builder);
+        }
+        ASSERT_TRUE(DescriptorTbl::create(&_pool, table_builder.desc_tbl(), &_desc_tbl).ok());
+        _runtime_state->set_desc_tbl(_desc_tbl);
+    }
+
+    virtual void TearDown() {
+        _runtime_state = NULL;
+        _pool.clear();
+        _test_env.reset();
+        FileSystemUtil::remove_paths({TMP_DIR});
+    }
+
+    static TExpr slot_ref(TSlotId slot_id, TTupleId tuple_id) {
+        TExprNode node;
+        node.node_type = TExprNodeType::SLOT_REF;
+        node.type = TSlotDescriptorBuilder().get_common_type(TPrimitiveType::INT);
+        node.num_children = 0;
+        node.__isset.slot_ref = true;
+        node.slot_ref.slot_id = slot_id;
+        node.slot_ref.tuple_id = tuple_id;
+        TExpr expr;
+        expr.nodes.push_back(node);
+        return expr;
+    }
+
+    static TPlanNode rows_plan_node(int node_id, TTupleId tuple_id) {
+        TPlanNode tnode;
+        tnode.node_id = node_id;
+        tnode.node_type = TPlanNodeType::EXCHANGE_NODE;
+        tnode.num_children = 0;
+        tnode.limit = -1;
+        tnode.row_tuples.push_back(tuple_id);
+        tnode.nullable_tuples.push_back(false);
+        return tnode;
+    }
+
+    static TPlanNode join_plan_node(TJoinOp::type join_op) {
+        TPlanNode tnode;
+        tnode.node_id = 0;
+        tnode.node_type = TPlanNodeType::HASH_JOIN_NODE;
+        tnode.num_children = 2;
+        tnode.limit = -1;
+        tnode.row_tuples.push_back(0);
+        tnode.row_tuples.push_back(1);
+        tnode.nullable_tuples.push_back(true);
+        tnode.nullable_tuples.push_back(true);
+        tnode.__isset.hash_join_node = true;
+        tnode.hash_join_node.join_op = join_op;
+        TEqJoinCondition eq_join_conjunct;
+        eq_join_conjunct.left = slot_ref(0, 0);
+        eq_join_conjunct.right = slot_ref(2, 1);
+        tnode.hash_join_node.eq_join_conjuncts.push_back(eq_join_conjunct);
+        return tnode;
+    }
+
+    // The output row of join_op that keeps the sides given, "-" for a side not returned
+    static string row_string(TJoinOp::type join_op, const TestRow* probe, const TestRow* build) {
+        if (join_op == TJoinOp::LEFT_SEMI_JOIN || join_op == TJoinOp::LEFT_ANTI_JOIN
+                || join_op == TJoinOp::NULL_AWARE_LEFT_ANTI_JOIN) {
+            // the build row of a semi join is any of the matching ones
+            build = NULL;
+        } else if (join_op == TJoinOp::RIGHT_SEMI_JOIN || join_op == TJoinOp::RIGHT_ANTI_JOIN) {
+            probe = NULL;
+        }
+        std::stringstream ss;
+        for (const TestRow* row : {probe, build}) {
+            if (row == NULL) {
+                ss << "(-)";
+            } else if (row->key_is_null) {
+                ss << "(NULL," << row->value << ")";
+            } else {
+                ss << "(" << row->key << "," << row->value << ")";
+            }
+        }
+        return ss.str();
+    }
+
+    static bool key_matches(const TestRow& probe, const TestRow& build) {
+        return !probe.key_is_null && !build.key_is_null && probe.key == build.key;
+    }
+
+    // Joins the rows the straightforward way.
+    static vector<string> expected_rows(TJoinOp::type join_op,
+            const vector<TestRow>& probe_rows, const vector<TestRow>& build_rows) {
+        std::unordered_map<int32_t, vector<const TestRow*>> build_by_key;
+        bool build_has_null_key = false;
+        for (const TestRow& build : build_rows) {
+            if (build.key_is_null) {
+                build_has_null_key = true;
+            } else {
+                build_by_key[build.key].push_back(&build);
+            }
+        }
+        std::unordered_set<int32_t> matched_keys;
+        vector<string> rows;
+        for (const TestRow& probe : probe_rows) {
+            const vector<const TestRow*>* matches = NULL;
+            if (!probe.key_is_null) {
+                auto it = build_by_key.find(probe.key);
+                if (it != build_by_key.end()) {
+                    matches = &it->second;
+                    matched_keys.insert(probe.key);
+                }
+            }
+            switch (join_op) {
+            case TJoinOp::INNER_JOIN:
+            case TJoinOp::LEFT_OUTER_JOIN:
+            case TJoinOp::RIGHT_OUTER_JOIN:
+            case TJoinOp::FULL_OUTER_JOIN:
+                if (matches != NULL) {
+                    for (const TestRow* build : *matches) {
+                        rows.push_back(row_string(join_op, &probe, build));
+                    }
+                } else if (join_op == TJoinOp::LEFT_OUTER_JOIN
+                        || join_op == TJoinOp::FULL_OUTER_JOIN) {
+                    rows.push_back(row_string(join_op, &probe, NULL));
+                }
+                break;
+            case TJoinOp::LEFT_SEMI_JOIN:
+                if (matches != NULL) {
+                    rows.push_back(row_string(join_op, &probe, NULL));
+                }
+                break;
+            case TJoinOp::LEFT_ANTI_JOIN:
+                if (matches == NULL) {
+                    rows.push_back(row_string(join_op, &probe, NULL));
+                }
+                break;
+            case TJoinOp::NULL_AWARE_LEFT_ANTI_JOIN:
+                // probe.key NOT IN (build keys)
+                if (build_rows.empty()
+                        || (!build_has_null_key && !probe.key_is_null && matches == NULL)) {
+                    rows.push_back(row_string(join_op, &probe, NULL));
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        for (const TestRow& build : build_rows) {
+            bool matched = !build.key_is_null && matched_keys.count(build.key) > 0;
+            if ((matched && join_op == TJoinOp::RIGHT_SEMI_JOIN)
+                    || (!matched && (join_op == TJoinOp::RIGHT_OUTER_JOIN
+                            || join_op == TJoinOp::FULL_OUTER_JOIN
+                            || join_op == TJoinOp::RIGHT_ANTI_JOIN))) {
+                rows.push_back(row_string(join_op, NULL, &build));
+            }
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    static TestRow read_row(TupleRow* row, int tuple_idx, const TupleDescriptor* tuple_desc) {
+        TestRow test_row;
+        Tuple* tuple = row->get_tuple(tuple_idx);
+        const SlotDescriptor* key_slot = tuple_desc->slots()[0];
+        const SlotDescriptor* value_slot = tuple_desc->slots()[1];
+        test_row.key_is_null = tuple->is_null(key_slot->null_indicator_offset());
+        test_row.key = test_row.key_is_null ?
+            0 : *reinterpret_cast<int32_t*>(tuple->get_slot(key_slot->tuple_offset()));
+        test_row.value = *reinterpret_cast<int32_t*>(tuple->get_slot(value_slot->tuple_offset()));
+        return test_row;
+    }
+
+    // Runs a PartitionedHashJoinNode over the rows and checks that it returns the
+    // expected rows. Returns the node, closed, to check its counters.
+    PartitionedHashJoinNode* join(TJoinOp::type join_op,
+            const vector<TestRow>& probe_rows, const vector<TestRow>& build_rows) {
+        TPlanNode tnode = join_plan_node(join_op);
+        PartitionedHashJoinNode* node =
+            _pool.add(new PartitionedHashJoinNode(&_pool, tnode, *_desc_tbl));
+        EXPECT_TRUE(node->init(tnode, _runtime_state).ok());
+        node->_children.push_back(_pool.add(
+                    new TestRowsNode(&_pool, rows_plan_node(1, 0), *_desc_tbl, &probe_rows)));
+        node->_children.push_back(_pool.add(
+                    new TestRowsNode(&_pool, rows_plan_node(2, 1), *_desc_tbl, &build_rows)));
+
+        Status status = node->prepare(_runtime_state);
+        EXPECT_TRUE(status.ok()) << status.get_error_msg();
+        status = node->open(_runtime_state);
+        EXPECT_TRUE(status.ok()) << status.get_error_msg();
+
+        const vector<TupleDescriptor*>& tuple_descs = node->row_desc().tuple_descriptors();
+        vector<string> rows;
+        bool eos = !status.ok();
+        while (!eos) {
+            RowBatch batch(node->row_desc(), _runtime_state->batch_size(),
+                           _runtime_state->instance_mem_tracker());
+            status = node->get_next(_runtime_state, &batch, &eos);
+            EXPECT_TRUE(status.ok()) << status.get_error_msg();
+            if (!status.ok()) {
+                break;
+            }
+            for (int i = 0; i < batch.num_rows(); ++i) {
+                TupleRow* row = batch.get_row(i);
+                TestRow probe;
+                TestRow build;
+                bool has_probe = row->get_tuple(0) != NULL;
+                bool has_build = row->get_tuple(1) != NULL;
+                if (has_probe) {
+                    probe = read_row(row, 0, tuple_descs[0]);
+                }
+                if (has_build) {
+                    build = read_row(row, 1, tuple_descs[1]);
+                }
+                rows.push_back(row_string(join_op,
+                            has_probe ? &probe : NULL, has_build ? &build : NULL));
+            }
+        }
+        node->close(_runtime_state);
+
+        std::sort(rows.begin(), rows.end());
+        vector<string> expected = expected_rows(join_op, probe_rows, build_rows);
+        EXPECT_EQ(expected.size(), rows.size()) << "join_op=" << join_op;
+        EXPECT_TRUE(expected == rows) << "join_op=" << join_op;
+        return node;
+    }
+
+    // 'num_rows' rows cycling over 'num_keys' keys, the multiples of 'key_step'. The key of
+    // every 'null_every'th row is NULL.
+    static vector<TestRow> gen_rows(int num_rows, int num_keys, int null_every, int key_step) {
+        vector<TestRow> rows;
+        for (int i = 0; i < num_rows; ++i) {
+            TestRow row;
+            row.key_is_null = null_every > 0 && i % null_every == 0;
+            row.key = (i % num_keys) * key_step;
+            row.value = i;
+            rows.push_back(row);
+        }
+        return rows;
+    }
+
+    scoped_ptr<TestEnv> _test_env;
+    RuntimeState* _runtime_state;
+    ObjectPool _pool;
+    DescriptorTbl* _desc_tbl;
+};
+
+// The build side is ~20 times the memory of the node, its partitions are spilled and
+// still too large to be joined, so they are repartitioned.
+TEST_F(PartitionedHashJoinNodeTest, spill_and_repartition) {
+    // 2 build rows per key, a third of the probe keys match
+    vector<TestRow> build_rows = gen_rows(400000, 200000, 101, 3);
+    vector<TestRow> probe_rows = gen_rows(100000, 100000, 97, 7);
+
+    for (TJoinOp::type join_op : {TJoinOp::INNER_JOIN, TJoinOp::LEFT_OUTER_JOIN,
+            TJoinOp::RIGHT_OUTER_JOIN, TJoinOp::FULL_OUTER_JOIN, TJoinOp::LEFT_SEMI_JOIN,
+            TJoinOp::RIGHT_SEMI_JOIN, TJoinOp::LEFT_ANTI_JOIN, TJoinOp::RIGHT_ANTI_JOIN}) {
+        PartitionedHashJoinNode* node = join(join_op, probe_rows, build_rows);
+        EXPECT_GT(node->_num_spilled_partitions->value(), 0) << "join_op=" << join_op;
+        EXPECT_GT(node->_num_repartitions->value(), 0) << "join_op=" << join_op;
+    }
+}
+
+TEST_F(PartitionedHashJoinNodeTest, null_aware_left_anti_join) {
+    vector<TestRow> probe_rows = gen_rows(100000, 100000, 97, 7);
+    vector<TestRow> no_build_rows;
+
+    // A NULL build key: no row
+    vector<TestRow> build_rows = gen_rows(400000, 200000, 101, 3);
+    PartitionedHashJoinNode* node =
+        join(TJoinOp::NULL_AWARE_LEFT_ANTI_JOIN, probe_rows, build_rows);
+    EXPECT_EQ(0, node->rows_returned());
+
+    // No NULL build key: the rows with a NULL key are not returned, the spilled
+    // partitions are joined as in a left anti join
+    build_rows = gen_rows(400000, 200000, 0, 3);
+    node = join(TJoinOp::NULL_AWARE_LEFT_ANTI_JOIN, probe_rows, build_rows);
+    EXPECT_GT(node->_num_repartitions->value(), 0);
+
+    // No build row: all the rows
+    node = join(TJoinOp::NULL_AWARE_LEFT_ANTI_JOIN, probe_rows, no_build_rows);
+    EXPECT_EQ(static_cast<int64_t>(probe_rows.size()), node->rows_returned());
+}
+
+// The build side fits, the probe rows are joined without spilling.
+TEST_F(PartitionedHashJoinNodeTest, in_memory) {
+    vector<TestRow> build_rows = gen_rows(1000, 500, 101, 3);
+    vector<TestRow> probe_rows = gen_rows(2000, 1000, 97, 7);
+
+    for (TJoinOp::type join_op : {TJoinOp::INNER_JOIN, TJoinOp::LEFT_OUTER_JOIN,
+            TJoinOp::RIGHT_OUTER_JOIN, TJoinOp::FULL_OUTER_JOIN, TJoinOp::LEFT_SEMI_JOIN,
+            TJoinOp::RIGHT_SEMI_JOIN, TJoinOp::LEFT_ANTI_JOIN, TJoinOp::RIGHT_ANTI_JOIN,
+            TJoinOp::NULL_AWARE_LEFT_ANTI_JOIN}) {
+        PartitionedHashJoinNode* node = join(join_op, probe_rows, build_rows);
+        EXPECT_EQ(0, node->_num_spilled_partitions->value()) << "join_op=" << join_op;
+    }
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    doris::config::read_size = 8388608;
+    doris::config::min_buffer_size = 1024;
+    doris::config::disable_mem_pools = false;
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+    doris::DiskInfo::init();
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,449 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "common/object_pool.h"
+#include "exec/olap_scan_node.h"
+#include "exec/olap_scanner.h"
+#include "gen_cpp/Descriptors_types.h"
+#include "gen_cpp/PaloInternalService_types.h"
+#include "gen_cpp/PlanNodes_types.h"
+#include "olap/delta_writer.h"
+#include "olap/olap_engine.h"
+#include "olap/olap_table.h"
+#include "olap/reader.h"
+#include "olap/row_cursor.h"
+#include "olap/utils.h"
+#include "runtime/descriptors.h"
+#include "runtime/exec_env.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/thread_resource_mgr.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+#include "runtime/vectorized_row_batch.h"
+#include "util/arena.h"
+#include "util/cpu_info.h"
+#include "util/descriptor_helper.h"
+#include "util/logging.h"
+
+namespace doris {
+
+// Scans a DUP_KEYS tablet once through the row path and once a batch at a
+// time, and checks that both return the same rows.
+
+static const uint32_t MAX_PATH_LEN = 1024;
+static const int64_t TABLET_ID = 10005;
+static const int32_t SCHEMA_HASH = 270068377;
+static const int64_t PARTITION_ID = 30005;
+
+OLAPEngine* k_engine = nullptr;
+
+void set_up() {
+    char buffer[MAX_PATH_LEN];
+    getcwd(buffer, MAX_PATH_LEN);
+    config::storage_root_path = std::string(buffer) + "/data_vectorized_scan";
+    remove_all_dir(config::storage_root_path);
+    create_dir(config::storage_root_path);
+    std::vector<StorePath> paths;
+    paths.emplace_back(config::storage_root_path, -1);
+
+    doris::EngineOptions options;
+    options.store_paths = paths;
+    doris::OLAPEngine::open(options, &k_engine);
+}
+
+void tear_down() {
+    remove_all_dir(config::storage_root_path);
+    remove_all_dir(std::string(getenv("DORIS_HOME")) + UNUSED_PREFIX);
+}
+
+// k1 INT, k2 VARCHAR keys and v1 BIGINT, k2 and v1 nullable
+void create_table_request(TCreateTabletReq* request) {
+    request->tablet_id = TABLET_ID;
+    request->__set_version(1);
+    request->__set_version_hash(0);
+    request->tablet_schema.schema_hash = SCHEMA_HASH;
+    request->tablet_schema.short_key_column_count = 2;
+    request->tablet_schema.keys_type = TKeysType::DUP_KEYS;
+    request->tablet_schema.storage_type = TStorageType::COLUMN;
+
+    TColumn k1;
+    k1.column_name = "k1";
+    k1.__set_is_key(true);
+    k1.column_type.type = TPrimitiveType::INT;
+    request->tablet_schema.columns.push_back(k1);
+
+    TColumn k2;
+    k2.column_name = "k2";
+    k2.__set_is_key(true);
+    k2.__set_is_allow_null(true);
+    k2.column_type.type = TPrimitiveType::VARCHAR;
+    k2.column_type.__set_len(20);
+    request->tablet_schema.columns.push_back(k2);
+
+    TColumn v1;
+    v1.column_name = "v1";
+    v1.__set_is_key(false);
+    v1.__set_is_allow_null(true);
+    v1.column_type.type = TPrimitiveType::BIGINT;
+    request->tablet_schema.columns.push_back(v1);
+}
+
+TDescriptorTable create_descriptor_table() {
+    TDescriptorTableBuilder dtb;
+    TTupleDescriptorBuilder tuple_builder;
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().type(TYPE_INT).column_name("k1").column_pos(0).build());
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().string_type(20).column_name("k2").column_pos(1).build());
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().type(TYPE_BIGINT).column_name("v1").column_pos(2).build());
+    tuple_builder.build(&dtb);
+    return dtb.desc_tbl();
+}
+
+TCondition condition(const std::string& column, const std::string& op,
+                     const std::vector<std::string>& values) {
+    TCondition cond;
+    cond.column_name = column;
+    cond.condition_op = op;
+    cond.condition_values = values;
+    return cond;
+}
+
+// A row as text, "NULL" for a null value
+std::string row_string(int32_t k1, const Slice* k2, const int64_t* v1) {
+    std::string row = std::to_string(k1);
+    row += "|" + (k2 == nullptr ? std::string("NULL") : k2->to_string());
+    row += "|" + (v1 == nullptr ? std::string("NULL") : std::to_string(*v1));
+    return row;
+}
+
+class VectorizedOlapScanTest : public testing::Test {
+public:
+    void SetUp() override {
+        TCreateTabletReq request;
+        create_table_request(&request);
+        ASSERT_EQ(OLAP_SUCCESS, k_engine->create_table(request));
+        DescriptorTbl::create(&_obj_pool, create_descriptor_table(), &_desc_tbl);
+        _tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+
+        // two versions whose keys overlap, of several blocks each
+        load(20005, 0, 6000);
+        load(20006, 3000, 9000);
+        _table = OLAPEngine::get_instance()->get_table(TABLET_ID, SCHEMA_HASH);
+        ASSERT_TRUE(_table != nullptr);
+        _version = _table->lastest_version()->end_version();
+        _version_hash = _table->lastest_version()->version_hash();
+
+        _origin_vectorized = config::enable_vectorized_olap_scan;
+    }
+
+    void TearDown() override {
+        config::enable_vectorized_olap_scan = _origin_vectorized;
+        _table.reset();
+        ASSERT_EQ(OLAP_SUCCESS, k_engine->drop_table(TABLET_ID, SCHEMA_HASH));
+    }
+
+    // Load rows [begin, end) as one version. Duplicate k1 values, and nulls in
+    // k2 and v1, are spread over the rows.
+    void load(int64_t transaction_id, int begin, int end) {
+        PUniqueId load_id;
+        load_id.set_hi(0);
+        load_id.set_lo(transaction_id);
+        WriteRequest write_req = {TABLET_ID, SCHEMA_HASH, WriteType::LOAD,
+                                  transaction_id, PARTITION_ID, load_id, false, _tuple_desc};
+        DeltaWriter* delta_writer = nullptr;
+        DeltaWriter::open(&write_req, &delta_writer);
+        ASSERT_NE(delta_writer, nullptr);
+
+        const std::vector<SlotDescriptor*>& slots = _tuple_desc->slots();
+        for (int i = begin; i < end; ++i) {
+            Tuple* tuple = reinterpret_cast<Tuple*>(_arena.Allocate(_tuple_desc->byte_size()));
+            memset(tuple, 0, _tuple_desc->byte_size());
+            *(int32_t*)(tuple->get_slot(slots[0]->tuple_offset())) = i / 2;
+            if (i % 5 == 0) {
+                tuple->set_null(slots[1]->null_indicator_offset());
+            } else {
+                std::string k2 = "s" + std::to_string(i % 7);
+                StringValue* k2_ptr = (StringValue*)(tuple->get_slot(slots[1]->tuple_offset()));
+                k2_ptr->ptr = _arena.Allocate(k2.size());
+                memcpy(k2_ptr->ptr, k2.data(), k2.size());
+                k2_ptr->len = k2.size();
+            }
+            if (i % 3 == 0) {
+                tuple->set_null(slots[2]->null_indicator_offset());
+            } else {
+                *(int64_t*)(tuple->get_slot(slots[2]->tuple_offset())) = i;
+            }
+            ASSERT_EQ(OLAP_SUCCESS, delta_writer->write(tuple));
+        }
+        ASSERT_EQ(OLAP_SUCCESS, delta_writer->close(nullptr));
+        SAFE_DELETE(delta_writer);
+
+        OLAPTablePtr table = OLAPEngine::get_instance()->get_table(TABLET_ID, SCHEMA_HASH);
+        TPublishVersionRequest publish_req;
+        publish_req.transaction_id = transaction_id;
+        TPartitionVersionInfo info;
+        info.partition_id = PARTITION_ID;
+        info.version = table->lastest_version()->end_version() + 1;
+        info.version_hash = table->lastest_version()->version_hash() + 1;
+        publish_req.partition_version_infos.push_back(info);
+        std::vector<TTabletId> error_tablet_ids;
+        ASSERT_EQ(OLAP_SUCCESS, k_engine->publish_version(publish_req, &error_tablet_ids));
+    }
+
+    void init_reader_params(ReaderParams* params) {
+        params->olap_table = _table;
+        params->reader_type = READER_QUERY;
+        params->aggregation = false;
+        params->version = Version(0, _version);
+        params->return_columns = {0, 1, 2};
+    }
+
+    // Read all rows with next_row_with_aggregation
+    void read_rows(const ReaderParams& params, std::vector<std::string>* rows) {
+        config::enable_vectorized_olap_scan = false;
+        Reader reader;
+        ASSERT_EQ(OLAP_SUCCESS, reader.init(params));
+        ASSERT_FALSE(reader.vectorized_read());
+
+        RowCursor cursor;
+        ASSERT_EQ(OLAP_SUCCESS, cursor.init(_table->tablet_schema(), params.return_columns));
+        cursor.allocate_memory_for_string_type(_table->tablet_schema());
+        bool eof = false;
+        while (true) {
+            ASSERT_EQ(OLAP_SUCCESS, reader.next_row_with_aggregation(&cursor, &eof));
+            if (eof) {
+                break;
+            }
+            int32_t k1 = *(int32_t*)cursor.get_field_content_ptr(0);
+            const Slice* k2 = cursor.is_null(1)
+                ? nullptr : (const Slice*)cursor.get_field_content_ptr(1);
+            const int64_t* v1 = cursor.is_null(2)
+                ? nullptr : (const int64_t*)cursor.get_field_content_ptr(2);
+            rows->push_back(row_string(k1, k2, v1));
+        }
+    }
+
+    // Read all rows with next_vector_batch
+    void read_vector_batches(const ReaderParams& params, std::vector<std::string>* rows) {
+        config::enable_vectorized_olap_scan = true;
+        Reader reader;
+        ASSERT_EQ(OLAP_SUCCESS, reader.init(params));
+        ASSERT_TRUE(reader.vectorized_read());
+
+        bool eof = false;
+        while (true) {
+            VectorizedRowBatch* batch = nullptr;
+            ASSERT_EQ(OLAP_SUCCESS, reader.next_vector_batch(&batch, &eof));
+            if (eof) {
+                break;
+            }
+            ASSERT_GT(batch->size(), 0);
+            ColumnVector* k1_col = batch->column(0);
+            ColumnVector* k2_col = batch->column(1);
+            ColumnVector* v1_col = batch->column(2);
+            const int32_t* k1 = (const int32_t*)k1_col->col_data();
+            const Slice* k2 = (const Slice*)k2_col->col_data();
+            const int64_t* v1 = (const int64_t*)v1_col->col_data();
+            for (uint16_t i = 0; i < batch->size(); ++i) {
+                uint16_t row = batch->selected_in_use() ? batch->selected()[i] : i;
+                bool k2_null = !k2_col->no_nulls() && k2_col->is_null()[row];
+                bool v1_null = !v1_col->no_nulls() && v1_col->is_null()[row];
+                rows->push_back(row_string(k1[row], k2_null ? nullptr : &k2[row],
+                                           v1_null ? nullptr : &v1[row]));
+            }
+        }
+    }
+
+    void check_reader(const ReaderParams& params) {
+        std::vector<std::string> expected;
+        read_rows(params, &expected);
+        std::vector<std::string> actual;
+        read_vector_batches(params, &actual);
+        ASSERT_FALSE(expected.empty());
+        // the row path merges the versions in key order, the vectorized path
+        // reads them one after another
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        ASSERT_EQ(expected, actual);
+    }
+
+    // Scan the tablet with an OlapScanner of a prepared OlapScanNode, and
+    // return the output tuples as text
+    void scan(bool vectorized, const std::vector<TCondition>& filters,
+              const std::vector<OlapScanRange>& key_ranges, std::vector<std::string>* rows) {
+        config::enable_vectorized_olap_scan = vectorized;
+        ExecEnv env;
+        env._thread_mgr = new ThreadResourceMgr();
+        {
+            TQueryOptions query_options;
+            query_options.batch_size = 1024;
+            RuntimeState state(TUniqueId(), query_options, "", &env);
+            state.set_desc_tbl(_desc_tbl);
+
+            TPlanNode tnode;
+            tnode.node_id = 0;
+            tnode.node_type = TPlanNodeType::OLAP_SCAN_NODE;
+            tnode.num_children = 0;
+            tnode.limit = -1;
+            tnode.row_tuples.push_back(0);
+            tnode.nullable_tuples.push_back(false);
+            tnode.__isset.olap_scan_node = true;
+            tnode.olap_scan_node.tuple_id = 0;
+            tnode.olap_scan_node.key_column_name = {"k1", "k2"};
+            tnode.olap_scan_node.key_column_type = {TPrimitiveType::INT, TPrimitiveType::VARCHAR};
+            tnode.olap_scan_node.is_preaggregation = true;
+
+            ObjectPool pool;
+            OlapScanNode node(&pool, tnode, *_desc_tbl);
+            ASSERT_TRUE(node.init(tnode, &state).ok());
+            ASSERT_TRUE(node.prepare(&state).ok());
+            node._olap_filter = filters;
+
+            TPaloScanRange palo_scan_range;
+            palo_scan_range.tablet_id = TABLET_ID;
+            palo_scan_range.schema_hash = std::to_string(SCHEMA_HASH);
+            palo_scan_range.version = std::to_string(_version);
+            palo_scan_range.version_hash = std::to_string(_version_hash);
+            palo_scan_range.db_name = "test";
+            DorisScanRange scan_range(palo_scan_range);
+
+            OlapScanner scanner(&state, &node, false, &scan_range, key_ranges);
+            ASSERT_TRUE(scanner.open().ok());
+
+            MemTracker tracker;
+            bool eof = false;
+            while (!eof) {
+                RowBatch batch(node.row_desc(), state.batch_size(), &tracker);
+                ASSERT_TRUE(scanner.get_batch(&state, &batch, &eof).ok());
+                for (int i = 0; i < batch.num_rows(); ++i) {
+                    Tuple* tuple = batch.get_row(i)->get_tuple(0);
+                    rows->push_back(Tuple::to_string(tuple, *_tuple_desc));
+                }
+            }
+            ASSERT_TRUE(scanner.close(&state).ok());
+            ASSERT_TRUE(node.close(&state).ok());
+        }
+        delete env._thread_mgr;
+        env._thread_mgr = nullptr;
+    }
+
+    void check_scanner(const std::vector<TCondition>& filters,
+                       const std::vector<OlapScanRange>& key_ranges) {
+        std::vector<std::string> expected;
+        scan(false, filters, key_ranges, &expected);
+        std::vector<std::string> actual;
+        scan(true, filters, key_ranges, &actual);
+        ASSERT_FALSE(expected.empty());
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        ASSERT_EQ(expected, actual);
+    }
+
+    ObjectPool _obj_pool;
+    DescriptorTbl* _desc_tbl = nullptr;
+    TupleDescriptor* _tuple_desc = nullptr;
+    Arena _arena;
+    OLAPTablePtr _table;
+    int64_t _version = 0;
+    int64_t _version_hash = 0;
+    bool _origin_vectorized = true;
+};
+
+TEST_F(VectorizedOlapScanTest, reader_without_keys) {
+    ReaderParams params;
+    init_reader_params(&params);
+    check_reader(params);
+}
+
+TEST_F(VectorizedOlapScanTest, reader_with_predicates) {
+    ReaderParams params;
+    init_reader_params(&params);
+    params.conditions.push_back(condition("k1", ">=", {"1000"}));
+    params.conditions.push_back(condition("k2", "*=", {"s1", "s3", "s6"}));
+    params.conditions.push_back(condition("v1", "is", {"not null"}));
+    check_reader(params);
+
+    ReaderParams null_params;
+    init_reader_params(&null_params);
+    null_params.conditions.push_back(condition("k2", "is", {"null"}));
+    null_params.conditions.push_back(condition("k1", "<<", {"4000"}));
+    check_reader(null_params);
+}
+
+// Start keys in the middle of a block make ColumnData return the rest of the
+// block it seeked to first, see _vector_batch_pending.
+TEST_F(VectorizedOlapScanTest, reader_with_key_ranges) {
+    ReaderParams params;
+    init_reader_params(&params);
+    params.range = "ge";
+    params.end_range = "lt";
+    params.start_key.push_back(OlapTuple({"1234"}));
+    params.end_key.push_back(OlapTuple({"1500"}));
+    params.start_key.push_back(OlapTuple({"2100"}));
+    params.end_key.push_back(OlapTuple({"3777"}));
+    check_reader(params);
+
+    params.range = "gt";
+    params.end_range = "le";
+    params.conditions.push_back(condition("k2", "*=", {"s2"}));
+    params.conditions.push_back(condition("v1", "is", {"null"}));
+    check_reader(params);
+}
+
+TEST_F(VectorizedOlapScanTest, scanner) {
+    check_scanner({}, {});
+
+    std::vector<TCondition> filters;
+    filters.push_back(condition("k1", ">=", {"500"}));
+    filters.push_back(condition("v1", "is", {"not null"}));
+    std::vector<std::string> begin_key = {"777"};
+    std::vector<std::string> end_key = {"3210"};
+    std::vector<OlapScanRange> key_ranges;
+    key_ranges.emplace_back(true, false, begin_key, end_key);
+    check_scanner(filters, key_ranges);
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    int ret = doris::OLAP_SUCCESS;
+    testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+
+    doris::set_up();
+    ret = RUN_ALL_TESTS();
+    doris::tear_down();
+
+    google::protobuf::ShutdownProtobufLibrary();
+    return ret;
+}
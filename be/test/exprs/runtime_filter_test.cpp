@@ -0,0 +1,170 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exprs/runtime_filter.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "gen_cpp/internal_service.pb.h"
+#include "runtime/string_value.hpp"
+#include "util/cpu_info.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class RuntimeFilterTest : public testing::Test {
+public:
+    RuntimeFilterTest() { }
+};
+
+static std::shared_ptr<RuntimeFilter> round_trip(const RuntimeFilter& filter) {
+    PRuntimeFilter pfilter;
+    filter.to_protobuf(&pfilter);
+    std::string bytes;
+    pfilter.SerializeToString(&bytes);
+    PRuntimeFilter received;
+    received.ParseFromString(bytes);
+    std::shared_ptr<RuntimeFilter> result;
+    Status st = RuntimeFilter::create_from_protobuf(received, &result);
+    EXPECT_TRUE(st.ok()) << st.get_error_msg();
+    return result;
+}
+
+TEST_F(RuntimeFilterTest, merge_int) {
+    // two instances of a join, each with half of the keys
+    RuntimeFilter left(TypeDescriptor(TYPE_INT), 1000, 0.05);
+    RuntimeFilter right(TypeDescriptor(TYPE_INT), 1000, 0.05);
+    ASSERT_TRUE(left.init_bloom_filter(100));
+    ASSERT_TRUE(right.init_bloom_filter(100));
+    for (int32_t value = 100; value < 200; value += 2) {
+        left.insert(&value);
+        int32_t other = value + 100;
+        right.insert(&other);
+    }
+    left.finish();
+    right.finish();
+
+    std::shared_ptr<RuntimeFilter> merged = round_trip(left);
+    merged->merge(*round_trip(right));
+    ASSERT_EQ(100, *reinterpret_cast<const int32_t*>(merged->min_value()));
+    ASSERT_EQ(298, *reinterpret_cast<const int32_t*>(merged->max_value()));
+    ASSERT_TRUE(merged->bloom_filter() != nullptr);
+    int num_found = 0;
+    for (int32_t value = 0; value < 400; ++value) {
+        bool found = merged->find(&value);
+        if (value >= 100 && value < 300 && value % 2 == 0) {
+            ASSERT_TRUE(found) << value;
+        } else if (value < 100 || value > 298) {
+            ASSERT_FALSE(found) << value;
+        }
+        num_found += found;
+    }
+    ASSERT_LT(num_found, 100 + 20);
+}
+
+TEST_F(RuntimeFilterTest, merge_different_bloom_filters) {
+    RuntimeFilter left(TypeDescriptor(TYPE_BIGINT), 1000, 0.05);
+    RuntimeFilter right(TypeDescriptor(TYPE_BIGINT), 1000, 0.05);
+    ASSERT_TRUE(left.init_bloom_filter(100));
+    ASSERT_TRUE(right.init_bloom_filter(100000));
+    int64_t value = 10;
+    left.insert(&value);
+    value = 20;
+    right.insert(&value);
+    left.finish();
+    right.finish();
+
+    // only the range remains
+    left.merge(right);
+    ASSERT_TRUE(left.bloom_filter() == nullptr);
+    value = 15;
+    ASSERT_TRUE(left.find(&value));
+    value = 21;
+    ASSERT_FALSE(left.find(&value));
+}
+
+TEST_F(RuntimeFilterTest, merge_empty_varchar) {
+    TypeDescriptor type = TypeDescriptor::create_varchar_type(10);
+    RuntimeFilter left(type, 1000, 0.05);
+    RuntimeFilter right(type, 1000, 0.05);
+    ASSERT_TRUE(left.init_bloom_filter(10));
+    ASSERT_TRUE(right.init_bloom_filter(10));
+    {
+        // the filter keeps its own copy of the strings
+        std::string key = "beta";
+        StringValue value(key);
+        right.insert(&value);
+        key = "alpha";
+        value = StringValue(key);
+        right.insert(&value);
+        key = "xxxxx";
+    }
+    left.finish();
+    right.finish();
+
+    std::string alpha = "alpha";
+    std::string beta = "beta";
+    std::string gamma = "gamma";
+    std::shared_ptr<RuntimeFilter> merged = round_trip(left);
+    ASSERT_TRUE(merged->empty());
+    StringValue value(alpha);
+    ASSERT_FALSE(merged->find(&value));
+
+    merged->merge(*round_trip(right));
+    ASSERT_FALSE(merged->empty());
+    ASSERT_TRUE(merged->find(&value));
+    value = StringValue(beta);
+    ASSERT_TRUE(merged->find(&value));
+    value = StringValue(gamma);
+    ASSERT_FALSE(merged->find(&value));
+}
+
+TEST_F(RuntimeFilterTest, invalid_protobuf) {
+    RuntimeFilter filter(TypeDescriptor(TYPE_INT), 1000, 0.05);
+    int32_t value = 1;
+    filter.insert(&value);
+    filter.finish();
+    PRuntimeFilter pfilter;
+    filter.to_protobuf(&pfilter);
+
+    std::shared_ptr<RuntimeFilter> result;
+    PRuntimeFilter bad_value = pfilter;
+    bad_value.set_min_value("12345");
+    ASSERT_FALSE(RuntimeFilter::create_from_protobuf(bad_value, &result).ok());
+    PRuntimeFilter bad_bloom_filter = pfilter;
+    bad_bloom_filter.set_bloom_filter("12345678");
+    ASSERT_FALSE(RuntimeFilter::create_from_protobuf(bad_bloom_filter, &result).ok());
+    ASSERT_TRUE(RuntimeFilter::create_from_protobuf(pfilter, &result).ok());
+    ASSERT_TRUE(result->find(&value));
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+    return RUN_ALL_TESTS();
+}
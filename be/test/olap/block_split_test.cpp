@@ -0,0 +1,344 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "common/object_pool.h"
+#include "exec/olap_common.h"
+#include "exec/olap_meta_reader.h"
+#include "exec/olap_utils.h"
+#include "gen_cpp/Descriptors_types.h"
+#include "gen_cpp/PaloInternalService_types.h"
+#include "olap/column_data.h"
+#include "olap/delta_writer.h"
+#include "olap/olap_engine.h"
+#include "olap/olap_table.h"
+#include "olap/reader.h"
+#include "olap/row_cursor.h"
+#include "olap/utils.h"
+#include "runtime/descriptors.h"
+#include "runtime/tuple.h"
+#include "runtime/vectorized_row_batch.h"
+#include "util/arena.h"
+#include "util/cpu_info.h"
+#include "util/descriptor_helper.h"
+#include "util/logging.h"
+
+namespace doris {
+
+// Reads a DUP_KEYS tablet whose versions have several segments in block
+// splits, and checks that the splits together return every row once.
+
+static const uint32_t MAX_PATH_LEN = 1024;
+static const int64_t TABLET_ID = 10006;
+static const int32_t SCHEMA_HASH = 270068378;
+static const int64_t PARTITION_ID = 30006;
+// small enough for a segment to hold only a few row blocks
+static const uint32_t SEGMENT_SIZE = 16 * 1024;
+
+OLAPEngine* k_engine = nullptr;
+
+void set_up() {
+    char buffer[MAX_PATH_LEN];
+    getcwd(buffer, MAX_PATH_LEN);
+    config::storage_root_path = std::string(buffer) + "/data_block_split";
+    remove_all_dir(config::storage_root_path);
+    create_dir(config::storage_root_path);
+    std::vector<StorePath> paths;
+    paths.emplace_back(config::storage_root_path, -1);
+
+    doris::EngineOptions options;
+    options.store_paths = paths;
+    doris::OLAPEngine::open(options, &k_engine);
+}
+
+void tear_down() {
+    remove_all_dir(config::storage_root_path);
+    remove_all_dir(std::string(getenv("DORIS_HOME")) + UNUSED_PREFIX);
+}
+
+// k1 INT, k2 VARCHAR keys and v1 BIGINT, k2 nullable
+void create_table_request(TCreateTabletReq* request) {
+    request->tablet_id = TABLET_ID;
+    request->__set_version(1);
+    request->__set_version_hash(0);
+    request->tablet_schema.schema_hash = SCHEMA_HASH;
+    request->tablet_schema.short_key_column_count = 2;
+    request->tablet_schema.keys_type = TKeysType::DUP_KEYS;
+    request->tablet_schema.storage_type = TStorageType::COLUMN;
+
+    TColumn k1;
+    k1.column_name = "k1";
+    k1.__set_is_key(true);
+    k1.column_type.type = TPrimitiveType::INT;
+    request->tablet_schema.columns.push_back(k1);
+
+    TColumn k2;
+    k2.column_name = "k2";
+    k2.__set_is_key(true);
+    k2.__set_is_allow_null(true);
+    k2.column_type.type = TPrimitiveType::VARCHAR;
+    k2.column_type.__set_len(20);
+    request->tablet_schema.columns.push_back(k2);
+
+    TColumn v1;
+    v1.column_name = "v1";
+    v1.__set_is_key(false);
+    v1.column_type.type = TPrimitiveType::BIGINT;
+    request->tablet_schema.columns.push_back(v1);
+}
+
+TDescriptorTable create_descriptor_table() {
+    TDescriptorTableBuilder dtb;
+    TTupleDescriptorBuilder tuple_builder;
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().type(TYPE_INT).column_name("k1").column_pos(0).build());
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().string_type(20).column_name("k2").column_pos(1).build());
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().type(TYPE_BIGINT).column_name("v1").column_pos(2).build());
+    tuple_builder.build(&dtb);
+    return dtb.desc_tbl();
+}
+
+class BlockSplitTest : public testing::Test {
+public:
+    void SetUp() override {
+        TCreateTabletReq request;
+        create_table_request(&request);
+        ASSERT_EQ(OLAP_SUCCESS, k_engine->create_table(request));
+        _table = OLAPEngine::get_instance()->get_table(TABLET_ID, SCHEMA_HASH);
+        ASSERT_TRUE(_table != nullptr);
+        _table->get_header()->set_segment_size(SEGMENT_SIZE);
+        DescriptorTbl::create(&_obj_pool, create_descriptor_table(), &_desc_tbl);
+        _tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+
+        // v1 tells the rows apart, k1 repeats within and across versions
+        load(20007, 0, 30000);
+        load(20008, 30000, 40000);
+        _version = _table->lastest_version()->end_version();
+        _version_hash = _table->lastest_version()->version_hash();
+
+        _origin_vectorized = config::enable_vectorized_olap_scan;
+    }
+
+    void TearDown() override {
+        config::enable_vectorized_olap_scan = _origin_vectorized;
+        _table.reset();
+        ASSERT_EQ(OLAP_SUCCESS, k_engine->drop_table(TABLET_ID, SCHEMA_HASH));
+    }
+
+    // Load rows [begin, end) as one version
+    void load(int64_t transaction_id, int begin, int end) {
+        PUniqueId load_id;
+        load_id.set_hi(0);
+        load_id.set_lo(transaction_id);
+        WriteRequest write_req = {TABLET_ID, SCHEMA_HASH, WriteType::LOAD,
+                                  transaction_id, PARTITION_ID, load_id, false, _tuple_desc};
+        DeltaWriter* delta_writer = nullptr;
+        DeltaWriter::open(&write_req, &delta_writer);
+        ASSERT_NE(delta_writer, nullptr);
+
+        const std::vector<SlotDescriptor*>& slots = _tuple_desc->slots();
+        for (int i = begin; i < end; ++i) {
+            Tuple* tuple = reinterpret_cast<Tuple*>(_arena.Allocate(_tuple_desc->byte_size()));
+            memset(tuple, 0, _tuple_desc->byte_size());
+            *(int32_t*)(tuple->get_slot(slots[0]->tuple_offset())) = (i % 10000) / 3;
+            if (i % 5 == 0) {
+                tuple->set_null(slots[1]->null_indicator_offset());
+            } else {
+                std::string k2 = "s" + std::to_string(i % 7);
+                StringValue* k2_ptr = (StringValue*)(tuple->get_slot(slots[1]->tuple_offset()));
+                k2_ptr->ptr = _arena.Allocate(k2.size());
+                memcpy(k2_ptr->ptr, k2.data(), k2.size());
+                k2_ptr->len = k2.size();
+            }
+            *(int64_t*)(tuple->get_slot(slots[2]->tuple_offset())) = i;
+            ASSERT_EQ(OLAP_SUCCESS, delta_writer->write(tuple));
+        }
+        ASSERT_EQ(OLAP_SUCCESS, delta_writer->close(nullptr));
+        SAFE_DELETE(delta_writer);
+
+        TPublishVersionRequest publish_req;
+        publish_req.transaction_id = transaction_id;
+        TPartitionVersionInfo info;
+        info.partition_id = PARTITION_ID;
+        info.version = _table->lastest_version()->end_version() + 1;
+        info.version_hash = _table->lastest_version()->version_hash() + 1;
+        publish_req.partition_version_infos.push_back(info);
+        std::vector<TTabletId> error_tablet_ids;
+        ASSERT_EQ(OLAP_SUCCESS, k_engine->publish_version(publish_req, &error_tablet_ids));
+    }
+
+    // Row blocks and segments of the largest version
+    void largest_version_blocks(uint64_t* num_blocks, uint32_t* num_segments) {
+        std::vector<ColumnData*> data_sources;
+        _table->acquire_data_sources(Version(0, _version), &data_sources);
+        *num_blocks = 0;
+        *num_segments = 0;
+        for (ColumnData* data : data_sources) {
+            if (data->segment_group()->num_index_entries() > *num_blocks) {
+                *num_blocks = data->segment_group()->num_index_entries();
+                *num_segments = data->num_segments();
+            }
+        }
+        _table->release_data_sources(&data_sources);
+    }
+
+    // v1 of every row of split block_split of num_block_splits
+    void read_split(int32_t block_split, int32_t num_block_splits, bool vectorized,
+                    std::vector<int64_t>* values) {
+        config::enable_vectorized_olap_scan = vectorized;
+        ReaderParams params;
+        params.olap_table = _table;
+        params.reader_type = READER_QUERY;
+        params.aggregation = false;
+        params.version = Version(0, _version);
+        params.return_columns = {0, 1, 2};
+        params.block_split = block_split;
+        params.num_block_splits = num_block_splits;
+
+        Reader reader;
+        ASSERT_EQ(OLAP_SUCCESS, reader.init(params));
+        ASSERT_EQ(vectorized, reader.vectorized_read());
+        bool eof = false;
+        if (vectorized) {
+            while (true) {
+                VectorizedRowBatch* batch = nullptr;
+                ASSERT_EQ(OLAP_SUCCESS, reader.next_vector_batch(&batch, &eof));
+                if (eof) {
+                    break;
+                }
+                const int64_t* v1 = (const int64_t*)batch->column(2)->col_data();
+                for (uint16_t i = 0; i < batch->size(); ++i) {
+                    values->push_back(v1[batch->selected_in_use() ? batch->selected()[i] : i]);
+                }
+            }
+        } else {
+            RowCursor cursor;
+            ASSERT_EQ(OLAP_SUCCESS, cursor.init(_table->tablet_schema(), params.return_columns));
+            cursor.allocate_memory_for_string_type(_table->tablet_schema());
+            while (true) {
+                ASSERT_EQ(OLAP_SUCCESS, reader.next_row_with_aggregation(&cursor, &eof));
+                if (eof) {
+                    break;
+                }
+                values->push_back(*(int64_t*)cursor.get_field_content_ptr(2));
+            }
+        }
+    }
+
+    // Every row is returned by exactly one of num_block_splits splits
+    void check_splits(int32_t num_block_splits, bool vectorized) {
+        std::vector<int64_t> values;
+        for (int32_t split = 0; split < num_block_splits; ++split) {
+            read_split(split, num_block_splits, vectorized, &values);
+        }
+        std::sort(values.begin(), values.end());
+        ASSERT_EQ(40000, values.size()) << "num_block_splits=" << num_block_splits;
+        for (size_t i = 0; i < values.size(); ++i) {
+            ASSERT_EQ((int64_t)i, values[i]) << "num_block_splits=" << num_block_splits;
+        }
+    }
+
+    ObjectPool _obj_pool;
+    DescriptorTbl* _desc_tbl = nullptr;
+    TupleDescriptor* _tuple_desc = nullptr;
+    Arena _arena;
+    OLAPTablePtr _table;
+    int64_t _version = 0;
+    int64_t _version_hash = 0;
+    bool _origin_vectorized = true;
+};
+
+// With as many splits as blocks, every split ends at the first block of the
+// next one, and so at data_offset 0 of every segment but the first
+TEST_F(BlockSplitTest, splits_across_segments) {
+    uint64_t num_blocks = 0;
+    uint32_t num_segments = 0;
+    largest_version_blocks(&num_blocks, &num_segments);
+    ASSERT_GT(num_segments, 1);
+    ASSERT_GT(num_blocks, num_segments);
+
+    std::vector<int32_t> split_counts = {1, 2, 3, 7};
+    split_counts.push_back(num_segments);
+    split_counts.push_back(num_blocks - 1);
+    split_counts.push_back(num_blocks);
+    // more splits than blocks leaves some of them empty
+    split_counts.push_back(num_blocks + 3);
+    for (int32_t num_block_splits : split_counts) {
+        check_splits(num_block_splits, false);
+        check_splits(num_block_splits, true);
+    }
+}
+
+// The splits OlapScanNode gets from EngineMetaReader for a tablet without
+// key ranges
+TEST_F(BlockSplitTest, engine_meta_reader_splits) {
+    TPaloScanRange palo_scan_range;
+    palo_scan_range.tablet_id = TABLET_ID;
+    palo_scan_range.schema_hash = std::to_string(SCHEMA_HASH);
+    palo_scan_range.version = std::to_string(_version);
+    palo_scan_range.version_hash = std::to_string(_version_hash);
+    palo_scan_range.db_name = "test";
+    boost::shared_ptr<DorisScanRange> scan_range(new DorisScanRange(palo_scan_range));
+
+    std::vector<OlapScanRange> ranges;
+    ASSERT_TRUE(EngineMetaReader::get_block_splits(scan_range, 4096, 6, &ranges).ok());
+    ASSERT_EQ(6, ranges.size());
+    std::vector<int64_t> values;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        ASSERT_EQ((int32_t)i, ranges[i].block_split);
+        ASSERT_EQ(6, ranges[i].num_block_splits);
+        read_split(ranges[i].block_split, ranges[i].num_block_splits, true, &values);
+    }
+    std::sort(values.begin(), values.end());
+    ASSERT_EQ(40000, values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        ASSERT_EQ((int64_t)i, values[i]);
+    }
+
+    // too few rows to split
+    ranges.clear();
+    ASSERT_TRUE(EngineMetaReader::get_block_splits(scan_range, 40000, 6, &ranges).ok());
+    ASSERT_TRUE(ranges.empty());
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    int ret = doris::OLAP_SUCCESS;
+    testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+
+    doris::set_up();
+    ret = RUN_ALL_TESTS();
+    doris::tear_down();
+
+    google::protobuf::ShutdownProtobufLibrary();
+    return ret;
+}
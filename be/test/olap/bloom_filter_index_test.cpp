@@ -75,6 +75,48 @@ TEST_F(TestBloomFilterIndex, normal_read_and_write) {
     ASSERT_TRUE(bf__1.test_bytes(bytes.c_str(), bytes.size()));
 }
 
+TEST_F(TestBloomFilterIndex, split_block_read_and_write) {
+    string bytes;
+    BloomFilterIndexReader reader;
+    BloomFilterIndexWriter writer;
+
+    BloomFilter* bf_0 = new(std::nothrow) BloomFilter();
+    bf_0->init(1024, 0.05, true);
+    bytes = "hello";
+    bf_0->add_bytes(NULL, 0);
+    bf_0->add_bytes(bytes.c_str(), bytes.size());
+    writer.add_bloom_filter(bf_0);
+
+    BloomFilter* bf_1 = new(std::nothrow) BloomFilter();
+    bf_1->init(1024, 0.05, true);
+    bytes = "doris";
+    bf_1->add_bytes(bytes.c_str(), bytes.size());
+    writer.add_bloom_filter(bf_1);
+
+    uint64_t expect_size = sizeof(BloomFilterIndexHeader) + bf_0->bit_num() * 2 / 8;
+    ASSERT_EQ(expect_size, writer.estimate_buffered_memory());
+
+    char buffer[expect_size];
+    memset(buffer, 0, expect_size);
+    ASSERT_EQ(OLAP_SUCCESS, writer.write_to_buffer(buffer, expect_size));
+
+    ASSERT_EQ(OLAP_SUCCESS, reader.init(buffer,
+            expect_size, true, bf_0->hash_function_num(), bf_0->bit_num(), true));
+    ASSERT_EQ(2, reader.entry_count());
+
+    // the entries are not aligned in the buffer
+    bytes = "hello";
+    const BloomFilter& bf__0 = reader.entry(0);
+    ASSERT_TRUE(bf__0.split_block());
+    ASSERT_TRUE(bf__0.test_bytes(NULL, 0));
+    ASSERT_TRUE(bf__0.test_bytes(bytes.c_str(), bytes.size()));
+
+    bytes = "doris";
+    const BloomFilter& bf__1 = reader.entry(1);
+    ASSERT_TRUE(bf__1.test_bytes(bytes.c_str(), bytes.size()));
+    ASSERT_FALSE(bf__1.test_bytes(NULL, 0));
+}
+
 // Test abnormal write case
 TEST_F(TestBloomFilterIndex, abnormal_write) {
     char buffer[24];
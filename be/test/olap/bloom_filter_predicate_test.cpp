@@ -0,0 +1,190 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <google/protobuf/stubs/common.h>
+
+#include "common/config.h"
+#include "olap/bloom_filter_predicate.h"
+#include "olap/field.h"
+#include "olap/wrapper_field.h"
+#include "runtime/mem_pool.h"
+#include "runtime/string_value.hpp"
+#include "runtime/vectorized_row_batch.h"
+#include "util/cpu_info.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class TestBloomFilterPredicate : public testing::Test {
+public:
+    TestBloomFilterPredicate() : _vectorized_batch(NULL) {
+        _mem_tracker.reset(new MemTracker(-1));
+        _mem_pool.reset(new MemPool(_mem_tracker.get()));
+    }
+
+    ~TestBloomFilterPredicate() {
+        if (_vectorized_batch != NULL) {
+            delete _vectorized_batch;
+        }
+    }
+
+    void InitVectorizedBatch(FieldType type, int size) {
+        FieldInfo field_info;
+        field_info.name = "column";
+        field_info.type = type;
+        field_info.aggregation = OLAP_FIELD_AGGREGATION_NONE;
+        field_info.length = 16;
+        field_info.is_allow_null = true;
+        field_info.is_key = true;
+        field_info.precision = 1000;
+        field_info.frac = 10000;
+        field_info.unique_id = 0;
+        field_info.is_bf_column = false;
+        std::vector<FieldInfo> schema(1, field_info);
+        std::vector<uint32_t> return_columns(1, 0);
+        _vectorized_batch = new VectorizedRowBatch(schema, return_columns, size);
+        _vectorized_batch->set_size(size);
+    }
+
+    std::vector<uint16_t> selected_rows() const {
+        std::vector<uint16_t> rows;
+        for (uint16_t j = 0; j < _vectorized_batch->size(); ++j) {
+            rows.push_back(_vectorized_batch->selected_in_use() ?
+                           _vectorized_batch->selected()[j] : j);
+        }
+        return rows;
+    }
+
+    std::unique_ptr<MemTracker> _mem_tracker;
+    std::unique_ptr<MemPool> _mem_pool;
+    VectorizedRowBatch* _vectorized_batch;
+};
+
+TEST_F(TestBloomFilterPredicate, INT_COLUMN) {
+    // the even values of [0, 1000)
+    std::shared_ptr<BloomFilter> filter(new BloomFilter());
+    ASSERT_TRUE(filter->init(500, 0.05, true));
+    for (int32_t value = 0; value < 1000; value += 2) {
+        filter->add_hash(runtime_filter_hash(value));
+    }
+    BloomFilterColumnPredicate<int32_t> pred(0, filter);
+
+    int size = 1024;
+    InitVectorizedBatch(OLAP_FIELD_TYPE_INT, size);
+    ColumnVector* col_vector = _vectorized_batch->column(0);
+    col_vector->set_no_nulls(true);
+    int32_t* col_data = reinterpret_cast<int32_t*>(_mem_pool->allocate(size * sizeof(int32_t)));
+    col_vector->set_col_data(col_data);
+    for (int i = 0; i < size; ++i) {
+        col_data[i] = i;
+    }
+
+    // no false negative, and few false positives
+    pred.evaluate(_vectorized_batch);
+    std::vector<uint16_t> rows = selected_rows();
+    ASSERT_GE(rows.size(), 500);
+    ASSERT_LT(rows.size(), 600);
+    for (int32_t value = 0; value < 1000; value += 2) {
+        ASSERT_TRUE(std::find(rows.begin(), rows.end(), value) != rows.end()) << value;
+    }
+
+    // null rows are filtered, selected rows are evaluated only
+    col_vector->set_no_nulls(false);
+    bool* is_null = reinterpret_cast<bool*>(_mem_pool->allocate(size));
+    for (int i = 0; i < size; ++i) {
+        is_null[i] = (i % 4 == 0);
+    }
+    col_vector->set_is_null(is_null);
+    uint16_t* sel = _vectorized_batch->selected();
+    for (int i = 0; i < 10; ++i) {
+        sel[i] = i * 3;
+    }
+    _vectorized_batch->set_size(10);
+    _vectorized_batch->set_selected_in_use(true);
+    pred.evaluate(_vectorized_batch);
+    // 6 and 18 pass, 0, 12 and 24 are null
+    rows = selected_rows();
+    ASSERT_TRUE(std::find(rows.begin(), rows.end(), 6) != rows.end());
+    ASSERT_TRUE(std::find(rows.begin(), rows.end(), 18) != rows.end());
+    ASSERT_TRUE(std::find(rows.begin(), rows.end(), 0) == rows.end());
+    ASSERT_TRUE(std::find(rows.begin(), rows.end(), 12) == rows.end());
+
+    // the statistic of a block tells nothing
+    ASSERT_TRUE(pred.evaluate(std::pair<WrapperField*, WrapperField*>(nullptr, nullptr)));
+}
+
+TEST_F(TestBloomFilterPredicate, VARCHAR_COLUMN) {
+    std::shared_ptr<BloomFilter> filter(new BloomFilter());
+    ASSERT_TRUE(filter->init(100, 0.05, true));
+    std::vector<std::string> values;
+    for (int i = 0; i < 100; ++i) {
+        values.push_back("key_" + std::to_string(i));
+        filter->add_hash(runtime_filter_hash(StringValue(values.back())));
+    }
+    // any empty string is the same
+    filter->add_hash(runtime_filter_hash(StringValue(NULL, 0)));
+    BloomFilterColumnPredicate<StringValue> pred(0, filter);
+
+    int size = 300;
+    InitVectorizedBatch(OLAP_FIELD_TYPE_VARCHAR, size);
+    ColumnVector* col_vector = _vectorized_batch->column(0);
+    col_vector->set_no_nulls(false);
+    bool* is_null = reinterpret_cast<bool*>(_mem_pool->allocate(size));
+    StringValue* col_data =
+        reinterpret_cast<StringValue*>(_mem_pool->allocate(size * sizeof(StringValue)));
+    col_vector->set_col_data(col_data);
+    col_vector->set_is_null(is_null);
+    std::vector<std::string> strings;
+    for (int i = 0; i < size; ++i) {
+        strings.push_back(i == 299 ? "" : "key_" + std::to_string(i));
+    }
+    for (int i = 0; i < size; ++i) {
+        // null slots of strings hold nothing valid
+        is_null[i] = (i == 5);
+        col_data[i] = is_null[i] ? StringValue(reinterpret_cast<char*>(1), 1000)
+                                 : StringValue(strings[i]);
+    }
+
+    pred.evaluate(_vectorized_batch);
+    std::vector<uint16_t> rows = selected_rows();
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(i != 5, std::find(rows.begin(), rows.end(), i) != rows.end()) << i;
+    }
+    ASSERT_TRUE(std::find(rows.begin(), rows.end(), 299) != rows.end());
+    ASSERT_LT(rows.size(), 100 + 40);
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+    int ret = RUN_ALL_TESTS();
+    google::protobuf::ShutdownProtobufLibrary();
+    return ret;
+}
@@ -102,6 +102,59 @@ TEST_F(TestBloomFilter, add_and_test_bytes) {
     ASSERT_TRUE(bf.test_bytes(bytes.c_str(), bytes.size()));
 }
 
+TEST_F(TestBloomFilter, split_block_bloom_filter) {
+    BloomFilter bf;
+    bf.init(1024, 0.05, true);
+    ASSERT_TRUE(bf.split_block());
+    ASSERT_EQ(8, bf.hash_function_num());
+    ASSERT_EQ(0, bf.bit_num() % 256);
+    ASSERT_GE(bf.bit_num(), 1024 * 8);
+
+    // no false negative, and the fpp is close to the requested one
+    for (int i = 0; i < 1024; ++i) {
+        bf.add_hash(HashUtil::hash64(&i, sizeof(i), DEFAULT_SEED));
+    }
+    int false_positives = 0;
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t hash = HashUtil::hash64(&i, sizeof(i), DEFAULT_SEED);
+        if (i < 1024) {
+            ASSERT_TRUE(bf.test_hash(hash));
+        } else if (bf.test_hash(hash)) {
+            ++false_positives;
+        }
+    }
+    ASSERT_LT(false_positives, 100000 * 0.05);
+
+    // each value sets 8 bits of a block, one in each word
+    string bytes = "doris";
+    BloomFilter small_bf;
+    small_bf.init(8, 0.1, true);
+    ASSERT_EQ(256, small_bf.bit_num());
+    // the bit set holds a whole block even for no entries
+    BloomFilter empty_bf;
+    ASSERT_TRUE(empty_bf.init(0, 0.1, true));
+    ASSERT_EQ(4, empty_bf.bit_set_data_len());
+    small_bf.add_bytes(bytes.c_str(), bytes.size());
+    int bit_count = 0;
+    for (uint32_t i = 0; i < small_bf.bit_set_data_len(); ++i) {
+        bit_count += __builtin_popcountll(small_bf.bit_set_data()[i]);
+    }
+    ASSERT_EQ(8, bit_count);
+    string points = small_bf.get_bytes_points_string(bytes.c_str(), bytes.size());
+    size_t pos = 0;
+    for (int i = 0; i < 8; ++i) {
+        size_t end = points.find('-', pos);
+        int point = std::stoi(points.substr(pos, end - pos));
+        ASSERT_EQ(i, point / 32);
+        pos = end + 1;
+    }
+
+    // filters of different layouts do not merge
+    BloomFilter classic_bf;
+    classic_bf.init(8, 0.1);
+    ASSERT_FALSE(small_bf.merge(classic_bf));
+}
+
 // Print bloom filter buffer and points of specified string
 TEST_F(TestBloomFilter, bloom_filter_info) {
     string bytes;
@@ -1560,6 +1560,65 @@ TEST_F(TestColumn, SeekFloatColumnWithPresent) {
     ASSERT_FLOAT_EQ(value, 3.234);    
 }
 
+TEST_F(TestColumn, SkipDecimalColumnWithNull) {
+    // write data
+    std::vector<FieldInfo> tablet_schema;
+    FieldInfo field_info;
+    SetFieldInfo(field_info,
+                 std::string("DecimalColumnWithPresent"),
+                 OLAP_FIELD_TYPE_DECIMAL,
+                 OLAP_FIELD_AGGREGATION_REPLACE,
+                 12,
+                 true,
+                 true);
+    tablet_schema.push_back(field_info);
+
+    CreateColumnWriter(tablet_schema);
+
+    RowCursor write_row;
+    write_row.init(tablet_schema);
+
+    RowBlock block(tablet_schema);
+    RowBlockInfo block_info;
+    block_info.row_num = 10000;
+    block.init(block_info);
+
+    // null, 1234.5678, null, 5678.1234
+    for (const char* value : {"", "1234.5678", "", "5678.1234"}) {
+        if (strlen(value) == 0) {
+            write_row.set_null(0);
+        } else {
+            std::vector<string> val_string_array;
+            val_string_array.push_back(value);
+            OlapTuple tuple(val_string_array);
+            write_row.from_tuple(tuple);
+            write_row.set_not_null(0);
+        }
+        block.set_row(0, write_row);
+        block.finalize(1);
+        ASSERT_EQ(_column_writer->write_batch(&block, &write_row), OLAP_SUCCESS);
+    }
+
+    ColumnDataHeaderMessage header;
+    ASSERT_EQ(_column_writer->finalize(&header), OLAP_SUCCESS);
+
+    // read data
+    CreateColumnReader(tablet_schema);
+
+    RowCursor read_row;
+    read_row.init(tablet_schema);
+
+    // skipping the null rows must not consume int and frac parts
+    ASSERT_EQ(_column_reader->skip(3), OLAP_SUCCESS);
+    _col_vector.reset(new ColumnVector());
+    ASSERT_EQ(_column_reader->next_vector(
+        _col_vector.get(), 1, _mem_pool.get()), OLAP_SUCCESS);
+    ASSERT_FALSE(_col_vector->is_null()[0]);
+    char* data = reinterpret_cast<char*>(_col_vector->col_data());
+    read_row.set_field_content(0, data, _mem_pool.get());
+    ASSERT_TRUE(strncmp(read_row.to_string().c_str(), "0&5678.1234", strlen("0&5678.1234")) == 0);
+}
+
 TEST_F(TestColumn, SkipFloatColumnWithPresent) {
     // write data
     std::vector<FieldInfo> tablet_schema;
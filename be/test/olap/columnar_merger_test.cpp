@@ -0,0 +1,372 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/columnar_merger.h"
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "common/object_pool.h"
+#include "gen_cpp/Descriptors_types.h"
+#include "gen_cpp/PaloInternalService_types.h"
+#include "olap/column_data.h"
+#include "olap/delta_writer.h"
+#include "olap/merger.h"
+#include "olap/olap_engine.h"
+#include "olap/olap_table.h"
+#include "olap/reader.h"
+#include "olap/row_cursor.h"
+#include "olap/segment_group.h"
+#include "olap/utils.h"
+#include "runtime/descriptors.h"
+#include "runtime/tuple.h"
+#include "util/arena.h"
+#include "util/descriptor_helper.h"
+#include "util/logging.h"
+
+namespace doris {
+
+// Merges the same versions with ColumnarMerger and with the row path of
+// Merger, and checks both write the same rows.
+
+static const uint32_t MAX_PATH_LEN = 1024;
+static const int32_t SCHEMA_HASH = 270068379;
+static const int64_t PARTITION_ID = 30007;
+
+OLAPEngine* k_engine = nullptr;
+
+void set_up() {
+    char buffer[MAX_PATH_LEN];
+    getcwd(buffer, MAX_PATH_LEN);
+    config::storage_root_path = std::string(buffer) + "/data_columnar_merger";
+    remove_all_dir(config::storage_root_path);
+    create_dir(config::storage_root_path);
+    std::vector<StorePath> paths;
+    paths.emplace_back(config::storage_root_path, -1);
+
+    doris::EngineOptions options;
+    options.store_paths = paths;
+    doris::OLAPEngine::open(options, &k_engine);
+}
+
+void tear_down() {
+    remove_all_dir(config::storage_root_path);
+    remove_all_dir(std::string(getenv("DORIS_HOME")) + UNUSED_PREFIX);
+}
+
+void add_column(TCreateTabletReq* request, const std::string& name, TPrimitiveType::type type,
+                bool is_key, TAggregationType::type aggregation) {
+    TColumn column;
+    column.column_name = name;
+    column.__set_is_key(is_key);
+    column.__set_is_allow_null(true);
+    column.column_type.type = type;
+    if (type == TPrimitiveType::VARCHAR) {
+        column.column_type.__set_len(20);
+    }
+    if (!is_key && request->tablet_schema.keys_type != TKeysType::DUP_KEYS) {
+        column.__set_aggregation_type(aggregation);
+    }
+    request->tablet_schema.columns.push_back(column);
+}
+
+// k1 INT, k2 VARCHAR keys and v1 BIGINT, v2 INT, v3 INT, v4 VARCHAR
+// values, all nullable. AGG_KEYS aggregates the values by SUM, MIN, MAX
+// and REPLACE, UNIQUE_KEYS replaces all of them.
+void create_table_request(int64_t tablet_id, TKeysType::type keys_type,
+                          TCreateTabletReq* request) {
+    request->tablet_id = tablet_id;
+    request->__set_version(1);
+    request->__set_version_hash(0);
+    request->tablet_schema.schema_hash = SCHEMA_HASH;
+    request->tablet_schema.short_key_column_count = 2;
+    request->tablet_schema.keys_type = keys_type;
+    request->tablet_schema.storage_type = TStorageType::COLUMN;
+
+    bool is_agg = keys_type == TKeysType::AGG_KEYS;
+    add_column(request, "k1", TPrimitiveType::INT, true, TAggregationType::NONE);
+    add_column(request, "k2", TPrimitiveType::VARCHAR, true, TAggregationType::NONE);
+    add_column(request, "v1", TPrimitiveType::BIGINT, false,
+               is_agg ? TAggregationType::SUM : TAggregationType::REPLACE);
+    add_column(request, "v2", TPrimitiveType::INT, false,
+               is_agg ? TAggregationType::MIN : TAggregationType::REPLACE);
+    add_column(request, "v3", TPrimitiveType::INT, false,
+               is_agg ? TAggregationType::MAX : TAggregationType::REPLACE);
+    add_column(request, "v4", TPrimitiveType::VARCHAR, false, TAggregationType::REPLACE);
+}
+
+TDescriptorTable create_descriptor_table() {
+    TDescriptorTableBuilder dtb;
+    TTupleDescriptorBuilder tuple_builder;
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().type(TYPE_INT).column_name("k1").column_pos(0).build());
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().string_type(20).column_name("k2").column_pos(1).build());
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().type(TYPE_BIGINT).column_name("v1").column_pos(2).build());
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().type(TYPE_INT).column_name("v2").column_pos(3).build());
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().type(TYPE_INT).column_name("v3").column_pos(4).build());
+    tuple_builder.add_slot(
+        TSlotDescriptorBuilder().string_type(20).column_name("v4").column_pos(5).build());
+    tuple_builder.build(&dtb);
+    return dtb.desc_tbl();
+}
+
+class ColumnarMergerTest : public testing::Test {
+public:
+    void SetUp() override {
+        DescriptorTbl::create(&_obj_pool, create_descriptor_table(), &_desc_tbl);
+        _tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+        _origin_columnar = config::enable_columnar_compaction;
+    }
+
+    void TearDown() override {
+        config::enable_columnar_compaction = _origin_columnar;
+        if (_table != nullptr) {
+            int64_t tablet_id = _table->tablet_id();
+            _table.reset();
+            ASSERT_EQ(OLAP_SUCCESS, k_engine->drop_table(tablet_id, SCHEMA_HASH));
+        }
+    }
+
+    void create_table(int64_t tablet_id, TKeysType::type keys_type) {
+        TCreateTabletReq request;
+        create_table_request(tablet_id, keys_type, &request);
+        ASSERT_EQ(OLAP_SUCCESS, k_engine->create_table(request));
+        _table = OLAPEngine::get_instance()->get_table(tablet_id, SCHEMA_HASH);
+        ASSERT_TRUE(_table != nullptr);
+    }
+
+    void set_string(Tuple* tuple, const SlotDescriptor* slot, const std::string& value) {
+        StringValue* str = (StringValue*)(tuple->get_slot(slot->tuple_offset()));
+        str->ptr = _arena.Allocate(value.size());
+        memcpy(str->ptr, value.data(), value.size());
+        str->len = value.size();
+    }
+
+    // Load rows [begin, end) as one version. Runs of rows share k1, and the
+    // key and value columns are null every few rows.
+    void load(int64_t transaction_id, int begin, int end) {
+        PUniqueId load_id;
+        load_id.set_hi(0);
+        load_id.set_lo(transaction_id);
+        WriteRequest write_req = {_table->tablet_id(), SCHEMA_HASH, WriteType::LOAD,
+                                  transaction_id, PARTITION_ID, load_id, false, _tuple_desc};
+        DeltaWriter* delta_writer = nullptr;
+        DeltaWriter::open(&write_req, &delta_writer);
+        ASSERT_NE(delta_writer, nullptr);
+
+        const std::vector<SlotDescriptor*>& slots = _tuple_desc->slots();
+        for (int i = begin; i < end; ++i) {
+            Tuple* tuple = reinterpret_cast<Tuple*>(_arena.Allocate(_tuple_desc->byte_size()));
+            memset(tuple, 0, _tuple_desc->byte_size());
+            if (i % 11 == 0) {
+                tuple->set_null(slots[0]->null_indicator_offset());
+            } else {
+                *(int32_t*)(tuple->get_slot(slots[0]->tuple_offset())) = i / 4;
+            }
+            if (i % 5 == 0) {
+                tuple->set_null(slots[1]->null_indicator_offset());
+            } else {
+                set_string(tuple, slots[1], "s" + std::to_string(i % 3));
+            }
+            if (i % 7 == 0) {
+                tuple->set_null(slots[2]->null_indicator_offset());
+            } else {
+                *(int64_t*)(tuple->get_slot(slots[2]->tuple_offset())) = i + transaction_id;
+            }
+            if (i % 6 == 0) {
+                tuple->set_null(slots[3]->null_indicator_offset());
+                tuple->set_null(slots[4]->null_indicator_offset());
+            } else {
+                *(int32_t*)(tuple->get_slot(slots[3]->tuple_offset())) = (i * 7) % 1000;
+                *(int32_t*)(tuple->get_slot(slots[4]->tuple_offset())) = (i * 13) % 1000;
+            }
+            if (i % 9 == 0) {
+                tuple->set_null(slots[5]->null_indicator_offset());
+            } else {
+                set_string(tuple, slots[5], "v" + std::to_string(transaction_id + i));
+            }
+            ASSERT_EQ(OLAP_SUCCESS, delta_writer->write(tuple));
+        }
+        ASSERT_EQ(OLAP_SUCCESS, delta_writer->close(nullptr));
+        SAFE_DELETE(delta_writer);
+
+        TPublishVersionRequest publish_req;
+        publish_req.transaction_id = transaction_id;
+        TPartitionVersionInfo info;
+        info.partition_id = PARTITION_ID;
+        info.version = _table->lastest_version()->end_version() + 1;
+        info.version_hash = _table->lastest_version()->version_hash() + 1;
+        publish_req.partition_version_infos.push_back(info);
+        std::vector<TTabletId> error_tablet_ids;
+        ASSERT_EQ(OLAP_SUCCESS, k_engine->publish_version(publish_req, &error_tablet_ids));
+    }
+
+    // Overlapping versions of a few thousand rows, so that equal keys of
+    // different versions meet where a batch of one of them ends
+    void load_versions() {
+        load(20010, 0, 6000);
+        load(20011, 3000, 9000);
+        load(20012, 1000, 2500);
+        load(20013, 5000, 12000);
+    }
+
+    // Merge all versions into a new segment group as base compaction does,
+    // by columns if columnar is true. The rows of the merged data are
+    // returned in order.
+    void merge(bool columnar, int segment_group_id, std::vector<std::string>* rows,
+               uint64_t* merged_rows) {
+        config::enable_columnar_compaction = columnar;
+        Version version(0, _table->lastest_version()->end_version());
+        std::vector<ColumnData*> data_sources;
+        _table->obtain_header_rdlock();
+        _table->acquire_data_sources(version, &data_sources);
+        _table->release_header_lock();
+        ASSERT_EQ(5, data_sources.size());
+
+        ColumnarMerger columnar_merger(_table, READER_BASE_COMPACTION, version);
+        ASSERT_EQ(columnar, columnar_merger.can_merge(data_sources));
+
+        SegmentGroup* segment_group = new SegmentGroup(_table.get(), version, 0, false,
+                                                       segment_group_id, 0);
+        Merger merger(_table, segment_group, READER_BASE_COMPACTION);
+        uint64_t filted_rows = 0;
+        ASSERT_EQ(OLAP_SUCCESS, merger.merge(data_sources, merged_rows, &filted_rows));
+        ASSERT_EQ(0, filted_rows);
+        _table->release_data_sources(&data_sources);
+        ASSERT_EQ(OLAP_SUCCESS, segment_group->load());
+        ASSERT_EQ(merger.row_count(), segment_group->num_rows());
+
+        std::unique_ptr<ColumnData> data(ColumnData::create(segment_group));
+        ASSERT_EQ(OLAP_SUCCESS, data->init());
+        ReaderParams params;
+        params.olap_table = _table;
+        params.reader_type = READER_CUMULATIVE_COMPACTION;
+        params.olap_data_arr.push_back(data.get());
+        {
+            Reader reader;
+            ASSERT_EQ(OLAP_SUCCESS, reader.init(params));
+            RowCursor cursor;
+            ASSERT_EQ(OLAP_SUCCESS, cursor.init(_table->tablet_schema()));
+            cursor.allocate_memory_for_string_type(_table->tablet_schema());
+            bool eof = false;
+            while (true) {
+                ASSERT_EQ(OLAP_SUCCESS, reader.next_row_with_aggregation(&cursor, &eof));
+                if (eof) {
+                    break;
+                }
+                rows->push_back(cursor.to_string());
+            }
+            ASSERT_EQ(0, reader.merged_rows());
+        }
+        data.reset();
+        segment_group->delete_all_files();
+        delete segment_group;
+    }
+
+    void check_merge() {
+        std::vector<std::string> expected;
+        uint64_t expected_merged_rows = 0;
+        merge(false, 0, &expected, &expected_merged_rows);
+        std::vector<std::string> actual;
+        uint64_t actual_merged_rows = 0;
+        merge(true, 1, &actual, &actual_merged_rows);
+
+        ASSERT_EQ(expected_merged_rows, actual_merged_rows);
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQ(expected[i], actual[i]) << "row " << i;
+        }
+    }
+
+    ObjectPool _obj_pool;
+    DescriptorTbl* _desc_tbl = nullptr;
+    TupleDescriptor* _tuple_desc = nullptr;
+    Arena _arena;
+    OLAPTablePtr _table;
+    bool _origin_columnar = false;
+};
+
+TEST_F(ColumnarMergerTest, dup_keys) {
+    create_table(10010, TKeysType::DUP_KEYS);
+    load_versions();
+    check_merge();
+}
+
+// SUM, MIN and MAX of keys that go on in the next batch of a version, and
+// REPLACE by the last version of a key
+TEST_F(ColumnarMergerTest, agg_keys) {
+    create_table(10011, TKeysType::AGG_KEYS);
+    load_versions();
+    check_merge();
+}
+
+TEST_F(ColumnarMergerTest, unique_keys) {
+    create_table(10012, TKeysType::UNIQUE_KEYS);
+    load_versions();
+    check_merge();
+}
+
+// Columnar merge leaves string aggregations to the row path
+TEST_F(ColumnarMergerTest, can_merge) {
+    create_table(10013, TKeysType::AGG_KEYS);
+    load(20014, 0, 100);
+    Version version(0, _table->lastest_version()->end_version());
+    std::vector<ColumnData*> data_sources;
+    _table->obtain_header_rdlock();
+    _table->acquire_data_sources(version, &data_sources);
+    _table->release_header_lock();
+
+    config::enable_columnar_compaction = true;
+    ColumnarMerger columnar_merger(_table, READER_BASE_COMPACTION, version);
+    ASSERT_TRUE(columnar_merger.can_merge(data_sources));
+    config::enable_columnar_compaction = false;
+    ASSERT_FALSE(columnar_merger.can_merge(data_sources));
+
+    config::enable_columnar_compaction = true;
+    FieldInfo& v4 = _table->tablet_schema()[5];
+    v4.aggregation = OLAP_FIELD_AGGREGATION_MAX;
+    ColumnarMerger string_max_merger(_table, READER_BASE_COMPACTION, version);
+    ASSERT_FALSE(string_max_merger.can_merge(data_sources));
+    v4.aggregation = OLAP_FIELD_AGGREGATION_REPLACE;
+    _table->release_data_sources(&data_sources);
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    int ret = doris::OLAP_SUCCESS;
+    testing::InitGoogleTest(&argc, argv);
+
+    doris::set_up();
+    ret = RUN_ALL_TESTS();
+    doris::tear_down();
+
+    google::protobuf::ShutdownProtobufLibrary();
+    return ret;
+}
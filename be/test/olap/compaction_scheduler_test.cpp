@@ -0,0 +1,186 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/compaction_scheduler.h"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "util/logging.h"
+
+namespace doris {
+
+static const int64_t GB = 1024L * 1024L * 1024L;
+
+TEST(CompactionSchedulerTest, priority) {
+    ASSERT_EQ(0, compaction_priority(0, GB, 100));
+    // more versions first
+    ASSERT_GT(compaction_priority(20, GB, 0), compaction_priority(10, GB, 0));
+    // of the same score, hot tablets first
+    ASSERT_GT(compaction_priority(10, GB, 100), compaction_priority(10, GB, 1));
+    // and small tablets first
+    ASSERT_GT(compaction_priority(10, GB, 0), compaction_priority(10, 100 * GB, 0));
+    // a cold tablet with many more versions still goes before a hot one
+    ASSERT_GT(compaction_priority(100, GB, 0), compaction_priority(10, GB, 10));
+}
+
+TEST(CompactionSchedulerTest, query_hotness) {
+    config::compaction_query_hotness_half_life_sec = 100;
+    QueryHotness hotness;
+    ASSERT_EQ(0, hotness.value(1000));
+    for (int i = 0; i < 8; ++i) {
+        hotness.add(1000);
+    }
+    ASSERT_EQ(8, hotness.value(1000));
+    ASSERT_EQ(8, hotness.value(1099));
+    ASSERT_EQ(4, hotness.value(1100));
+    ASSERT_EQ(1, hotness.value(1300));
+    hotness.add(1350);
+    ASSERT_EQ(2, hotness.value(1350));
+    // forgotten after long enough
+    ASSERT_EQ(0, hotness.value(1000000));
+}
+
+TEST(CompactionSchedulerTest, slots) {
+    CompactionSlots slots(2);
+    ASSERT_FALSE(slots.is_full("/disk1"));
+    ASSERT_TRUE(slots.try_acquire("/disk1", 1));
+    // one compaction of a tablet at a time
+    ASSERT_FALSE(slots.try_acquire("/disk1", 1));
+    ASSERT_TRUE(slots.try_acquire("/disk1", 2));
+    ASSERT_TRUE(slots.is_full("/disk1"));
+    ASSERT_FALSE(slots.try_acquire("/disk1", 3));
+    ASSERT_EQ(2, slots.running("/disk1"));
+
+    // other disks are not affected
+    ASSERT_FALSE(slots.is_full("/disk2"));
+    ASSERT_TRUE(slots.try_acquire("/disk2", 3));
+    ASSERT_EQ(1, slots.running("/disk2"));
+
+    slots.release("/disk1", 1);
+    ASSERT_FALSE(slots.is_full("/disk1"));
+    ASSERT_TRUE(slots.try_acquire("/disk1", 1));
+
+    slots.set_max_tasks_per_disk(3);
+    ASSERT_TRUE(slots.try_acquire("/disk1", 4));
+    ASSERT_TRUE(slots.is_full("/disk1"));
+}
+
+TEST(CompactionSchedulerTest, slots_unlimited) {
+    // no per-disk limit unless it is set, a tablet still takes one slot
+    CompactionSlots slots;
+    for (int64_t tablet_id = 0; tablet_id < 1000; ++tablet_id) {
+        ASSERT_TRUE(slots.try_acquire("/disk1", tablet_id));
+    }
+    ASSERT_FALSE(slots.is_full("/disk1"));
+    ASSERT_FALSE(slots.try_acquire("/disk1", 0));
+    ASSERT_EQ(1000, slots.running("/disk1"));
+}
+
+TEST(CompactionSchedulerTest, slots_concurrent) {
+    CompactionSlots slots(3);
+    std::atomic<int> running(0);
+    std::atomic<int> max_running(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&slots, &running, &max_running, i] {
+            for (int j = 0; j < 1000; ++j) {
+                int64_t tablet_id = i * 1000 + j;
+                if (!slots.try_acquire("/disk", tablet_id)) {
+                    continue;
+                }
+                int now = ++running;
+                int max = max_running;
+                while (now > max && !max_running.compare_exchange_weak(max, now)) { }
+                --running;
+                slots.release("/disk", tablet_id);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_LE(max_running, 3);
+    ASSERT_EQ(0, slots.running("/disk"));
+}
+
+TEST(CompactionSchedulerTest, io_throttle) {
+    // no limit
+    IoThrottle unlimited(0);
+    ASSERT_EQ(0, unlimited.reserve(100 * GB, 1000));
+    ASSERT_EQ(0, unlimited.reserve(100 * GB, 1000));
+
+    // 10KB take 1ms at 10MB/s, the first write goes at once
+    IoThrottle throttle(10 * 1000 * 1000);
+    ASSERT_EQ(0, throttle.reserve(10 * 1000, 1000));
+    ASSERT_EQ(1000, throttle.reserve(10 * 1000, 1000));
+    ASSERT_EQ(1500, throttle.reserve(10 * 1000, 1500));
+    // due by 4000, a writer coming later waits less
+    ASSERT_EQ(1000, throttle.reserve(1000, 3000));
+    // an idle disk saves up no credit for later bursts
+    ASSERT_EQ(0, throttle.reserve(10 * 1000, 1000000));
+    ASSERT_EQ(1000, throttle.reserve(10 * 1000, 1000000));
+    // writes of 0 bytes never wait
+    ASSERT_EQ(0, throttle.reserve(0, 1000000));
+}
+
+TEST(CompactionSchedulerTest, io_throttle_concurrent) {
+    // 4 threads writing 50 chunks of 10KB at 10MB/s at the same time share
+    // the rate, each chunk is due 1ms after another one
+    IoThrottle throttle(10 * 1000 * 1000);
+    std::vector<std::vector<int64_t>> waits(4);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&throttle, &waits, i] {
+            for (int j = 0; j < 50; ++j) {
+                waits[i].push_back(throttle.reserve(10 * 1000, 0));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::vector<int64_t> all_waits;
+    for (auto& thread_waits : waits) {
+        // a thread's chunks are due one after another
+        ASSERT_TRUE(std::is_sorted(thread_waits.begin(), thread_waits.end()));
+        all_waits.insert(all_waits.end(), thread_waits.begin(), thread_waits.end());
+    }
+    std::sort(all_waits.begin(), all_waits.end());
+    for (int i = 0; i < 200; ++i) {
+        ASSERT_EQ(i * 1000, all_waits[i]);
+    }
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -22,6 +22,7 @@
 #include "olap/field.h"
 #include "olap/column_predicate.h"
 #include "olap/comparison_predicate.h"
+#include "olap/wrapper_field.h"
 #include "runtime/mem_pool.h"
 #include "runtime/string_value.hpp"
 #include "runtime/vectorized_row_batch.h"
@@ -947,6 +948,63 @@ TEST_F(TestLessPredicate, DATETIME_COLUMN) {
     ASSERT_EQ(datetime::to_datetime_string(*(col_data + sel[0])), "2017-09-08 00:01:00");
 }
 
+// Block statistics of an INT column, a null bound is passed as nullptr.
+class TestPredicateStatistic : public testing::Test {
+public:
+    TestPredicateStatistic() {
+        _min.reset(WrapperField::create_by_type(OLAP_FIELD_TYPE_INT));
+        _max.reset(WrapperField::create_by_type(OLAP_FIELD_TYPE_INT));
+    }
+
+    std::pair<WrapperField*, WrapperField*> statistic(const char* min, const char* max) {
+        set_bound(_min.get(), min);
+        set_bound(_max.get(), max);
+        return std::make_pair(_min.get(), _max.get());
+    }
+
+    void set_bound(WrapperField* field, const char* value) {
+        if (value == nullptr) {
+            field->set_null();
+        } else {
+            field->set_not_null();
+            field->from_string(value);
+        }
+    }
+
+    std::unique_ptr<WrapperField> _min;
+    std::unique_ptr<WrapperField> _max;
+};
+
+TEST_F(TestPredicateStatistic, COMPARISON) {
+    ASSERT_TRUE(EqualPredicate<int32_t>(0, 10).evaluate(statistic("5", "20")));
+    ASSERT_FALSE(EqualPredicate<int32_t>(0, 30).evaluate(statistic("5", "20")));
+    ASSERT_FALSE(EqualPredicate<int32_t>(0, 1).evaluate(statistic("5", "20")));
+    ASSERT_TRUE(NotEqualPredicate<int32_t>(0, 5).evaluate(statistic("5", "20")));
+    ASSERT_FALSE(NotEqualPredicate<int32_t>(0, 5).evaluate(statistic("5", "5")));
+    ASSERT_TRUE(LessPredicate<int32_t>(0, 6).evaluate(statistic("5", "20")));
+    ASSERT_FALSE(LessPredicate<int32_t>(0, 5).evaluate(statistic("5", "20")));
+    ASSERT_TRUE(LessEqualPredicate<int32_t>(0, 5).evaluate(statistic("5", "20")));
+    ASSERT_FALSE(LessEqualPredicate<int32_t>(0, 4).evaluate(statistic("5", "20")));
+    ASSERT_TRUE(GreaterPredicate<int32_t>(0, 19).evaluate(statistic("5", "20")));
+    ASSERT_FALSE(GreaterPredicate<int32_t>(0, 20).evaluate(statistic("5", "20")));
+    ASSERT_TRUE(GreaterEqualPredicate<int32_t>(0, 20).evaluate(statistic("5", "20")));
+    ASSERT_FALSE(GreaterEqualPredicate<int32_t>(0, 21).evaluate(statistic("5", "20")));
+
+    // with nulls the min is unknown, only max can prune
+    ASSERT_TRUE(LessPredicate<int32_t>(0, 5).evaluate(statistic(nullptr, "20")));
+    ASSERT_TRUE(EqualPredicate<int32_t>(0, 1).evaluate(statistic(nullptr, "20")));
+    ASSERT_FALSE(EqualPredicate<int32_t>(0, 30).evaluate(statistic(nullptr, "20")));
+    ASSERT_FALSE(GreaterPredicate<int32_t>(0, 20).evaluate(statistic(nullptr, "20")));
+
+    // nothing but nulls never matches
+    ASSERT_FALSE(LessPredicate<int32_t>(0, 100).evaluate(statistic(nullptr, nullptr)));
+    ASSERT_FALSE(NotEqualPredicate<int32_t>(0, 100).evaluate(statistic(nullptr, nullptr)));
+
+    // no statistic recorded
+    ASSERT_TRUE(EqualPredicate<int32_t>(0, 30).evaluate(
+            std::pair<WrapperField*, WrapperField*>(nullptr, nullptr)));
+}
+
 } // namespace doris
 
 int main(int argc, char** argv) {
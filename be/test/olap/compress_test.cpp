@@ -0,0 +1,197 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/compress.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "olap/byte_buffer.h"
+#include "olap/out_stream.h"
+#include "olap/run_length_integer_writer.h"
+#include "util/logging.h"
+#include "util/stopwatch.hpp"
+
+namespace doris {
+
+struct Codec {
+    const char* name;
+    Compressor compressor;
+    Decompressor decompressor;
+};
+
+static const Codec CODECS[] = {
+    {"lzo", lzo_compress, lzo_decompress},
+    {"lz4", lz4_compress, lz4_decompress},
+    {"lz4hc", lz4hc_compress, lz4_decompress},
+};
+
+// Builds uncompressed column streams with the same writers and buffer size
+// as a segment, and keeps the payload of every stream buffer. These payloads
+// are what the codec of a table compresses one at a time.
+class TestCompress : public testing::Test {
+public:
+    void SetUp() {
+        _factory.reset(new OutStreamFactory(COMPRESS_NONE,
+                                            OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE));
+    }
+
+    void TearDown() {
+        for (StorageByteBuffer* chunk : _chunks) {
+            delete chunk;
+        }
+    }
+
+    // ids that only grow, as an auto increment key
+    void write_ids(uint32_t column_id, int num_rows) {
+        OutStream* stream = _factory->create_stream(column_id, StreamInfoMessage::DATA);
+        RunLengthIntegerWriter writer(stream, true);
+        int64_t id = 1000000;
+        for (int i = 0; i < num_rows; ++i) {
+            id += 1 + rand() % 3;
+            ASSERT_EQ(OLAP_SUCCESS, writer.write(id));
+        }
+        ASSERT_EQ(OLAP_SUCCESS, writer.flush());
+        add_chunks(stream);
+    }
+
+    // log lines built from a small vocabulary
+    void write_strings(uint32_t column_id, int num_rows) {
+        static const char* words[] = {
+            "GET", "POST", "/api/v1/query", "/api/v1/load", "status=200", "status=404",
+            "user_id=", "latency_ms=", "be", "fe", "INFO", "WARN"
+        };
+        OutStream* stream = _factory->create_stream(column_id, StreamInfoMessage::DATA);
+        for (int i = 0; i < num_rows; ++i) {
+            std::string line;
+            for (int j = 0; j < 6; ++j) {
+                line.append(words[rand() % (sizeof(words) / sizeof(words[0]))]);
+                line.append(std::to_string(rand() % 1000));
+                line.push_back(' ');
+            }
+            ASSERT_EQ(OLAP_SUCCESS, stream->write(line.data(), line.size()));
+        }
+        add_chunks(stream);
+    }
+
+    void add_chunks(OutStream* stream) {
+        ASSERT_EQ(OLAP_SUCCESS, stream->flush());
+        for (StorageByteBuffer* buf : stream->output_buffers()) {
+            uint64_t length = buf->limit() - sizeof(StreamHead);
+            StorageByteBuffer* chunk = StorageByteBuffer::create(length);
+            ASSERT_EQ(OLAP_SUCCESS, chunk->put(buf->array() + sizeof(StreamHead), length));
+            chunk->flip();
+            _chunks.push_back(chunk);
+        }
+    }
+
+    // compress and decompress every chunk, checking that the data survives
+    void run(const Codec& codec, bool log) {
+        uint64_t raw_bytes = 0;
+        uint64_t stored_bytes = 0;
+        uint64_t compress_ns = 0;
+        uint64_t decompress_ns = 0;
+        for (StorageByteBuffer* chunk : _chunks) {
+            uint64_t length = chunk->remaining();
+            // room for the worst case of lzo, a chunk that does not shrink is
+            // stored uncompressed anyway
+            std::unique_ptr<StorageByteBuffer> compressed(
+                    StorageByteBuffer::create(length + length / 8 + 128));
+            std::unique_ptr<StorageByteBuffer> decompressed(StorageByteBuffer::create(length));
+            bool smaller = false;
+            MonotonicStopWatch watch;
+            watch.start();
+            OLAPStatus res = codec.compressor(chunk, compressed.get(), &smaller);
+            compress_ns += watch.elapsed_time();
+            ASSERT_TRUE(res == OLAP_SUCCESS || res == OLAP_ERR_BUFFER_OVERFLOW) << codec.name;
+            raw_bytes += length;
+            if (res != OLAP_SUCCESS || !smaller) {
+                stored_bytes += length;
+                continue;
+            }
+            compressed->flip();
+            stored_bytes += compressed->remaining();
+
+            watch.start();
+            ASSERT_EQ(OLAP_SUCCESS, codec.decompressor(compressed.get(), decompressed.get()))
+                << codec.name;
+            decompress_ns += watch.elapsed_time();
+            ASSERT_EQ(length, decompressed->limit()) << codec.name;
+            ASSERT_EQ(0, memcmp(chunk->array() + chunk->position(), decompressed->array(), length))
+                << codec.name;
+        }
+        if (log) {
+            double mb = raw_bytes / 1024.0 / 1024.0;
+            LOG(INFO) << "codec=" << codec.name
+                      << " ratio=" << static_cast<double>(raw_bytes) / stored_bytes
+                      << " compress_mb/s=" << mb * 1000000000.0 / std::max<uint64_t>(compress_ns, 1)
+                      << " decompress_mb/s=" << mb * 1000000000.0 / std::max<uint64_t>(decompress_ns, 1);
+        }
+    }
+
+    std::unique_ptr<OutStreamFactory> _factory;
+    std::vector<StorageByteBuffer*> _chunks;
+};
+
+TEST_F(TestCompress, round_trip) {
+    write_ids(0, 10000);
+    write_strings(1, 1000);
+    for (const Codec& codec : CODECS) {
+        run(codec, false);
+    }
+}
+
+TEST_F(TestCompress, lz4hc_levels) {
+    write_strings(0, 1000);
+    int32_t origin_level = config::lz4hc_compression_level;
+    for (int32_t level : {1, 9, 12}) {
+        config::lz4hc_compression_level = level;
+        run(CODECS[2], false);
+    }
+    config::lz4hc_compression_level = origin_level;
+}
+
+// Logs ratio and speed of every codec on the streams of an id and a log line
+// column. The numbers are only logged, run it with
+// --gtest_also_run_disabled_tests.
+TEST_F(TestCompress, DISABLED_BENCHMARK) {
+    write_ids(0, 1000000);
+    write_strings(1, 100000);
+    for (const Codec& codec : CODECS) {
+        run(codec, true);
+    }
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -18,7 +18,9 @@
 #include "olap/delta_writer.h"
 
 #include <sys/file.h>
+#include <atomic>
 #include <string>
+#include <thread>
 #include <gtest/gtest.h>
 
 #include "gen_cpp/Descriptors_types.h"
@@ -27,6 +29,8 @@
 #include "olap/field.h"
 #include "olap/olap_engine.h"
 #include "olap/olap_table.h"
+#include "olap/reader.h"
+#include "olap/row_cursor.h"
 #include "olap/utils.h"
 #include "runtime/tuple.h"
 #include "util/descriptor_helper.h"
@@ -420,6 +424,199 @@ TEST_F(TestDeltaWriter, write) {
 
 // ######################### ALTER TABLE TEST BEGIN #########################
 
+// Several threads write the same keys into a sharded memtable concurrently.
+// Whether the memtable aggregated equal keys depends on memtable_hash_aggregate
+// (the skiplist does not aggregate under BE_TEST), so the rows are read back
+// through the merge path: each key must come out once, its SUM of all threads.
+static void concurrent_write(bool hash_aggregate) {
+    TCreateTabletReq request;
+    create_table_request(&request);
+    OLAPStatus res = k_engine->create_table(request);
+    ASSERT_EQ(OLAP_SUCCESS, res);
+
+    TDescriptorTable tdesc_tbl = create_descriptor_table();
+    ObjectPool obj_pool;
+    DescriptorTbl* desc_tbl = nullptr;
+    DescriptorTbl::create(&obj_pool, tdesc_tbl, &desc_tbl);
+    TupleDescriptor* tuple_desc = desc_tbl->get_tuple_descriptor(0);
+
+    PUniqueId load_id;
+    load_id.set_hi(0);
+    load_id.set_lo(0);
+    WriteRequest write_req = {10003, 270068375, WriteType::LOAD,
+                              20001, 30001, load_id, false, tuple_desc};
+    int32_t origin_shard_num = config::memtable_shard_num;
+    bool origin_hash_aggregate = config::memtable_hash_aggregate;
+    config::memtable_shard_num = 4;
+    config::memtable_hash_aggregate = hash_aggregate;
+    DeltaWriter* delta_writer = nullptr;
+    DeltaWriter::open(&write_req, &delta_writer);
+    ASSERT_NE(delta_writer, nullptr);
+
+    const std::vector<SlotDescriptor*>& slots = tuple_desc->slots();
+    const int num_keys = 100;
+    const int num_threads = 4;
+    Arena arena;
+    std::vector<Tuple*> tuples;
+    for (int i = 0; i < num_keys; ++i) {
+        Tuple* tuple = reinterpret_cast<Tuple*>(arena.Allocate(tuple_desc->byte_size()));
+        memset(tuple, 0, tuple_desc->byte_size());
+        *(int32_t*)(tuple->get_slot(slots[2]->tuple_offset())) = i;
+        ((DateTimeValue*)(tuple->get_slot(slots[5]->tuple_offset())))->from_date_str("2048-11-10", 10);
+        ((DateTimeValue*)(tuple->get_slot(slots[6]->tuple_offset())))->from_date_str("2636-08-16 19:39:43", 19);
+        ((DateTimeValue*)(tuple->get_slot(slots[15]->tuple_offset())))->from_date_str("2048-11-10", 10);
+        ((DateTimeValue*)(tuple->get_slot(slots[16]->tuple_offset())))->from_date_str("2636-08-16 19:39:43", 19);
+        *(int64_t*)(tuple->get_slot(slots[13]->tuple_offset())) = 1;
+        tuples.push_back(tuple);
+    }
+
+    std::vector<std::thread> threads;
+    std::atomic<int> failed(0);
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&]() {
+            if (delta_writer->write_batch(tuples) != OLAP_SUCCESS) {
+                ++failed;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(0, failed);
+
+    res = delta_writer->close(nullptr);
+    config::memtable_shard_num = origin_shard_num;
+    config::memtable_hash_aggregate = origin_hash_aggregate;
+    ASSERT_EQ(res, OLAP_SUCCESS);
+
+    OLAPTablePtr table = OLAPEngine::get_instance()->get_table(write_req.tablet_id, write_req.schema_hash);
+    TPublishVersionRequest publish_req;
+    publish_req.transaction_id = write_req.transaction_id;
+    TPartitionVersionInfo info;
+    info.partition_id = write_req.partition_id;
+    info.version = table->lastest_version()->end_version() + 1;
+    info.version_hash = table->lastest_version()->version_hash() + 1;
+    std::vector<TPartitionVersionInfo> partition_version_infos;
+    partition_version_infos.push_back(info);
+    publish_req.partition_version_infos = partition_version_infos;
+    std::vector<TTabletId> error_tablet_ids;
+    res = k_engine->publish_version(publish_req, &error_tablet_ids);
+    ASSERT_EQ(OLAP_SUCCESS, res);
+    SAFE_DELETE(delta_writer);
+
+    // The memtable may keep a row per thread and key, never more
+    ASSERT_GE(table->get_num_rows(), num_keys);
+    ASSERT_LE(table->get_num_rows(), num_keys * num_threads);
+
+    std::vector<ColumnData*> data_sources;
+    table->obtain_header_rdlock();
+    table->acquire_data_sources(Version(0, info.version), &data_sources);
+    table->release_header_lock();
+    {
+        ReaderParams params;
+        params.olap_table = table;
+        params.reader_type = READER_CUMULATIVE_COMPACTION;
+        params.olap_data_arr = data_sources;
+        Reader reader;
+        ASSERT_EQ(OLAP_SUCCESS, reader.init(params));
+        RowCursor cursor;
+        ASSERT_EQ(OLAP_SUCCESS, cursor.init(table->tablet_schema()));
+        cursor.allocate_memory_for_string_type(table->tablet_schema());
+        int num_rows = 0;
+        bool eof = false;
+        while (true) {
+            ASSERT_EQ(OLAP_SUCCESS, reader.next_row_with_aggregation(&cursor, &eof));
+            if (eof) {
+                break;
+            }
+            // v4, the BIGINT SUM column
+            ASSERT_EQ(num_threads, *reinterpret_cast<int64_t*>(cursor.get_field_content_ptr(13)));
+            ++num_rows;
+        }
+        ASSERT_EQ(num_keys, num_rows);
+    }
+    table->release_data_sources(&data_sources);
+
+    auto tablet_id = 10003;
+    auto schema_hash = 270068375;
+    res = k_engine->drop_table(tablet_id, schema_hash);
+    ASSERT_EQ(OLAP_SUCCESS, res);
+}
+
+TEST_F(TestDeltaWriter, concurrent_write) {
+    concurrent_write(true);
+}
+
+TEST_F(TestDeltaWriter, concurrent_write_without_hash_aggregate) {
+    concurrent_write(false);
+}
+
+TEST_F(TestDeltaWriter, async_flush) {
+    TCreateTabletReq request;
+    create_table_request(&request);
+    OLAPStatus res = k_engine->create_table(request);
+    ASSERT_EQ(OLAP_SUCCESS, res);
+
+    TDescriptorTable tdesc_tbl = create_descriptor_table();
+    ObjectPool obj_pool;
+    DescriptorTbl* desc_tbl = nullptr;
+    DescriptorTbl::create(&obj_pool, tdesc_tbl, &desc_tbl);
+    TupleDescriptor* tuple_desc = desc_tbl->get_tuple_descriptor(0);
+
+    PUniqueId load_id;
+    load_id.set_hi(0);
+    load_id.set_lo(0);
+    WriteRequest write_req = {10003, 270068375, WriteType::LOAD,
+                              20001, 30001, load_id, false, tuple_desc};
+    // every write fills the memtable, so each row is flushed on its own
+    int32_t origin_buffer_size = config::write_buffer_size;
+    config::write_buffer_size = 1;
+    DeltaWriter* delta_writer = nullptr;
+    DeltaWriter::open(&write_req, &delta_writer);
+    ASSERT_NE(delta_writer, nullptr);
+
+    const std::vector<SlotDescriptor*>& slots = tuple_desc->slots();
+    const int num_keys = 20;
+    Arena arena;
+    for (int i = 0; i < num_keys; ++i) {
+        Tuple* tuple = reinterpret_cast<Tuple*>(arena.Allocate(tuple_desc->byte_size()));
+        memset(tuple, 0, tuple_desc->byte_size());
+        *(int32_t*)(tuple->get_slot(slots[2]->tuple_offset())) = i;
+        ((DateTimeValue*)(tuple->get_slot(slots[5]->tuple_offset())))->from_date_str("2048-11-10", 10);
+        ((DateTimeValue*)(tuple->get_slot(slots[6]->tuple_offset())))->from_date_str("2636-08-16 19:39:43", 19);
+        ((DateTimeValue*)(tuple->get_slot(slots[15]->tuple_offset())))->from_date_str("2048-11-10", 10);
+        ((DateTimeValue*)(tuple->get_slot(slots[16]->tuple_offset())))->from_date_str("2636-08-16 19:39:43", 19);
+        *(int64_t*)(tuple->get_slot(slots[13]->tuple_offset())) = 1;
+        res = delta_writer->write(tuple);
+        ASSERT_EQ(OLAP_SUCCESS, res);
+    }
+    config::write_buffer_size = origin_buffer_size;
+
+    res = delta_writer->close(nullptr);
+    ASSERT_EQ(res, OLAP_SUCCESS);
+
+    OLAPTablePtr table = OLAPEngine::get_instance()->get_table(write_req.tablet_id, write_req.schema_hash);
+    TPublishVersionRequest publish_req;
+    publish_req.transaction_id = write_req.transaction_id;
+    TPartitionVersionInfo info;
+    info.partition_id = write_req.partition_id;
+    info.version = table->lastest_version()->end_version() + 1;
+    info.version_hash = table->lastest_version()->version_hash() + 1;
+    std::vector<TPartitionVersionInfo> partition_version_infos;
+    partition_version_infos.push_back(info);
+    publish_req.partition_version_infos = partition_version_infos;
+    std::vector<TTabletId> error_tablet_ids;
+    res = k_engine->publish_version(publish_req, &error_tablet_ids);
+
+    ASSERT_EQ(num_keys, table->get_num_rows());
+    SAFE_DELETE(delta_writer);
+
+    auto tablet_id = 10003;
+    auto schema_hash = 270068375;
+    res = k_engine->drop_table(tablet_id, schema_hash);
+    ASSERT_EQ(OLAP_SUCCESS, res);
+}
+
 void schema_change_request(const TCreateTabletReq& base_request, TCreateTabletReq* request) {
     //linked schema change, add a value column
     request->tablet_id = base_request.tablet_id + 1;
@@ -22,6 +22,7 @@
 #include "olap/field.h"
 #include "olap/column_predicate.h"
 #include "olap/in_list_predicate.h"
+#include "olap/wrapper_field.h"
 #include "runtime/mem_pool.h"
 #include "runtime/string_value.hpp"
 #include "runtime/vectorized_row_batch.h"
@@ -667,6 +668,48 @@ TEST_F(TestInListPredicate, DATETIME_COLUMN) {
     ASSERT_EQ(datetime::to_datetime_string(*(col_data + sel[0])), "2017-09-10 01:00:00");
 }
 
+static void set_statistic_bound(WrapperField* field, const char* value) {
+    if (value == nullptr) {
+        field->set_null();
+    } else {
+        field->set_not_null();
+        field->from_string(value);
+    }
+}
+
+TEST_F(TestInListPredicate, STATISTIC) {
+    std::unique_ptr<WrapperField> min(WrapperField::create_by_type(OLAP_FIELD_TYPE_INT));
+    std::unique_ptr<WrapperField> max(WrapperField::create_by_type(OLAP_FIELD_TYPE_INT));
+    std::pair<WrapperField*, WrapperField*> statistic(min.get(), max.get());
+    std::set<int32_t> values = {1, 10, 30};
+    InListPredicate<int32_t> in_pred(0, std::move(values));
+    values = {1, 10, 30};
+    NotInListPredicate<int32_t> not_in_pred(0, std::move(values));
+
+    set_statistic_bound(min.get(), "5");
+    set_statistic_bound(max.get(), "20");
+    ASSERT_TRUE(in_pred.evaluate(statistic));
+    ASSERT_TRUE(not_in_pred.evaluate(statistic));
+
+    set_statistic_bound(min.get(), "11");
+    set_statistic_bound(max.get(), "29");
+    ASSERT_FALSE(in_pred.evaluate(statistic));
+
+    set_statistic_bound(min.get(), "10");
+    set_statistic_bound(max.get(), "10");
+    ASSERT_TRUE(in_pred.evaluate(statistic));
+    ASSERT_FALSE(not_in_pred.evaluate(statistic));
+
+    set_statistic_bound(min.get(), nullptr);
+    set_statistic_bound(max.get(), "0");
+    ASSERT_FALSE(in_pred.evaluate(statistic));
+    ASSERT_TRUE(not_in_pred.evaluate(statistic));
+
+    set_statistic_bound(max.get(), nullptr);
+    ASSERT_FALSE(in_pred.evaluate(statistic));
+    ASSERT_FALSE(not_in_pred.evaluate(statistic));
+}
+
 } // namespace doris
 
 int main(int argc, char** argv) {
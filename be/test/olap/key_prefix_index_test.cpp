@@ -0,0 +1,162 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/key_prefix_index.h"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "olap/field_info.h"
+#include "util/logging.h"
+#include "util/slice.h"
+
+namespace doris {
+
+template<typename T>
+static std::string make_cell(T value) {
+    std::string cell(1 + sizeof(T), '\0');
+    memcpy(&cell[1], &value, sizeof(T));
+    return cell;
+}
+
+static std::string make_null_cell(size_t size) {
+    std::string cell(1 + size, '\0');
+    cell[0] = 1;
+    return cell;
+}
+
+static std::string make_string_cell(const std::string& value) {
+    Slice slice(value.data(), value.size());
+    return make_cell(slice);
+}
+
+template<typename T>
+static void check_order(FieldType type, std::vector<T> values) {
+    std::sort(values.begin(), values.end());
+    uint64_t null_prefix = key_prefix(type, sizeof(T), make_null_cell(sizeof(T)).data());
+    uint64_t prev = key_prefix(type, sizeof(T), make_cell(values[0]).data());
+    ASSERT_LT(null_prefix, prev);
+    for (size_t i = 1; i < values.size(); ++i) {
+        uint64_t prefix = key_prefix(type, sizeof(T), make_cell(values[i]).data());
+        ASSERT_LE(prev, prefix);
+        prev = prefix;
+    }
+}
+
+TEST(KeyPrefixIndexTest, integer_prefix) {
+    ASSERT_TRUE(key_prefix_supported(OLAP_FIELD_TYPE_INT));
+    ASSERT_FALSE(key_prefix_supported(OLAP_FIELD_TYPE_DOUBLE));
+
+    check_order<int8_t>(OLAP_FIELD_TYPE_TINYINT, {-128, -1, 0, 1, 127});
+    check_order<int16_t>(OLAP_FIELD_TYPE_SMALLINT, {-32768, -300, -1, 0, 1, 300, 32767});
+    check_order<int32_t>(OLAP_FIELD_TYPE_INT, {INT32_MIN, -65536, -1, 0, 1, 65536, INT32_MAX});
+    check_order<int64_t>(OLAP_FIELD_TYPE_BIGINT,
+                         {INT64_MIN, -(1L << 40), -1, 0, 1, 255, 256, 1L << 40, INT64_MAX});
+    check_order<int128_t>(OLAP_FIELD_TYPE_LARGEINT,
+                          {-(static_cast<int128_t>(1) << 100), -1, 0, 1,
+                           static_cast<int128_t>(1) << 100});
+
+    // small integers keep all their bits
+    uint64_t a = key_prefix(OLAP_FIELD_TYPE_INT, 4, make_cell<int32_t>(7).data());
+    uint64_t b = key_prefix(OLAP_FIELD_TYPE_INT, 4, make_cell<int32_t>(8).data());
+    ASSERT_LT(a, b);
+    // big ones lose the lowest byte
+    a = key_prefix(OLAP_FIELD_TYPE_BIGINT, 8, make_cell<int64_t>(256).data());
+    b = key_prefix(OLAP_FIELD_TYPE_BIGINT, 8, make_cell<int64_t>(257).data());
+    ASSERT_EQ(a, b);
+}
+
+TEST(KeyPrefixIndexTest, string_prefix) {
+    std::vector<std::string> values = {"", "a", "ab", "abc", "abcdefg", "abcdefgh", "b", "\xff"};
+    uint64_t prev = key_prefix(OLAP_FIELD_TYPE_VARCHAR, 20, make_null_cell(sizeof(Slice)).data());
+    for (auto& value : values) {
+        uint64_t prefix = key_prefix(OLAP_FIELD_TYPE_VARCHAR, 20, make_string_cell(value).data());
+        ASSERT_LE(prev, prefix);
+        prev = prefix;
+    }
+    uint64_t a = key_prefix(OLAP_FIELD_TYPE_CHAR, 10, make_string_cell("abcdefg").data());
+    uint64_t b = key_prefix(OLAP_FIELD_TYPE_CHAR, 10, make_string_cell("abcdefgh").data());
+    ASSERT_EQ(a, b);
+
+    // varchar keys are compared on the bytes of the index only
+    a = key_prefix(OLAP_FIELD_TYPE_VARCHAR, 5, make_string_cell("abc").data());
+    b = key_prefix(OLAP_FIELD_TYPE_VARCHAR, 5, make_string_cell("abcd").data());
+    ASSERT_EQ(a, b);
+}
+
+// first entry not less than (strict is false) or greater than key
+static uint32_t expected_bound(const std::vector<uint64_t>& prefixes, uint64_t key, bool strict) {
+    if (strict) {
+        return std::upper_bound(prefixes.begin(), prefixes.end(), key) - prefixes.begin();
+    }
+    return std::lower_bound(prefixes.begin(), prefixes.end(), key) - prefixes.begin();
+}
+
+TEST(KeyPrefixIndexTest, narrow) {
+    KeyPrefixIndex index;
+    uint32_t first = 0;
+    uint32_t last = 10;
+    index.narrow(5, &first, &last);
+    ASSERT_EQ(0, first);
+    ASSERT_EQ(10, last);
+
+    srand(1);
+    for (uint32_t num_entries : {1, 2, 15, 16, 17, 100, 1000, 4097}) {
+        for (uint32_t interval : {1, 3, 16}) {
+            std::vector<uint64_t> prefixes;
+            for (uint32_t i = 0; i < num_entries; ++i) {
+                prefixes.push_back(rand() % (num_entries / 4 + 2) * 2);
+            }
+            std::sort(prefixes.begin(), prefixes.end());
+            index.init(prefixes, interval);
+            ASSERT_FALSE(index.empty());
+
+            for (uint64_t key = 0; key <= prefixes.back() + 2; ++key) {
+                uint32_t first = 0;
+                uint32_t last = num_entries;
+                index.narrow(key, &first, &last);
+                ASSERT_LE(first, last);
+                for (bool strict : {false, true}) {
+                    uint32_t bound = expected_bound(prefixes, key, strict);
+                    ASSERT_LE(first, bound) << num_entries << " " << interval << " " << key;
+                    ASSERT_GE(last, bound) << num_entries << " " << interval << " " << key;
+                }
+                // at most two intervals are left to search
+                ASSERT_LE(last - first, 2 * interval + expected_bound(prefixes, key, true)
+                          - expected_bound(prefixes, key, false));
+            }
+        }
+    }
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,332 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/loser_tree.h"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "olap/field_info.h"
+#include "olap/reader.h"
+#include "olap/row_cursor.h"
+#include "olap/tuple.h"
+#include "util/logging.h"
+#include "util/stopwatch.hpp"
+
+namespace doris {
+
+// A sorted run of one version, merged as CollectIterator merges its children
+struct Source {
+    std::vector<int64_t> keys;
+    size_t pos = 0;
+    int32_t version = 0;
+
+    int64_t key() const { return keys[pos]; }
+};
+
+// key ascending, then version ascending
+struct SourceLess {
+    bool operator()(const Source& a, const Source& b) const {
+        if (a.key() != b.key()) {
+            return a.key() < b.key();
+        }
+        return a.version < b.version;
+    }
+};
+
+struct SourceGreater {
+    bool operator()(const Source* a, const Source* b) const {
+        return SourceLess()(*b, *a);
+    }
+};
+
+class TestLoserTree : public testing::Test {
+public:
+    // num_rows keys spread over num_sources sorted sources. With run_length 1
+    // the sources interleave row by row, longer runs give each source ranges
+    // of consecutive keys of its own, as versions loaded in key order do.
+    void generate(int num_sources, int num_rows, int run_length) {
+        _sources.assign(num_sources, Source());
+        for (int i = 0; i < num_sources; ++i) {
+            _sources[i].version = i;
+        }
+        int64_t key = 0;
+        for (int i = 0; i < num_rows; ++i) {
+            int source = run_length == 1 ? rand() % num_sources
+                : (i / run_length) % num_sources;
+            _sources[source].keys.push_back(key);
+            // duplicated keys across versions
+            if (rand() % 4 != 0) {
+                ++key;
+            }
+        }
+    }
+
+    std::vector<Source*> start() {
+        std::vector<Source*> items;
+        for (Source& source : _sources) {
+            source.pos = 0;
+            if (!source.keys.empty()) {
+                items.push_back(&source);
+            }
+        }
+        return items;
+    }
+
+    // advance the winner, nullptr when it is exhausted
+    static Source* advance(Source* source) {
+        return ++source->pos < source->keys.size() ? source : nullptr;
+    }
+
+    // (key, version) of every row in merge order
+    std::vector<std::pair<int64_t, int32_t>> merge_with_tree() {
+        std::vector<std::pair<int64_t, int32_t>> rows;
+        LoserTree<Source, SourceLess> tree;
+        tree.init(start());
+        for (Source* top = tree.top(); top != nullptr; top = tree.top()) {
+            rows.emplace_back(top->key(), top->version);
+            tree.next(advance(top));
+        }
+        return rows;
+    }
+
+    // the binary heap merge CollectIterator used before the loser tree
+    std::vector<std::pair<int64_t, int32_t>> merge_with_heap() {
+        std::vector<std::pair<int64_t, int32_t>> rows;
+        std::priority_queue<Source*, std::vector<Source*>, SourceGreater> heap;
+        for (Source* source : start()) {
+            heap.push(source);
+        }
+        while (!heap.empty()) {
+            Source* top = heap.top();
+            rows.emplace_back(top->key(), top->version);
+            heap.pop();
+            if (advance(top) != nullptr) {
+                heap.push(top);
+            }
+        }
+        return rows;
+    }
+
+    std::vector<std::pair<int64_t, int32_t>> expected_rows() {
+        std::vector<std::pair<int64_t, int32_t>> rows;
+        for (const Source& source : _sources) {
+            for (int64_t key : source.keys) {
+                rows.emplace_back(key, source.version);
+            }
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    std::vector<Source> _sources;
+};
+
+TEST_F(TestLoserTree, empty) {
+    LoserTree<Source, SourceLess> tree;
+    tree.init(std::vector<Source*>());
+    ASSERT_EQ(nullptr, tree.top());
+}
+
+TEST_F(TestLoserTree, merge) {
+    for (int num_sources : {1, 2, 3, 7, 16, 33}) {
+        for (int run_length : {1, 5, 100}) {
+            generate(num_sources, 5000, run_length);
+            ASSERT_EQ(expected_rows(), merge_with_tree());
+        }
+    }
+}
+
+TEST_F(TestLoserTree, empty_sources) {
+    // sources without rows between non empty ones
+    generate(10, 3, 1);
+    ASSERT_EQ(expected_rows(), merge_with_tree());
+}
+
+// Compares the loser tree with the binary heap CollectIterator used before,
+// for 2 to 200 versions of a tablet. The numbers are only logged, run it with
+// --gtest_also_run_disabled_tests.
+TEST_F(TestLoserTree, DISABLED_BENCHMARK) {
+    const int num_rows = 2000000;
+    for (int run_length : {1, 1000}) {
+        for (int num_sources : {2, 10, 50, 100, 200}) {
+            generate(num_sources, num_rows, run_length);
+            MonotonicStopWatch watch;
+            watch.start();
+            size_t tree_rows = merge_with_tree().size();
+            uint64_t tree_ns = watch.elapsed_time();
+            watch.start();
+            size_t heap_rows = merge_with_heap().size();
+            uint64_t heap_ns = watch.elapsed_time();
+            ASSERT_EQ(heap_rows, tree_rows);
+            LOG(INFO) << "versions=" << num_sources
+                      << " run_length=" << run_length
+                      << " loser_tree_rows/sec="
+                      << static_cast<int64_t>(num_rows * 1000000000.0 / tree_ns)
+                      << " heap_rows/sec="
+                      << static_cast<int64_t>(num_rows * 1000000000.0 / heap_ns);
+        }
+    }
+}
+
+// Rows of a single key column, whose KeyPrefix orders them as CollectIterator
+// orders its children
+class TestKeyPrefix : public testing::Test {
+public:
+    void set_key_type(FieldType type, uint32_t length) {
+        FieldInfo field_info;
+        field_info.name = "k1";
+        field_info.type = type;
+        field_info.aggregation = OLAP_FIELD_AGGREGATION_NONE;
+        field_info.length = length;
+        field_info.index_length = length;
+        field_info.is_key = true;
+        field_info.is_allow_null = true;
+        field_info.unique_id = 0;
+        field_info.is_bf_column = false;
+        _schema.assign(1, field_info);
+    }
+
+    // "NULL" is a null key
+    void init_row(const std::string& value, RowCursor* row, KeyPrefix* prefix) {
+        ASSERT_EQ(OLAP_SUCCESS, row->init(_schema));
+        ASSERT_EQ(OLAP_SUCCESS, row->allocate_memory_for_string_type(_schema));
+        OlapTuple tuple;
+        tuple.add_value(value, value == "NULL");
+        ASSERT_EQ(OLAP_SUCCESS, row->from_tuple(tuple));
+        prefix->update(_schema[0].type, *row);
+        ASSERT_TRUE(prefix->valid);
+    }
+
+    // Returns KeyPrefix::compare() of a and b, after checking that it agrees
+    // with the full key compare when it is not 0
+    int compare(const std::string& a, const std::string& b) {
+        RowCursor a_row;
+        RowCursor b_row;
+        KeyPrefix a_prefix;
+        KeyPrefix b_prefix;
+        init_row(a, &a_row, &a_prefix);
+        init_row(b, &b_row, &b_prefix);
+        int prefix_cmp = KeyPrefix::compare(a_prefix, b_prefix);
+        int full_cmp = a_row.full_key_cmp(b_row);
+        EXPECT_EQ(-prefix_cmp, KeyPrefix::compare(b_prefix, a_prefix));
+        if (prefix_cmp != 0) {
+            EXPECT_EQ(prefix_cmp < 0, full_cmp < 0) << a << " " << b;
+            EXPECT_NE(0, full_cmp) << a << " " << b;
+        }
+        return prefix_cmp;
+    }
+
+    std::vector<FieldInfo> _schema;
+};
+
+TEST_F(TestKeyPrefix, get_key_prefix) {
+    uint64_t a = 0;
+    uint64_t b = 0;
+    int8_t tiny[] = {-128, 127};
+    ASSERT_TRUE(get_key_prefix(OLAP_FIELD_TYPE_TINYINT, (const char*)&tiny[0], &a));
+    ASSERT_TRUE(get_key_prefix(OLAP_FIELD_TYPE_TINYINT, (const char*)&tiny[1], &b));
+    ASSERT_LT(a, b);
+    uint64_t big[] = {0, UINT64_MAX};
+    ASSERT_TRUE(get_key_prefix(OLAP_FIELD_TYPE_UNSIGNED_BIGINT, (const char*)&big[0], &a));
+    ASSERT_TRUE(get_key_prefix(OLAP_FIELD_TYPE_UNSIGNED_BIGINT, (const char*)&big[1], &b));
+    ASSERT_LT(a, b);
+    Slice empty;
+    Slice padded("ab\0", 3);
+    Slice longer("abcdefghijk");
+    ASSERT_TRUE(get_key_prefix(OLAP_FIELD_TYPE_VARCHAR, (const char*)&empty, &a));
+    ASSERT_EQ(0UL, a);
+    ASSERT_TRUE(get_key_prefix(OLAP_FIELD_TYPE_CHAR, (const char*)&padded, &a));
+    ASSERT_EQ(0x6162000000000000ULL, a);
+    ASSERT_TRUE(get_key_prefix(OLAP_FIELD_TYPE_VARCHAR, (const char*)&longer, &b));
+    ASSERT_EQ(0x6162636465666768ULL, b);
+    // no prefix for the other types
+    double d = 1.0;
+    ASSERT_FALSE(get_key_prefix(OLAP_FIELD_TYPE_DOUBLE, (const char*)&d, &a));
+}
+
+TEST_F(TestKeyPrefix, integers) {
+    set_key_type(OLAP_FIELD_TYPE_INT, 4);
+    ASSERT_LT(compare("-1", "1"), 0);
+    ASSERT_LT(compare("-2147483648", "2147483647"), 0);
+    ASSERT_EQ(0, compare("7", "7"));
+    set_key_type(OLAP_FIELD_TYPE_BIGINT, 8);
+    ASSERT_LT(compare("-9223372036854775808", "-1"), 0);
+    ASSERT_GT(compare("9223372036854775807", "0"), 0);
+}
+
+TEST_F(TestKeyPrefix, largeint) {
+    set_key_type(OLAP_FIELD_TYPE_LARGEINT, 16);
+    ASSERT_LT(compare("-170141183460469231731687303715884105728", "0"), 0);
+    ASSERT_LT(compare("-1", "1"), 0);
+    // 2^64 and 2^65 differ in the high 64 bits
+    ASSERT_LT(compare("18446744073709551616", "36893488147419103232"), 0);
+    // only the low 64 bits differ, the full keys decide
+    ASSERT_EQ(0, compare("1", "2"));
+    ASSERT_EQ(0, compare("18446744073709551617", "18446744073709551618"));
+}
+
+TEST_F(TestKeyPrefix, null) {
+    set_key_type(OLAP_FIELD_TYPE_INT, 4);
+    ASSERT_LT(compare("NULL", "-2147483648"), 0);
+    ASSERT_GT(compare("0", "NULL"), 0);
+    ASSERT_EQ(0, compare("NULL", "NULL"));
+    set_key_type(OLAP_FIELD_TYPE_VARCHAR, 16 + OLAP_STRING_MAX_BYTES);
+    ASSERT_LT(compare("NULL", ""), 0);
+}
+
+TEST_F(TestKeyPrefix, char_padding) {
+    // CHAR values are padded with zeros to their length, as the prefix of
+    // shorter values is
+    set_key_type(OLAP_FIELD_TYPE_CHAR, 12);
+    ASSERT_LT(compare("ab", "abc"), 0);
+    ASSERT_LT(compare("ab", "b"), 0);
+    ASSERT_EQ(0, compare("ab", "ab"));
+    // the first 8 bytes are equal, the full keys decide
+    ASSERT_EQ(0, compare("abcdefgh", "abcdefghij"));
+    ASSERT_EQ(0, compare("abcdefghik", "abcdefghij"));
+}
+
+TEST_F(TestKeyPrefix, varchar) {
+    set_key_type(OLAP_FIELD_TYPE_VARCHAR, 16 + OLAP_STRING_MAX_BYTES);
+    ASSERT_LT(compare("", "a"), 0);
+    ASSERT_LT(compare("ab", "abc"), 0);
+    // bytes compare unsigned
+    ASSERT_LT(compare("a", "\xff"), 0);
+    ASSERT_LT(compare("zzzz", "\xe4\xb8\xad"), 0);
+    // equal prefixes fall back to the full compare
+    ASSERT_EQ(0, compare("12345678", "123456789"));
+    ASSERT_EQ(0, compare("123456789b", "123456789a"));
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -15,6 +15,8 @@
 // specific language governing permissions and limitations
 // under the License.
 
+#include <math.h>
+#include <random>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -79,6 +81,38 @@ public:
         delete _cache;
     }
 
+    void SetPolicy(CacheEvictionPolicy eviction, bool tinylfu_admission) {
+        delete _cache;
+        CachePolicy policy;
+        policy.eviction = eviction;
+        policy.tinylfu_admission = tinylfu_admission;
+        _cache = new_cache(kCacheSize, policy);
+    }
+
+    // Look up key, inserting it on a miss, as the storage engine caches do.
+    // Return true on a hit.
+    bool Access(int key) {
+        std::string result;
+        Cache::Handle* handle = _cache->lookup(EncodeKey(&result, key));
+        if (handle == NULL) {
+            Insert(key, key, 1);
+            return false;
+        }
+        _cache->release(handle);
+        return true;
+    }
+
+    double ProtectedUsage() {
+        rapidjson::Document document;
+        document.SetArray();
+        _cache->get_cache_status(&document);
+        double usage = 0;
+        for (rapidjson::SizeType i = 0; i < document.Size(); ++i) {
+            usage += document[i]["protected_usage"].GetDouble();
+        }
+        return usage;
+    }
+
     int Lookup(int key) {
         std::string result;
         Cache::Handle* handle = _cache->lookup(EncodeKey(&result, key));
@@ -228,12 +262,126 @@ TEST_F(CacheTest, HeavyEntries) {
     ASSERT_LE(cached_weight, kCacheSize + kCacheSize / 10);
 }
 
+// hot keys looked up twice, then a scan of twice the capacity
+static void scan_after_hot_keys(CacheTest* test, int num_hot) {
+    for (int i = 0; i < num_hot; i++) {
+        test->Insert(i, 1000 + i, 1);
+        ASSERT_EQ(1000 + i, test->Lookup(i));
+    }
+    for (int i = 0; i < 2 * CacheTest::kCacheSize; i++) {
+        test->Insert(100000 + i, i, 1);
+    }
+}
+
+TEST_F(CacheTest, LruEvictedByScan) {
+    scan_after_hot_keys(this, 100);
+    int num_cached = 0;
+    for (int i = 0; i < 100; i++) {
+        num_cached += Lookup(i) >= 0;
+    }
+    ASSERT_EQ(0, num_cached);
+}
+
+TEST_F(CacheTest, SegmentedLruResistsScan) {
+    SetPolicy(CACHE_EVICTION_SLRU, false);
+    scan_after_hot_keys(this, 100);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(1000 + i, Lookup(i));
+    }
+}
+
+TEST_F(CacheTest, SegmentedLruErase) {
+    SetPolicy(CACHE_EVICTION_SLRU, false);
+    Insert(100, 101, 3);
+    ASSERT_EQ(0, ProtectedUsage());
+    ASSERT_EQ(101, Lookup(100));
+    ASSERT_EQ(3, ProtectedUsage());
+    Erase(100);
+    ASSERT_EQ(0, ProtectedUsage());
+    ASSERT_EQ(-1, Lookup(100));
+    ASSERT_EQ(1, _deleted_keys.size());
+}
+
+TEST_F(CacheTest, TinyLfuRejectsColdEntries) {
+    SetPolicy(CACHE_EVICTION_LRU, true);
+    // fill the cache with keys looked up three times
+    for (int i = 0; i < 2 * kCacheSize; i++) {
+        for (int j = 0; j < 3; j++) {
+            Access(i);
+        }
+    }
+    int num_cached = 0;
+    for (int i = 0; i < 2 * kCacheSize; i++) {
+        num_cached += Lookup(i) >= 0;
+    }
+    ASSERT_GT(num_cached, 0);
+    // keys never looked up are not admitted, but for a few whose estimated
+    // frequency is raised by other keys sharing counters of the sketch
+    for (int i = 0; i < kCacheSize; i++) {
+        Insert(100000 + i, i, 1);
+    }
+    int num_admitted = 0;
+    for (int i = 0; i < kCacheSize; i++) {
+        num_admitted += Lookup(100000 + i) >= 0;
+    }
+    ASSERT_LT(num_admitted, kCacheSize / 20);
+}
+
 TEST_F(CacheTest, NewId) {
     uint64_t a = _cache->new_id();
     uint64_t b = _cache->new_id();
     ASSERT_NE(a, b);
 }
 
+// Replays traces of point lookups on a skewed hot set mixed with scans that
+// read each key once, and logs the hit rates of every policy. The numbers
+// are only logged, run it with --gtest_also_run_disabled_tests.
+TEST_F(CacheTest, DISABLED_BENCHMARK) {
+    struct Trace {
+        const char* name;
+        // one scan of scan_length keys after every scan_interval lookups
+        int scan_interval;
+        int scan_length;
+    };
+    const Trace traces[] = {
+        {"point_lookups", 0, 0},
+        {"small_scans", 20000, 2 * kCacheSize},
+        {"large_scans", 50000, 20 * kCacheSize},
+    };
+    const int num_lookups = 1000000;
+    const int num_hot_keys = 10 * kCacheSize;
+    for (const Trace& trace : traces) {
+        for (CacheEvictionPolicy eviction : {CACHE_EVICTION_LRU, CACHE_EVICTION_SLRU}) {
+            for (bool tinylfu_admission : {false, true}) {
+                SetPolicy(eviction, tinylfu_admission);
+                std::mt19937 rand(0);
+                std::uniform_real_distribution<double> uniform(0, 1);
+                int scan_key = 1 << 30;
+                int64_t lookup_hits = 0;
+                int64_t scan_hits = 0;
+                int64_t num_scanned = 0;
+                for (int i = 0; i < num_lookups; i++) {
+                    // about 80% of lookups on 2% of the hot keys
+                    int key = static_cast<int>(pow(uniform(rand), 8) * num_hot_keys);
+                    lookup_hits += Access(key);
+                    if (trace.scan_interval > 0 && (i + 1) % trace.scan_interval == 0) {
+                        for (int j = 0; j < trace.scan_length; j++) {
+                            scan_hits += Access(scan_key++);
+                        }
+                        num_scanned += trace.scan_length;
+                    }
+                }
+                LOG(INFO) << "trace=" << trace.name
+                          << " eviction=" << (eviction == CACHE_EVICTION_SLRU ? "slru" : "lru")
+                          << " tinylfu=" << tinylfu_admission
+                          << " lookup_hit_rate=" << static_cast<double>(lookup_hits) / num_lookups
+                          << " total_hit_rate="
+                          << static_cast<double>(lookup_hits + scan_hits) / (num_lookups + num_scanned);
+            }
+        }
+    }
+}
+
 }  // namespace doris
 
 int main(int argc, char** argv) {
@@ -0,0 +1,267 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/memtable.h"
+
+#include <stdlib.h>
+#include <map>
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "common/object_pool.h"
+#include "gen_cpp/Descriptors_types.h"
+#include "olap/field.h"
+#include "olap/schema.h"
+#include "runtime/descriptors.h"
+#include "runtime/tuple.h"
+#include "util/arena.h"
+#include "util/descriptor_helper.h"
+#include "util/logging.h"
+#include "util/stopwatch.hpp"
+
+namespace doris {
+
+static const int NUM_ROWS = 10000;
+
+// k1 BIGINT, k2 INT, v1 BIGINT SUM, v2 BIGINT REPLACE
+class TestMemTable : public testing::Test {
+public:
+    TestMemTable() : _tuple_desc(nullptr) {}
+
+    void SetUp() {
+        TDescriptorTableBuilder dtb;
+        TTupleDescriptorBuilder tuple_builder;
+        tuple_builder.add_slot(
+            TSlotDescriptorBuilder().type(TYPE_BIGINT).column_name("k1").column_pos(0).build());
+        tuple_builder.add_slot(
+            TSlotDescriptorBuilder().type(TYPE_INT).column_name("k2").column_pos(1).build());
+        tuple_builder.add_slot(
+            TSlotDescriptorBuilder().type(TYPE_BIGINT).column_name("v1").column_pos(2).build());
+        tuple_builder.add_slot(
+            TSlotDescriptorBuilder().type(TYPE_BIGINT).column_name("v2").column_pos(3).build());
+        tuple_builder.build(&dtb);
+        DescriptorTbl* desc_tbl = nullptr;
+        DescriptorTbl::create(&_obj_pool, dtb.desc_tbl(), &desc_tbl);
+        _tuple_desc = desc_tbl->get_tuple_descriptor(0);
+
+        add_field("k1", OLAP_FIELD_TYPE_BIGINT, 8, true, OLAP_FIELD_AGGREGATION_NONE);
+        add_field("k2", OLAP_FIELD_TYPE_INT, 4, true, OLAP_FIELD_AGGREGATION_NONE);
+        add_field("v1", OLAP_FIELD_TYPE_BIGINT, 8, false, OLAP_FIELD_AGGREGATION_SUM);
+        add_field("v2", OLAP_FIELD_TYPE_BIGINT, 8, false, OLAP_FIELD_AGGREGATION_REPLACE);
+        _schema.reset(new Schema(_field_infos));
+        for (uint32_t i = 0; i < _field_infos.size(); ++i) {
+            _col_ids.push_back(i);
+        }
+    }
+
+    void add_field(const std::string& name, FieldType type, uint32_t length, bool is_key,
+                   FieldAggregationMethod aggregation) {
+        FieldInfo field_info;
+        field_info.name = name;
+        field_info.type = type;
+        field_info.aggregation = aggregation;
+        field_info.length = length;
+        field_info.index_length = length;
+        field_info.is_key = is_key;
+        field_info.is_allow_null = true;
+        field_info.unique_id = _field_infos.size();
+        field_info.is_bf_column = false;
+        _field_infos.push_back(field_info);
+    }
+
+    // rows with few distinct k1, so that many rows share a prefix of the key. v1
+    // is 1 and v2 the index of the row.
+    std::vector<Tuple*> generate_tuples(int num_rows, int k1_cardinality = 100,
+                                        int k2_cardinality = 1000) {
+        const std::vector<SlotDescriptor*>& slots = _tuple_desc->slots();
+        std::vector<Tuple*> tuples;
+        for (int i = 0; i < num_rows; ++i) {
+            Tuple* tuple = reinterpret_cast<Tuple*>(_arena.Allocate(_tuple_desc->byte_size()));
+            memset(tuple, 0, _tuple_desc->byte_size());
+            *(int64_t*)(tuple->get_slot(slots[0]->tuple_offset())) = rand() % k1_cardinality;
+            *(int32_t*)(tuple->get_slot(slots[1]->tuple_offset())) = rand() % k2_cardinality;
+            *(int64_t*)(tuple->get_slot(slots[2]->tuple_offset())) = 1;
+            *(int64_t*)(tuple->get_slot(slots[3]->tuple_offset())) = i;
+            tuples.push_back(tuple);
+        }
+        return tuples;
+    }
+
+    MemTable* create_mem_table(KeysType keys_type, bool sort_dup_keys_on_flush,
+                               bool hash_aggregate, int num_shards) {
+        bool origin_sort = config::memtable_sort_dup_keys_on_flush;
+        bool origin_hash = config::memtable_hash_aggregate;
+        config::memtable_sort_dup_keys_on_flush = sort_dup_keys_on_flush;
+        config::memtable_hash_aggregate = hash_aggregate;
+        MemTable* mem_table = new MemTable(_schema.get(), &_field_infos, &_col_ids,
+                                           _tuple_desc, keys_type, num_shards);
+        config::memtable_sort_dup_keys_on_flush = origin_sort;
+        config::memtable_hash_aggregate = origin_hash;
+        return mem_table;
+    }
+
+    std::vector<const char*> sorted_rows(MemTable* mem_table) {
+        std::vector<const char*> rows;
+        OLAPStatus res = mem_table->_visit_sorted_rows([&rows](const char* row) {
+            rows.push_back(row);
+            return OLAP_SUCCESS;
+        });
+        EXPECT_EQ(OLAP_SUCCESS, res);
+        return rows;
+    }
+
+    std::pair<int64_t, int32_t> key_of(const char* row) {
+        return std::make_pair(*(const int64_t*)(row + _schema->get_col_offset(0) + 1),
+                              *(const int32_t*)(row + _schema->get_col_offset(1) + 1));
+    }
+
+    int64_t value_of(const char* row, int col) {
+        return *(const int64_t*)(row + _schema->get_col_offset(col) + 1);
+    }
+
+    void bench(KeysType keys_type, const char* keys_type_name,
+               const std::vector<Tuple*>& tuples) {
+        for (bool sort_on_flush : {false, true}) {
+            std::unique_ptr<MemTable> mem_table(
+                    create_mem_table(keys_type, sort_on_flush, sort_on_flush, 1));
+            MonotonicStopWatch watch;
+            watch.start();
+            for (Tuple* tuple : tuples) {
+                mem_table->insert(tuple);
+            }
+            uint64_t insert_ns = watch.elapsed_time();
+            size_t num_rows = sorted_rows(mem_table.get()).size();
+            uint64_t total_ns = watch.elapsed_time();
+            LOG(INFO) << "keys_type=" << keys_type_name
+                      << " path=" << (sort_on_flush ? "sort_on_flush" : "skip_list")
+                      << " input_rows=" << tuples.size()
+                      << " output_rows=" << num_rows
+                      << " insert_ms=" << insert_ns / 1000000
+                      << " flush_ms=" << (total_ns - insert_ns) / 1000000
+                      << " rows/sec=" << static_cast<int64_t>(tuples.size() * 1000000000.0 / total_ns)
+                      << " memory_usage=" << mem_table->memory_usage();
+        }
+    }
+
+    ObjectPool _obj_pool;
+    TupleDescriptor* _tuple_desc;
+    std::vector<FieldInfo> _field_infos;
+    std::vector<uint32_t> _col_ids;
+    std::unique_ptr<Schema> _schema;
+    Arena _arena;
+};
+
+// The hash aggregation config does not change DUP_KEYS memtables.
+TEST_F(TestMemTable, sort_dup_keys_on_flush) {
+    std::vector<Tuple*> tuples = generate_tuples(NUM_ROWS);
+    for (bool hash_aggregate : {false, true}) {
+        for (int num_shards : {1, 4}) {
+            std::unique_ptr<MemTable> skip_list_table(
+                    create_mem_table(KeysType::DUP_KEYS, false, hash_aggregate, num_shards));
+            std::unique_ptr<MemTable> sorted_table(
+                    create_mem_table(KeysType::DUP_KEYS, true, hash_aggregate, num_shards));
+            for (Tuple* tuple : tuples) {
+                skip_list_table->insert(tuple);
+                sorted_table->insert(tuple);
+            }
+
+            std::vector<const char*> expected = sorted_rows(skip_list_table.get());
+            std::vector<const char*> actual = sorted_rows(sorted_table.get());
+            ASSERT_EQ(NUM_ROWS, expected.size());
+            ASSERT_EQ(NUM_ROWS, actual.size());
+            for (int i = 0; i < NUM_ROWS; ++i) {
+                ASSERT_EQ(key_of(expected[i]), key_of(actual[i]));
+                if (i > 0) {
+                    ASSERT_LE(_schema->compare(actual[i - 1], actual[i]), 0);
+                }
+            }
+        }
+    }
+}
+
+// AGG_KEYS and UNIQUE_KEYS memtables with each of the two configs on and off.
+// The sort on flush config only applies to DUP_KEYS. With hash aggregation each
+// key comes out once, v1 summed and v2 the value of the last row inserted. The
+// skiplist does not aggregate under BE_TEST, so without hash aggregation only
+// the order of the rows and the sum over all of them are checked.
+TEST_F(TestMemTable, hash_aggregate) {
+    std::vector<Tuple*> tuples = generate_tuples(NUM_ROWS, 10, 100);
+    std::map<std::pair<int64_t, int32_t>, int64_t> last_values;
+    const std::vector<SlotDescriptor*>& slots = _tuple_desc->slots();
+    for (Tuple* tuple : tuples) {
+        std::pair<int64_t, int32_t> key(*(int64_t*)(tuple->get_slot(slots[0]->tuple_offset())),
+                                        *(int32_t*)(tuple->get_slot(slots[1]->tuple_offset())));
+        last_values[key] = *(int64_t*)(tuple->get_slot(slots[3]->tuple_offset()));
+    }
+    for (KeysType keys_type : {KeysType::AGG_KEYS, KeysType::UNIQUE_KEYS}) {
+        for (bool sort_dup_keys_on_flush : {false, true}) {
+            for (bool hash_aggregate : {false, true}) {
+                for (int num_shards : {1, 4}) {
+                    std::unique_ptr<MemTable> mem_table(create_mem_table(
+                            keys_type, sort_dup_keys_on_flush, hash_aggregate, num_shards));
+                    for (Tuple* tuple : tuples) {
+                        mem_table->insert(tuple);
+                    }
+                    std::vector<const char*> rows = sorted_rows(mem_table.get());
+                    int64_t sum = 0;
+                    for (size_t i = 0; i < rows.size(); ++i) {
+                        ASSERT_EQ(1, last_values.count(key_of(rows[i])));
+                        if (i > 0) {
+                            ASSERT_LE(_schema->compare(rows[i - 1], rows[i]), 0);
+                        }
+                        sum += value_of(rows[i], 2);
+                    }
+                    ASSERT_EQ(NUM_ROWS, sum);
+                    if (!hash_aggregate) {
+                        continue;
+                    }
+                    ASSERT_EQ(last_values.size(), rows.size());
+                    auto it = last_values.begin();
+                    for (const char* row : rows) {
+                        ASSERT_EQ(it->first, key_of(row));
+                        ASSERT_EQ(it->second, value_of(row, 3));
+                        ++it;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Compares insert plus sort of the skiplist and the sort on flush path. The
+// numbers are only logged, run it with --gtest_also_run_disabled_tests. BE_TEST
+// builds do not aggregate in the skiplist, so for AGG_KEYS that path keeps
+// every row.
+TEST_F(TestMemTable, DISABLED_BENCHMARK) {
+    const int num_rows = 500000;
+    bench(KeysType::DUP_KEYS, "DUP_KEYS", generate_tuples(num_rows));
+    // about 50 rows per key, as in metric rollups
+    bench(KeysType::AGG_KEYS, "AGG_KEYS", generate_tuples(num_rows, 100, 100));
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,341 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/ngram_bloom_filter.h"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "olap/bloom_filter_reader.h"
+#include "olap/column_writer.h"
+#include "olap/delete_handler.h"
+#include "olap/olap_cond.h"
+#include "olap/olap_engine.h"
+#include "olap/olap_table.h"
+#include "olap/out_stream.h"
+#include "olap/row_block.h"
+#include "olap/row_cursor.h"
+#include "olap/segment_group.h"
+#include "olap/segment_reader.h"
+#include "olap/store.h"
+#include "util/logging.h"
+
+namespace doris {
+
+static std::vector<std::string> fragments_of(const std::string& pattern) {
+    std::vector<std::string> fragments;
+    like_pattern_fragments(pattern, &fragments);
+    return fragments;
+}
+
+TEST(NgramBloomFilterTest, like_pattern_fragments) {
+    ASSERT_EQ(std::vector<std::string>({"foo"}), fragments_of("%foo%"));
+    ASSERT_EQ(std::vector<std::string>({"foo"}), fragments_of("foo"));
+    ASSERT_EQ(std::vector<std::string>({"ab", "cd", "ef"}), fragments_of("ab%cd_ef%%"));
+    ASSERT_EQ(std::vector<std::string>(), fragments_of("%_%"));
+    // escaped wildcards are literal
+    ASSERT_EQ(std::vector<std::string>({"a%b_c\\d"}), fragments_of("%a\\%b\\_c\\\\d%"));
+}
+
+TEST(NgramBloomFilterTest, ngram_hashes) {
+    std::vector<uint64_t> hashes;
+    ngram_hashes({"ab", "abcd"}, 3, &hashes);
+    ASSERT_EQ(2, hashes.size());
+    ASSERT_EQ(ngram_hash("abc", 3), hashes[0]);
+    ASSERT_EQ(ngram_hash("bcd", 3), hashes[1]);
+    ASSERT_NE(ngram_hash("abc", 3), ngram_hash("abc", 2));
+
+    // invalid gram sizes have no ngrams
+    hashes.clear();
+    ngram_hashes({"abcdefghijk"}, 0, &hashes);
+    ngram_hashes({"abcdefghijk"}, MAX_NGRAM_SIZE + 1, &hashes);
+    ASSERT_TRUE(hashes.empty());
+}
+
+TEST(NgramBloomFilterTest, test_ngrams) {
+    static const size_t gram_size = 3;
+    BloomFilter bf;
+    ASSERT_TRUE(bf.init(1024 * 16, 0.05, true));
+
+    std::vector<std::string> values;
+    srand(1);
+    for (int i = 0; i < 1024; ++i) {
+        std::string value = "GET /api/v1/item/" + std::to_string(rand() % 100000)
+                + " status=" + std::to_string(200 + rand() % 3);
+        add_ngrams(value.data(), value.size(), gram_size, &bf);
+        values.push_back(value);
+    }
+
+    // no false negative for substrings of the values
+    for (const std::string& value : values) {
+        for (size_t pos = 0; pos < value.size(); pos += 5) {
+            std::string pattern = "%" + value.substr(pos, 7) + "%";
+            std::vector<uint64_t> hashes;
+            ngram_hashes(fragments_of(pattern), gram_size, &hashes);
+            ASSERT_TRUE(test_ngrams(bf, hashes)) << pattern;
+        }
+    }
+
+    // a pattern with no ngram cannot prune
+    std::vector<uint64_t> hashes;
+    ngram_hashes(fragments_of("%zz%"), gram_size, &hashes);
+    ASSERT_TRUE(test_ngrams(bf, hashes));
+
+    // substrings absent from the block are pruned
+    int num_pruned = 0;
+    for (const char* pattern : {"%error%", "%POST /api%", "%timeout%", "%status=500%"}) {
+        hashes.clear();
+        ngram_hashes(fragments_of(pattern), gram_size, &hashes);
+        if (!test_ngrams(bf, hashes)) {
+            ++num_pruned;
+        }
+    }
+    ASSERT_EQ(4, num_pruned);
+}
+
+static TCondition like_condition(const std::string& pattern) {
+    TCondition condition;
+    condition.column_name = "v";
+    condition.condition_op = "like";
+    condition.condition_values.push_back(pattern);
+    return condition;
+}
+
+TEST(NgramBloomFilterTest, cond_like) {
+    FieldInfo field_info;
+    field_info.name = "v";
+    field_info.type = OLAP_FIELD_TYPE_VARCHAR;
+    field_info.aggregation = OLAP_FIELD_AGGREGATION_NONE;
+    field_info.length = 32;
+    field_info.index_length = 32;
+    field_info.is_key = false;
+    field_info.is_allow_null = false;
+    field_info.unique_id = 0;
+    field_info.is_bf_column = true;
+
+    Cond cond;
+    TCondition condition = like_condition("%ab\\%c%def_g");
+    condition.condition_op = "LIKE";
+    ASSERT_EQ(OLAP_SUCCESS, cond.init(condition, field_info));
+    ASSERT_EQ(OP_LIKE, cond.op);
+    ASSERT_TRUE(cond.operand_field == nullptr);
+    ASSERT_EQ(std::vector<std::string>({"ab%c", "def", "g"}), cond.like_fragments);
+
+    // storage does not evaluate the pattern, rows and bloom filters pass
+    char row[1 + sizeof(Slice)];
+    row[0] = 0;
+    Slice value("xyz");
+    memcpy(row + 1, &value, sizeof(Slice));
+    ASSERT_TRUE(cond.eval(row));
+    BloomFilter bf;
+    ASSERT_TRUE(bf.init(1024, 0.05, true));
+    ASSERT_TRUE(cond.eval(bf));
+
+    // one pattern only
+    Cond two_patterns;
+    condition.condition_values.push_back("%x%");
+    ASSERT_NE(OLAP_SUCCESS, two_patterns.init(condition, field_info));
+
+    Cond unknown_op;
+    condition = like_condition("%x%");
+    condition.condition_op = "lik";
+    ASSERT_NE(OLAP_SUCCESS, unknown_op.init(condition, field_info));
+}
+
+static const uint32_t NUM_BLOCKS = 16;
+static const uint32_t ROWS_PER_BLOCK = 8;
+// the only block with a row containing "needle"
+static const uint32_t NEEDLE_BLOCK = 11;
+
+// Writes the bloom filter column v of NUM_BLOCKS blocks with ColumnWriter
+// and picks the blocks of LIKE conditions with a SegmentReader over its
+// ngram bloom filters
+class NgramPickRowGroupsTest : public testing::Test {
+public:
+    void SetUp() override {
+        _origin_gram_size = config::ngram_bloom_filter_gram_size;
+        config::ngram_bloom_filter_gram_size = 3;
+        _engine = new OLAPEngine(EngineOptions());
+
+        OLAPHeader* header = new OLAPHeader();
+        ColumnMessage* column = header->add_column();
+        column->set_name("v");
+        column->set_type("VARCHAR");
+        column->set_aggregation("NONE");
+        column->set_length(32);
+        column->set_is_key(false);
+        column->set_unique_id(0);
+        column->set_is_bf_column(true);
+        _store.reset(new OlapStore("./ngram_bloom_filter_test"));
+        _table.reset(new OLAPTable(header, _store.get()));
+        _segment_group.reset(new SegmentGroup(_table.get(), Version(0, 0), 0, false, 0, 1));
+
+        write_segment();
+    }
+
+    void TearDown() override {
+        _segment_group.reset();
+        _table.reset();
+        _store.reset();
+        delete _engine;
+        OLAPEngine::_s_instance = nullptr;
+        config::ngram_bloom_filter_gram_size = _origin_gram_size;
+    }
+
+    void write_segment() {
+        const RowFields& tablet_schema = _table->tablet_schema();
+        OutStreamFactory stream_factory(COMPRESS_LZ4, OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE);
+        std::unique_ptr<ColumnWriter> writer(ColumnWriter::create(
+                0, tablet_schema, &stream_factory, ROWS_PER_BLOCK, BLOOM_FILTER_DEFAULT_FPP));
+        ASSERT_TRUE(writer != nullptr);
+        ASSERT_EQ(OLAP_SUCCESS, writer->init());
+
+        RowCursor row;
+        ASSERT_EQ(OLAP_SUCCESS, row.init(tablet_schema));
+        row.allocate_memory_for_string_type(tablet_schema);
+        RowBlock block(tablet_schema);
+        RowBlockInfo block_info;
+        block_info.row_num = 1;
+        block.init(block_info);
+        for (uint32_t i = 0; i < NUM_BLOCKS; ++i) {
+            std::vector<uint64_t> hashes;
+            for (uint32_t j = 0; j < ROWS_PER_BLOCK; ++j) {
+                std::string value = "row " + std::to_string(i * ROWS_PER_BLOCK + j)
+                        + " of block " + std::to_string(i);
+                if (i == NEEDLE_BLOCK && j == 3) {
+                    value = "a needle in block " + std::to_string(i);
+                }
+                // the block refers to the string of the cursor, a row at a time
+                row.from_tuple(OlapTuple({value}));
+                block.set_row(0, row);
+                block.finalize(1);
+                ASSERT_EQ(OLAP_SUCCESS, writer->write_batch(&block, &row));
+                add_ngram_hashes(value.data(), value.size(), 3, &hashes);
+            }
+            ASSERT_EQ(OLAP_SUCCESS, writer->create_row_index_entry());
+            std::sort(hashes.begin(), hashes.end());
+            hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+            _max_block_ngrams = std::max(_max_block_ngrams, hashes.size());
+        }
+        ASSERT_EQ(OLAP_SUCCESS, writer->finalize(&_header));
+        _header.set_number_of_rows(NUM_BLOCKS * ROWS_PER_BLOCK);
+        ASSERT_EQ(3, _header.ngram_bf_gram_size());
+        ASSERT_EQ(1, _header.ngram_bf_column_size());
+        ASSERT_EQ(0, _header.ngram_bf_column(0));
+
+        // the content of the NGRAM_BLOOM_FILTER stream
+        BloomFilterIndexWriter& ngram_bf_index = writer->_ngram_bf_index;
+        _ngram_bf_size = ngram_bf_index.estimate_buffered_memory();
+        _ngram_bf_buffer = new char[_ngram_bf_size];
+        ASSERT_EQ(OLAP_SUCCESS, ngram_bf_index.write_to_buffer(_ngram_bf_buffer, _ngram_bf_size));
+    }
+
+    // Return the blocks picked for the LIKE condition of pattern
+    std::vector<uint32_t> pick(const std::string& pattern) {
+        Conditions conditions;
+        conditions.set_table(_table);
+        EXPECT_EQ(OLAP_SUCCESS, conditions.append_condition(like_condition(pattern)));
+
+        std::vector<uint32_t> return_columns = {0};
+        std::set<uint32_t> load_bf_columns;
+        DeleteHandler delete_handler;
+        OlapReaderStatistics stats;
+        SegmentReader reader("", _table.get(), _segment_group.get(), 0, return_columns,
+                             load_bf_columns, &conditions, nullptr, delete_handler,
+                             DEL_NOT_SATISFIED, nullptr, &stats);
+        FileHeader<ColumnDataHeaderMessage> file_header;
+        *file_header.mutable_message() = _header;
+        reader._file_header = &file_header;
+        reader._unique_id_to_table_id_map[0] = 0;
+        reader._block_count = NUM_BLOCKS;
+        reader._num_rows_in_block = ROWS_PER_BLOCK;
+
+        // the reader owns the buffer
+        BloomFilterIndexReader* bf_reader = new BloomFilterIndexReader();
+        char* buffer = new char[_ngram_bf_size];
+        memcpy(buffer, _ngram_bf_buffer, _ngram_bf_size);
+        EXPECT_EQ(OLAP_SUCCESS, bf_reader->init(buffer, _ngram_bf_size, false,
+                SPLIT_BLOCK_WORDS, _header.ngram_bf_bit_num(0), true));
+        reader._ngram_bloom_filters[0] = bf_reader;
+
+        std::vector<uint32_t> blocks;
+        EXPECT_EQ(OLAP_SUCCESS, reader._pick_row_groups(0, NUM_BLOCKS - 1));
+        for (uint32_t i = 0; i < NUM_BLOCKS; ++i) {
+            if (reader._include_blocks[i] != DEL_SATISFIED) {
+                blocks.push_back(i);
+            }
+        }
+        EXPECT_EQ(NUM_BLOCKS - blocks.size(), stats.blocks_ngram_filtered);
+        conditions.finalize();
+        return blocks;
+    }
+
+    std::vector<uint32_t> all_blocks() {
+        std::vector<uint32_t> blocks;
+        for (uint32_t i = 0; i < NUM_BLOCKS; ++i) {
+            blocks.push_back(i);
+        }
+        return blocks;
+    }
+
+    ~NgramPickRowGroupsTest() {
+        delete[] _ngram_bf_buffer;
+    }
+
+    int32_t _origin_gram_size = 0;
+    OLAPEngine* _engine = nullptr;
+    std::unique_ptr<OlapStore> _store;
+    OLAPTablePtr _table;
+    std::unique_ptr<SegmentGroup> _segment_group;
+    ColumnDataHeaderMessage _header;
+    char* _ngram_bf_buffer = nullptr;
+    size_t _ngram_bf_size = 0;
+    size_t _max_block_ngrams = 0;
+};
+
+TEST_F(NgramPickRowGroupsTest, pick_row_groups) {
+    // the filters are sized for the block with the most distinct ngrams
+    BloomFilter expected_bf;
+    ASSERT_TRUE(expected_bf.init(_max_block_ngrams, BLOOM_FILTER_DEFAULT_FPP, true));
+    ASSERT_EQ(expected_bf.bit_num(), _header.ngram_bf_bit_num(0));
+
+    // every ngram of these patterns is only in the needle block
+    ASSERT_EQ(std::vector<uint32_t>({NEEDLE_BLOCK}), pick("%needle%"));
+    ASSERT_EQ(std::vector<uint32_t>({NEEDLE_BLOCK}), pick("a needle%"));
+    // no false negative
+    ASSERT_EQ(all_blocks(), pick("%of block%"));
+    // fragments shorter than a gram do not prune
+    ASSERT_EQ(all_blocks(), pick("%ne%dl%"));
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -22,6 +22,7 @@
 #include "olap/field.h"
 #include "olap/column_predicate.h"
 #include "olap/null_predicate.h"
+#include "olap/wrapper_field.h"
 #include "runtime/mem_pool.h"
 #include "runtime/string_value.hpp"
 #include "runtime/vectorized_row_batch.h"
@@ -448,6 +449,36 @@ TEST_F(TestNullPredicate, DATETIME_COLUMN) {
     ASSERT_EQ(_vectorized_batch->size(), 2);
 }
 
+static void set_statistic_bound(WrapperField* field, const char* value) {
+    if (value == nullptr) {
+        field->set_null();
+    } else {
+        field->set_not_null();
+        field->from_string(value);
+    }
+}
+
+TEST_F(TestNullPredicate, STATISTIC) {
+    std::unique_ptr<WrapperField> min(WrapperField::create_by_type(OLAP_FIELD_TYPE_INT));
+    std::unique_ptr<WrapperField> max(WrapperField::create_by_type(OLAP_FIELD_TYPE_INT));
+    std::pair<WrapperField*, WrapperField*> statistic(min.get(), max.get());
+    NullPredicate is_null_pred(0, true);
+    NullPredicate not_null_pred(0, false);
+
+    set_statistic_bound(min.get(), "5");
+    set_statistic_bound(max.get(), "20");
+    ASSERT_FALSE(is_null_pred.evaluate(statistic));
+    ASSERT_TRUE(not_null_pred.evaluate(statistic));
+
+    set_statistic_bound(min.get(), nullptr);
+    ASSERT_TRUE(is_null_pred.evaluate(statistic));
+    ASSERT_TRUE(not_null_pred.evaluate(statistic));
+
+    set_statistic_bound(max.get(), nullptr);
+    ASSERT_TRUE(is_null_pred.evaluate(statistic));
+    ASSERT_FALSE(not_null_pred.evaluate(statistic));
+}
+
 } // namespace doris
 
 int main(int argc, char** argv) {
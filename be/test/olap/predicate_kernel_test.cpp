@@ -0,0 +1,304 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <stdlib.h>
+#include <gtest/gtest.h>
+#include <google/protobuf/stubs/common.h>
+
+#include "olap/column_predicate.h"
+#include "olap/comparison_predicate.h"
+#include "olap/field.h"
+#include "olap/in_list_predicate.h"
+#include "olap/null_predicate.h"
+#include "olap/predicate_kernel.h"
+#include "runtime/mem_pool.h"
+#include "runtime/string_value.hpp"
+#include "runtime/vectorized_row_batch.h"
+#include "util/logging.h"
+#include "util/stopwatch.hpp"
+
+namespace doris {
+
+static const int BATCH_SIZE = 1024;
+
+class TestPredicateKernel : public testing::Test {
+public:
+    TestPredicateKernel() {
+        _mem_tracker.reset(new MemTracker(-1));
+        _mem_pool.reset(new MemPool(_mem_tracker.get()));
+        FieldInfo field_info;
+        field_info.name = "c0";
+        field_info.type = OLAP_FIELD_TYPE_BIGINT;
+        field_info.aggregation = OLAP_FIELD_AGGREGATION_REPLACE;
+        field_info.length = 8;
+        field_info.is_allow_null = true;
+        field_info.is_key = true;
+        field_info.unique_id = 0;
+        field_info.is_bf_column = false;
+        _schema.push_back(field_info);
+        _return_columns.push_back(0);
+        _batch.reset(new VectorizedRowBatch(_schema, _return_columns, BATCH_SIZE));
+        _is_null = reinterpret_cast<bool*>(_mem_pool->allocate(BATCH_SIZE));
+    }
+
+    // Fill the column with values in [0, cardinality) and, if null_ratio > 0,
+    // mark roughly one of every null_ratio rows as null.
+    template <class T>
+    T* fill_column(int cardinality, int null_ratio) {
+        T* data = reinterpret_cast<T*>(_mem_pool->allocate(BATCH_SIZE * sizeof(T)));
+        for (int i = 0; i < BATCH_SIZE; ++i) {
+            data[i] = static_cast<T>(rand() % cardinality);
+            _is_null[i] = null_ratio > 0 && rand() % null_ratio == 0;
+        }
+        ColumnVector* column = _batch->column(0);
+        column->set_col_data(data);
+        column->set_is_null(_is_null);
+        column->set_no_nulls(null_ratio == 0);
+        return data;
+    }
+
+    // Reset the batch, optionally pre-selecting every keep_ratio-th row.
+    void reset_batch(int keep_ratio) {
+        _batch->set_size(BATCH_SIZE);
+        _batch->set_selected_in_use(false);
+        if (keep_ratio > 1) {
+            uint16_t* sel = _batch->selected();
+            uint16_t size = 0;
+            for (int i = 0; i < BATCH_SIZE; i += keep_ratio) {
+                sel[size++] = i;
+            }
+            _batch->set_size(size);
+            _batch->set_selected_in_use(true);
+        }
+    }
+
+    // Rows selected in the batch before evaluation.
+    std::vector<uint16_t> selected_rows() {
+        std::vector<uint16_t> rows;
+        for (uint16_t j = 0; j < _batch->size(); ++j) {
+            rows.push_back(_batch->selected_in_use() ? _batch->selected()[j] : j);
+        }
+        return rows;
+    }
+
+    template <class T, class Op>
+    void check(const ColumnPredicate& pred, const T* data, Op op, int keep_ratio) {
+        reset_batch(keep_ratio);
+        bool no_nulls = _batch->column(0)->no_nulls();
+        std::vector<uint16_t> expected;
+        for (uint16_t row : selected_rows()) {
+            if ((no_nulls || !_is_null[row]) && op(data[row])) {
+                expected.push_back(row);
+            }
+        }
+        pred.evaluate(_batch.get());
+        std::vector<uint16_t> actual = selected_rows();
+        ASSERT_EQ(expected.size(), actual.size());
+        for (int i = 0; i < expected.size(); ++i) {
+            ASSERT_EQ(expected[i], actual[i]);
+        }
+    }
+
+    template <class T>
+    void check_comparisons(int null_ratio) {
+        const int cardinality = 100;
+        T* data = fill_column<T>(cardinality, null_ratio);
+        T value = static_cast<T>(cardinality / 3);
+        for (int keep_ratio : {1, 2, 10}) {
+            check(EqualPredicate<T>(0, value), data,
+                  [&](const T& v) { return v == value; }, keep_ratio);
+            check(NotEqualPredicate<T>(0, value), data,
+                  [&](const T& v) { return v != value; }, keep_ratio);
+            check(LessPredicate<T>(0, value), data,
+                  [&](const T& v) { return v < value; }, keep_ratio);
+            check(LessEqualPredicate<T>(0, value), data,
+                  [&](const T& v) { return v <= value; }, keep_ratio);
+            check(GreaterPredicate<T>(0, value), data,
+                  [&](const T& v) { return v > value; }, keep_ratio);
+            check(GreaterEqualPredicate<T>(0, value), data,
+                  [&](const T& v) { return v >= value; }, keep_ratio);
+        }
+    }
+
+    template <class T>
+    void check_in_list(int list_size, int null_ratio) {
+        const int cardinality = 100;
+        T* data = fill_column<T>(cardinality, null_ratio);
+        std::set<T> values;
+        for (int i = 0; i < list_size; ++i) {
+            values.insert(static_cast<T>(i * 7));
+        }
+        std::set<T> copy = values;
+        InListPredicate<T> in_pred(0, std::move(copy));
+        copy = values;
+        NotInListPredicate<T> not_in_pred(0, std::move(copy));
+        for (int keep_ratio : {1, 2, 10}) {
+            check(in_pred, data,
+                  [&](const T& v) { return values.count(v) > 0; }, keep_ratio);
+            check(not_in_pred, data,
+                  [&](const T& v) { return values.count(v) == 0; }, keep_ratio);
+        }
+    }
+
+    std::unique_ptr<MemTracker> _mem_tracker;
+    std::unique_ptr<MemPool> _mem_pool;
+    std::vector<FieldInfo> _schema;
+    std::vector<uint32_t> _return_columns;
+    std::unique_ptr<VectorizedRowBatch> _batch;
+    bool* _is_null;
+};
+
+#define TEST_KERNEL_COMPARISON(TYPE, TYPE_NAME) \
+TEST_F(TestPredicateKernel, TYPE_NAME##_COMPARISON) { \
+    check_comparisons<TYPE>(0); \
+    check_comparisons<TYPE>(3); \
+} \
+TEST_F(TestPredicateKernel, TYPE_NAME##_IN_LIST) { \
+    check_in_list<TYPE>(4, 0); \
+    check_in_list<TYPE>(4, 3); \
+    check_in_list<TYPE>(32, 0); \
+    check_in_list<TYPE>(32, 3); \
+} \
+
+TEST_KERNEL_COMPARISON(int8_t, TINYINT)
+TEST_KERNEL_COMPARISON(int16_t, SMALLINT)
+TEST_KERNEL_COMPARISON(int32_t, INT)
+TEST_KERNEL_COMPARISON(int64_t, BIGINT)
+TEST_KERNEL_COMPARISON(int128_t, LARGEINT)
+TEST_KERNEL_COMPARISON(float, FLOAT)
+TEST_KERNEL_COMPARISON(double, DOUBLE)
+TEST_KERNEL_COMPARISON(uint64_t, DATETIME)
+
+TEST_F(TestPredicateKernel, NULL_PREDICATE) {
+    fill_column<int32_t>(100, 3);
+    for (int keep_ratio : {1, 2, 10}) {
+        std::vector<uint16_t> expected_null;
+        std::vector<uint16_t> expected_not_null;
+        reset_batch(keep_ratio);
+        for (uint16_t row : selected_rows()) {
+            (_is_null[row] ? expected_null : expected_not_null).push_back(row);
+        }
+
+        NullPredicate is_null_pred(0, true);
+        is_null_pred.evaluate(_batch.get());
+        ASSERT_EQ(expected_null, selected_rows());
+
+        reset_batch(keep_ratio);
+        NullPredicate not_null_pred(0, false);
+        not_null_pred.evaluate(_batch.get());
+        ASSERT_EQ(expected_not_null, selected_rows());
+    }
+}
+
+// A batch of 1 << 16 rows: the last selected row is 65535, so the range of the
+// selected rows does not fit in uint16_t.
+TEST_F(TestPredicateKernel, LAST_ROW_65535) {
+    const uint32_t num_rows = 1 << 16;
+    std::vector<int32_t> data(num_rows);
+    std::vector<bool> expected(num_rows);
+    for (uint32_t i = 0; i < num_rows; ++i) {
+        data[i] = rand() % 100;
+        expected[i] = data[i] < 50;
+    }
+    int32_t value = 50;
+    predicate_kernel::CompareMatcher<predicate_kernel::PRED_OP_LT, int32_t> matcher(
+        data.data(), value);
+    // Every odd row, dense enough for the bitmap path
+    std::vector<uint16_t> sel;
+    for (uint32_t i = 1; i < num_rows; i += 2) {
+        sel.push_back(i);
+    }
+    ASSERT_EQ(65535, sel.back());
+    uint16_t n = sel.size();
+    std::vector<uint16_t> expected_sel;
+    for (uint16_t i : sel) {
+        if (expected[i]) {
+            expected_sel.push_back(i);
+        }
+    }
+    uint16_t new_size = predicate_kernel::select_rows(matcher, nullptr, n, sel.data(), true);
+    sel.resize(new_size);
+    ASSERT_EQ(expected_sel, sel);
+}
+
+// Measures rows/sec of each predicate per type and selectivity. The numbers are
+// only logged, run it with --gtest_also_run_disabled_tests.
+class TestPredicateKernelBench : public TestPredicateKernel {
+public:
+    template <class T>
+    void bench(const char* type_name) {
+        const int cardinality = 100;
+        const int rounds = 2000;
+        fill_column<T>(cardinality, 0);
+        for (int selectivity : {1, 10, 50, 90}) {
+            T value = static_cast<T>(cardinality * selectivity / 100);
+            run(LessPredicate<T>(0, value), type_name, "less", selectivity, rounds);
+        }
+        run(EqualPredicate<T>(0, static_cast<T>(cardinality / 2)),
+            type_name, "equal", 0, rounds);
+        std::set<T> values;
+        for (int i = 0; i < 5; ++i) {
+            values.insert(static_cast<T>(i * 20));
+        }
+        run(InListPredicate<T>(0, std::move(values)), type_name, "in_list", 0, rounds);
+    }
+
+    void run(const ColumnPredicate& pred, const char* type_name, const char* pred_name,
+             int selectivity, int rounds) {
+        MonotonicStopWatch watch;
+        watch.start();
+        int64_t rows = 0;
+        for (int i = 0; i < rounds; ++i) {
+            reset_batch(1);
+            pred.evaluate(_batch.get());
+            rows += BATCH_SIZE;
+        }
+        watch.stop();
+        double seconds = watch.elapsed_time() / 1000000000.0;
+        LOG(INFO) << "predicate=" << pred_name << " type=" << type_name
+                  << " selectivity=" << selectivity << "%"
+                  << " rows/sec=" << static_cast<int64_t>(rows / seconds);
+    }
+};
+
+TEST_F(TestPredicateKernelBench, DISABLED_BENCHMARK) {
+    bench<int8_t>("TINYINT");
+    bench<int16_t>("SMALLINT");
+    bench<int32_t>("INT");
+    bench<int64_t>("BIGINT");
+    bench<int128_t>("LARGEINT");
+    bench<float>("FLOAT");
+    bench<double>("DOUBLE");
+    bench<uint64_t>("DATETIME");
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    int ret = doris::OLAP_SUCCESS;
+    testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+    ret = RUN_ALL_TESTS();
+    google::protobuf::ShutdownProtobufLibrary();
+    return ret;
+}
@@ -17,6 +17,9 @@
 
 #include "olap/serialize.h"
 
+#include <stdlib.h>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 namespace doris {
@@ -231,6 +234,40 @@ TEST_F(SerializeTest, new_percentile_bits) {
     }
 }
 
+// Pack data the way write_ints does, most significant bit first.
+static std::vector<uint8_t> pack_ints(const std::vector<int64_t>& data, uint32_t bit_width) {
+    std::vector<uint8_t> out((data.size() * bit_width + 7) / 8, 0);
+    uint64_t bit_pos = 0;
+    for (int64_t value : data) {
+        for (int32_t bit = bit_width - 1; bit >= 0; --bit, ++bit_pos) {
+            if ((static_cast<uint64_t>(value) >> bit) & 1) {
+                out[bit_pos / 8] |= 0x80 >> (bit_pos % 8);
+            }
+        }
+    }
+    return out;
+}
+
+TEST_F(SerializeTest, unpack_ints) {
+    for (uint32_t bit_width = 1; bit_width <= 64; ++bit_width) {
+        for (uint32_t count : {1, 3, 7, 8, 100, 512}) {
+            std::vector<int64_t> data;
+            for (uint32_t i = 0; i < count; ++i) {
+                uint64_t value = (static_cast<uint64_t>(rand()) << 40)
+                        ^ (static_cast<uint64_t>(rand()) << 20) ^ rand();
+                if (bit_width < 64) {
+                    value &= (1UL << bit_width) - 1;
+                }
+                data.push_back(value);
+            }
+            std::vector<uint8_t> packed = pack_ints(data, bit_width);
+            std::vector<int64_t> result(count);
+            unpack_ints(packed.data(), packed.size(), result.data(), count, bit_width);
+            ASSERT_EQ(data, result) << "bit_width=" << bit_width << ", count=" << count;
+        }
+    }
+}
+
 
 }
 }
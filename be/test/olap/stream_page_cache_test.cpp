@@ -0,0 +1,288 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/stream_page_cache.h"
+
+#include <string.h>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "olap/compress.h"
+#include "olap/file_helper.h"
+#include "olap/file_stream.h"
+#include "olap/out_stream.h"
+#include "olap/stream_index_reader.h"
+#include "olap/stream_index_writer.h"
+#include "util/logging.h"
+
+namespace doris {
+
+static const std::string FILE_NAME = "/data/1/10001/12345/10001_2_2_0_0.dat";
+
+class TestStreamPageCache : public testing::Test {
+public:
+    // a decompressed block filled with value
+    StorageByteBuffer* create_block(uint64_t size, char value) {
+        StorageByteBuffer* block = StorageByteBuffer::create(size);
+        memset(block->array(), value, size);
+        return block;
+    }
+};
+
+TEST_F(TestStreamPageCache, lookup_and_insert) {
+    StreamPageCache cache(1024 * 1024, CachePolicy(), nullptr);
+    uint64_t block_length = 0;
+    ASSERT_EQ(nullptr, cache.lookup(FILE_NAME, 100, &block_length));
+
+    std::unique_ptr<StorageByteBuffer> block(create_block(1000, 'a'));
+    // only [0, limit) is cached
+    block->set_limit(800);
+    cache.insert(FILE_NAME, 100, 300, *block);
+    ASSERT_EQ(800, cache.mem_tracker()->consumption());
+
+    std::unique_ptr<StorageByteBuffer> cached(cache.lookup(FILE_NAME, 100, &block_length));
+    ASSERT_TRUE(cached != nullptr);
+    ASSERT_EQ(300, block_length);
+    ASSERT_EQ(0, cached->position());
+    ASSERT_EQ(800, cached->limit());
+    ASSERT_EQ(0, memcmp(block->array(), cached->array(), 800));
+
+    // another offset or another file is another block
+    ASSERT_EQ(nullptr, cache.lookup(FILE_NAME, 400, &block_length));
+    ASSERT_EQ(nullptr, cache.lookup(FILE_NAME + "x", 100, &block_length));
+}
+
+TEST_F(TestStreamPageCache, empty_block) {
+    StreamPageCache cache(1024 * 1024, CachePolicy(), nullptr);
+    std::unique_ptr<StorageByteBuffer> block(create_block(100, 'a'));
+    block->set_limit(0);
+    cache.insert(FILE_NAME, 0, 8, *block);
+    uint64_t block_length = 0;
+    ASSERT_EQ(nullptr, cache.lookup(FILE_NAME, 0, &block_length));
+    ASSERT_EQ(0, cache.mem_tracker()->consumption());
+}
+
+TEST_F(TestStreamPageCache, eviction) {
+    // 16 shards of 4KB
+    const uint64_t capacity = 64 * 1024;
+    std::unique_ptr<StorageByteBuffer> block(create_block(1024, 'a'));
+    std::unique_ptr<StorageByteBuffer> first;
+    {
+        StreamPageCache cache(capacity, CachePolicy(), nullptr);
+        uint64_t block_length = 0;
+        cache.insert(FILE_NAME, 0, 1024, *block);
+        first.reset(cache.lookup(FILE_NAME, 0, &block_length));
+        ASSERT_TRUE(first != nullptr);
+
+        for (uint64_t i = 1; i < 1000; ++i) {
+            cache.insert(FILE_NAME, i * 1024, 1024, *block);
+            ASSERT_LE(cache.mem_tracker()->consumption(), capacity);
+        }
+        int num_cached = 0;
+        for (uint64_t i = 0; i < 1000; ++i) {
+            std::unique_ptr<StorageByteBuffer> cached(
+                    cache.lookup(FILE_NAME, i * 1024, &block_length));
+            num_cached += cached != nullptr;
+        }
+        ASSERT_GT(num_cached, 0);
+        ASSERT_LE(num_cached, capacity / 1024);
+    }
+    // a looked up block outlives its eviction and the cache
+    ASSERT_EQ(0, memcmp(block->array(), first->array(), 1024));
+}
+
+TEST_F(TestStreamPageCache, parent_mem_tracker) {
+    MemTracker process_mem_tracker(1024 * 1024);
+    std::unique_ptr<StorageByteBuffer> block(create_block(1024, 'a'));
+    {
+        StreamPageCache cache(64 * 1024, CachePolicy(), &process_mem_tracker);
+        cache.insert(FILE_NAME, 0, 1024, *block);
+        ASSERT_EQ(1024, process_mem_tracker.consumption());
+
+        // nothing is cached while the process is over its limit
+        process_mem_tracker.consume(1024 * 1024);
+        cache.insert(FILE_NAME, 1024, 1024, *block);
+        uint64_t block_length = 0;
+        ASSERT_EQ(nullptr, cache.lookup(FILE_NAME, 1024, &block_length));
+        ASSERT_EQ(1024 + 1024 * 1024, process_mem_tracker.consumption());
+        process_mem_tracker.release(1024 * 1024);
+    }
+    // evicted blocks are released from the parent too
+    ASSERT_EQ(0, process_mem_tracker.consumption());
+}
+
+static const uint32_t BLOCK_SIZE = 1024;
+static const int NUM_BLOCKS = 4;
+
+// Reads streams of NUM_BLOCKS compressed blocks through the cache
+class TestCachedFileStream : public testing::Test {
+public:
+    void SetUp() override {
+        _file_name = "./stream_page_cache_test_file";
+        system(("rm -f " + _file_name).c_str());
+        OutStream out_stream(BLOCK_SIZE, lz4_compress);
+        for (int i = 0; i < NUM_BLOCKS; ++i) {
+            for (uint32_t j = 0; j < BLOCK_SIZE; ++j) {
+                ASSERT_EQ(OLAP_SUCCESS, out_stream.write(value(i * BLOCK_SIZE + j)));
+                if (j == 0) {
+                    // the previous block is spilled by the first byte of this one
+                    PositionEntryWriter index_entry;
+                    out_stream.get_position(&index_entry);
+                    _block_positions.push_back(
+                            static_cast<uint32_t>(index_entry.positions(0)));
+                }
+            }
+        }
+        ASSERT_EQ(OLAP_SUCCESS, out_stream.flush());
+
+        FileHandler writer;
+        ASSERT_EQ(OLAP_SUCCESS, writer.open_with_mode(_file_name,
+                O_CREAT | O_EXCL | O_WRONLY, S_IRUSR | S_IWUSR));
+        ASSERT_EQ(OLAP_SUCCESS, out_stream.write_to_file(&writer, 0));
+        writer.close();
+        ASSERT_EQ(OLAP_SUCCESS, _file.open_with_mode(_file_name, O_RDONLY, S_IRUSR | S_IWUSR));
+        _shared_buffer = StorageByteBuffer::create(BLOCK_SIZE + sizeof(StreamHead));
+    }
+
+    void TearDown() override {
+        SAFE_DELETE(_shared_buffer);
+        _file.close();
+        system(("rm -f " + _file_name).c_str());
+    }
+
+    static char value(uint32_t i) {
+        return static_cast<char>(i / 16);
+    }
+
+    ReadOnlyFileStream* create_stream(StreamPageCache* cache) {
+        ReadOnlyFileStream* stream = new ReadOnlyFileStream(
+                &_file, &_shared_buffer, 0, _file.length(), lz4_decompress, BLOCK_SIZE, &_stats);
+        EXPECT_EQ(OLAP_SUCCESS, stream->init());
+        stream->set_page_cache(cache);
+        return stream;
+    }
+
+    // seek to the offset-th byte of the block-th block and check the next byte
+    void seek(ReadOnlyFileStream* stream, int block, uint32_t offset) {
+        PositionEntryReader entry;
+        uint32_t positions[] = {_block_positions[block], offset};
+        entry._positions = positions;
+        entry._positions_count = 2;
+        PositionProvider position(&entry);
+        ASSERT_EQ(OLAP_SUCCESS, stream->seek(&position));
+        char byte = 0;
+        ASSERT_EQ(OLAP_SUCCESS, stream->read(&byte));
+        ASSERT_EQ(value(block * BLOCK_SIZE + offset), byte);
+    }
+
+    void read_all(ReadOnlyFileStream* stream) {
+        for (uint32_t i = 0; i < NUM_BLOCKS * BLOCK_SIZE; ++i) {
+            char byte = 0;
+            ASSERT_EQ(OLAP_SUCCESS, stream->read(&byte));
+            ASSERT_EQ(value(i), byte);
+        }
+        char byte = 0;
+        ASSERT_EQ(OLAP_ERR_COLUMN_STREAM_EOF, stream->read(&byte));
+    }
+
+    std::string _file_name;
+    // position of each compressed block in the stream
+    std::vector<uint32_t> _block_positions;
+    FileHandler _file;
+    StorageByteBuffer* _shared_buffer = nullptr;
+    OlapReaderStatistics _stats;
+};
+
+TEST_F(TestCachedFileStream, miss_then_hit) {
+    StreamPageCache cache(1024 * 1024, CachePolicy(), nullptr);
+    std::unique_ptr<ReadOnlyFileStream> stream(create_stream(&cache));
+    read_all(stream.get());
+    ASSERT_EQ(NUM_BLOCKS, _stats.page_cache_miss);
+    ASSERT_EQ(0, _stats.page_cache_hit);
+    ASSERT_EQ(NUM_BLOCKS * BLOCK_SIZE, cache.mem_tracker()->consumption());
+
+    // another query reads the decompressed blocks from the cache
+    int64_t compressed_bytes_read = _stats.compressed_bytes_read;
+    stream.reset(create_stream(&cache));
+    read_all(stream.get());
+    ASSERT_EQ(NUM_BLOCKS, _stats.page_cache_miss);
+    ASSERT_EQ(NUM_BLOCKS, _stats.page_cache_hit);
+    ASSERT_EQ(compressed_bytes_read, _stats.compressed_bytes_read);
+}
+
+TEST_F(TestCachedFileStream, seek) {
+    StreamPageCache cache(1024 * 1024, CachePolicy(), nullptr);
+    std::unique_ptr<ReadOnlyFileStream> stream(create_stream(&cache));
+    seek(stream.get(), 2, 100);
+    seek(stream.get(), 0, 0);
+    ASSERT_EQ(2, _stats.page_cache_miss);
+    ASSERT_EQ(0, _stats.page_cache_hit);
+
+    // cached blocks, and the blocks read after them, are found after a seek
+    stream.reset(create_stream(&cache));
+    seek(stream.get(), 2, BLOCK_SIZE - 1);
+    seek(stream.get(), 0, 10);
+    ASSERT_EQ(2, _stats.page_cache_hit);
+    // the rest of block 0, then block 1 is a miss and block 2 a hit
+    for (uint32_t i = 11; i < 3 * BLOCK_SIZE; ++i) {
+        char byte = 0;
+        ASSERT_EQ(OLAP_SUCCESS, stream->read(&byte));
+        ASSERT_EQ(value(i), byte);
+    }
+    ASSERT_EQ(3, _stats.page_cache_miss);
+    ASSERT_EQ(3, _stats.page_cache_hit);
+    // a seek within the current block does not look it up again
+    seek(stream.get(), 2, 5);
+    ASSERT_EQ(3, _stats.page_cache_hit);
+}
+
+TEST_F(TestCachedFileStream, prefetch) {
+    ThreadPool pool(1, 64);
+    MemTracker read_ahead_tracker;
+    StreamPageCache cache(1024 * 1024, CachePolicy(), nullptr);
+    std::unique_ptr<ReadOnlyFileStream> stream(create_stream(&cache));
+    stream->set_read_ahead(&pool, 4096, &read_ahead_tracker);
+    stream->prefetch();
+    ASSERT_GT(read_ahead_tracker.consumption(), 0);
+    read_all(stream.get());
+
+    // the first block is cached, nothing is read ahead
+    stream.reset(create_stream(&cache));
+    ASSERT_EQ(0, read_ahead_tracker.consumption());
+    stream->set_read_ahead(&pool, 4096, &read_ahead_tracker);
+    stream->prefetch();
+    ASSERT_EQ(0, read_ahead_tracker.consumption());
+    read_all(stream.get());
+    ASSERT_EQ(NUM_BLOCKS, _stats.page_cache_hit);
+    ASSERT_EQ(0, read_ahead_tracker.consumption());
+    stream.reset();
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,197 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/stream_read_ahead.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "util/logging.h"
+
+namespace doris {
+
+static const std::string TEST_DIR = "./ut_dir/stream_read_ahead_test";
+static const uint64_t FILE_SIZE = 1024 * 1024;
+
+class TestStreamReadAhead : public testing::Test {
+public:
+    void SetUp() {
+        boost::filesystem::remove_all(TEST_DIR);
+        ASSERT_TRUE(boost::filesystem::create_directories(TEST_DIR));
+        _file_name = TEST_DIR + "/data";
+        _content.resize(FILE_SIZE);
+        for (uint64_t i = 0; i < FILE_SIZE; ++i) {
+            _content[i] = static_cast<char>(rand());
+        }
+        FileHandler writer;
+        ASSERT_EQ(OLAP_SUCCESS, writer.open_with_mode(
+                _file_name, O_CREAT | O_EXCL | O_WRONLY, S_IRUSR | S_IWUSR));
+        ASSERT_EQ(OLAP_SUCCESS, writer.write(_content.data(), FILE_SIZE));
+        ASSERT_EQ(OLAP_SUCCESS, writer.close());
+        ASSERT_EQ(OLAP_SUCCESS, _file_handler.open(_file_name, O_RDONLY));
+    }
+
+    void TearDown() {
+        // every window is released with its stream
+        ASSERT_EQ(0, _mem_tracker.consumption());
+        _file_handler.close();
+        boost::filesystem::remove_all(TEST_DIR);
+    }
+
+    // read [offset, offset + length) of a stream ending at end and compare
+    void check_read(StreamReadAhead* read_ahead, uint64_t offset, uint64_t length,
+                    uint64_t end) {
+        std::vector<char> buf(length);
+        ASSERT_EQ(OLAP_SUCCESS, read_ahead->read(buf.data(), length, offset, end));
+        ASSERT_EQ(0, memcmp(_content.data() + offset, buf.data(), length));
+    }
+
+    // read the stream [begin, end) from its start in pieces of random sizes
+    void check_sequential(StreamReadAhead* read_ahead, uint64_t begin, uint64_t end) {
+        uint64_t offset = begin;
+        while (offset < end) {
+            uint64_t length = std::min<uint64_t>(1 + rand() % 20000, end - offset);
+            check_read(read_ahead, offset, length, end);
+            offset += length;
+        }
+    }
+
+    std::string _file_name;
+    std::vector<char> _content;
+    FileHandler _file_handler;
+    MemTracker _mem_tracker;
+};
+
+TEST_F(TestStreamReadAhead, sequential) {
+    ThreadPool pool(4, 64);
+    for (uint64_t window_size : std::vector<uint64_t>{4096, 65536, 2 * FILE_SIZE}) {
+        StreamReadAhead read_ahead(&_file_handler, &pool, window_size, &_mem_tracker);
+        check_sequential(&read_ahead, 0, FILE_SIZE);
+    }
+    // a stream in the middle of the file, windows stop at its end
+    StreamReadAhead read_ahead(&_file_handler, &pool, 65536, &_mem_tracker);
+    read_ahead.prefetch(1000, 300000);
+    check_sequential(&read_ahead, 1000, 300000);
+}
+
+TEST_F(TestStreamReadAhead, seek) {
+    ThreadPool pool(4, 64);
+    StreamReadAhead read_ahead(&_file_handler, &pool, 65536, &_mem_tracker);
+    for (int i = 0; i < 200; ++i) {
+        // forward and backward jumps, reads larger than a window and reads
+        // continuing the last one
+        uint64_t offset = rand() % FILE_SIZE;
+        uint64_t length = std::min<uint64_t>(1 + rand() % 200000, FILE_SIZE - offset);
+        check_read(&read_ahead, offset, length, FILE_SIZE);
+        if (offset + length < FILE_SIZE) {
+            check_read(&read_ahead, offset + length, 1, FILE_SIZE);
+        }
+    }
+}
+
+TEST_F(TestStreamReadAhead, many_streams) {
+    // streams of one file read by turns on a small pool, as the columns of
+    // a segment are
+    ThreadPool pool(2, 8);
+    const uint64_t stream_length = FILE_SIZE / 16;
+    std::vector<std::unique_ptr<StreamReadAhead>> streams;
+    for (int i = 0; i < 16; ++i) {
+        streams.emplace_back(new StreamReadAhead(&_file_handler, &pool, 8192, &_mem_tracker));
+        streams.back()->prefetch(i * stream_length, (i + 1) * stream_length);
+    }
+    for (uint64_t pos = 0; pos < stream_length; pos += 1000) {
+        for (int i = 0; i < 16; ++i) {
+            uint64_t begin = i * stream_length;
+            uint64_t length = std::min<uint64_t>(1000, stream_length - pos);
+            check_read(streams[i].get(), begin + pos, length, begin + stream_length);
+        }
+    }
+}
+
+TEST_F(TestStreamReadAhead, pool_shutdown) {
+    ThreadPool pool(1, 64);
+    StreamReadAhead read_ahead(&_file_handler, &pool, 4096, &_mem_tracker);
+    check_read(&read_ahead, 0, 100, FILE_SIZE);
+    // windows nobody will run are read by the stream itself
+    pool.shutdown();
+    pool.join();
+    check_sequential(&read_ahead, 100, FILE_SIZE);
+}
+
+TEST_F(TestStreamReadAhead, destroy_pending) {
+    ThreadPool pool(1, 1024);
+    // dropped with windows queued or running, none of them may use the
+    // file handler after that
+    for (int i = 0; i < 100; ++i) {
+        StreamReadAhead read_ahead(&_file_handler, &pool, 65536, &_mem_tracker);
+        read_ahead.prefetch(0, FILE_SIZE);
+        check_read(&read_ahead, 0, 10, FILE_SIZE);
+    }
+    pool.drain_and_shutdown();
+}
+
+TEST_F(TestStreamReadAhead, mem_tracker) {
+    ThreadPool pool(2, 64);
+    {
+        StreamReadAhead read_ahead(&_file_handler, &pool, 4096, &_mem_tracker);
+        read_ahead.prefetch(0, FILE_SIZE);
+        ASSERT_EQ(4096, _mem_tracker.consumption());
+        // the current window and the next one
+        for (uint64_t offset = 0; offset < FILE_SIZE; offset += 1000) {
+            check_read(&read_ahead, offset, std::min<uint64_t>(1000, FILE_SIZE - offset),
+                       FILE_SIZE);
+            ASSERT_LE(_mem_tracker.consumption(), 2 * 4096);
+        }
+        // a seek drops both windows and reads a new one
+        check_read(&read_ahead, 100, 10, FILE_SIZE);
+        ASSERT_LE(_mem_tracker.consumption(), 2 * 4096);
+        // the last window of a stream is shorter
+        check_read(&read_ahead, FILE_SIZE - 10, 10, FILE_SIZE);
+        ASSERT_EQ(10, _mem_tracker.consumption());
+    }
+    ASSERT_EQ(0, _mem_tracker.consumption());
+}
+
+TEST_F(TestStreamReadAhead, read_error) {
+    ThreadPool pool(2, 64);
+    FileHandler closed;
+    StreamReadAhead read_ahead(&closed, &pool, 4096, &_mem_tracker);
+    std::vector<char> buf(100);
+    ASSERT_NE(OLAP_SUCCESS, read_ahead.read(buf.data(), 100, 0, FILE_SIZE));
+    ASSERT_NE(OLAP_SUCCESS, read_ahead.read(buf.data(), 100, 100, FILE_SIZE));
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
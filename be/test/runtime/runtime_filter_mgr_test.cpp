@@ -0,0 +1,183 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/runtime_filter_mgr.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "exprs/runtime_filter.h"
+#include "gen_cpp/internal_service.pb.h"
+#include "runtime/types.h"
+#include "service/backend_options.h"
+
+namespace doris {
+
+static const int32_t FILTER_ID = 1;
+static const int64_t BLOOM_FILTER_VALUES = 1024;
+
+// The filter a join instance sends for its keys. The bloom filters are sized
+// alike, as the plan sizes them, so that they merge.
+PRuntimeFilter filter_of(const std::vector<int32_t>& keys) {
+    RuntimeFilter filter(TypeDescriptor(TYPE_INT), BLOOM_FILTER_VALUES, 0.05);
+    filter.init_bloom_filter(BLOOM_FILTER_VALUES);
+    for (int32_t key : keys) {
+        filter.insert(&key);
+    }
+    filter.finish();
+    PRuntimeFilter pfilter;
+    filter.to_protobuf(&pfilter);
+    return pfilter;
+}
+
+class RuntimeFilterMgrTest : public testing::Test {
+public:
+    RuntimeFilterMgrTest() : _mgr(nullptr) { }
+
+    void SetUp() override {
+        _query_id.hi = 100;
+        _query_id.lo = 200;
+        _origin_expire_time_sec = config::runtime_filter_expire_time_sec;
+        config::runtime_filter_expire_time_sec = 600;
+    }
+
+    void TearDown() override {
+        config::runtime_filter_expire_time_sec = _origin_expire_time_sec;
+    }
+
+    // The filter of one of num_producers instances, published to this backend
+    PMergeRuntimeFilterRequest merge_request(
+            int32_t filter_id, int num_producers, const std::vector<int32_t>& keys) {
+        PMergeRuntimeFilterRequest request;
+        *request.mutable_query_id() = UniqueId(_query_id).to_proto();
+        request.set_filter_id(filter_id);
+        request.set_num_producers(num_producers);
+        PNetworkAddress* target = request.add_targets();
+        target->set_hostname(BackendOptions::get_localhost());
+        target->set_port(config::brpc_port);
+        *request.mutable_filter() = filter_of(keys);
+        return request;
+    }
+
+    PPublishRuntimeFilterRequest publish_request(
+            int32_t filter_id, const std::vector<int32_t>& keys) {
+        PPublishRuntimeFilterRequest request;
+        *request.mutable_query_id() = UniqueId(_query_id).to_proto();
+        request.set_filter_id(filter_id);
+        *request.mutable_filter() = filter_of(keys);
+        return request;
+    }
+
+    // The filter if it is published, without waiting
+    std::shared_ptr<RuntimeFilter> published(int32_t filter_id) {
+        return _mgr.wait(_query_id, filter_id, std::chrono::steady_clock::now());
+    }
+
+protected:
+    RuntimeFilterMgr _mgr;
+    TUniqueId _query_id;
+    int32_t _origin_expire_time_sec;
+};
+
+TEST_F(RuntimeFilterMgrTest, merge_counts_producers) {
+    ASSERT_TRUE(_mgr.merge(merge_request(FILTER_ID, 3, {1, 5})).ok());
+    ASSERT_TRUE(_mgr.merge(merge_request(FILTER_ID, 3, {9})).ok());
+    ASSERT_TRUE(published(FILTER_ID) == nullptr);
+    ASSERT_EQ(1, _mgr._merging.size());
+    ASSERT_EQ(2, _mgr._merging.begin()->second.num_received);
+
+    // the last instance publishes the merged filter
+    ASSERT_TRUE(_mgr.merge(merge_request(FILTER_ID, 3, {3})).ok());
+    ASSERT_TRUE(_mgr._merging.empty());
+    std::shared_ptr<RuntimeFilter> filter = published(FILTER_ID);
+    ASSERT_TRUE(filter != nullptr);
+    ASSERT_EQ(1, *reinterpret_cast<const int32_t*>(filter->min_value()));
+    ASSERT_EQ(9, *reinterpret_cast<const int32_t*>(filter->max_value()));
+    ASSERT_TRUE(filter->bloom_filter() != nullptr);
+    for (int32_t key : {1, 3, 5, 9}) {
+        ASSERT_TRUE(filter->find(&key));
+    }
+    int32_t out_of_range = 10;
+    ASSERT_FALSE(filter->find(&out_of_range));
+
+    // a filter of another type is refused
+    PMergeRuntimeFilterRequest request = merge_request(FILTER_ID + 1, 2, {1});
+    ASSERT_TRUE(_mgr.merge(request).ok());
+    RuntimeFilter bigint_filter(TypeDescriptor(TYPE_BIGINT), 0, 0.05);
+    bigint_filter.to_protobuf(request.mutable_filter());
+    ASSERT_FALSE(_mgr.merge(request).ok());
+}
+
+TEST_F(RuntimeFilterMgrTest, publish_to_local_consumer) {
+    std::shared_ptr<RuntimeFilter> filter;
+    std::thread consumer([this, &filter] {
+        filter = _mgr.wait(_query_id, FILTER_ID,
+                           std::chrono::steady_clock::now() + std::chrono::seconds(60));
+    });
+    ASSERT_TRUE(_mgr.merge(merge_request(FILTER_ID, 1, {4, 2})).ok());
+    consumer.join();
+    ASSERT_TRUE(filter != nullptr);
+    ASSERT_EQ(2, *reinterpret_cast<const int32_t*>(filter->min_value()));
+    ASSERT_EQ(4, *reinterpret_cast<const int32_t*>(filter->max_value()));
+
+    // a filter published by another backend
+    ASSERT_TRUE(_mgr.publish(publish_request(FILTER_ID + 1, {7})).ok());
+    ASSERT_TRUE(published(FILTER_ID + 1) != nullptr);
+}
+
+TEST_F(RuntimeFilterMgrTest, wait_timeout) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::shared_ptr<RuntimeFilter> filter =
+        _mgr.wait(_query_id, FILTER_ID, start + std::chrono::milliseconds(50));
+    ASSERT_TRUE(filter == nullptr);
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+
+    // the filter of another query does not end the wait
+    TUniqueId other_query_id;
+    other_query_id.hi = _query_id.hi + 1;
+    other_query_id.lo = _query_id.lo;
+    ASSERT_TRUE(_mgr.publish(publish_request(FILTER_ID, {1})).ok());
+    ASSERT_TRUE(_mgr.wait(other_query_id, FILTER_ID, std::chrono::steady_clock::now()) == nullptr);
+}
+
+TEST_F(RuntimeFilterMgrTest, gc_expired_filters) {
+    ASSERT_TRUE(_mgr.merge(merge_request(FILTER_ID, 2, {1})).ok());
+    ASSERT_TRUE(_mgr.publish(publish_request(FILTER_ID + 1, {1})).ok());
+
+    // the filters of a query that ended are kept until they expire
+    config::runtime_filter_expire_time_sec = 0;
+    ASSERT_TRUE(_mgr.publish(publish_request(FILTER_ID + 2, {1})).ok());
+    ASSERT_EQ(1, _mgr._merging.size());
+    ASSERT_EQ(2, _mgr._published.size());
+
+    // at most once a minute
+    _mgr._last_gc_time = std::chrono::steady_clock::now() - std::chrono::seconds(61);
+    ASSERT_TRUE(_mgr.publish(publish_request(FILTER_ID + 3, {1})).ok());
+    ASSERT_TRUE(_mgr._merging.empty());
+    ASSERT_EQ(1, _mgr._published.size());
+    ASSERT_TRUE(published(FILTER_ID + 3) != nullptr);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -68,6 +68,11 @@ OLAPStatus DeltaWriter::write(Tuple* tuple) {
     return add_status;
 }
 
+OLAPStatus DeltaWriter::write_batch(const std::vector<Tuple*>& tuples) {
+    _k_tablet_recorder[_req.tablet_id] += tuples.size();
+    return add_status;
+}
+
 OLAPStatus DeltaWriter::close(google::protobuf::RepeatedPtrField<PTabletInfo>* tablet_vec) {
     return close_status;
 }
@@ -0,0 +1,97 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/vectorized_row_batch.h"
+
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "olap/field.h"
+#include "util/cpu_info.h"
+
+namespace doris {
+
+static const int BATCH_SIZE = 1024;
+
+class VectorizedRowBatchTest : public testing::Test {
+public:
+    VectorizedRowBatchTest() {
+        FieldInfo field_info;
+        field_info.name = "c0";
+        field_info.type = OLAP_FIELD_TYPE_INT;
+        field_info.aggregation = OLAP_FIELD_AGGREGATION_NONE;
+        field_info.length = 4;
+        field_info.is_allow_null = false;
+        field_info.is_key = true;
+        field_info.unique_id = 0;
+        field_info.is_bf_column = false;
+        _schema.push_back(field_info);
+        _return_columns.push_back(0);
+        _batch.reset(new VectorizedRowBatch(_schema, _return_columns, BATCH_SIZE));
+    }
+
+    // Reset the batch to all of its rows, optionally pre-selecting every
+    // keep_ratio-th row.
+    void reset_batch(int keep_ratio) {
+        _batch->set_size(BATCH_SIZE);
+        _batch->set_selected_in_use(false);
+        if (keep_ratio > 1) {
+            uint16_t* sel = _batch->selected();
+            uint16_t size = 0;
+            for (int i = 0; i < BATCH_SIZE; i += keep_ratio) {
+                sel[size++] = i;
+            }
+            _batch->set_size(size);
+            _batch->set_selected_in_use(true);
+        }
+    }
+
+    std::vector<uint16_t> selected_rows() {
+        std::vector<uint16_t> rows;
+        for (uint16_t j = 0; j < _batch->size(); ++j) {
+            rows.push_back(_batch->selected_in_use() ? _batch->selected()[j] : j);
+        }
+        return rows;
+    }
+
+    std::vector<FieldInfo> _schema;
+    std::vector<uint32_t> _return_columns;
+    std::unique_ptr<VectorizedRowBatch> _batch;
+};
+
+TEST_F(VectorizedRowBatchTest, skip_rows) {
+    for (int keep_ratio : {1, 2, 10}) {
+        reset_batch(keep_ratio);
+        std::vector<uint16_t> expected = selected_rows();
+        _batch->skip_rows(0);
+        ASSERT_EQ(expected, selected_rows());
+        _batch->skip_rows(3);
+        expected.erase(expected.begin(), expected.begin() + 3);
+        ASSERT_EQ(expected, selected_rows());
+        ASSERT_TRUE(_batch->selected_in_use());
+        _batch->skip_rows(_batch->size());
+        ASSERT_EQ(0, _batch->size());
+    }
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+    return RUN_ALL_TESTS();
+}
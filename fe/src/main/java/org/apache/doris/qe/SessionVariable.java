@@ -68,6 +68,7 @@ public class SessionVariable implements Serializable, Writable {
     public static final String DISABLE_STREAMING_PREAGGREGATIONS = "disable_streaming_preaggregations";
     public static final String DISABLE_COLOCATE_JOIN = "disable_colocate_join";
     public static final String MT_DOP = "mt_dop";
+    public static final String DISABLE_PAGE_CACHE = "disable_page_cache";
 
     // max memory used on every backend.
     @VariableMgr.VarAttr(name = EXEC_MEM_LIMIT)
@@ -178,6 +179,10 @@ public class SessionVariable implements Serializable, Writable {
     @VariableMgr.VarAttr(name = DISABLE_COLOCATE_JOIN)
     private boolean disableColocateJoin = false;
 
+    // do not read or fill the page cache of backends, for one-off scans
+    @VariableMgr.VarAttr(name = DISABLE_PAGE_CACHE)
+    private boolean disablePageCache = false;
+
     public long getMaxExecMemByte() {
         return maxExecMemByte;
     }
@@ -418,6 +423,14 @@ public class SessionVariable implements Serializable, Writable {
         this.disableColocateJoin = disableColocateJoin;
     }
 
+    public boolean isDisablePageCache() {
+        return disablePageCache;
+    }
+
+    public void setDisablePageCache(boolean disablePageCache) {
+        this.disablePageCache = disablePageCache;
+    }
+
     // Serialize to thrift object
     TQueryOptions toThrift() {
         TQueryOptions tResult = new TQueryOptions();
@@ -436,6 +449,7 @@ public class SessionVariable implements Serializable, Writable {
         tResult.setBatch_size(batchSize);
         tResult.setDisable_stream_preaggregations(disableStreamPreaggregations);
         tResult.setMt_dop(mtDop);
+        tResult.setDisable_page_cache(disablePageCache);
         return tResult;
     }
 
@@ -30,6 +30,9 @@ struct TColumn {
     5: optional bool is_allow_null
     6: optional string default_value
     7: optional bool is_bloom_filter_column
+    // store the bloom filter of the column with the split block layout. The
+    // FE does not set it yet, there is no column property for it
+    8: optional bool is_split_block_bloom_filter_column
 }
 
 struct TTabletSchema {
@@ -39,6 +42,9 @@ struct TTabletSchema {
     4: required Types.TStorageType storage_type
     5: required list<TColumn> columns
     6: optional double bloom_filter_fpp
+    // codec of the segment streams, LZ4 if not set. The FE does not set it
+    // yet, there is no table property for it
+    7: optional Types.TCompressKind compress_kind
 }
 
 struct TCreateTabletReq {
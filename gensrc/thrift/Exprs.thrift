@@ -47,6 +47,9 @@ enum TExprNodeType {
   // TODO: old style compute functions. this will be deprecated
   COMPUTE_FUNCTION_CALL,
   LARGE_INT_LITERAL,
+
+  // only created by the BE, for the runtime filters of hash joins
+  RUNTIME_FILTER_PRED,
 }
 
 //enum TAggregationOp {
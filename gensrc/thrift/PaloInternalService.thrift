@@ -126,6 +126,9 @@ struct TQueryOptions {
 
   // multithreaded degree of intra-node parallelism
   27: optional i32 mt_dop = 0;
+
+  // do not read or fill the storage page cache of the backends
+  28: optional bool disable_page_cache = false;
 }
 
 // A scan range plus the parameters needed to execute that scan.
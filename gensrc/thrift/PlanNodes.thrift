@@ -233,12 +233,22 @@ struct TMetaScanNode {
   5: optional string user
 }
 
+// A runtime filter of a hash join in another fragment that an olap scan waits
+// for before it starts scanning
+struct TRuntimeFilterTarget {
+  1: required i32 filter_id
+  // expr of the scanned tuple the filter is applied to, the probe side expr
+  // of the equi-join conjunct
+  2: required Exprs.TExpr target_expr
+}
+
 struct TOlapScanNode {
   1: required Types.TTupleId tuple_id
   2: required list<string> key_column_name
   3: required list<Types.TPrimitiveType> key_column_type
   4: required bool is_preaggregation
   5: optional string sort_column
+  6: optional list<TRuntimeFilterTarget> runtime_filters
 }
 struct TEqJoinCondition {
   // left-hand side of "<a> = <b>"
@@ -267,6 +277,25 @@ enum TJoinOp {
   NULL_AWARE_LEFT_ANTI_JOIN
 }
 
+// A runtime filter of the build side keys of a hash join, which the instances
+// of the join send to one backend, that merges them and publishes the result
+// to the scans of the probe side
+struct TRuntimeFilterDesc {
+  1: required i32 filter_id
+  // index of the equi-join conjunct whose keys are filtered
+  2: required i32 expr_order
+  // brpc address of the backend merging the filter
+  3: required Types.TNetworkAddress merge_addr
+  // number of the instances of the join, all of them send their filter
+  4: required i32 num_producers
+  // brpc addresses of the backends running a target scan
+  5: required list<Types.TNetworkAddress> target_addrs
+  // estimated number of build side rows of all the instances. The bloom
+  // filters of the instances have the size for it so that they can be merged,
+  // only the range of the keys is published if unset and num_producers > 1.
+  6: optional i64 expected_build_rows
+}
+
 struct THashJoinNode {
   1: required TJoinOp join_op
 
@@ -281,6 +310,9 @@ struct THashJoinNode {
   // If true, this join node can (but may choose not to) generate slot filters
   // after constructing the build side that can be applied to the probe side.
   5: optional bool add_probe_filters
+
+  // runtime filters published to the scans of other fragments
+  6: optional list<TRuntimeFilterDesc> runtime_filters
 }
 
 struct TMergeJoinNode {
@@ -47,6 +47,12 @@ enum TStorageMedium {
     SSD,
 }
 
+enum TCompressKind {
+    LZO,
+    LZ4,
+    LZ4HC,
+}
+
 enum TVarType {
     SESSION,
     GLOBAL
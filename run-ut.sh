@@ -165,6 +165,10 @@ ${DORIS_TEST_BINARY_DIR}/exec/broker_scan_node_test
 ${DORIS_TEST_BINARY_DIR}/exec/es_scan_node_test
 ${DORIS_TEST_BINARY_DIR}/exec/olap_table_info_test
 ${DORIS_TEST_BINARY_DIR}/exec/olap_table_sink_test
+${DORIS_TEST_BINARY_DIR}/exec/vectorized_olap_scan_test
+${DORIS_TEST_BINARY_DIR}/exec/olap_scan_node_push_down_test
+${DORIS_TEST_BINARY_DIR}/exec/hash_table_test
+${DORIS_TEST_BINARY_DIR}/exec/partitioned_hash_join_node_test
 
 ## Running runtime Unittest
 ${DORIS_TEST_BINARY_DIR}/runtime/fragment_mgr_test
@@ -178,7 +182,10 @@ ${DORIS_TEST_BINARY_DIR}/runtime/stream_load_pipe_test
 ${DORIS_TEST_BINARY_DIR}/runtime/tablet_writer_mgr_test
 ${DORIS_TEST_BINARY_DIR}/runtime/snapshot_loader_test
 ${DORIS_TEST_BINARY_DIR}/runtime/user_function_cache_test
+${DORIS_TEST_BINARY_DIR}/runtime/vectorized_row_batch_test
+${DORIS_TEST_BINARY_DIR}/runtime/runtime_filter_mgr_test
 ## Running expr Unittest
+${DORIS_TEST_BINARY_DIR}/exprs/runtime_filter_test
 
 # Running http
 ${DORIS_TEST_BINARY_DIR}/http/metrics_action_test
@@ -199,16 +206,28 @@ ${DORIS_TEST_BINARY_DIR}/olap/row_block_test
 ${DORIS_TEST_BINARY_DIR}/olap/comparison_predicate_test
 ${DORIS_TEST_BINARY_DIR}/olap/in_list_predicate_test
 ${DORIS_TEST_BINARY_DIR}/olap/null_predicate_test
+${DORIS_TEST_BINARY_DIR}/olap/bloom_filter_predicate_test
+${DORIS_TEST_BINARY_DIR}/olap/predicate_kernel_test
 ${DORIS_TEST_BINARY_DIR}/olap/file_helper_test
 ${DORIS_TEST_BINARY_DIR}/olap/file_utils_test
 ${DORIS_TEST_BINARY_DIR}/olap/delete_handler_test
 ${DORIS_TEST_BINARY_DIR}/olap/column_reader_test
 ${DORIS_TEST_BINARY_DIR}/olap/row_cursor_test
 ${DORIS_TEST_BINARY_DIR}/olap/skiplist_test
+${DORIS_TEST_BINARY_DIR}/olap/memtable_test
 ${DORIS_TEST_BINARY_DIR}/olap/serialize_test
+${DORIS_TEST_BINARY_DIR}/olap/compress_test
+${DORIS_TEST_BINARY_DIR}/olap/loser_tree_test
+${DORIS_TEST_BINARY_DIR}/olap/stream_page_cache_test
+${DORIS_TEST_BINARY_DIR}/olap/stream_read_ahead_test
+${DORIS_TEST_BINARY_DIR}/olap/compaction_scheduler_test
+${DORIS_TEST_BINARY_DIR}/olap/key_prefix_index_test
+${DORIS_TEST_BINARY_DIR}/olap/ngram_bloom_filter_test
 ${DORIS_TEST_BINARY_DIR}/olap/olap_header_manager_test
 ${DORIS_TEST_BINARY_DIR}/olap/olap_meta_test
 ${DORIS_TEST_BINARY_DIR}/olap/delta_writer_test
+${DORIS_TEST_BINARY_DIR}/olap/block_split_test
+${DORIS_TEST_BINARY_DIR}/olap/columnar_merger_test
 
 ## Running agent unittest
 # Prepare agent testdata